@@ -0,0 +1,531 @@
+/*
+ *  autofind_peaks.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef AUTOFIND_PEAKS_H_INCLUDED
+#define AUTOFIND_PEAKS_H_INCLUDED
+
+// The peak search of Star::AutoFind: PSF convolution of the image and
+// detection of its brightest local maxima, either at full resolution or on
+// a binned copy refined at full resolution. It only depends on wxRect and
+// wxSize so it can be run outside PHD2 (see tests/autofind_test.cpp).
+
+#include "computepool.h"
+
+#include <wx/gdicmn.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <vector>
+
+class AutoFindPeaks
+{
+public:
+    // 3x3 median filter of rect, see Median3() in image_math.h
+    typedef bool (*MedianFn)(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect);
+
+    struct FloatImg
+    {
+        float *px;
+        wxSize Size;
+        unsigned int NPixels;
+
+        FloatImg() : px(0) { }
+        FloatImg(const wxSize& size) : px(0) { Init(size); }
+        FloatImg(const unsigned short *src, const wxSize& size) : px(0) {
+            Init(size);
+            for (unsigned int i = 0; i < NPixels; i++)
+                px[i] = (float) src[i];
+        }
+        ~FloatImg() { delete[] px; }
+        void Init(const wxSize& sz) { delete[] px;  Size = sz; NPixels = Size.GetWidth() * Size.GetHeight(); px = new float[NPixels]; }
+        void Swap(FloatImg& other) { std::swap(px, other.px); std::swap(Size, other.Size); std::swap(NPixels, other.NPixels); }
+
+    private:
+        FloatImg(const FloatImg&);
+        FloatImg& operator=(const FloatImg&);
+    };
+
+    struct Peak
+    {
+        int x;
+        int y;
+        float val;
+
+        Peak() { }
+        Peak(int x_, int y_, float val_) : x(x_), y(y_), val(val_) { }
+        bool operator<(const Peak& rhs) const { return val < rhs.val; }
+    };
+
+    // statistics of the search, for the debug log
+    struct SearchStats
+    {
+        double mean;                // full resolution PSF-convolved image
+        double stdev;
+        unsigned int candidates;    // peaks found in the binned image
+    };
+
+    enum { CONV_RADIUS = 4 };  // psf_conv leaves this many pixels around the edge without data
+
+    enum
+    {
+        PEAK_SRCH = 4,      // a peak must be the maximum within this distance
+        PEAK_LOCAL = 7,     // half-size of the window the peak is compared to
+    };
+
+    static double PeakThreshold() { return 0.1; }
+
+    // Binning factor for the search of an image of npixels pixels, 1 for a
+    // full resolution search
+    static int Downsample(unsigned int npixels)
+    {
+        // image sizes above which AutoFind searches a binned image first
+        static const unsigned int AUTOFIND_BIN2_PIXELS = 4 * 1024 * 1024;
+        static const unsigned int AUTOFIND_BIN4_PIXELS = 16 * 1024 * 1024;
+
+        if (npixels > AUTOFIND_BIN4_PIXELS)
+            return 4;
+        if (npixels > AUTOFIND_BIN2_PIXELS)
+            return 2;
+        return 1;
+    }
+
+    static void GetStats(double *mean, double *stdev, const FloatImg& img, const wxRect& win)
+    {
+        // Determine the mean and standard deviation
+        double sum = 0.0;
+        double a = 0.0;
+        double q = 0.0;
+        double k = 1.0;
+        double km1 = 0.0;
+
+        const int width = img.Size.GetWidth();
+        const float *p0 = &img.px[win.GetTop() * width + win.GetLeft()];
+        for (int y = 0; y < win.GetHeight(); y++)
+        {
+            const float *end = p0 + win.GetWidth();
+            for (const float *p = p0; p < end; p++)
+            {
+                double const x = (double) *p;
+                sum += x;
+                double const a0 = a;
+                a += (x - a) / k;
+                q += (x - a0) * (x - a);
+                km1 = k;
+                k += 1.0;
+            }
+            p0 += width;
+        }
+
+        *mean = sum / km1;
+        *stdev = sqrt(q / km1);
+    }
+
+    static void psf_conv(FloatImg& dst, const FloatImg& src)
+    {
+        dst.Init(src.Size);
+
+        //                       A      B1     B2    C1     C2    C3     D1     D2     D3
+        const double PSF[] = { 0.906, 0.584, 0.365, .117, .049, -0.05, -.064, -.074, -.094 };
+
+        int const width = src.Size.GetWidth();
+        int const height = src.Size.GetHeight();
+
+        memset(dst.px, 0, src.NPixels * sizeof(float));
+
+        /* PSF Grid is:
+        D3 D3 D3 D3 D3 D3 D3 D3 D3
+        D3 D3 D3 D2 D1 D2 D3 D3 D3
+        D3 D3 C3 C2 C1 C2 C3 D3 D3
+        D3 D2 C2 B2 B1 B2 C2 D2 D3
+        D3 D1 C1 B1 A  B1 C1 D1 D3
+        D3 D2 C2 B2 B1 B2 C2 D2 D3
+        D3 D3 C3 C2 C1 C2 C3 D3 D3
+        D3 D3 D3 D2 D1 D2 D3 D3 D3
+        D3 D3 D3 D3 D3 D3 D3 D3 D3
+
+        1@A
+        4@B1, B2, C1, C3, D1
+        8@C2, D2
+        44 * D3
+        */
+
+        int psf_size = 4;
+
+        ComputePool::ParallelRows(height - 2 * psf_size, width, [&](int r0, int r1) {
+            for (int y = psf_size + r0; y < psf_size + r1; y++)
+            {
+                for (int x = psf_size; x < width - psf_size; x++)
+                {
+                    float A, B1, B2, C1, C2, C3, D1, D2, D3;
+
+#define PX(dx, dy) *(src.px + width * (y + (dy)) + x + (dx))
+                    A =  PX(+0, +0);
+                    B1 = PX(+0, -1) + PX(+0, +1) + PX(+1, +0) + PX(-1, +0);
+                    B2 = PX(-1, -1) + PX(+1, -1) + PX(-1, +1) + PX(+1, +1);
+                    C1 = PX(+0, -2) + PX(-2, +0) + PX(+2, +0) + PX(+0, +2);
+                    C2 = PX(-1, -2) + PX(+1, -2) + PX(-2, -1) + PX(+2, -1) + PX(-2, +1) + PX(+2, +1) + PX(-1, +2) + PX(+1, +2);
+                    C3 = PX(-2, -2) + PX(+2, -2) + PX(-2, +2) + PX(+2, +2);
+                    D1 = PX(+0, -3) + PX(-3, +0) + PX(+3, +0) + PX(+0, +3);
+                    D2 = PX(-1, -3) + PX(+1, -3) + PX(-3, -1) + PX(+3, -1) + PX(-3, +1) + PX(+3, +1) + PX(-1, +3) + PX(+1, +3);
+                    D3 = PX(-4, -2) + PX(-3, -2) + PX(+3, -2) + PX(+4, -2) + PX(-4, -1) + PX(+4, -1) + PX(-4, +0) + PX(+4, +0) + PX(-4, +1) + PX(+4, +1) + PX(-4, +2) + PX(-3, +2) + PX(+3, +2) + PX(+4, +2);
+#undef PX
+                    int i;
+                    const float *uptr;
+
+                    uptr = src.px + width * (y - 4) + (x - 4);
+                    for (i = 0; i < 9; i++)
+                        D3 += *uptr++;
+
+                    uptr = src.px + width * (y - 3) + (x - 4);
+                    for (i = 0; i < 3; i++)
+                        D3 += *uptr++;
+                    uptr += 3;
+                    for (i = 0; i < 3; i++)
+                        D3 += *uptr++;
+
+                    uptr = src.px + width * (y + 3) + (x - 4);
+                    for (i = 0; i < 3; i++)
+                        D3 += *uptr++;
+                    uptr += 3;
+                    for (i = 0; i < 3; i++)
+                        D3 += *uptr++;
+
+                    uptr = src.px + width * (y + 4) + (x - 4);
+                    for (i = 0; i < 9; i++)
+                        D3 += *uptr++;
+
+                    double mean = (A + B1 + B2 + C1 + C2 + C3 + D1 + D2 + D3) / 81.0;
+                    double PSF_fit = PSF[0] * (A - mean) + PSF[1] * (B1 - 4.0 * mean) + PSF[2] * (B2 - 4.0 * mean) +
+                        PSF[3] * (C1 - 4.0 * mean) + PSF[4] * (C2 - 8.0 * mean) + PSF[5] * (C3 - 4.0 * mean) +
+                        PSF[6] * (D1 - 4.0 * mean) + PSF[7] * (D2 - 8.0 * mean) + PSF[8] * (D3 - 44.0 * mean);
+
+                    dst.px[width * y + x] = (float) PSF_fit;
+                }
+            }
+        });
+    }
+
+    // Median-filtered, PSF-convolved image, the input of the full
+    // resolution search. The median eliminates hot pixels.
+    static void ConvImage(FloatImg& dst, const unsigned short *image, const wxSize& size, MedianFn median)
+    {
+        std::vector<unsigned short> smoothed(size.GetWidth() * size.GetHeight());
+        median(&smoothed[0], image, size, wxRect(size));
+
+        FloatImg tmp(&smoothed[0], size);
+        psf_conv(dst, tmp);
+    }
+
+    // Average each factor x factor block of pixels, leaving out the brightest
+    // pixel of the block. This removes hot pixels in the same pass; a median
+    // filter after binning would remove stars smaller than a binned pixel.
+    static void Bin(FloatImg& dst, const unsigned short *src, const wxSize& size, int factor)
+    {
+        int const width = size.GetWidth();
+        int const dw = size.GetWidth() / factor;
+        int const dh = size.GetHeight() / factor;
+        unsigned int const n = factor * factor;
+
+        dst.Init(wxSize(dw, dh));
+
+        ComputePool::ParallelRows(dh, dw * n, [&](int y0, int y1) {
+            for (int yy = y0; yy < y1; yy++)
+            {
+                for (int xx = 0; xx < dw; xx++)
+                {
+                    unsigned int sum = 0;
+                    unsigned short maxv = 0;
+                    for (int j = 0; j < factor; j++)
+                    {
+                        const unsigned short *p = src + (yy * factor + j) * width + xx * factor;
+                        for (int i = 0; i < factor; i++)
+                        {
+                            sum += p[i];
+                            if (p[i] > maxv)
+                                maxv = p[i];
+                        }
+                    }
+                    dst.px[yy * dw + xx] = (float)(unsigned short)((sum - maxv + (n - 1) / 2) / (n - 1));
+                }
+            }
+        });
+    }
+
+    // Median-filtered, PSF-convolved image values within rect, computed from
+    // only the pixels around rect. Values match those of the whole image
+    // convolved at once wherever the whole image has valid data.
+    static void ConvWindow(FloatImg& dst, const unsigned short *image, const wxSize& size, const wxRect& rect, MedianFn median)
+    {
+        enum { MARGIN = CONV_RADIUS + 1 };  // psf_conv radius + median radius
+
+        wxRect src(rect);
+        src.Inflate(MARGIN);
+        src.Intersect(wxRect(size));
+
+        std::vector<unsigned short> tmp(src.GetWidth() * src.GetHeight());
+        for (int y = 0; y < src.GetHeight(); y++)
+        {
+            memcpy(&tmp[y * src.GetWidth()], image + (src.GetTop() + y) * size.GetWidth() + src.GetLeft(),
+                   src.GetWidth() * sizeof(unsigned short));
+        }
+
+        FloatImg conv;
+        ConvImage(conv, &tmp[0], src.GetSize(), median);
+
+        dst.Init(rect.GetSize());
+        for (int y = 0; y < rect.GetHeight(); y++)
+        {
+            memcpy(dst.px + y * rect.GetWidth(),
+                   conv.px + (rect.GetTop() - src.GetTop() + y) * src.GetWidth() + rect.GetLeft() - src.GetLeft(),
+                   rect.GetWidth() * sizeof(float));
+        }
+    }
+
+    // Estimate the mean and standard deviation of the whole PSF-convolved image
+    // from evenly spaced strips of rows
+    static void GetConvStats(double *mean, double *stdev, const unsigned short *image, const wxSize& size, const wxRect& convRect,
+                             MedianFn median)
+    {
+        enum { STRIP_ROWS = 8, STRIP_SPACING = 128 };
+
+        double n = 0.0;
+        double m = 0.0;
+        double m2 = 0.0;
+
+        for (int y = convRect.GetTop(); y <= convRect.GetBottom(); y += STRIP_SPACING)
+        {
+            wxRect strip(convRect.GetLeft(), y, convRect.GetWidth(), std::min((int) STRIP_ROWS, convRect.GetBottom() - y + 1));
+
+            FloatImg conv;
+            ConvWindow(conv, image, size, strip, median);
+
+            double smean, sstdev;
+            GetStats(&smean, &sstdev, conv, wxRect(conv.Size));
+
+            // combine with the previous strips
+            double const ns = (double) conv.NPixels;
+            double const nt = n + ns;
+            double const delta = smean - m;
+            m += delta * ns / nt;
+            m2 += sstdev * sstdev * ns + delta * delta * n * ns / nt;
+            n = nt;
+        }
+
+        *mean = m;
+        *stdev = sqrt(m2 / n);
+    }
+
+    // Check whether (x, y) is a local maximum of the PSF-convolved image and
+    // measure its intensity relative to the surrounding pixels. convRect is the
+    // region of conv containing valid data.
+    static bool MeasurePeak(double *h, const FloatImg& conv, const wxRect& convRect, int x, int y, int srch, double global_stdev)
+    {
+        int const dw = conv.Size.GetWidth();
+        float const val = conv.px[dw * y + x];
+
+        if (val <= 0.0)
+            return false;
+
+        for (int j = -srch; j <= srch; j++)
+        {
+            for (int i = -srch; i <= srch; i++)
+            {
+                if (i == 0 && j == 0)
+                    continue;
+                if (conv.px[dw * (y + j) + (x + i)] > val)
+                    return false;
+            }
+        }
+
+        // compare local maximum to mean value of surrounding pixels
+        double local_mean, local_stdev;
+        wxRect localRect(x - PEAK_LOCAL, y - PEAK_LOCAL, 2 * PEAK_LOCAL + 1, 2 * PEAK_LOCAL + 1);
+        localRect.Intersect(convRect);
+        GetStats(&local_mean, &local_stdev, conv, localRect);
+
+        // this is our measure of star intensity
+        *h = (val - local_mean) / global_stdev;
+
+        return *h >= PeakThreshold();
+    }
+
+    static void AddPeak(std::set<Peak>& stars, const Peak& peak, size_t maxPeaks)
+    {
+        stars.insert(peak);
+        if (stars.size() > maxPeaks)
+            stars.erase(stars.begin());
+    }
+
+    // Find the brightest local maxima of the PSF-convolved image. The peak
+    // coordinates are scaled up by downsample to the original image.
+    static void FindPeaks(std::set<Peak>& stars, const FloatImg& conv, int srch, int downsample, size_t maxPeaks,
+                          SearchStats *stats)
+    {
+        int dw = conv.Size.GetWidth();      // width of the downsampled image
+        int dh = conv.Size.GetHeight();     // height of the downsampled image
+        wxRect convRect(CONV_RADIUS, CONV_RADIUS, dw - 2 * CONV_RADIUS, dh - 2 * CONV_RADIUS);  // region containing valid data
+
+        double global_mean, global_stdev;
+        GetStats(&global_mean, &global_stdev, conv, convRect);
+
+        stats->mean = global_mean;
+        stats->stdev = global_stdev;
+        stats->candidates = 0;
+
+        // find each local maximum
+        for (int y = convRect.GetTop() + srch; y <= convRect.GetBottom() - srch; y++)
+        {
+            for (int x = convRect.GetLeft() + srch; x <= convRect.GetRight() - srch; x++)
+            {
+                double h;
+                if (!MeasurePeak(&h, conv, convRect, x, y, srch, global_stdev))
+                    continue;
+
+                // coordinates on the original image
+                int imgx = x * downsample + downsample / 2;
+                int imgy = y * downsample + downsample / 2;
+
+                AddPeak(stars, Peak(imgx, imgy, h), maxPeaks);
+            }
+        }
+    }
+
+    // Search the whole image at full resolution
+    static void FindPeaksFull(std::set<Peak>& stars, const unsigned short *image, const wxSize& size, size_t maxPeaks,
+                              MedianFn median, SearchStats *stats, FloatImg *convOut = 0)
+    {
+        FloatImg conv;
+        ConvImage(conv, image, size, median);
+
+        FindPeaks(stars, conv, PEAK_SRCH, 1, maxPeaks, stats);
+
+        if (convOut)
+            convOut->Swap(conv);
+    }
+
+    // Search a binned copy of the image for candidate stars, then measure each
+    // candidate at full resolution in a small window around it. This finds the
+    // same peaks as searching the full resolution image while convolving only
+    // a small part of it at full resolution.
+    static void FindPeaksBinned(std::set<Peak>& stars, const unsigned short *image, const wxSize& size, int downsample, size_t maxPeaks,
+                                MedianFn median, SearchStats *stats, FloatImg *convOut = 0)
+    {
+        FloatImg conv;
+        {
+            FloatImg binned;
+            Bin(binned, image, size, downsample);
+            psf_conv(conv, binned);
+        }
+
+        // the binned image only has to locate the stars, so keep extra
+        // candidates in case the ranking changes at full resolution
+        std::set<Peak> candidates;
+        SearchStats binnedStats;
+        FindPeaks(candidates, conv, std::max(PEAK_SRCH / downsample, 1), downsample, 2 * maxPeaks, &binnedStats);
+
+        if (convOut)
+            convOut->Swap(conv);
+
+        wxRect convRect(CONV_RADIUS, CONV_RADIUS, size.GetWidth() - 2 * CONV_RADIUS, size.GetHeight() - 2 * CONV_RADIUS);
+
+        double global_mean, global_stdev;
+        GetConvStats(&global_mean, &global_stdev, image, size, convRect, median);
+
+        stats->mean = global_mean;
+        stats->stdev = global_stdev;
+        stats->candidates = (unsigned int) candidates.size();
+
+        // full resolution peaks are taken where the full image search would look for them
+        wxRect peakRect(convRect);
+        peakRect.Deflate(PEAK_SRCH);
+
+        int const reach = downsample;                // distance from a candidate to its full resolution peak
+        int const half = reach + PEAK_LOCAL;         // window size covering the peak and its surroundings
+
+        std::vector<Peak> cand(candidates.begin(), candidates.end());
+        std::vector<Peak> refined(cand.size());
+        std::vector<char> found(cand.size());
+
+        ComputePool::ParallelFor((int) cand.size(), 8, [&](int begin, int end) {
+            for (int k = begin; k < end; k++)
+            {
+                wxRect search(cand[k].x - reach, cand[k].y - reach, 2 * reach + 1, 2 * reach + 1);
+                search.Intersect(peakRect);
+                if (search.IsEmpty())
+                    continue;
+
+                wxRect win(cand[k].x - half, cand[k].y - half, 2 * half + 1, 2 * half + 1);
+                win.Intersect(wxRect(size));
+
+                FloatImg wconv;
+                ConvWindow(wconv, image, size, win, median);
+
+                wxRect wconvRect(convRect);
+                wconvRect.Intersect(win);
+                wconvRect.Offset(-win.GetLeft(), -win.GetTop());
+
+                // brightest full resolution pixel near the candidate
+                int px = search.GetLeft(), py = search.GetTop();
+                float best = wconv.px[(py - win.GetTop()) * win.GetWidth() + px - win.GetLeft()];
+                for (int y = search.GetTop(); y <= search.GetBottom(); y++)
+                {
+                    for (int x = search.GetLeft(); x <= search.GetRight(); x++)
+                    {
+                        float const val = wconv.px[(y - win.GetTop()) * win.GetWidth() + x - win.GetLeft()];
+                        if (val > best)
+                        {
+                            best = val;
+                            px = x;
+                            py = y;
+                        }
+                    }
+                }
+
+                double h;
+                if (MeasurePeak(&h, wconv, wconvRect, px - win.GetLeft(), py - win.GetTop(), PEAK_SRCH, global_stdev))
+                {
+                    refined[k] = Peak(px, py, h);
+                    found[k] = 1;
+                }
+            }
+        });
+
+        for (size_t k = 0; k < cand.size(); k++)
+            if (found[k])
+                AddPeak(stars, refined[k], maxPeaks);
+    }
+};
+
+#endif
@@ -377,7 +377,7 @@ BacklashComp::BacklashComp(Scope *scope)
 {
     m_pScope = scope;
     m_pHistory = new BLCHistory();
-    int lastAmt = pConfig->Profile.GetInt("/" + m_pScope->GetMountClassName() + "/DecBacklashPulse", 0);
+    int lastAmt = SettingsRegistry::Current()->decBacklashPulse;
     int lastFloor = pConfig->Profile.GetInt("/" + m_pScope->GetMountClassName() + "/DecBacklashFloor", 0);
     int lastCeiling = pConfig->Profile.GetInt("/" + m_pScope->GetMountClassName() + "/DecBacklashCeiling", 0);
     if (lastAmt > 0)
@@ -450,7 +450,7 @@ void BacklashComp::SetBacklashPulse(int ms, int floor, int ceiling)
         }
     }
 
-    pConfig->Profile.SetInt("/" + m_pScope->GetMountClassName() + "/DecBacklashPulse", m_pulseWidth);
+    SettingsRegistry::Set(&SettingsSnapshot::decBacklashPulse, m_pulseWidth);
     pConfig->Profile.SetInt("/" + m_pScope->GetMountClassName() + "/DecBacklashFloor", m_adjustmentFloor);
     pConfig->Profile.SetInt("/" + m_pScope->GetMountClassName() + "/DecBacklashCeiling", m_adjustmentCeiling);
 }
@@ -549,8 +549,9 @@ void BacklashComp::_TrackBLCResults(unsigned int moveTypeOptions, double yDistan
             }
         }
         Debug.Write(wxString::Format("BLC: Pulse adjusted to %d\n", newBLC));
-        pConfig->Profile.SetInt("/" + m_pScope->GetMountClassName() + "/DecBacklashPulse", newBLC);
         SetCompValues(newBLC, m_adjustmentFloor, m_adjustmentCeiling);
+        // queued and written to the profile on the main thread
+        SettingsRegistry::Set(&SettingsSnapshot::decBacklashPulse, m_pulseWidth);
 
     }
 
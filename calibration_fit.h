@@ -0,0 +1,362 @@
+/*
+ *  calibration_fit.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef CALIBRATION_FIT_INCLUDED
+#define CALIBRATION_FIT_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Robust straight-line fit of the star positions recorded along one
+// calibration leg.
+//
+// Each sample is the star position after a known total guide pulse
+// duration. The fit solves pos = p0 + v * t by iteratively reweighted least
+// squares: points far from the line are down-weighted (Huber) and gross
+// outliers, such as a centroid on the wrong star, are dropped entirely, so a
+// single bad frame no longer ends or spoils the leg. The residual scatter
+// gives the uncertainty of the direction and rate, which lets the leg stop as
+// soon as they are known well enough.
+//
+// It only depends on PHD_Point so it can be run outside PHD2 (see
+// tests/calibration_fit_test.cpp).
+class CalibrationFit
+{
+    struct Sample
+    {
+        double t;       // cumulative pulse duration, ms
+        PHD_Point pos;
+        double weight;
+    };
+
+    std::vector<Sample> m_samples;
+    double m_vx;
+    double m_vy;
+    double m_x0;
+    double m_y0;
+    double m_sigma;     // per-axis position scatter, pixels
+    double m_rateErr;   // standard error of the rate, px/ms
+    double m_dof;
+    bool m_valid;
+
+    enum
+    {
+        HUBER_K = 2,            // residuals beyond this many sigma are down-weighted
+        REJECT_K = 5,           // residuals beyond this many sigma are ignored
+        MAX_ITERATIONS = 10,
+    };
+    // pixels; centroid noise is never really lower than this
+    static double MinSigma() { return 0.1; }
+
+public:
+    CalibrationFit();
+
+    void Reset();
+    void AddSample(double t, const PHD_Point& pos);
+
+    bool IsValid() const { return m_valid; }
+    int SampleCount() const { return (int) m_samples.size(); }
+    int OutlierCount() const;
+    bool LastSampleIsOutlier() const;
+    const PHD_Point& Origin() const { return m_samples[0].pos; }
+    const PHD_Point& SamplePos(int idx) const { return m_samples[idx].pos; }
+
+    // direction of motion in image coordinates, radians
+    double Angle() const;
+    // speed of motion, px/ms
+    double Rate() const;
+    // fitted displacement from the start of the leg to the latest sample, pixels
+    double Displacement() const;
+    // half-widths of the ~95% confidence intervals
+    double AngleInterval() const;
+    double RateInterval() const;
+
+    // true when there are enough samples and both intervals are within tolerance;
+    // rateTolerance is relative to the rate
+    bool IsConverged(int minSamples, double angleTolerance, double rateTolerance) const;
+
+private:
+    static double TQuantile(double dof);
+    static double FitLine(const std::vector<Sample>& samples, double *vx, double *vy, double *x0, double *y0);
+    static bool MedianLine(const std::vector<Sample>& samples, double *vx, double *vy, double *x0, double *y0);
+    void Solve();
+};
+
+inline CalibrationFit::CalibrationFit()
+{
+    Reset();
+}
+
+inline void CalibrationFit::Reset()
+{
+    m_samples.clear();
+    m_vx = m_vy = 0.0;
+    m_x0 = m_y0 = 0.0;
+    m_sigma = 0.0;
+    m_rateErr = 0.0;
+    m_dof = 0.0;
+    m_valid = false;
+}
+
+inline void CalibrationFit::AddSample(double t, const PHD_Point& pos)
+{
+    Sample s;
+    s.t = t;
+    s.pos = pos;
+    s.weight = 1.0;
+    m_samples.push_back(s);
+
+    Solve();
+}
+
+// weighted least-squares line through the samples; returns the sum of
+// (t - tmean)^2 weighted, or 0 when the line is undetermined
+inline double CalibrationFit::FitLine(const std::vector<Sample>& samples, double *vx, double *vy, double *x0, double *y0)
+{
+    double sw = 0.0, st = 0.0, sx = 0.0, sy = 0.0;
+    for (const auto& s : samples)
+    {
+        sw += s.weight;
+        st += s.weight * s.t;
+        sx += s.weight * s.pos.X;
+        sy += s.weight * s.pos.Y;
+    }
+    if (sw <= 0.0)
+        return 0.0;
+
+    double const tm = st / sw;
+    double const xm = sx / sw;
+    double const ym = sy / sw;
+
+    double stt = 0.0, stx = 0.0, sty = 0.0;
+    for (const auto& s : samples)
+    {
+        double const dt = s.t - tm;
+        stt += s.weight * dt * dt;
+        stx += s.weight * dt * (s.pos.X - xm);
+        sty += s.weight * dt * (s.pos.Y - ym);
+    }
+    if (stt <= 0.0)
+        return 0.0;
+
+    *vx = stx / stt;
+    *vy = sty / stt;
+    *x0 = xm - *vx * tm;
+    *y0 = ym - *vy * tm;
+
+    return stt;
+}
+
+static inline double MedianOf(std::vector<double>& v)
+{
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    return v[v.size() / 2];
+}
+
+// Siegel's repeated median line through the samples. It is not pulled off by
+// a bad sample even when the leg has only three or four good ones, so it is
+// the starting point for the reweighting; returns false when all the samples
+// have the same t
+inline bool CalibrationFit::MedianLine(const std::vector<Sample>& samples, double *vx, double *vy, double *x0, double *y0)
+{
+    size_t const n = samples.size();
+    std::vector<double> sx, sy, mx, my;
+    sx.reserve(n);
+    sy.reserve(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        sx.clear();
+        sy.clear();
+        for (size_t j = 0; j < n; j++)
+        {
+            double const dt = samples[j].t - samples[i].t;
+            if (dt == 0.0)
+                continue;
+            sx.push_back((samples[j].pos.X - samples[i].pos.X) / dt);
+            sy.push_back((samples[j].pos.Y - samples[i].pos.Y) / dt);
+        }
+        if (sx.empty())
+            continue;
+        mx.push_back(MedianOf(sx));
+        my.push_back(MedianOf(sy));
+    }
+    if (mx.empty())
+        return false;
+
+    *vx = MedianOf(mx);
+    *vy = MedianOf(my);
+
+    mx.clear();
+    my.clear();
+    for (const auto& s : samples)
+    {
+        mx.push_back(s.pos.X - *vx * s.t);
+        my.push_back(s.pos.Y - *vy * s.t);
+    }
+    *x0 = MedianOf(mx);
+    *y0 = MedianOf(my);
+
+    return true;
+}
+
+inline void CalibrationFit::Solve()
+{
+    m_valid = false;
+
+    size_t const n = m_samples.size();
+    if (n < 3)
+        return;
+
+    for (auto& s : m_samples)
+        s.weight = 1.0;
+
+    if (!MedianLine(m_samples, &m_vx, &m_vy, &m_x0, &m_y0))
+        return;
+
+    std::vector<double> resid(n);
+    std::vector<double> tmp(n);
+
+    for (int iter = 0; iter < MAX_ITERATIONS; iter++)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            const Sample& s = m_samples[i];
+            resid[i] = hypot(s.pos.X - (m_x0 + m_vx * s.t), s.pos.Y - (m_y0 + m_vy * s.t));
+        }
+
+        // robust scale: the residual length of a 2-D gaussian is Rayleigh
+        // distributed with median sigma * sqrt(2 ln 2)
+        tmp = resid;
+        std::nth_element(tmp.begin(), tmp.begin() + n / 2, tmp.end());
+        double const scale = std::max(tmp[n / 2] / 1.1774, MinSigma());
+
+        bool changed = false;
+        for (size_t i = 0; i < n; i++)
+        {
+            double w;
+            if (resid[i] <= HUBER_K * scale)
+                w = 1.0;
+            else if (resid[i] <= REJECT_K * scale)
+                w = HUBER_K * scale / resid[i];
+            else
+                w = 0.0;
+            if (fabs(w - m_samples[i].weight) > 1e-3)
+                changed = true;
+            m_samples[i].weight = w;
+        }
+
+        if (!changed)
+            break;
+
+        if (FitLine(m_samples, &m_vx, &m_vy, &m_x0, &m_y0) == 0.0)
+            return;
+    }
+
+    double const stt = FitLine(m_samples, &m_vx, &m_vy, &m_x0, &m_y0);
+    if (stt == 0.0)
+        return;
+
+    double sw = 0.0, sr2 = 0.0;
+    for (const auto& s : m_samples)
+    {
+        double const dx = s.pos.X - (m_x0 + m_vx * s.t);
+        double const dy = s.pos.Y - (m_y0 + m_vy * s.t);
+        sw += s.weight;
+        sr2 += s.weight * (dx * dx + dy * dy);
+    }
+
+    // two axes, each losing two degrees of freedom to the line
+    m_dof = 2.0 * (sw - 2.0);
+    if (m_dof < 1.0)
+        return;
+
+    m_sigma = std::max(sqrt(sr2 / m_dof), MinSigma());
+    m_rateErr = m_sigma / sqrt(stt);
+    m_valid = true;
+}
+
+inline int CalibrationFit::OutlierCount() const
+{
+    int count = 0;
+    for (const auto& s : m_samples)
+        if (s.weight == 0.0)
+            ++count;
+    return count;
+}
+
+inline bool CalibrationFit::LastSampleIsOutlier() const
+{
+    return m_valid && m_samples.back().weight == 0.0;
+}
+
+inline double CalibrationFit::Angle() const
+{
+    return atan2(m_vy, m_vx);
+}
+
+inline double CalibrationFit::Rate() const
+{
+    return hypot(m_vx, m_vy);
+}
+
+inline double CalibrationFit::Displacement() const
+{
+    return Rate() * (m_samples.back().t - m_samples.front().t);
+}
+
+// two-sided 95% Student t quantile, approximated well enough for dof >= 1
+inline double CalibrationFit::TQuantile(double dof)
+{
+    return 1.96 + 2.5 / dof + 3.0 / (dof * dof);
+}
+
+inline double CalibrationFit::RateInterval() const
+{
+    return TQuantile(m_dof) * m_rateErr;
+}
+
+inline double CalibrationFit::AngleInterval() const
+{
+    double const rate = Rate();
+    return rate > 0.0 ? std::min(RateInterval() / rate, M_PI) : M_PI;
+}
+
+inline bool CalibrationFit::IsConverged(int minSamples, double angleTolerance, double rateTolerance) const
+{
+    return m_valid && SampleCount() >= minSamples && !LastSampleIsOutlier() &&
+        AngleInterval() <= angleTolerance && RateInterval() <= rateTolerance * Rate();
+}
+
+#endif
@@ -291,7 +291,7 @@ LEWebcamDialog::LEWebcamDialog(wxWindow *parent, CVVidCapture *vc)
 
         if (serialPorts.IsEmpty())
         {
-            wxMessageBox(_("No serial ports found"),_("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_("No serial ports found"),_("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("No Serial port found");
         }
 
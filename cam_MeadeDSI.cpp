@@ -109,13 +109,13 @@ bool CameraDSI::Connect(const wxString& camId)
     }
 
     retval = !(MeadeCam->Open(DevNum));
-//  wxMessageBox(wxString::Format("Color: %d\n%u x %u",
+//  PhdMessageBox(wxString::Format("Color: %d\n%u x %u",
 //      MeadeCam->IsColor,MeadeCam->GetWidth(),MeadeCam->GetHeight()));
     if (!retval) {
         FullSize = wxSize(MeadeCam->GetWidth(),MeadeCam->GetHeight());
-//      wxMessageBox(wxString::Format("%s\n%s (%d)\nColor: %d\n-II: %d\n%u x %u",MeadeCam->CcdName,MeadeCam->ModelName, MeadeCam->ModelNumber,
+//      PhdMessageBox(wxString::Format("%s\n%s (%d)\nColor: %d\n-II: %d\n%u x %u",MeadeCam->CcdName,MeadeCam->ModelName, MeadeCam->ModelNumber,
 //          MeadeCam->IsColor,MeadeCam->IsDsiII, FullSize.GetWidth(), FullSize.GetHeight()) + "\n" + MeadeCam->ErrorMessage);
-//      wxMessageBox(wxString::Format("%s\n%s (%d)\nColor: %d\n-USB2: %d\n%u x %u",MeadeCam->CcdName,MeadeCam->ModelName, MeadeCam->ModelNumber,
+//      PhdMessageBox(wxString::Format("%s\n%s (%d)\nColor: %d\n-USB2: %d\n%u x %u",MeadeCam->CcdName,MeadeCam->ModelName, MeadeCam->ModelNumber,
 //                                    MeadeCam->IsColor,MeadeCam->IsUSB2, FullSize.GetWidth(), FullSize.GetHeight()) + "\n" + MeadeCam->ErrorMessage);
         MeadeCam->Initialize();
         MeadeCam->SetHighGain(true);
@@ -86,7 +86,7 @@ bool CameraSACGuider::Connect(const wxString& camId)
             if (retval) {  // Good to go, now get other functions
             //  CloseUSB = (B_V_DLLFUNC)GetProcAddress(CameraDLL,"closeUSB");
             //  if (!CloseUSB)
-            //      (void) wxMessageBox(wxT("Didn't find closeUSB in DLL"),_("Error"),wxOK | wxICON_ERROR);
+            //      (void) PhdMessageBox(wxT("Didn't find closeUSB in DLL"),_("Error"),wxOK | wxICON_ERROR);
                 CmosReset = (V_Cp_DLLFUNC)GetProcAddress(CameraDLL,"cmosReset");
                 if (!CmosReset) {
                     FreeLibrary(CameraDLL);
@@ -119,11 +119,11 @@ bool CameraSACGuider::Connect(const wxString& camId)
     }
     CmosReset(DevName);
 
-//    wxMessageBox(_T("RA+")); wxGetApp().Yield(); ST4PulseGuideScope(WEST,2000); wxGetApp().Yield();
-//    wxMessageBox(_T("Dec+"));  wxGetApp().Yield(); ST4PulseGuideScope(NORTH,2000);wxGetApp().Yield();
-//    wxMessageBox(_T("Dec-"));  wxGetApp().Yield(); ST4PulseGuideScope(EAST,2000);wxGetApp().Yield();
-//    wxMessageBox(_T("RA-"));  wxGetApp().Yield(); ST4PulseGuideScope(SOUTH,2000);wxGetApp().Yield();
-//    wxMessageBox(_T("Done"));
+//    PhdMessageBox(_T("RA+")); wxGetApp().Yield(); ST4PulseGuideScope(WEST,2000); wxGetApp().Yield();
+//    PhdMessageBox(_T("Dec+"));  wxGetApp().Yield(); ST4PulseGuideScope(NORTH,2000);wxGetApp().Yield();
+//    PhdMessageBox(_T("Dec-"));  wxGetApp().Yield(); ST4PulseGuideScope(EAST,2000);wxGetApp().Yield();
+//    PhdMessageBox(_T("RA-"));  wxGetApp().Yield(); ST4PulseGuideScope(SOUTH,2000);wxGetApp().Yield();
+//    PhdMessageBox(_T("Done"));
     }
     ClearGuidePort();
     Connected = true;
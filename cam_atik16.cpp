@@ -97,7 +97,7 @@ bool CameraAtik16::EnumCameras(wxArrayString& names, wxArrayString& ids)
     wxString err;
     if (!LoadDLL(&err))
     {
-        wxMessageBox(err, _("DLL error"), wxICON_ERROR | wxOK);
+        PhdMessageBox(err, _("DLL error"), wxICON_ERROR | wxOK);
         return true;
     }
 
@@ -217,7 +217,7 @@ bool CameraAtik16::ST4PulseGuideScope(int direction, int duration)
     //swatch.Start();
     ArtemisPulseGuide(Cam_Handle,axis,duration);  // returns after pulse
     //long t1 = swatch.Time();
-    //wxMessageBox(wxString::Format("%ld",t1));
+    //PhdMessageBox(wxString::Format("%ld",t1));
 /*  ArtemisGuide(Cam_Handle,axis);
     wxMilliSleep(duration);
     ArtemisStopGuiding(Cam_Handle);*/
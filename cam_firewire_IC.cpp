@@ -164,7 +164,7 @@ bool CameraFirewire::Connect(const wxString& camId)
         // Set some more format things
         if (debug) { debugfile->AddLine(wxString::Format("9: Set FPS")); debugfile->Write(); }
     //  retval = m_pGrabber->setFPS(7.5);  // No need to run higher than this
-    //  if (!retval) wxMessageBox (_T("Could not set to 7.5 FPS"));
+    //  if (!retval) PhdMessageBox (_T("Could not set to 7.5 FPS"));
         if (debug) { debugfile->AddLine(wxString::Format("10: Turn off auto-exposure")); debugfile->Write(); }
         retval = m_pGrabber->setProperty(CameraControl_Exposure,false);
         if (!retval) {
@@ -200,7 +200,7 @@ bool CameraFirewire::Connect(const wxString& camId)
     FullSize = wxSize((int)w, (int)h);
     Name = wxString(camera->model);
 
-//  wxMessageBox(Name + wxString::Format(" - %d x %d - %ld ms",FullSize.GetWidth(),FullSize.GetHeight(),t1));
+//  PhdMessageBox(Name + wxString::Format(" - %d x %d - %ld ms",FullSize.GetWidth(),FullSize.GetHeight(),t1));
 //  dc1394feature_info_t feature;
 
     // set shutter speed mode
@@ -219,7 +219,7 @@ bool CameraFirewire::Connect(const wxString& camId)
     if (DCAM_start_stop_mode)
         dc1394_video_set_transmission(camera, DC1394_OFF);
 
-/*  int ans = wxMessageBox("Enable flushing of buffer on each capture?",_T("Flush mode?"),wxYES_NO);
+/*  int ans = PhdMessageBox("Enable flushing of buffer on each capture?",_T("Flush mode?"),wxYES_NO);
     if (ans == wxYES)
         DCAM_flush_mode = true;
     else
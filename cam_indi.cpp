@@ -52,6 +52,7 @@
 CameraINDI::CameraINDI()
     :
     sync_cond(sync_lock),
+    blob_cond(blob_lock),
     m_gui(nullptr)
 {
     ClearStatus();
@@ -102,6 +103,7 @@ void CameraINDI::ClearStatus()
     cam_bp = nullptr;
     guide_active = false;
     sync_cond.Broadcast(); // just in case worker thread was blocked waiting for guide pulse to complete
+    blob_cond.Broadcast(); // or waiting for an image
 }
 
 void CameraINDI::CheckState()
@@ -258,16 +260,22 @@ void  CameraINDI::newBLOB(IBLOB *bp)
     {
         if (bp->name == INDICameraBlobName)
         {
+            wxMutexLocker lck(blob_lock);
             cam_bp = bp;
             modal = false;
+            blob_cond.Broadcast();
         }
     }
     else if (video_prop)
     {
+        // hold the lock while stacking so the worker thread cannot finish the
+        // capture while a frame is being added
+        wxMutexLocker lck(blob_lock);
         cam_bp = bp;
         if (modal && !stacking)
         {
             StackStream();
+            blob_cond.Broadcast();
         }
     }
 }
@@ -660,6 +668,40 @@ void CameraINDI::SetCCDdevice()
 
 bool CameraINDI::ReadFITS(usImage& img, bool takeSubframe, const wxRect& subframe)
 {
+    // most drivers send a plain uncompressed 8 or 16 bit image, decode it
+    // straight into the frame buffer without going through CFITSIO
+    FITSRawImage raw;
+    if (raw.Parse(cam_bp->blob, static_cast<size_t>(cam_bp->bloblen)) &&
+        (!takeSubframe || (raw.Width() >= subframe.width && raw.Height() >= subframe.height)))
+    {
+        if (takeSubframe)
+        {
+            if (img.Init(FullSize))
+            {
+                pFrame->Alert(_("Memory allocation error"));
+                return true;
+            }
+
+            img.Clear();
+            img.Subframe = subframe;
+
+            int const stride = img.Size.GetWidth();
+            raw.CopyRect(img.ImageData + subframe.y * stride + subframe.x, stride, 0, 0, subframe.width, subframe.height);
+        }
+        else
+        {
+            if (img.Init(raw.Width(), raw.Height()))
+            {
+                pFrame->Alert(_("Memory allocation error"));
+                return true;
+            }
+
+            raw.CopyRect(img.ImageData, raw.Width(), 0, 0, raw.Width(), raw.Height());
+        }
+
+        return false;
+    }
+
     int xsize, ysize;
     fitsfile *fptr;  // FITS file pointer
     int status = 0;  // CFITSIO status value MUST be initialized to zero!
@@ -716,25 +758,20 @@ bool CameraINDI::ReadFITS(usImage& img, bool takeSubframe, const wxRect& subfram
         img.Clear();
         img.Subframe = subframe;
 
-        unsigned short *rawdata = new unsigned short[xsize*ysize];
-
-        if (fits_read_pix(fptr, TUSHORT, fpixel, xsize*ysize, nullptr, rawdata, nullptr, &status))
-        {
-            pFrame->Alert(_("Error reading data"));
-            PHD_fits_close_file(fptr);
-            delete[] rawdata;
-            return true;
-        }
-
-        int i = 0;
-        for (int y = 0; y < subframe.height; y++)
+        // read each row directly into place in the full-size frame
+        int const rows = wxMin(ysize, subframe.height);
+        int const cols = wxMin(xsize, subframe.width);
+        for (int y = 0; y < rows; y++)
         {
             unsigned short *dataptr = img.ImageData + (y + subframe.y) * img.Size.GetWidth() + subframe.x;
-            memcpy(dataptr, &rawdata[i], subframe.width * sizeof(unsigned short));
-            i += subframe.width;
+            fpixel[1] = y + 1;
+            if (fits_read_pix(fptr, TUSHORT, fpixel, cols, nullptr, dataptr, nullptr, &status))
+            {
+                pFrame->Alert(_("Error reading data"));
+                PHD_fits_close_file(fptr);
+                return true;
+            }
         }
-
-        delete[] rawdata;
     }
     else
     {
@@ -871,43 +908,58 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
         if (INDIConfig::Verbose())
             Debug.Write(wxString::Format("INDI Camera Exposing for %dms\n", duration));
 
+        {
+            wxMutexLocker lck(blob_lock);
+            modal = true;  // will be reset when the image blob is received
+        }
+
         // set the exposure time, this immediately start the exposure
         expose_prop->np->value = (double)duration/1000;
         sendNewNumber(expose_prop);
 
-        modal = true;  // will be reset when the image blob is received
-
-        unsigned long loopwait = duration > 100 ? 10 : 1;
-
         CameraWatchdog watchdog(duration, GetTimeoutMs());
 
-        while (modal)
+        bool timedOut = false;
         {
-            wxMilliSleep(loopwait);
-            if (WorkerThread::TerminateRequested())
-                return true;
-            if (watchdog.Expired())
+            wxMutexLocker lck(blob_lock);
+            while (modal)
             {
-                if (first_frame && video_prop)
-                {
-                    // exposure fail, maybe this is a webcam with only streaming
-                    // try to use video stream instead of exposure
-                    // See: http://www.indilib.org/forum/ccds-dslrs/3078-v4l2-ccd-exposure-property.html
-                    // TODO : check if an updated INDI v4l2 driver offer a better solution
-                    pFrame->Alert(wxString::Format(_("Camera  %s, exposure error. Trying to use streaming instead."), INDICameraName));
-                    INDICameraForceVideo = true;
-                    first_frame = false;
-                    return Capture(duration, img,  options, subframeArg);
-                }
-                else
-                {
-                    first_frame = false;
-                    DisconnectWithAlert(CAPT_FAIL_TIMEOUT);
+                // newBLOB wakes us as soon as the image arrives, the timeout
+                // only bounds how long it takes to notice a stop request
+                blob_cond.WaitTimeout(100);
+                if (!modal)
+                    break;
+                if (WorkerThread::TerminateRequested())
                     return true;
+                if (watchdog.Expired())
+                {
+                    timedOut = true;
+                    break;
                 }
             }
         }
 
+        if (timedOut)
+        {
+            if (first_frame && video_prop)
+            {
+                // exposure fail, maybe this is a webcam with only streaming
+                // try to use video stream instead of exposure
+                // See: http://www.indilib.org/forum/ccds-dslrs/3078-v4l2-ccd-exposure-property.html
+                // TODO : check if an updated INDI v4l2 driver offer a better solution
+                pFrame->Alert(wxString::Format(_("Camera  %s, exposure error. Trying to use streaming instead."), INDICameraName));
+                INDICameraForceVideo = true;
+                first_frame = false;
+                return Capture(duration, img,  options, subframeArg);
+            }
+            else
+            {
+                first_frame = false;
+                DisconnectWithAlert(CAPT_FAIL_TIMEOUT);
+                return true;
+            }
+        }
+
         if (INDIConfig::Verbose())
             Debug.Write(wxString::Format("INDI Camera Exposure end\n"));
 
@@ -977,24 +1029,28 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
             sendNewSwitch(video_prop);
         }
 
-        modal = true;
-        stacking = false;
-        StackFrames = 0;
+        {
+            wxMutexLocker lck(blob_lock);
 
-        unsigned long loopwait = duration > 100 ? 10 : 1;
-        wxStopWatch swatch;
-        swatch.Start();
+            modal = true;
+            stacking = false;
+            StackFrames = 0;
 
-        // wait the required time
-        while (modal)
-        {
-            wxMilliSleep(loopwait);
-            // test exposure complete
-            if ((swatch.Time() >= duration) && (StackFrames > 2))
-                modal = false;
-            // test termination request, stop streaming before to return
-            if (WorkerThread::TerminateRequested())
-                modal = false;
+            wxStopWatch swatch;
+            swatch.Start();
+
+            // wait the required time, newBLOB signals each stacked frame
+            while (modal)
+            {
+                long remaining = duration - swatch.Time();
+                blob_cond.WaitTimeout(remaining > 0 && remaining < 100 ? remaining : 100);
+                // test exposure complete
+                if ((swatch.Time() >= duration) && (StackFrames > 2))
+                    modal = false;
+                // test termination request, stop streaming before to return
+                if (WorkerThread::TerminateRequested())
+                    modal = false;
+            }
         }
 
         if (WorkerThread::StopRequested() ||  WorkerThread::TerminateRequested())
@@ -1009,11 +1065,8 @@ bool CameraINDI::Capture(int duration, usImage& img, int options, const wxRect&
         if (WorkerThread::TerminateRequested())
             return true;
 
-        // wait current frame is processed
-        while (stacking)
-        {
-            wxMilliSleep(loopwait);
-        }
+        // no frame can be in the middle of being stacked here since newBLOB
+        // stacks while holding blob_lock
 
         pFrame->StatusMsg(wxString::Format(_("%d frames"), StackFrames));
 
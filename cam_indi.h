@@ -75,6 +75,9 @@ private:
     bool guide_active;
     GuideAxis guide_active_axis;
 
+    wxMutex blob_lock;
+    wxCondition blob_cond;   // signalled from the INDI thread when an image blob arrives
+
     IndiGui  *m_gui;
     IBLOB    *cam_bp;
     usImage  *StackImg;
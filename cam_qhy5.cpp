@@ -114,14 +114,14 @@ bool CameraQHY5::Connect(const wxString& camId)
 {
     if (init_libusb())
     {
-        wxMessageBox(_("Could not initialize USB library"), _("Error"), wxOK | wxICON_ERROR);
+        PhdMessageBox(_("Could not initialize USB library"), _("Error"), wxOK | wxICON_ERROR);
         return true;
     }
 
     m_handle = libusb_open_device_with_vid_pid(NULL, QHY5_VID, QHY5_PID);
     if (m_handle == NULL)
     {
-        wxMessageBox(_T("Libusb failed to open camera QHY5."), _("Error"), wxOK | wxICON_ERROR);
+        PhdMessageBox(_T("Libusb failed to open camera QHY5."), _("Error"), wxOK | wxICON_ERROR);
         return true;
     }
 
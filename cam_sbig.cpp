@@ -111,7 +111,7 @@ bool CameraSBIG::LoadDriver()
     if (ok)
         m_driverLoaded = true;
     else
-        wxMessageBox(_("Error loading SBIG driver and/or DLL"));
+        PhdMessageBox(_("Error loading SBIG driver and/or DLL"));
 
     return ok;
 }
@@ -152,17 +152,17 @@ static bool SelectInterfaceAndDevice()
 
     switch (resp) {
     case 0:
-        //          wxMessageBox("2: USB selected");
+        //          PhdMessageBox("2: USB selected");
         odp.deviceType = DEV_USB;
         QueryUSBResults2 usbp;
-        //          wxMessageBox("3: Sending Query USB");
+        //          PhdMessageBox("3: Sending Query USB");
         err = SBIGUnivDrvCommand(CC_QUERY_USB2, 0, &usbp);
-        //          wxMessageBox("4: Query sent");
-        //          wxMessageBox(wxString::Format("5: %u cams found",usbp.camerasFound));
+        //          PhdMessageBox("4: Query sent");
+        //          PhdMessageBox(wxString::Format("5: %u cams found",usbp.camerasFound));
         Debug.Write(wxString::Format("SBIG: CC_QUERY_USB2 returns %hd, camerasFound = %hu\n", err, usbp.camerasFound));
         if (usbp.camerasFound > 1)
         {
-            //              wxMessageBox("5a: Enumerating cams");
+            //              PhdMessageBox("5a: Enumerating cams");
             wxArrayString USBNames;
             int i;
             for (i = 0; i<usbp.camerasFound; i++)
@@ -281,7 +281,7 @@ bool CameraSBIG::Connect(const wxString& camId)
     err = SBIGUnivDrvCommand(CC_OPEN_DEVICE, &odp, NULL);
     if (err != CE_NO_ERROR)
     {
-        wxMessageBox(wxString::Format(_("Cannot open SBIG camera: Code %d"),err), _("Error"));
+        PhdMessageBox(wxString::Format(_("Cannot open SBIG camera: Code %d"),err), _("Error"));
         Disconnect();
         return true;
     }
@@ -291,7 +291,7 @@ bool CameraSBIG::Connect(const wxString& camId)
     err = SBIGUnivDrvCommand(CC_ESTABLISH_LINK, NULL, &elr);
     if (err != CE_NO_ERROR)
     {
-        wxMessageBox (wxString::Format(_("Link to SBIG camera failed: Code %d"),err), _("Error"));
+        PhdMessageBox (wxString::Format(_("Link to SBIG camera failed: Code %d"),err), _("Error"));
         Disconnect();
         return true;
     }
@@ -304,7 +304,7 @@ bool CameraSBIG::Connect(const wxString& camId)
     err = SBIGUnivDrvCommand(CC_GET_CCD_INFO, &gcip, &gcir0);
     if (err == CE_NO_ERROR)
     {
-        int resp = wxMessageBox(wxString::Format(_("Tracking CCD found, use it?\n\nNo = use main image CCD")), _("CCD Choice"), wxYES_NO | wxICON_QUESTION);
+        int resp = PhdMessageBox(wxString::Format(_("Tracking CCD found, use it?\n\nNo = use main image CCD")), _("CCD Choice"), wxYES_NO | wxICON_QUESTION);
         if (resp == wxYES)
             UseTrackingCCD = true;
     }
@@ -314,7 +314,7 @@ bool CameraSBIG::Connect(const wxString& camId)
         err = SBIGUnivDrvCommand(CC_GET_CCD_INFO, &gcip, &gcir0);
         if (err != CE_NO_ERROR)
         {
-            wxMessageBox(_("Error getting info on main CCD"), _("Error"));
+            PhdMessageBox(_("Error getting info on main CCD"), _("Error"));
             Disconnect();
             return true;
         }
@@ -42,6 +42,7 @@
 #include "cam_simulator.h"
 
 #include <wx/dir.h>
+#include <wx/file.h>
 #include <wx/gdicmn.h>
 #include <wx/stopwatch.h>
 #include <wx/radiobut.h>
@@ -50,7 +51,10 @@
 #include <wx/txtstrm.h>
 #include <wx/tokenzr.h>
 
-#define SIMMODE 3   // 1=FITS, 2=BMP, 3=Generate
+#include <deque>
+#include <memory>
+
+#define SIMMODE 3   // 2=BMP, 3=Generate (replaying saved FITS frames is a runtime option, see SimCamParams::replay_frames)
 // #define SIMDEBUG
 
 /* simulation parameters for SIMMODE = 3*/
@@ -82,6 +86,9 @@ struct SimCamParams
     static double comet_rate_x;
     static double comet_rate_y;
     static bool allow_async_st4;
+    static bool replay_frames;
+    static wxString replay_dir;
+    static bool replay_timing;
 };
 
 unsigned int SimCamParams::width = 752;          // simulated camera image width
@@ -108,6 +115,9 @@ bool SimCamParams::show_comet;
 double SimCamParams::comet_rate_x;
 double SimCamParams::comet_rate_y;
 bool SimCamParams::allow_async_st4 = true;
+bool SimCamParams::replay_frames;                // play back saved FITS frames instead of generating images
+wxString SimCamParams::replay_dir;               // folder of frames to play back, empty for sim_images in the log folder
+bool SimCamParams::replay_timing;                // pace playback using the frames' DATE-OBS
 
 // Note: these are all in units appropriate for the UI
 #define NR_STARS_DEFAULT 20
@@ -172,6 +182,9 @@ static void load_sim_params()
     SimCamParams::show_comet = pConfig->Profile.GetBoolean("/SimCam/show_comet", SHOW_COMET_DEFAULT);
     SimCamParams::comet_rate_x = pConfig->Profile.GetDouble("/SimCam/comet_rate_x", COMET_RATE_X_DEFAULT);
     SimCamParams::comet_rate_y = pConfig->Profile.GetDouble("/SimCam/comet_rate_y", COMET_RATE_Y_DEFAULT);
+    SimCamParams::replay_frames = pConfig->Profile.GetBoolean("/SimCam/replay_frames", false);
+    SimCamParams::replay_dir = pConfig->Profile.GetString("/SimCam/replay_dir", wxEmptyString);
+    SimCamParams::replay_timing = pConfig->Profile.GetBoolean("/SimCam/replay_timing", false);
 }
 
 static void save_sim_params()
@@ -194,6 +207,9 @@ static void save_sim_params()
     pConfig->Profile.SetBoolean("/SimCam/show_comet", SimCamParams::show_comet);
     pConfig->Profile.SetDouble("/SimCam/comet_rate_x", SimCamParams::comet_rate_x);
     pConfig->Profile.SetDouble("/SimCam/comet_rate_y", SimCamParams::comet_rate_y);
+    pConfig->Profile.SetBoolean("/SimCam/replay_frames", SimCamParams::replay_frames);
+    pConfig->Profile.SetString("/SimCam/replay_dir", SimCamParams::replay_dir);
+    pConfig->Profile.SetBoolean("/SimCam/replay_timing", SimCamParams::replay_timing);
 }
 
 #ifdef STEPGUIDER_SIMULATOR
@@ -272,7 +288,7 @@ StepGuider::STEP_RESULT StepGuiderSimulator::Step(GUIDE_DIRECTION direction, int
 
     // parent class maintains x/y offsets, so nothing to do here. Just simulate a delay.
     enum { LATENCY_MS_PER_STEP = 5 };
-    wxMilliSleep(steps * LATENCY_MS_PER_STEP);
+    PhdClock::MilliSleep(steps * LATENCY_MS_PER_STEP);
     return STEP_OK;
 }
 
@@ -373,6 +389,63 @@ struct SimStar
     double inten;
 };
 
+inline static wxUint64 splitmix64(wxUint64 x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+inline static wxUint32 hash32(wxUint32 x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Random numbers for the simulator. Everything is derived from a counter, so
+// the bulk pixel noise for a row is a pure function of (frame key, row,
+// column): rows can be generated on any number of threads, the loops
+// vectorize, and a given seed always produces the same images.
+struct SimRandom
+{
+    wxUint64 seed;
+    wxUint64 counter;
+
+    SimRandom() : seed(0), counter(0) { }
+
+    void Seed(wxUint64 s) { seed = s; counter = 0; }
+
+    wxUint64 Next() { return splitmix64(seed ^ splitmix64(++counter)); }
+
+    // uniform in (0, 1]
+    double Uniform() { return (double)((Next() >> 11) + 1) * (1.0 / 9007199254740992.0); }
+
+    // uniform integer in [0, n)
+    unsigned int Below(unsigned int n) { return (unsigned int)(((Next() >> 32) * n) >> 32); }
+
+    // a pair of normally-distributed independent random values - Box-Muller algorithm, sigma=1
+    void Normal(double r[2])
+    {
+        double const a = sqrt(-2.0 * log(Uniform()));
+        double const p = 2 * M_PI * Uniform();
+        r[0] = a * cos(p);
+        r[1] = a * sin(p);
+    }
+
+    static wxUint32 RowKey(wxUint64 frameKey, int row) { return (wxUint32) splitmix64(frameKey + (wxUint64) row); }
+
+    // uniform integer in [0, n) for column col of a row
+    static unsigned int Below(wxUint32 rowKey, int col, unsigned int n)
+    {
+        return (unsigned int)(((wxUint64) hash32(rowKey + (wxUint32) col * 0x9E3779B9U) * n) >> 32);
+    }
+};
+
 static const double AMBIENT_TEMP = 15.;
 static const double MIN_COOLER_TEMP = -15.;
 
@@ -390,7 +463,7 @@ struct Cooler
 
     double CurrentTemp() const
     {
-        time_t now = wxDateTime::GetTimeNow();
+        time_t now = PhdClock::TimeNow();
 
         if (now >= endTime)
             return endTemp;
@@ -421,7 +494,7 @@ struct Cooler
         startTemp = CurrentTemp();
         endTemp = std::max(std::min(newtemp, AMBIENT_TEMP), MIN_COOLER_TEMP);
         double dt = ceil(fabs(endTemp - startTemp) / rate);
-        endTime = wxDateTime::GetTimeNow() + (time_t) dt;
+        endTime = PhdClock::TimeNow() + (time_t) dt;
         direction = endTemp < startTemp ? -1. : +1.;
     }
 
@@ -433,6 +506,8 @@ struct Cooler
     }
 };
 
+class SimFramePlayer;
+
 struct SimCamState
 {
     unsigned int width;
@@ -442,9 +517,10 @@ struct SimCamState
     double ra_ofs;           // assume no backlash in RA
     BacklashVal dec_ofs;     // simulate backlash in DEC
     double cum_dec_drift;    // cumulative dec drift
-    wxStopWatch timer;       // platform-independent timer
+    ClockStopWatch timer;    // simulation time
     long last_exposure_time; // last expoure time, milliseconds
     Cooler cooler;           // simulated cooler
+    SimRandom rng;
 
 #ifdef SIMDEBUG
     wxFFile DebugFile;
@@ -459,11 +535,12 @@ struct SimCamState
     void ReadDisplacements(double& cumX, double& cumY);
 #endif
 
-#if SIMMODE == 1
-    wxDir dir;
-    bool dirStarted;
+    SimFramePlayer *player;
+    wxLongLong lastFrameTimestamp;
+    ClockStopWatch sinceLastFrame;
+    bool StartPlayback();
+    void StopPlayback();
     bool ReadNextImage(usImage& img, const wxRect& subframe);
-#endif
 
     void Initialize();
     void FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset);
@@ -503,15 +580,15 @@ void SimCamState::Initialize()
         hotpx[i].x = rand() % width;
         hotpx[i].y = rand() % height;
     }
-    srand(clock());
+    // use a fixed seed if one was given on the command line to make simulator runs repeatable
+    long const seed = wxGetApp().GetSimulatorSeed();
+    rng.Seed(seed >= 0 ? (wxUint64) seed : (wxUint64) ::wxGetUTCTimeMillis().GetValue());
     ra_ofs = 0.;
     dec_ofs = BacklashVal(SimCamParams::dec_backlash);
     cum_dec_drift = 0.;
     last_exposure_time = 0;
 
-#if SIMMODE == 1
-    dirStarted = false;
-#endif
+    StopPlayback();
 
 #ifdef SIM_FILE_DISPLACEMENTS
     pIStream = nullptr;
@@ -528,11 +605,11 @@ void SimCamState::Initialize()
             pIStream = new wxFileInputStream(dlg.GetPath());
             if (!pIStream->IsOk())
             {
-                wxMessageBox(_("Can't use this file for star displacements"));
+                PhdMessageBox(_("Can't use this file for star displacements"));
             }
         }
         else
-            wxMessageBox(_("Can't simulate any star movement without a displacement file"));
+            PhdMessageBox(_("Can't simulate any star movement without a displacement file"));
     }
     if (pIStream && pIStream->IsOk())
         pText = new wxTextInputStream(*pIStream);
@@ -551,127 +628,271 @@ void SimCamState::Initialize()
 #endif
 }
 
-#if SIMMODE == 1
-bool SimCamState::ReadNextImage(usImage& img, const wxRect& subframe)
+// a frame from the replay folder, decoded to 16 bits per pixel
+struct SimFrame
 {
     wxString filename;
+    bool ok;
+    wxSize size;
+    std::vector<unsigned short> pixels;
+    wxLongLong timestamp; // DATE-OBS in milliseconds, 0 if not available
+};
 
-    if (!dir.IsOpened())
-    {
-        dir.Open(wxFileName(Debug.GetLogDir(), "sim_images").GetFullPath());
-    }
-    if (dir.IsOpened())
+static wxLongLong parse_date_obs(const wxString& str)
+{
+    int y, mo, d, h, mi;
+    double sec;
+    if (sscanf(str.c_str(), "%d-%d-%dT%d:%d:%lf", &y, &mo, &d, &h, &mi, &sec) != 6 ||
+        mo < 1 || mo > 12 || d < 1 || d > 31 || h < 0 || h > 23 || mi < 0 || mi > 59 || sec < 0. || sec >= 60.)
     {
-        if (!dirStarted)
-        {
-            dir.GetFirst(&filename, "*.fit", wxDIR_FILES);
-            dirStarted = true;
-        }
-        else
-        {
-            if (!dir.GetNext(&filename))
-                dir.GetFirst(&filename, "*.fit", wxDIR_FILES);
-        }
+        return 0;
     }
-    if (filename.IsEmpty())
-    {
+
+    // only the differences between timestamps matter, so the time zone is irrelevant
+    wxDateTime dt(d, (wxDateTime::Month)(mo - 1), y, h, mi, (wxDateTime::wxDateTime_t) sec,
+                  (wxDateTime::wxDateTime_t)((sec - floor(sec)) * 1000.));
+    return dt.IsValid() ? dt.GetValue() : wxLongLong(0);
+}
+
+static bool load_sim_frame(SimFrame *frame)
+{
+    wxFile file(frame->filename);
+    if (!file.IsOpened())
+        return true;
+
+    wxFileOffset const len = file.Length();
+    if (len <= 0)
+        return true;
+    std::vector<char> buf((size_t) len);
+    if (file.Read(buf.data(), buf.size()) != (ssize_t) buf.size())
         return true;
+
+    // uncompressed frames, which is what PHD2 saves, are decoded directly
+    FITSRawImage raw;
+    if (raw.Parse(buf.data(), buf.size()))
+    {
+        frame->size = wxSize(raw.Width(), raw.Height());
+        frame->pixels.resize((size_t) raw.Width() * raw.Height());
+        raw.CopyRect(frame->pixels.data(), raw.Width(), 0, 0, raw.Width(), raw.Height());
+        frame->timestamp = parse_date_obs(raw.GetString("DATE-OBS"));
+        return false;
     }
 
-    Debug.Write("Sim file opened: " + filename + "\n");
     fitsfile *fptr;  // FITS file pointer
     int status = 0;  // CFITSIO status value MUST be initialized to zero!
+    void *mem = buf.data();
+    size_t memsize = buf.size();
 
-    if (PHD_fits_open_diskfile(&fptr, wxFileName(dir.GetName(), filename).GetFullPath(), READONLY, &status))
+    if (fits_open_memfile(&fptr, "", READONLY, &mem, &memsize, 0, nullptr, &status))
         return true;
 
-    int hdutype;
-    if (fits_get_hdu_type(fptr, &hdutype, &status) || hdutype != IMAGE_HDU)
+    int hdutype, naxis, nhdus;
+    long fits_size[2];
+    if (fits_get_hdu_type(fptr, &hdutype, &status) || hdutype != IMAGE_HDU ||
+        fits_get_img_dim(fptr, &naxis, &status) || naxis != 2 ||
+        fits_get_num_hdus(fptr, &nhdus, &status) || nhdus != 1 ||
+        fits_get_img_size(fptr, 2, fits_size, &status))
     {
-        pFrame->Alert(_("FITS file is not of an image"));
         PHD_fits_close_file(fptr);
         return true;
     }
 
-    int naxis;
-    fits_get_img_dim(fptr, &naxis, &status);
+    frame->size = wxSize((int) fits_size[0], (int) fits_size[1]);
+    frame->pixels.resize((size_t) fits_size[0] * fits_size[1]);
 
-    int nhdus;
-    fits_get_num_hdus(fptr, &nhdus, &status);
-    if ((nhdus != 1) || (naxis != 2)) {
-        pFrame->Alert(_("Unsupported type or read error loading FITS file"));
+    long fpixel[] = { 1, 1 };
+    if (fits_read_pix(fptr, TUSHORT, fpixel, (LONGLONG) frame->pixels.size(), nullptr, frame->pixels.data(), nullptr, &status))
+    {
         PHD_fits_close_file(fptr);
         return true;
     }
 
-    long fits_size[2];
-    fits_get_img_size(fptr, 2, fits_size, &status);
+    char date[FLEN_VALUE];
+    if (fits_read_key(fptr, TSTRING, "DATE-OBS", date, nullptr, &status) == 0)
+        frame->timestamp = parse_date_obs(date);
+
+    PHD_fits_close_file(fptr);
+    return false;
+}
 
-    int xsize = (int) fits_size[0];
-    int ysize = (int) fits_size[1];
+// Plays back a folder of saved frames. The folder is indexed once and a
+// background thread keeps a few frames decoded ahead of the one being
+// captured, so playback is not held up by file I/O. Playback wraps around to
+// the first frame at the end.
+class SimFramePlayer : public wxThread
+{
+    enum { READ_AHEAD = 4 };
 
-    if (img.Init(xsize, ysize)) {
-        pFrame->Alert(_("Memory allocation error"));
-        PHD_fits_close_file(fptr);
-        return true;
-    }
+    wxArrayString m_files;
+    wxMutex m_lock;
+    wxCondition m_cond;
+    std::deque<SimFrame *> m_ready;
+    bool m_stop;
 
-    unsigned short *buf = new unsigned short[img.NPixels];
-    bool useSubframe = !subframe.IsEmpty();
-    wxRect frame;
-    if (useSubframe)
-        frame = subframe;
-    else
-        frame = wxRect(0, 0, xsize, ysize);
+public:
+    SimFramePlayer(const wxArrayString& files)
+        : wxThread(wxTHREAD_JOINABLE), m_files(files), m_cond(m_lock), m_stop(false) { }
+    ~SimFramePlayer();
+
+    void Stop();
+    SimFrame *NextFrame();
+
+protected:
+    ExitCode Entry() override;
+};
+
+SimFramePlayer::~SimFramePlayer()
+{
+    for (SimFrame *frame : m_ready)
+        delete frame;
+}
 
-    long inc[] = { 1, 1 };
-    long fpixel[] = { frame.GetLeft() + 1, frame.GetTop() + 1 };
-    long lpixel[] = { frame.GetRight() + 1, frame.GetBottom() + 1 };
-    if (fits_read_subset(fptr, TUSHORT, fpixel, lpixel, inc, nullptr, buf, nullptr, &status))
+void SimFramePlayer::Stop()
+{
     {
-        pFrame->Alert(_("Error reading data"));
-        PHD_fits_close_file(fptr);
-        return true;
+        wxMutexLocker lck(m_lock);
+        m_stop = true;
+        m_cond.Broadcast();
     }
+    Wait();
+}
 
-    if (useSubframe)
+wxThread::ExitCode SimFramePlayer::Entry()
+{
+    for (size_t i = 0; ; i = (i + 1) % m_files.size())
     {
-        img.Subframe = subframe;
-
-        // Clear out the image
-        img.Clear();
-
-        int i = 0;
-        for (int y = 0; y < subframe.height; y++)
         {
-            unsigned short *dst = img.ImageData + (y + subframe.y) * xsize + subframe.x;
-            for (int x = 0; x < subframe.width; x++, i++)
-                *dst++ = (unsigned short) buf[i];
+            wxMutexLocker lck(m_lock);
+            while (!m_stop && m_ready.size() >= READ_AHEAD)
+                m_cond.Wait();
+            if (m_stop)
+                break;
         }
+
+        SimFrame *frame = new SimFrame();
+        frame->filename = m_files[i];
+        frame->ok = !load_sim_frame(frame);
+
+        wxMutexLocker lck(m_lock);
+        m_ready.push_back(frame);
+        m_cond.Broadcast();
     }
-    else
+
+    return 0;
+}
+
+// returns the next frame, which the caller must delete, or null if the worker thread is terminating
+SimFrame *SimFramePlayer::NextFrame()
+{
+    wxMutexLocker lck(m_lock);
+
+    while (m_ready.empty())
     {
-        for (unsigned int i = 0; i < img.NPixels; i++)
-            img.ImageData[i] = (unsigned short) buf[i];
+        m_cond.WaitTimeout(100);
+        if (WorkerThread::TerminateRequested())
+            return nullptr;
     }
 
-    delete[] buf;
+    SimFrame *frame = m_ready.front();
+    m_ready.pop_front();
+    m_cond.Broadcast();
 
-    PHD_fits_close_file(fptr);
+    return frame;
+}
+
+bool SimCamState::StartPlayback()
+{
+    wxString dirname = SimCamParams::replay_dir;
+    if (dirname.IsEmpty())
+        dirname = wxFileName(Debug.GetLogDir(), "sim_images").GetFullPath();
+
+    wxArrayString files;
+    if (wxDir::Exists(dirname))
+        wxDir::GetAllFiles(dirname, &files, "*.fit", wxDIR_FILES);
+    if (files.IsEmpty())
+    {
+        pFrame->Alert(wxString::Format(_("No FITS frames to replay in %s"), dirname));
+        return true;
+    }
 
+    // saved frames have the capture time in their names, so name order is capture order
+    files.Sort();
+
+    Debug.Write(wxString::Format("Sim playback: %u frames in %s\n", (unsigned int) files.size(), dirname));
+
+    player = new SimFramePlayer(files);
+    if (player->Run() != wxTHREAD_NO_ERROR)
+    {
+        delete player;
+        player = nullptr;
+        return true;
+    }
+
+    lastFrameTimestamp = 0;
     return false;
 }
-#endif // SIMMODE == 1
 
-// get a pair of normally-distributed independent random values - Box-Muller algorithm, sigma=1
-static void rand_normal(double r[2])
+void SimCamState::StopPlayback()
+{
+    if (player)
+    {
+        player->Stop();
+        delete player;
+        player = nullptr;
+    }
+}
+
+bool SimCamState::ReadNextImage(usImage& img, const wxRect& subframe)
 {
-    double u = (double) rand() / RAND_MAX;
-    double v = (double) rand() / RAND_MAX;
-    double const a = sqrt(-2.0 * log(u));
-    double const p = 2 * M_PI * v;
-    r[0] = a * cos(p);
-    r[1] = a * sin(p);
+    if (!player && StartPlayback())
+        return true;
+
+    std::unique_ptr<SimFrame> frame(player->NextFrame());
+    if (!frame)
+        return true;
+
+    Debug.Write("Sim file opened: " + frame->filename + "\n");
+
+    if (!frame->ok)
+    {
+        pFrame->Alert(_("Unsupported type or read error loading FITS file"));
+        return true;
+    }
+
+    // optionally reproduce the frame timing of the recorded session
+    if (SimCamParams::replay_timing && frame->timestamp != 0 && lastFrameTimestamp != 0)
+    {
+        long wait = (frame->timestamp - lastFrameTimestamp).ToLong() - sinceLastFrame.Time();
+        if (wait > 0 && WorkerThread::MilliSleep(wait, WorkerThread::INT_ANY))
+            return true;
+    }
+    lastFrameTimestamp = frame->timestamp;
+    sinceLastFrame.Start();
+
+    if (img.Init(frame->size))
+    {
+        pFrame->Alert(_("Memory allocation error"));
+        return true;
+    }
+
+    int const width = frame->size.GetWidth();
+    wxRect rect(frame->size);
+
+    if (!subframe.IsEmpty())
+    {
+        rect.Intersect(subframe);
+        img.Subframe = rect;
+        img.Clear();
+    }
+
+    // copy just the rows of the requested subframe
+    for (int y = rect.GetTop(); y <= rect.GetBottom(); y++)
+    {
+        size_t const ofs = (size_t) y * width + rect.GetLeft();
+        memcpy(img.ImageData + ofs, &frame->pixels[ofs], rect.GetWidth() * sizeof(unsigned short));
+    }
+
+    return false;
 }
 
 inline static unsigned short *pixel_addr(usImage& img, int x, int y)
@@ -753,69 +974,99 @@ static void render_comet(usImage& img, int binning, const wxRect& subframe, cons
 
 }
 
-static void render_star(usImage& img, int binning, const wxRect& subframe, const wxRealPoint& p, double inten)
+// render all the stars in one pass: each star is a fixed profile spread over
+// the 4 nearest pixels according to its sub-pixel position. Stars entirely
+// outside the subframe are skipped, and the rest are clipped once rather than
+// checking the bounds of every pixel.
+static void render_stars(usImage& img, int binning, const wxRect& subframe, const wxVector<wxRealPoint>& pos,
+                         const wxVector<double>& inten)
 {
     enum { WIDTH = 5 };
-    double STAR[][WIDTH] = {{ 0.0,  0.8,   2.2,  0.8, 0.0, },
-                            { 0.8, 16.6,  46.1, 16.6, 0.8, },
-                            { 2.2, 46.1, 128.0, 46.1, 2.2, },
-                            { 0.8, 16.6,  46.1, 16.6, 0.8, },
-                            { 0.0,  0.8,   2.2,  0.8, 0.0, },
-                           };
+    static const double STAR[WIDTH][WIDTH] = {{ 0.0,  0.8,   2.2,  0.8, 0.0, },
+                                              { 0.8, 16.6,  46.1, 16.6, 0.8, },
+                                              { 2.2, 46.1, 128.0, 46.1, 2.2, },
+                                              { 0.8, 16.6,  46.1, 16.6, 0.8, },
+                                              { 0.0,  0.8,   2.2,  0.8, 0.0, },
+                                             };
 
-    wxRealPoint intpart;
-    double fx = modf(p.x / (double) binning, &intpart.x);
-    double fy = modf(p.y / (double) binning, &intpart.y);
-    double f00 = (1.0 - fx) * (1.0 - fy);
-    double f01 = (1.0 - fx) * fy;
-    double f10 = fx * (1.0 - fy);
-    double f11 = fx * fy;
+    wxRect const clip = subframe.Intersect(wxRect(img.Size));
+    if (clip.IsEmpty())
+        return;
 
-    double d[WIDTH + 1][WIDTH + 1] = { { 0.0 } };
-    for (unsigned int i = 0; i < WIDTH; i++)
-        for (unsigned int j = 0; j < WIDTH; j++)
+    int const stride = img.Size.GetWidth();
+
+    for (unsigned int k = 0; k < pos.size(); k++)
+    {
+        wxRealPoint intpart;
+        double fx = modf(pos[k].x / (double) binning, &intpart.x);
+        double fy = modf(pos[k].y / (double) binning, &intpart.y);
+
+        int const x0 = (int) intpart.x - (WIDTH - 1) / 2;
+        int const y0 = (int) intpart.y - (WIDTH - 1) / 2;
+
+        // the star covers pixels [x0, x0 + WIDTH] x [y0, y0 + WIDTH]
+        int const xa = std::max(x0, clip.GetLeft());
+        int const xb = std::min(x0 + WIDTH, clip.GetRight());
+        int const ya = std::max(y0, clip.GetTop());
+        int const yb = std::min(y0 + WIDTH, clip.GetBottom());
+        if (xa > xb || ya > yb)
+            continue;
+
+        double const s = inten[k] / 256.0;
+        double const f00 = (1.0 - fx) * (1.0 - fy) * s;
+        double const f01 = (1.0 - fx) * fy * s;
+        double const f10 = fx * (1.0 - fy) * s;
+        double const f11 = fx * fy * s;
+
+        double d[WIDTH + 1][WIDTH + 1] = { { 0.0 } };
+        for (unsigned int i = 0; i < WIDTH; i++)
+            for (unsigned int j = 0; j < WIDTH; j++)
+            {
+                double const v = STAR[i][j];
+                d[i][j] += f00 * v;
+                d[i+1][j] += f10 * v;
+                d[i][j+1] += f01 * v;
+                d[i+1][j+1] += f11 * v;
+            }
+
+        for (int y = ya; y <= yb; y++)
         {
-            double s = STAR[i][j];
-            if (s > 0.0)
+            unsigned short *const row = img.ImageData + y * stride;
+            for (int x = xa; x <= xb; x++)
             {
-                s *= inten / 256.0;
-                d[i][j] += f00 * s;
-                d[i+1][j] += f10 * s;
-                d[i][j+1] += f01 * s;
-                d[i+1][j+1] += f11 * s;
+                unsigned int t = row[x] + (unsigned int) std::min(d[x - x0][y - y0], 65535.0);
+                row[x] = (unsigned short) std::min(t, 65535U);
             }
         }
+    }
+}
 
-    wxPoint c((int) intpart.x - (WIDTH - 1) / 2,
-              (int) intpart.y - (WIDTH - 1) / 2);
+// fill the subframe with base + scale * uniform[0, range) noise
+static void render_noise(usImage& img, const wxRect& subframe, SimRandom& rng, double base, double scale, unsigned int range)
+{
+    wxUint64 const frameKey = rng.Next();
+    int const stride = img.Size.GetWidth();
+    int const width = subframe.GetWidth();
+    unsigned short *const p0 = &img.Pixel(subframe.GetLeft(), subframe.GetTop());
 
-    for (unsigned int i = 0; i < WIDTH + 1; i++)
-    {
-        int const cx = c.x + i;
-        if (cx < subframe.GetLeft() || cx > subframe.GetRight())
-            continue;
-        for (unsigned int j = 0; j < WIDTH + 1; j++)
+    ComputePool::ParallelRows(subframe.GetHeight(), width, [=](int r0, int r1) {
+        for (int r = r0; r < r1; r++)
         {
-            int const cy = c.y + j;
-            if (cy < subframe.GetTop() || cy > subframe.GetBottom())
-                continue;
-            int incr = (int) d[i][j];
-            if (incr > (unsigned short)-1)
-                incr = (unsigned short)-1;
-            incr_pixel(img, cx, cy, incr);
+            unsigned short *const p = p0 + r * stride;
+            wxUint32 const key = SimRandom::RowKey(frameKey, subframe.GetTop() + r);
+            for (int i = 0; i < width; i++)
+            {
+                double const v = base + scale * SimRandom::Below(key, i, range);
+                p[i] = (unsigned short) std::min(v, 65535.0);
+            }
         }
-    }
+    });
 }
 
-static void render_clouds(usImage& img, const wxRect& subframe, int exptime, int gain, int offset)
+static void render_clouds(usImage& img, const wxRect& subframe, SimRandom& rng, int exptime, int gain, int offset)
 {
-    unsigned short *p0 = &img.Pixel(subframe.GetLeft(), subframe.GetTop());
-    for (int r = 0; r < subframe.GetHeight(); r++, p0 += img.Size.GetWidth())
-    {
-        unsigned short *const end = p0 + subframe.GetWidth();
-        for (unsigned short *p = p0; p < end; p++)
-            *p = (unsigned short) (SimCamParams::clouds_inten * ((double) gain / 10.0 * offset * exptime / 100.0 + ((rand() % (gain * 100)) / 30.0)));
-    }
+    double const inten = SimCamParams::clouds_inten;
+    render_noise(img, subframe, rng, inten * ((double) gain / 10.0 * offset * exptime / 100.0), inten / 30.0, gain * 100);
 }
 
 #ifdef SIM_FILE_DISPLACEMENTS
@@ -970,7 +1221,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
     // simulate seeing
     if (SimCamParams::seeing_scale > 0.0)
     {
-        rand_normal(seeing);
+        rng.Normal(seeing);
         static const double seeing_adjustment = (2.345 * 1.4 * 2.4);        //FWHM, geometry, empirical
         double sigma = SimCamParams::seeing_scale / (seeing_adjustment * SimCamParams::image_scale);
         seeing[0] *= sigma;
@@ -1039,19 +1290,20 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
     }
 #endif // STEPGUIDER_SIMULATOR
 
-    // render each star
+    // render the stars
     if (!pCamera->ShutterClosed)
     {
+        double const dark = (double) gain / 10.0 * offset * exptime / 100.0;
+        wxVector<double> inten(nr_stars);
         for (unsigned int i = 0; i < nr_stars; i++)
         {
             double star = stars[i].inten * exptime * gain;
-            double dark = (double) gain / 10.0 * offset * exptime / 100.0;
-            double noise = (double)(rand() % (gain * 100));
-            double inten = star + dark + noise;
-
-            render_star(img, pCamera->Binning, subframe, cc[i], inten);
+            double noise = (double) rng.Below(gain * 100);
+            inten[i] = star + dark + noise;
         }
 
+        render_stars(img, pCamera->Binning, subframe, cc, inten);
+
 #ifndef SIM_FILE_DISPLACEMENTS
         if (SimCamParams::show_comet)
         {
@@ -1063,7 +1315,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
             double inten = 3.0;
             double star = inten * exptime * gain;
             double dark = (double) gain / 10.0 * offset * exptime / 100.0;
-            double noise = (double)(rand() % (gain * 100));
+            double noise = (double) rng.Below(gain * 100);
             inten = star + dark + noise;
 
             render_comet(img, pCamera->Binning, subframe, wxRealPoint(cx, cy), inten);
@@ -1072,7 +1324,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
     }
 
     if (SimCamParams::clouds_inten)
-        render_clouds(img, subframe, exptime, gain, offset);
+        render_clouds(img, subframe, rng, exptime, gain, offset);
 
     // render hot pixels
     for (unsigned int i = 0; i < hotpx.size(); i++)
@@ -1156,6 +1408,7 @@ CameraSimulator::~CameraSimulator()
     if (sim->pIStream)
         delete sim->pIStream;
 #endif
+    sim->StopPlayback();
     delete sim;
 }
 
@@ -1192,15 +1445,10 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
 #endif
 
 #if SIMMODE == 3
-static void fill_noise(usImage& img, const wxRect& subframe, int exptime, int gain, int offset)
+static void fill_noise(usImage& img, const wxRect& subframe, SimRandom& rng, int exptime, int gain, int offset)
 {
-    unsigned short *p0 = &img.Pixel(subframe.GetLeft(), subframe.GetTop());
-    for (int r = 0; r < subframe.GetHeight(); r++, p0 += img.Size.GetWidth())
-    {
-        unsigned short *const end = p0 + subframe.GetWidth();
-        for (unsigned short *p = p0; p < end; p++)
-            *p = (unsigned short) (SimCamParams::noise_multiplier * ((double) gain / 10.0 * offset * exptime / 100.0 + (rand() % (gain * 100))));
-    }
+    double const mult = SimCamParams::noise_multiplier;
+    render_noise(img, subframe, rng, mult * ((double) gain / 10.0 * offset * exptime / 100.0), mult, gain * 100);
 }
 #endif // SIMMODE == 3
 
@@ -1208,6 +1456,7 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
 {
     wxRect subframe(subframeArg);
     CameraWatchdog watchdog(duration, GetTimeoutMs());
+    ClockStopWatch exposure;
 
     // sleep before rendering the image so that any changes made in the middle of a long exposure (e.g. manual guide pulse) shows up in the image
 
@@ -1222,53 +1471,59 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
         }
     }
 
-#if SIMMODE == 1
-
-    if (!UseSubframes)
-        subframe = wxRect();
-
-    if (sim->ReadNextImage(img, subframe))
-        return true;
-
-    FullSize = img.Size;
+    if (SimCamParams::replay_frames)
+    {
+        if (!UseSubframes)
+            subframe = wxRect();
 
-#else
+        {
+            TRACE_SCOPE("SimReadFrame");
+            if (sim->ReadNextImage(img, subframe))
+                return true;
+        }
 
-    int width = sim->width / Binning;
-    int height = sim->height / Binning;
-    FullSize = wxSize(width, height);
+        FullSize = img.Size;
+    }
+    else
+    {
+        int width = sim->width / Binning;
+        int height = sim->height / Binning;
+        FullSize = wxSize(width, height);
 
-    bool usingSubframe = UseSubframes;
-    if (subframe.width <= 0 || subframe.height <= 0 || subframe.GetRight() >= width || subframe.GetBottom() >= height)
-        usingSubframe = false;
-    if (!usingSubframe)
-        subframe = wxRect(0, 0, FullSize.GetWidth(), FullSize.GetHeight());
+        bool usingSubframe = UseSubframes;
+        if (subframe.width <= 0 || subframe.height <= 0 || subframe.GetRight() >= width || subframe.GetBottom() >= height)
+            usingSubframe = false;
+        if (!usingSubframe)
+            subframe = wxRect(0, 0, FullSize.GetWidth(), FullSize.GetHeight());
 
-    int const exptime = duration;
-    int const gain = 30;
-    int const offset = 100;
+        int const exptime = duration;
+        int const gain = 30;
+        int const offset = 100;
 
-    if (img.Init(FullSize))
-    {
-        pFrame->Alert(_("Memory allocation error"));
-        return true;
-    }
+        if (img.Init(FullSize))
+        {
+            pFrame->Alert(_("Memory allocation error"));
+            return true;
+        }
 
-    if (usingSubframe)
-        img.Clear();
+        {
+            TRACE_SCOPE("SimRender");
 
-    fill_noise(img, subframe, exptime, gain, offset);
+            if (usingSubframe)
+                img.Clear();
 
-    sim->FillImage(img, subframe, exptime, gain, offset);
+            fill_noise(img, subframe, sim->rng, exptime, gain, offset);
 
-    if (usingSubframe)
-        img.Subframe = subframe;
+            sim->FillImage(img, subframe, exptime, gain, offset);
+        }
 
-    if (options & CAPTURE_SUBTRACT_DARK) SubtractDark(img);
+        if (usingSubframe)
+            img.Subframe = subframe;
 
-#endif // SIMMODE == 1
+        if (options & CAPTURE_SUBTRACT_DARK) SubtractDark(img);
+    }
 
-    long elapsed = watchdog.Time();
+    long elapsed = exposure.Time();
     if (elapsed < duration)
     {
         if (WorkerThread::MilliSleep(duration - elapsed, WorkerThread::INT_ANY))
@@ -1283,7 +1538,8 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
     return false;
 }
 
-bool CameraSimulator::ST4PulseGuideScope(int direction, int duration)
+// move the simulated star for a guide pulse; the caller waits out the pulse duration
+bool CameraSimulator::ApplyGuidePulse(int direction, int duration)
 {
     // Following must take into account how the render_star function works.  Render_star uses camera binning explicitly, so
     // relying only on image scale in computing d creates distances that are too small by a factor of <binning>
@@ -1314,10 +1570,25 @@ bool CameraSimulator::ST4PulseGuideScope(int direction, int duration)
     case SOUTH:   sim->dec_ofs.incr(-d); break;
     default: return true;
     }
+    return false;
+}
+
+bool CameraSimulator::ST4PulseGuideScope(int direction, int duration)
+{
+    if (ApplyGuidePulse(direction, duration))
+        return true;
     WorkerThread::MilliSleep(duration, WorkerThread::INT_ANY);
     return false;
 }
 
+bool CameraSimulator::ST4PulseGuideScopeConcurrent(int raDirection, int raDuration, int decDirection, int decDuration)
+{
+    if (ApplyGuidePulse(raDirection, raDuration) || ApplyGuidePulse(decDirection, decDuration))
+        return true;
+    WorkerThread::MilliSleep(wxMax(raDuration, decDuration), WorkerThread::INT_ANY);
+    return false;
+}
+
 bool CameraSimulator::SetCoolerOn(bool on)
 {
     if (on)
@@ -1473,6 +1744,10 @@ struct SimCamDialog : public wxDialog
     wxTextCtrl *pPECustomPeriod;
     wxButton *pPierFlip;
     wxButton *pResetBtn;
+    wxCheckBox *pReplayCbx;
+    wxTextCtrl *pReplayDir;
+    wxButton *pReplayBrowseBtn;
+    wxCheckBox *pReplayTimingCbx;
 
     SimCamDialog(wxWindow *parent);
     ~SimCamDialog() { }
@@ -1482,6 +1757,7 @@ struct SimCamDialog : public wxDialog
     void OnRbDefaultPE(wxCommandEvent& evt);
     void OnRbCustomPE(wxCommandEvent& evt);
     void OnOkClick(wxCommandEvent& evt);
+    void OnReplayDirSelect(wxCommandEvent& evt);
 
     DECLARE_EVENT_TABLE()
 };
@@ -1562,6 +1838,10 @@ static void SetControlStates(SimCamDialog *dlg, bool captureActive)
     dlg->pPierFlip->Enable(enable);
     dlg->pReverseDecPulseCbx->Enable(enable);
     dlg->pResetBtn->Enable(enable);
+    dlg->pReplayCbx->Enable(enable);
+    dlg->pReplayDir->Enable(enable);
+    dlg->pReplayBrowseBtn->Enable(enable);
+    dlg->pReplayTimingCbx->Enable(enable);
 }
 
 // Event handlers
@@ -1575,6 +1855,18 @@ void SimCamDialog::OnRbCustomPE(wxCommandEvent& evt)
     SetRBState(this, false);
 }
 
+void SimCamDialog::OnReplayDirSelect(wxCommandEvent& evt)
+{
+    wxString dir = pReplayDir->GetValue();
+    if (dir.IsEmpty())
+        dir = wxFileName(Debug.GetLogDir(), "sim_images").GetFullPath();
+
+    wxString sRtn = wxDirSelector(_("Choose a folder of FITS frames"), dir);
+
+    if (sRtn.Len() > 0)
+        pReplayDir->SetValue(sRtn);
+}
+
 // Need to enforce semantics on free-form user input
 void SimCamDialog::OnOkClick(wxCommandEvent& evt)
 {
@@ -1590,13 +1882,13 @@ void SimCamDialog::OnOkClick(wxCommandEvent& evt)
         {
             if (amp <= 0.0 || period <= 0.0)
             {
-                wxMessageBox(_("PE amplitude and period must be > 0"), "Error", wxOK | wxICON_ERROR);
+                PhdMessageBox(_("PE amplitude and period must be > 0"), "Error", wxOK | wxICON_ERROR);
                 bOk = false;
             }
         }
         else
         {
-            wxMessageBox(_("PE amplitude and period must be numbers > 0"), "Error", wxOK | wxICON_ERROR);
+            PhdMessageBox(_("PE amplitude and period must be numbers > 0"), "Error", wxOK | wxICON_ERROR);
             bOk = false;
         }
     }
@@ -1699,9 +1991,27 @@ SimCamDialog::SimCamDialog(wxWindow *parent)
     pSessionGroup->Add(showComet);
     pSessionGroup->Add(pCloudsCbx);
 
+    // Frame replay controls - a wide text edit control for the folder with a 'browse' button at the right
+    wxStaticBoxSizer *pReplayGroup = new wxStaticBoxSizer(wxVERTICAL, this, _("Frame replay"));
+    pReplayCbx = NewCheckBox(this, SimCamParams::replay_frames, _("Replay saved frames"),
+        _("Play back the FITS frames in a folder instead of generating simulated images"));
+    wxBoxSizer *pReplayDirSizer = new wxBoxSizer(wxHORIZONTAL);
+    pReplayDir = new wxTextCtrl(this, wxID_ANY, SimCamParams::replay_dir, wxDefaultPosition, wxSize(350, -1));
+    pReplayDir->SetToolTip(_("Folder of FITS frames to replay; empty for the sim_images folder in the log folder"));
+    pReplayBrowseBtn = new wxButton(this, wxID_ANY, _("Browse..."));
+    pReplayBrowseBtn->Bind(wxEVT_COMMAND_BUTTON_CLICKED, &SimCamDialog::OnReplayDirSelect, this);
+    pReplayDirSizer->Add(pReplayDir, wxSizerFlags(1).Expand());
+    pReplayDirSizer->Add(pReplayBrowseBtn, wxSizerFlags(0).Border(wxLEFT, 10));
+    pReplayTimingCbx = NewCheckBox(this, SimCamParams::replay_timing, _("Use recorded frame timing"),
+        _("Pace playback using the DATE-OBS times of the frames"));
+    pReplayGroup->Add(pReplayCbx);
+    pReplayGroup->Add(pReplayDirSizer, wxSizerFlags().Border(wxTOP, 5).Expand());
+    pReplayGroup->Add(pReplayTimingCbx, wxSizerFlags().Border(wxTOP, 5));
+
     pVSizer->Add(pCamGroup, wxSizerFlags().Border(wxALL, 10).Expand());
     pVSizer->Add(pMountGroup, wxSizerFlags().Border(wxRIGHT | wxLEFT, 10));
     pVSizer->Add(pSessionGroup, wxSizerFlags().Border(wxRIGHT | wxLEFT, 10).Expand());
+    pVSizer->Add(pReplayGroup, wxSizerFlags().Border(wxTOP | wxRIGHT | wxLEFT, 10).Expand());
 
     // Now deal with the buttons
     wxBoxSizer *pButtonSizer = new wxBoxSizer( wxHORIZONTAL );
@@ -1755,6 +2065,9 @@ void SimCamDialog::OnReset(wxCommandEvent& event)
     UpdatePierSideLabel();
     showComet->SetValue(SHOW_COMET_DEFAULT);
     pCloudsCbx->SetValue(false);
+    pReplayCbx->SetValue(false);
+    pReplayDir->SetValue(wxEmptyString);
+    pReplayTimingCbx->SetValue(false);
 }
 
 void SimCamDialog::OnPierFlip(wxCommandEvent& event)
@@ -1822,10 +2135,17 @@ void CameraSimulator::ShowPropertyDialog()
         SimCamParams::reverse_dec_pulse_on_west_side = dlg.pReverseDecPulseCbx->GetValue();
         SimCamParams::show_comet = dlg.showComet->GetValue();
         SimCamParams::clouds_inten = dlg.pCloudsCbx->GetValue() ? CLOUDS_INTEN_DEFAULT : 0;
+
+        UpdateChecker replayUpd;
+        replayUpd.Update(SimCamParams::replay_frames, dlg.pReplayCbx->GetValue());
+        replayUpd.Update(SimCamParams::replay_dir, dlg.pReplayDir->GetValue().Trim().Trim(false));
+        SimCamParams::replay_timing = dlg.pReplayTimingCbx->GetValue();
         save_sim_params();
 
         if (upd.WasModified())
             sim->Initialize();
+        else if (replayUpd.WasModified())
+            sim->StopPlayback(); // playback restarts from the new folder at the next capture
     }
 }
 
@@ -57,8 +57,12 @@ public:
     bool     ST4HasNonGuiMove() override { return true; }
     bool     ST4SynchronousOnly() override;
     bool     ST4PulseGuideScope(int direction, int duration) override;
+    bool     ST4CanPulseConcurrently() override { return true; }
+    bool     ST4PulseGuideScopeConcurrent(int raDirection, int raDuration, int decDirection, int decDuration) override;
     PierSide SideOfPier() const;
     void     FlipPierSide();
+private:
+    bool     ApplyGuidePulse(int direction, int duration);
 };
 
 #endif
@@ -129,7 +129,7 @@ bool CameraWDM::SelectDeviceAndMode()
         // Init the library
         if (CVFAILED(vidCap->Init()))
         {
-            wxMessageBox(_T("Error initializing WDM services"),_("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("Error initializing WDM services"),_("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("CVFAILED(VidCap->Init())");
         }
         inited = true;
@@ -138,7 +138,7 @@ bool CameraWDM::SelectDeviceAndMode()
         int nDevices;
         if (CVFAILED(vidCap->GetNumDevices(nDevices)))
         {
-            wxMessageBox(_T("Error detecting WDM devices"), _("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("Error detecting WDM devices"), _("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("CVFAILED(m_pVidCap->GetNumDevices(nDevices))");
         }
 
@@ -176,7 +176,7 @@ bool CameraWDM::SelectDeviceAndMode()
         // Connect to camera
         if (!CVSUCCESS(vidCap->Connect(deviceNumber)))
         {
-            wxMessageBox(wxString::Format("Error connecting to WDM device #%d", deviceNumber), _("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(wxString::Format("Error connecting to WDM device #%d", deviceNumber), _("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("Error connecting to WDM device");
         }
         connected = true;
@@ -254,7 +254,7 @@ bool CameraWDM::Connect(const wxString& camId)
         // Init the library
         if (CVFAILED(m_pVidCap->Init()))
         {
-            wxMessageBox(_T("Error initializing WDM services"),_("Error"),wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("Error initializing WDM services"),_("Error"),wxOK | wxICON_ERROR);
             throw ERROR_INFO("CVFAILED(VidCap->Init())");
         }
 
@@ -277,13 +277,13 @@ bool CameraWDM::Connect(const wxString& camId)
         }
         else
         {
-            wxMessageBox(wxString::Format("Error connecting to WDM device #%d", m_deviceNumber), _("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(wxString::Format("Error connecting to WDM device #%d", m_deviceNumber), _("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("Error connecting to WDM device");
         }
 
         if (CVFAILED(m_pVidCap->SetMode(m_deviceMode)))
         {
-            wxMessageBox(wxString::Format("Error activating video mode %d", m_deviceMode), _("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(wxString::Format("Error activating video mode %d", m_deviceMode), _("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("setmode() failed");
         }
 
@@ -291,7 +291,7 @@ bool CameraWDM::Connect(const wxString& camId)
         CVVidCapture::VIDCAP_MODE modeInfo;
         if (CVFAILED(m_pVidCap->GetCurrentMode(modeInfo)))
         {
-            wxMessageBox(wxString::Format("Error probing video mode %d", m_deviceMode),_("Error"),wxOK | wxICON_ERROR);
+            PhdMessageBox(wxString::Format("Error probing video mode %d", m_deviceMode),_("Error"),wxOK | wxICON_ERROR);
             throw ERROR_INFO("GetCurrentMode() failed");
         }
 
@@ -302,7 +302,7 @@ bool CameraWDM::Connect(const wxString& camId)
 
         if (CVFAILED(m_pVidCap->StartImageCap(CVImage::CVIMAGE_GREY, CaptureCallback, this)))
         {
-            wxMessageBox(_T("Failed to start image capture!"),_("Error"),wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("Failed to start image capture!"),_("Error"),wxOK | wxICON_ERROR);
             throw ERROR_INFO("StartImageCap() failed");
         }
 
@@ -168,7 +168,7 @@ bool Camera_ZWO::EnumCameras(wxArrayString& names, wxArrayString& ids)
     wxString err;
     if (!TryLoadDll(&err))
     {
-        wxMessageBox(err, _("Error"), wxOK | wxICON_ERROR);
+        PhdMessageBox(err, _("Error"), wxOK | wxICON_ERROR);
         return true;
     }
 
@@ -706,14 +706,34 @@ inline static ASI_GUIDE_DIRECTION GetASIDirection(int direction)
     }
 }
 
-bool Camera_ZWO::ST4PulseGuideScope(int direction, int duration)
+// returns true on error
+bool Camera_ZWO::SetGuideRelay(int direction, bool on)
 {
     ASI_GUIDE_DIRECTION d = GetASIDirection(direction);
-    ASIPulseGuideOn(m_cameraId, d);
+    ASI_ERROR_CODE r = on ? ASIPulseGuideOn(m_cameraId, d) : ASIPulseGuideOff(m_cameraId, d);
+    if (r != ASI_SUCCESS)
+    {
+        Debug.Write(wxString::Format("%s(%d) ret %d\n", on ? "ASIPulseGuideOn" : "ASIPulseGuideOff", d, r));
+        return true;
+    }
+    return false;
+}
+
+bool Camera_ZWO::ST4PulseGuideScope(int direction, int duration)
+{
+    if (SetGuideRelay(direction, true))
+        return true;
+
     WorkerThread::MilliSleep(duration, WorkerThread::INT_ANY);
-    ASIPulseGuideOff(m_cameraId, d);
 
-    return false;
+    return SetGuideRelay(direction, false);
+}
+
+bool Camera_ZWO::ST4PulseGuideScopeConcurrent(int raDirection, int raDuration, int decDirection, int decDuration)
+{
+    // the ASI guide port switches each direction independently
+    return ST4RunConcurrentPulses(raDirection, raDuration, decDirection, decDuration,
+        [this](int direction, bool on) { return SetGuideRelay(direction, on); });
 }
 
 void  Camera_ZWO::ClearGuidePort()
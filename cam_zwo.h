@@ -60,6 +60,8 @@ public:
     bool Disconnect() override;
 
     bool    ST4PulseGuideScope(int direction, int duration) override;
+    bool    ST4CanPulseConcurrently() override { return true; }
+    bool    ST4PulseGuideScopeConcurrent(int raDirection, int raDuration, int decDirection, int decDuration) override;
     void    ClearGuidePort();
 
     bool HasNonGuiCapture() override { return true; }
@@ -74,6 +76,7 @@ public:
 
 private:
     bool StopCapture(void);
+    bool SetGuideRelay(int direction, bool on);
 };
 
 #endif
@@ -213,7 +213,7 @@ void CamCalImportDialog::OnOk(wxCommandEvent& evt)
         else
         {
             // ImportFromProfile already logs errors
-            wxMessageBox(_("Bad-pixel map could not be imported because of errors in file/copy"));
+            PhdMessageBox(_("Bad-pixel map could not be imported because of errors in file/copy"));
         }
     }
 
@@ -232,7 +232,7 @@ void CamCalImportDialog::OnOk(wxCommandEvent& evt)
         else
         {
             Debug.Write(wxString::Format("Dark lib import failed on file copy of %s to %s\n", sourceName, destName));
-            wxMessageBox(_("Dark library could not be imported because of errors in file/copy"));
+            PhdMessageBox(_("Dark library could not be imported because of errors in file/copy"));
         }
     }
     pFrame->SetDarkMenuState();                     // Get enabled states straightened out
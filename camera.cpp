@@ -46,6 +46,7 @@ static const double DefaultPixelSize = 0.0;
 static const int DefaultReadDelay = 150;
 static const bool DefaultLoadDarks = true;
 static const bool DefaultLoadDMap = false;
+static const bool DefaultLearnDefects = false;
 
 wxSize UNDEFINED_FRAME_SIZE = wxSize(0, 0);
 
@@ -207,12 +208,14 @@ GuideCamera::GuideCamera()
     Binning = pConfig->Profile.GetInt("/camera/binning", 1);
     CurrentDarkFrame = nullptr;
     CurrentDefectMap = nullptr;
+    m_defectLearner = pConfig->Profile.GetBoolean("/camera/LearnDefects", DefaultLearnDefects) ? new DefectLearner() : nullptr;
 }
 
 GuideCamera::~GuideCamera()
 {
     ClearDarks();
     ClearDefectMap();
+    delete m_defectLearner;
 }
 
 static int CompareNoCase(const wxString& first, const wxString& second)
@@ -781,7 +784,7 @@ void CameraConfigDialogPane::LayoutControls(GuideCamera *pCamera, BrainCtrlIdMap
     wxStaticBoxSizer *pSpecGroup = new wxStaticBoxSizer(wxVERTICAL, m_pParent, _("Camera-Specific Properties"));
     if (pCamera)
     {
-        int numItems = 3;
+        int numItems = 4;
         if (pCamera->HasGainControl) ++numItems;
         if (pCamera->HasDelayParam)  ++numItems;
         if (pCamera->HasPortNum)     ++numItems;
@@ -802,6 +805,7 @@ void CameraConfigDialogPane::LayoutControls(GuideCamera *pCamera, BrainCtrlIdMap
             pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szBinning));
         if (pCamera->HasSubframes)
             pDetailsSizer->Add(GetSingleCtrl(CtrlMap, AD_cbUseSubFrames), wxSizerFlags().Border(wxTOP, 3));
+        pDetailsSizer->Add(GetSingleCtrl(CtrlMap, AD_cbLearnDefects), wxSizerFlags().Border(wxTOP, 3));
         if (pCamera->HasCooler)
             pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szCooler));
         pSpecGroup->Add(pDetailsSizer, spec_flags);
@@ -853,6 +857,13 @@ CameraConfigDialogCtrlSet::CameraConfigDialogCtrlSet(wxWindow *pParent, GuideCam
         AddCtrl(CtrlMap, AD_cbUseSubFrames, m_pUseSubframes, _("Check to only download subframes (ROIs). Sub-frame size is equal to search region size."));
     }
 
+    m_pLearnDefects = new wxCheckBox(GetParentWindow(AD_cbLearnDefects), wxID_ANY, _("Learn hot pixels"));
+    AddCtrl(CtrlMap, AD_cbLearnDefects, m_pLearnDefects,
+        _("Check to detect hot and cold pixels that persist over many full frames and remove them from the guide images. "
+          "This catches defects missing from the dark library or bad-pixel map, for example after a change in sensor temperature. "
+          "A pixel is only confirmed after the star field has moved across it, so defects are learned while dithering "
+          "or while the mount drifts, not during steady guiding."));
+
     // Pixel size always
     m_pPixelSize = NewSpinnerDouble(GetParentWindow(AD_szPixelSize), textWidth, m_pCamera->GetCameraPixelSize(), 0.0, 99.9, 0.1,
         _("Guide camera un-binned pixel size in microns. Used with the guide telescope focal length to display guiding error in arc-seconds."));
@@ -973,6 +984,8 @@ void CameraConfigDialogCtrlSet::LoadValues()
         m_pUseSubframes->SetValue(m_pCamera->UseSubframes);
     }
 
+    m_pLearnDefects->SetValue(m_pCamera->GetLearnDefects());
+
     if (m_pCamera->HasGainControl)
     {
         m_pCameraGain->SetValue(m_pCamera->GetCameraGain());
@@ -1137,6 +1150,8 @@ void CameraConfigDialogCtrlSet::UnloadValues()
         pConfig->Profile.SetBoolean("/camera/UseSubframes", m_pCamera->UseSubframes);
     }
 
+    m_pCamera->SetLearnDefects(m_pLearnDefects->GetValue());
+
     if (m_pCamera->HasGainControl)
     {
         m_pCamera->SetCameraGain(m_pCameraGain->GetValue());
@@ -1352,6 +1367,63 @@ void GuideCamera::SetDefectMap(DefectMap *defectMap)
     CurrentDefectMap = defectMap;
 }
 
+void GuideCamera::SetLearnDefects(bool learn)
+{
+    pConfig->Profile.SetBoolean("/camera/LearnDefects", learn);
+
+    wxCriticalSectionLocker lck(DarkFrameLock);
+
+    if (learn == (m_defectLearner != nullptr))
+        return;
+
+    Debug.Write(wxString::Format("Defect learning %s\n", learn ? "enabled" : "disabled"));
+
+    delete m_defectLearner;
+    m_defectLearner = learn ? new DefectLearner() : nullptr;
+}
+
+// Called from the main thread before each exposure with the guide star
+// position and search regions, which the learner must not take for defects
+void GuideCamera::SetDefectLearnerField(const DefectLearner::Field& field)
+{
+    wxCriticalSectionLocker lck(DarkFrameLock);
+    m_defectLearnerField = field;
+}
+
+// Hot pixels that are not in the dark frame or defect map, e.g. because the
+// sensor temperature changed since they were built, are learned from the
+// light frames and removed before the frame reaches star detection.
+void GuideCamera::LearnDefects(usImage& img)
+{
+    // the worker thread captures while the main thread may change the setting
+    wxCriticalSectionLocker lck(DarkFrameLock);
+
+    if (!m_defectLearner)
+        return;
+
+    // only full frames are used so that every pixel is seen
+    if (img.ImageData && img.Subframe.IsEmpty())
+    {
+        bool changed = m_defectLearner->Learn(img.ImageData, img.Size, m_defectLearnerField);
+
+        const DefectLearner::FrameStats& stats = m_defectLearner->LastFrame();
+        if (stats.skipped)
+        {
+            Debug.Write(wxString::Format("DefectLearner: skipped frame with too many outliers (%u), bg = %u sigma = %.1f\n",
+                stats.hits, stats.bg, stats.sigma));
+        }
+        if (changed)
+        {
+            Debug.Write(wxString::Format("DefectLearner: %u defective pixels flagged after %u frames, %u candidates\n",
+                (unsigned int) m_defectLearner->Defects().size(), m_defectLearner->FrameCount(), m_defectLearner->CandidateCount()));
+        }
+    }
+
+    const std::vector<wxPoint>& defects = m_defectLearner->Defects();
+    if (!defects.empty())
+        RemoveDefects(img, defects);
+}
+
 void GuideCamera::ClearDarks()
 {
     wxCriticalSectionLocker lck(DarkFrameLock);
@@ -1444,7 +1516,10 @@ bool GuideCamera::Capture(GuideCamera *camera, int duration, usImage& img, int c
     img.InitImgStartTime();
     img.BitsPerPixel = camera->BitsPerPixel();
     img.ImgExpDur = duration;
+    TRACE_SCOPE("Camera::Capture", "exposure", duration);
     bool err = camera->Capture(duration, img, captureOptions, subframe);
+    if (!err && (captureOptions & CAPTURE_LIGHT) == CAPTURE_LIGHT)
+        camera->LearnDefects(img);
     return err;
 }
 
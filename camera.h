@@ -65,6 +65,7 @@ class CameraConfigDialogCtrlSet : public ConfigDialogCtrlSet
 {
     GuideCamera *m_pCamera;
     wxCheckBox *m_pUseSubframes;
+    wxCheckBox *m_pLearnDefects;
     wxSpinCtrl *m_pCameraGain;
     wxSpinCtrl *m_timeoutVal;
     wxChoice   *m_pPortNum;
@@ -109,6 +110,10 @@ class GuideCamera :  public wxMessageBoxProxy, public OnboardST4
     friend class CameraConfigDialogCtrlSet;
 
     double          m_pixelSize;
+    DefectLearner  *m_defectLearner;    // null when defect learning is disabled; protected by DarkFrameLock
+    DefectLearner::Field m_defectLearnerField; // protected by DarkFrameLock
+
+    void            LearnDefects(usImage& img);
 
 protected:
     bool            m_hasGuideOutput;
@@ -189,6 +194,9 @@ public:
     void            SelectDark(int exposureDuration);
     void            SetDefectMap(DefectMap *newMap);
     void            ClearDefectMap();
+    bool            GetLearnDefects() const;
+    void            SetLearnDefects(bool learn);
+    void            SetDefectLearnerField(const DefectLearner::Field& field);
     void            ClearDarks();
 
     void            SubtractDark(usImage& img);
@@ -242,6 +250,11 @@ inline double GuideCamera::GetCameraPixelSize() const
     return m_pixelSize;
 }
 
+inline bool GuideCamera::GetLearnDefects() const
+{
+    return m_defectLearner != nullptr;
+}
+
 inline bool GuideCamera::GetDevicePixelSize(double *devPixelSize)
 {
     return true;                // Return an error, the device/driver can't report pixel size
@@ -0,0 +1,184 @@
+/*
+ *  computepool.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum
+{
+    MIN_PIXELS_PER_RANGE = 64 * 1024,
+    MAX_POOL_THREADS = 15,
+};
+
+struct PoolJob
+{
+    const ComputePool::RangeFn *fn;
+    int count;
+    int grain;
+    int nranges;
+    std::atomic<int> next;  // next range to claim
+    int helpers;            // pool threads working on the job, guarded by the pool lock
+
+    void Run()
+    {
+        int r;
+        while ((r = next.fetch_add(1, std::memory_order_relaxed)) < nranges)
+        {
+            int const begin = r * grain;
+            (*fn)(begin, std::min(begin + grain, count));
+        }
+    }
+};
+
+struct PoolState
+{
+    std::mutex lock;
+    std::condition_variable workAvailable;
+    std::condition_variable helperDone;
+    std::deque<PoolJob *> jobs;
+    unsigned int nthreads;
+
+    PoolState()
+    {
+        unsigned int ncpu = std::max(std::thread::hardware_concurrency(), 1U);
+        nthreads = std::min(ncpu - 1, (unsigned int) MAX_POOL_THREADS);
+
+        Debug.Write(wxString::Format("ComputePool: %u cpus, %u pool threads\n", ncpu, nthreads));
+
+        for (unsigned int i = 0; i < nthreads; i++)
+            std::thread(&PoolState::ThreadMain, this).detach();
+    }
+
+    void ThreadMain()
+    {
+        std::unique_lock<std::mutex> lck(lock);
+
+        for (;;)
+        {
+            workAvailable.wait(lck, [this] { return !jobs.empty(); });
+
+            PoolJob *job = jobs.front();
+            // move the job to the back so idle threads spread over concurrent jobs
+            jobs.pop_front();
+            jobs.push_back(job);
+            ++job->helpers;
+
+            lck.unlock();
+            job->Run();
+            lck.lock();
+
+            if (--job->helpers == 0)
+                helperDone.notify_all();
+
+            // the job owner removes the job once all ranges are claimed, but
+            // don't spin on it in the meantime
+            if (job->next.load(std::memory_order_relaxed) >= job->nranges)
+            {
+                auto it = std::find(jobs.begin(), jobs.end(), job);
+                if (it != jobs.end())
+                    jobs.erase(it);
+            }
+        }
+    }
+};
+
+// the pool threads are detached and never stopped, so the state is
+// deliberately never destroyed
+static PoolState *Pool()
+{
+    static PoolState *s_pool = new PoolState();
+    return s_pool;
+}
+
+unsigned int ComputePool::Concurrency()
+{
+    return Pool()->nthreads + 1;
+}
+
+int ComputePool::RowGrain(int rows, int rowPixels)
+{
+    int grain = MIN_PIXELS_PER_RANGE / std::max(rowPixels, 1);
+    return std::max(std::min(grain, rows), 1);
+}
+
+void ComputePool::ParallelFor(int count, int grain, const RangeFn& fn)
+{
+    if (count <= 0)
+        return;
+
+    grain = std::max(grain, 1);
+
+    PoolJob job;
+    job.fn = &fn;
+    job.count = count;
+    job.grain = grain;
+    job.nranges = (count + grain - 1) / grain;
+    job.next = 0;
+    job.helpers = 0;
+
+    if (job.nranges == 1)
+    {
+        fn(0, count);
+        return;
+    }
+
+    PoolState *pool = Pool();
+
+    if (pool->nthreads == 0)
+    {
+        job.Run();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(pool->lock);
+        pool->jobs.push_back(&job);
+    }
+    pool->workAvailable.notify_all();
+
+    job.Run();
+
+    // all ranges are claimed; wait for pool threads still running one
+    std::unique_lock<std::mutex> lck(pool->lock);
+    auto it = std::find(pool->jobs.begin(), pool->jobs.end(), &job);
+    if (it != pool->jobs.end())
+        pool->jobs.erase(it);
+    pool->helperDone.wait(lck, [&job] { return job.helpers == 0; });
+}
@@ -0,0 +1,72 @@
+/*
+ *  computepool.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef COMPUTEPOOL_INCLUDED
+#define COMPUTEPOOL_INCLUDED
+
+#include <functional>
+
+// Process-wide pool of threads for data-parallel pixel work.
+//
+// A job is split into fixed ranges that the calling thread and any idle pool
+// threads claim one at a time, so a thread that is preempted (for example by
+// the guide loop) only delays its current range while the others take the
+// rest. The caller always works on its own job, which makes nested or
+// concurrent jobs from different threads safe, and the pool has one thread
+// fewer than the number of cores so the caller never competes with it for
+// the last one.
+class ComputePool
+{
+public:
+    typedef std::function<void(int begin, int end)> RangeFn;
+
+    // number of threads that can work on one job, including the caller
+    static unsigned int Concurrency();
+
+    // Call fn(begin, end) for consecutive ranges of at most grain items
+    // covering [0, count) and return when all have completed. The ranges
+    // depend only on count and grain, never on the number of threads, so
+    // per-range results combined in range order are deterministic.
+    static void ParallelFor(int count, int grain, const RangeFn& fn);
+
+    // rows per range for image row loops, large enough that a range is worth
+    // handing to another thread
+    static int RowGrain(int rows, int rowPixels);
+
+    static void ParallelRows(int rows, int rowPixels, const RangeFn& fn)
+    {
+        ParallelFor(rows, RowGrain(rows, rowPixels), fn);
+    }
+};
+
+#endif
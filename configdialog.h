@@ -58,6 +58,7 @@ enum BRAIN_CTRL_IDS
     AD_szDither,
     AD_GLOBAL_TAB_BOUNDARY,        //-----end of global tab controls
     AD_cbUseSubFrames,
+    AD_cbLearnDefects,
     AD_szNoiseReduction,
     AD_szAutoExposure,
     AD_szSaturationOptions,
@@ -60,9 +60,10 @@
 
 #define HYSTERESIS 0.1 // for the hybrid mode
 
-GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
-    start_time_(std::chrono::system_clock::now()),
-    last_time_(std::chrono::system_clock::now()),
+GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters, TimeSource time_source) :
+    time_source_(time_source),
+    start_time_(time_source()),
+    last_time_(start_time_),
     control_signal_(0),
     prediction_(0),
     last_prediction_end_(0),
@@ -98,7 +99,7 @@ GaussianProcessGuider::~GaussianProcessGuider()
 
 void GaussianProcessGuider::SetTimestamp()
 {
-    auto current_time = std::chrono::system_clock::now();
+    auto current_time = time_source_();
     double delta_measurement_time = std::chrono::duration<double>(current_time - last_time_).count();
     last_time_ = current_time;
     get_last_point().timestamp = std::chrono::duration<double>(current_time - start_time_).count()
@@ -250,7 +251,7 @@ double GaussianProcessGuider::PredictGearError(double prediction_location)
     // in the first step of each sequence, use the current time stamp as last prediction end
     if (last_prediction_end_ < 0.0)
     {
-        last_prediction_end_ = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+        last_prediction_end_ = std::chrono::duration<double>(time_source_() - start_time_).count();
     }
 
     // prediction from the last endpoint to the prediction point
@@ -297,7 +298,7 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     // the starting time is set at the first call of result after startup or reset
     if (get_number_of_measurements() == 1)
     {
-        start_time_ = std::chrono::system_clock::now();
+        start_time_ = time_source_();
         last_time_ = start_time_; // this is OK, since last_time_ only provides a minor correction
     }
 
@@ -326,7 +327,7 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     {
         if (prediction_point < 0.0)
         {
-            prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+            prediction_point = std::chrono::duration<double>(time_source_() - start_time_).count();
         }
         // the point of highest precision shoud be between now and the next step
         UpdateGP(prediction_point + 0.5 * time_step);
@@ -380,7 +381,7 @@ double GaussianProcessGuider::deduceResult(double time_step, double prediction_p
     {
         if (prediction_point < 0.0)
         {
-            prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+            prediction_point = std::chrono::duration<double>(time_source_() - start_time_).count();
         }
         // the point of highest precision should be between now and the next step
         UpdateGP(prediction_point + 0.5 * time_step);
@@ -416,8 +417,8 @@ void GaussianProcessGuider::reset()
     circular_buffer_data_[0].control = 0; // set first control to zero
 
     last_prediction_end_ = -1.0; // the negative value signals we didn't predict yet
-    start_time_ = std::chrono::system_clock::now();
-    last_time_ = std::chrono::system_clock::now();
+    start_time_ = time_source_();
+    last_time_ = time_source_();
 
     dither_offset_ = 0.0;
     dither_steps_ = 0;
@@ -560,7 +561,7 @@ void GaussianProcessGuider::inject_data_point(double timestamp, double input, do
     last_prediction_end_ = timestamp;
     get_last_point().timestamp = timestamp; // overrides the usual HandleTimestamps();
 
-    start_time_ = std::chrono::system_clock::now() - std::chrono::seconds((int) timestamp);
+    start_time_ = time_source_() - std::chrono::seconds((int) timestamp);
 
     add_one_point(); // add new point here, since the control is for the next point in time
     HandleControls(control); // already store control signal
@@ -124,8 +124,12 @@ public:
 
     };
 
+public:
+    typedef std::chrono::system_clock::time_point (*TimeSource)();
+
 private:
 
+    TimeSource time_source_; // clock for the measurement timestamps
     std::chrono::system_clock::time_point start_time_; // reference time
     std::chrono::system_clock::time_point last_time_;
 
@@ -220,7 +224,11 @@ public:
     double GetPredictionGain() const;
     bool SetPredictionGain(double);
 
-    GaussianProcessGuider(guide_parameters parameters);
+    /**
+     * The time source defaults to the system clock. PHD2 passes its own clock
+     * so that simulated sessions can run faster than real time.
+     */
+    GaussianProcessGuider(guide_parameters parameters, TimeSource time_source = std::chrono::system_clock::now);
     ~GaussianProcessGuider();
 
     /**
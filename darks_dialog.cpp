@@ -251,7 +251,7 @@ void DarksDialog::OnStart(wxCommandEvent& evt)
     wxYield();
 
     if (!pCamera->HasShutter)
-        wxMessageBox(_("Cover guide scope"));
+        PhdMessageBox(_("Cover guide scope"));
     pCamera->ShutterClosed = true;
 
     m_pProgress->SetValue(0);
@@ -375,7 +375,7 @@ void DarksDialog::OnStart(wxCommandEvent& evt)
         pCamera->ShutterClosed = false; // Lights
         if (!pCamera->HasShutter)
             wrapupMsg = _("Uncover guide scope") + wxT("\n\n") + wrapupMsg;   // Results will appear in smaller font
-        wxMessageBox(wxString::Format(_("Operation complete: %s"), wrapupMsg));
+        PhdMessageBox(wxString::Format(_("Operation complete: %s"), wrapupMsg));
         EndDialog(wxOK);
     }
 }
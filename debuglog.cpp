@@ -82,7 +82,7 @@ bool DebugLog::Init(const wxDateTime& initTime, bool bEnable, bool bForceOpen)
 
         if (!wxFFile::Open(m_pPathName, "a"))
         {
-            wxMessageBox(wxString::Format("unable to open file %s", m_pPathName));
+            PhdMessageBox(wxString::Format("unable to open file %s", m_pPathName));
         }
     }
 
@@ -98,7 +98,7 @@ bool DebugLog::ChangeDirLog(const wxString& newdir)
 
     if (!SetLogDir(newdir))
     {
-        wxMessageBox(wxString::Format("invalid folder name %s, debug log folder unchanged", newdir));
+        PhdMessageBox(wxString::Format("invalid folder name %s, debug log folder unchanged", newdir));
         bOk = false;
     }
 
@@ -136,6 +136,7 @@ bool DebugLog::Flush(void)
 
     if (m_bEnabled)
     {
+        MetricTimer timer(Metrics.logFlushTime);
         wxCriticalSectionLocker lock(m_criticalSection);
 
         bReturn = wxFFile::Flush();
@@ -148,9 +149,10 @@ wxString DebugLog::Write(const wxString& str)
 {
     if (m_bEnabled)
     {
+        MetricTimer timer(Metrics.logWriteTime);
         wxCriticalSectionLocker lock(m_criticalSection);
 
-        wxDateTime now = wxDateTime::UNow();
+        wxDateTime now = PhdClock::UNow();
         wxTimeSpan deltaTime = now - m_lastWriteTime;
         m_lastWriteTime = now;
         wxString outputLine = wxString::Format("%s %s %lu %s", now.Format("%H:%M:%S.%l"),
@@ -0,0 +1,412 @@
+/*
+ *  defect_learner.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef DEFECT_LEARNER_INCLUDED
+#define DEFECT_LEARNER_INCLUDED
+
+// Learns hot and cold pixels from the light frames taken while looping and
+// guiding, so that defects appearing after the dark library or defect map
+// was built (e.g. with a change in sensor temperature) are still removed.
+// It only depends on wxRect, wxSize and wxPoint so it can be run outside
+// PHD2 (see tests/defect_learner_test.cpp).
+//
+// Each frame is scanned for isolated single-pixel outliers: pixels far from
+// the background level whose neighbors are all close to the background.
+// Stars are spread over several pixels and fail the test, but an
+// undersampled star can pass it, so:
+//
+//  - outliers inside the guide star search regions are ignored
+//  - a pixel is only flagged after it was an outlier at several field
+//    positions, i.e. at guide star positions at least FIELD_MOVE_PX apart.
+//    A defect stays on the same sensor pixel when the field moves (dither,
+//    drift while looping), a star does not.
+//
+// Outliers are tracked sparsely with an exponentially decaying hit score. A
+// pixel is flagged once it has been an outlier in most recent scans of its
+// row and at enough field positions, and is released again when it stops
+// being one.
+//
+// Large frames are scanned a subset of rows at a time, at most PIXEL_BUDGET
+// pixels per frame, so each row is visited every few frames.
+
+#include <wx/gdicmn.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+class DefectLearner
+{
+public:
+    struct Field
+    {
+        bool hasStar;
+        double starX;                   // guide star position
+        double starY;
+        std::vector<wxRect> exclude;    // guide star search regions
+
+        Field() : hasStar(false), starX(0.0), starY(0.0) { }
+    };
+
+    struct FrameStats
+    {
+        unsigned int bg;
+        double sigma;
+        unsigned int hits;              // outliers found in the rows scanned
+        bool skipped;                   // too many outliers for a normal star field
+    };
+
+    enum
+    {
+        PIXEL_BUDGET = 1000000,         // pixels scanned per frame
+        MIN_FIELD_POSITIONS = 3,
+    };
+    static double FieldMovePx() { return 3.0; }
+
+private:
+    enum
+    {
+        BACKGROUND_SAMPLES = 4096,
+        MAX_HITS_PER_FRAME = 2000,      // per full frame; more than this and the frame is not a normal star field
+        MAX_CANDIDATES = 20000,
+        PRUNE_INTERVAL = 16,            // frames
+        BLOCK = 32,
+    };
+
+    struct Candidate
+    {
+        float score;                // decayed count of row scans the pixel was an outlier
+        unsigned int frame;         // frame number when the score was last updated
+        float fieldX;               // guide star position when the pixel was last counted at a new field position
+        float fieldY;
+        unsigned char positions;    // number of field positions the pixel was an outlier at
+        bool flagged;
+    };
+
+    wxSize m_size;
+    unsigned int m_rowStride;       // rows are scanned every m_rowStride frames
+    unsigned int m_frame;
+    std::unordered_map<unsigned int, Candidate> m_candidates; // key is pixel index
+    std::vector<unsigned short> m_samples;
+    std::vector<unsigned int> m_hits;
+    std::vector<wxPoint> m_defects;
+    FrameStats m_stats;
+
+    static float DecayedScore(float score, unsigned int visits)
+    {
+        static const float SCORE_DECAY = 0.95f;     // per row scan
+        return score * powf(SCORE_DECAY, (float) visits);
+    }
+
+    static bool NeighborsBelow(const unsigned short *p, int w, unsigned int limit)
+    {
+        return p[-w - 1] < limit && p[-w] < limit && p[-w + 1] < limit &&
+            p[-1] < limit && p[1] < limit &&
+            p[w - 1] < limit && p[w] < limit && p[w + 1] < limit;
+    }
+
+    static bool NeighborsAbove(const unsigned short *p, int w, unsigned int limit)
+    {
+        return p[-w - 1] > limit && p[-w] > limit && p[-w + 1] > limit &&
+            p[-1] > limit && p[1] > limit &&
+            p[w - 1] > limit && p[w] > limit && p[w + 1] > limit;
+    }
+
+    static unsigned short BlockMaxOffset(const unsigned short *p, int n, unsigned short lo)
+    {
+        unsigned short maxofs = 0;
+        if (n == BLOCK)
+        {
+            for (int i = 0; i < BLOCK; i++)
+                maxofs = std::max(maxofs, (unsigned short)(p[i] - lo));
+        }
+        else
+        {
+            for (int i = 0; i < n; i++)
+                maxofs = std::max(maxofs, (unsigned short)(p[i] - lo));
+        }
+        return maxofs;
+    }
+
+    static bool Excluded(const Field& field, int x, int y)
+    {
+        for (const wxRect& r : field.exclude)
+            if (r.Contains(x, y))
+                return true;
+        return false;
+    }
+
+    void MeasureBackground(const unsigned short *px, unsigned int npixels);
+    void Scan(const unsigned short *px, const Field& field, unsigned int firstRow);
+    bool Update(const Field& field);
+    bool Prune(const Field& field);
+    void UpdateDefects();
+
+public:
+    DefectLearner() { Reset(); }
+
+    void Reset();
+
+    // Updates the statistics from a dark-subtracted full frame. Returns
+    // true if the set of flagged pixels changed.
+    bool Learn(const unsigned short *px, const wxSize& size, const Field& field);
+
+    const std::vector<wxPoint>& Defects() const { return m_defects; }
+    const FrameStats& LastFrame() const { return m_stats; }
+    unsigned int RowStride() const { return m_rowStride; }
+    unsigned int FrameCount() const { return m_frame; }
+    unsigned int CandidateCount() const { return (unsigned int) m_candidates.size(); }
+};
+
+inline void DefectLearner::Reset()
+{
+    m_size = wxSize(0, 0);
+    m_rowStride = 1;
+    m_frame = 0;
+    m_candidates.clear();
+    m_defects.clear();
+    m_stats = FrameStats();
+}
+
+// background level and noise from a sparse sample of the frame
+inline void DefectLearner::MeasureBackground(const unsigned short *px, unsigned int npixels)
+{
+    static const double MIN_SIGMA = 1.0;        // ADU
+
+    unsigned int const step = npixels / BACKGROUND_SAMPLES + 1;
+    m_samples.clear();
+    for (unsigned int i = 0; i < npixels; i += step)
+        m_samples.push_back(px[i]);
+
+    auto mid = m_samples.begin() + m_samples.size() / 2;
+    std::nth_element(m_samples.begin(), mid, m_samples.end());
+    unsigned int const bg = *mid;
+
+    for (auto& val : m_samples)
+        val = (unsigned short) abs((int) val - (int) bg);
+    std::nth_element(m_samples.begin(), mid, m_samples.end());
+
+    m_stats.bg = bg;
+    m_stats.sigma = std::max(1.4826 * *mid, MIN_SIGMA);
+}
+
+// Outliers are rare, so the pixels are screened a block at a time and only
+// the blocks containing an outlier are examined pixel by pixel. Offsetting
+// by lo turns the range check into a single unsigned compare (values below
+// lo wrap around to large values), and the block maximum is a branch-free
+// loop the compiler can vectorize. Full blocks get a fixed trip count, which
+// lets it vectorize at -O2 as well.
+inline void DefectLearner::Scan(const unsigned short *px, const Field& field, unsigned int firstRow)
+{
+    static const double HOT_SIGMA = 6.0;            // outlier threshold, background sigmas
+    static const double COLD_SIGMA = 6.0;
+    static const double NEIGHBOR_FRACTION = 0.25;   // neighbors must be within this fraction of the outlier's excess
+
+    int const w = m_size.GetWidth();
+    int const h = m_size.GetHeight();
+    unsigned int const bg = m_stats.bg;
+    double const sigma = m_stats.sigma;
+
+    unsigned short const hi = (unsigned short) std::min(bg + HOT_SIGMA * sigma, 65535.);
+    unsigned short const lo = bg > COLD_SIGMA * sigma ? (unsigned short)(bg - COLD_SIGMA * sigma) : 0;
+    unsigned short const range = hi - lo;
+
+    size_t const maxHits = MAX_HITS_PER_FRAME / m_rowStride + 1;
+
+    m_hits.clear();
+    for (int y = firstRow; y < h - 1; y += m_rowStride)
+    {
+        const unsigned short *row = &px[y * w];
+        for (int x0 = 1; x0 < w - 1; x0 += BLOCK)
+        {
+            int const x1 = std::min(x0 + (int) BLOCK, w - 1);
+
+            if (BlockMaxOffset(&row[x0], x1 - x0, lo) <= range)
+                continue;
+
+            for (int x = x0; x < x1; x++)
+            {
+                unsigned int const val = row[x];
+                bool hit = false;
+                if (val > hi)
+                {
+                    unsigned int const limit = bg + (unsigned int)(NEIGHBOR_FRACTION * (val - bg));
+                    hit = NeighborsBelow(&row[x], w, limit);
+                }
+                else if (val < lo)
+                {
+                    unsigned int const limit = bg - (unsigned int)(NEIGHBOR_FRACTION * (bg - val));
+                    hit = NeighborsAbove(&row[x], w, limit);
+                }
+                if (hit && !Excluded(field, x, y))
+                    m_hits.push_back(y * w + x);
+            }
+        }
+        if (m_hits.size() > maxHits)
+        {
+            m_stats.skipped = true;
+            break;
+        }
+    }
+
+    m_stats.hits = (unsigned int) m_hits.size();
+}
+
+inline bool DefectLearner::Update(const Field& field)
+{
+    bool changed = false;
+
+    for (unsigned int idx : m_hits)
+    {
+        auto it = m_candidates.find(idx);
+        if (it == m_candidates.end())
+        {
+            if (m_candidates.size() < MAX_CANDIDATES)
+            {
+                Candidate c = { 1.0f, m_frame, (float) field.starX, (float) field.starY,
+                    (unsigned char)(field.hasStar ? 1 : 0), false };
+                m_candidates.insert(std::make_pair(idx, c));
+            }
+            continue;
+        }
+
+        Candidate& c = it->second;
+        c.score = DecayedScore(c.score, (m_frame - c.frame) / m_rowStride) + 1.0f;
+        c.frame = m_frame;
+
+        if (field.hasStar && c.positions < MIN_FIELD_POSITIONS &&
+            (c.positions == 0 || hypot(field.starX - c.fieldX, field.starY - c.fieldY) >= FieldMovePx()))
+        {
+            ++c.positions;
+            c.fieldX = (float) field.starX;
+            c.fieldY = (float) field.starY;
+        }
+
+        static const float FLAG_SCORE = 10.0f;      // about 14 consecutive scans, or a hit rate above 50%
+        if (!c.flagged && c.score >= FLAG_SCORE && c.positions >= MIN_FIELD_POSITIONS)
+        {
+            c.flagged = true;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+inline bool DefectLearner::Prune(const Field& field)
+{
+    static const float RELEASE_SCORE = 4.0f;
+    static const float DROP_SCORE = 0.5f;
+
+    int const w = m_size.GetWidth();
+    bool changed = false;
+
+    for (auto it = m_candidates.begin(); it != m_candidates.end(); )
+    {
+        Candidate& c = it->second;
+
+        // outliers are not counted inside the search regions, so do not let
+        // the score of a pixel there decay either
+        if (Excluded(field, it->first % w, it->first / w))
+        {
+            c.frame = m_frame;
+            ++it;
+            continue;
+        }
+
+        float const score = DecayedScore(c.score, (m_frame - c.frame) / m_rowStride);
+        if (c.flagged ? score < RELEASE_SCORE : score < DROP_SCORE)
+        {
+            changed = changed || c.flagged;
+            it = m_candidates.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    return changed;
+}
+
+inline bool DefectLearner::Learn(const unsigned short *px, const wxSize& size, const Field& field)
+{
+    int const w = size.GetWidth();
+    int const h = size.GetHeight();
+    if (!px || w < 3 || h < 3)
+        return false;
+
+    bool changed = false;
+
+    if (size != m_size)
+    {
+        changed = !m_defects.empty();
+        Reset();
+        m_size = size;
+        unsigned int const rows = h - 2;
+        m_rowStride = std::max(1U, std::min(rows, (unsigned int)(((unsigned long long) rows * w + PIXEL_BUDGET - 1) / PIXEL_BUDGET)));
+    }
+
+    ++m_frame;
+    m_stats.skipped = false;
+
+    MeasureBackground(px, (unsigned int) w * h);
+    Scan(px, field, 1 + m_frame % m_rowStride);
+
+    if (m_stats.skipped)
+        return changed;
+
+    changed = Update(field) || changed;
+
+    if (m_frame % PRUNE_INTERVAL == 0)
+        changed = Prune(field) || changed;
+
+    if (changed)
+        UpdateDefects();
+
+    return changed;
+}
+
+inline void DefectLearner::UpdateDefects()
+{
+    int const w = m_size.GetWidth();
+
+    m_defects.clear();
+    for (const auto& entry : m_candidates)
+    {
+        if (entry.second.flagged)
+            m_defects.push_back(wxPoint(entry.first % w, entry.first / w));
+    }
+}
+
+#endif // DEFECT_LEARNER_INCLUDED
@@ -802,7 +802,7 @@ wxWindow *DriftTool::CreateDriftToolWindow()
 {
     if (!pCamera)
     {
-        wxMessageBox(_("Please connect a camera first."));
+        PhdMessageBox(_("Please connect a camera first."));
         return 0;
     }
 
@@ -60,13 +60,13 @@ void MyFrame::OnEEGG(wxCommandEvent& evt)
         wxString savedCal = pConfig->Profile.GetString("/scope/calibration/timestamp", wxEmptyString);
         if (savedCal.IsEmpty())
         {
-            wxMessageBox(_("There is no calibration data available."));
+            PhdMessageBox(_("There is no calibration data available."));
             return;
         }
 
         if (!pMount)
         {
-            wxMessageBox(_("Please connect a mount first."));
+            PhdMessageBox(_("Please connect a mount first."));
             return;
         }
 
@@ -133,7 +133,7 @@ void MyFrame::OnEEGG(wxCommandEvent& evt)
             }
             if (devicestr.Length() > 0)
             {
-                if (wxMessageBox(wxString::Format(_("%s calibration will be cleared - calibration will be re-done when guiding is started."), devicestr),
+                if (PhdMessageBox(wxString::Format(_("%s calibration will be cleared - calibration will be re-done when guiding is started."), devicestr),
                     _("Clear Calibration"), wxOK | wxCANCEL) == wxOK)
                 {
                     if (pMount)
@@ -157,7 +157,7 @@ void MyFrame::OnEEGG(wxCommandEvent& evt)
             Debug.AddLine("User-requested FlipCal");
             if (!TheScope()->IsCalibrated())
             {
-                wxMessageBox(_("Scope has no current calibration data - you should just do a fresh calibration."));
+                PhdMessageBox(_("Scope has no current calibration data - you should just do a fresh calibration."));
             }
             else
             {
@@ -175,13 +175,13 @@ void MyFrame::OnEEGG(wxCommandEvent& evt)
                 {
                     if (FlipCalibrationData())
                     {
-                        wxMessageBox(_("Failed to flip calibration - please upload debug log file to PHD2 forum for assistance."));
+                        PhdMessageBox(_("Failed to flip calibration - please upload debug log file to PHD2 forum for assistance."));
                     }
                     else
                     {
                         double xnew = degrees(scope->xAngle());
                         double ynew = degrees(scope->yAngle());
-                        wxMessageBox(wxString::Format(_("Calibration angles flipped: (%.2f, %.2f) to (%.2f, %.2f)"),
+                        PhdMessageBox(wxString::Format(_("Calibration angles flipped: (%.2f, %.2f) to (%.2f, %.2f)"),
                             xorig, yorig, xnew, ynew));
                     }
                 }
@@ -264,12 +264,12 @@ void MyFrame::OnGuidingAssistant(wxCommandEvent& WXUNUSED(evt))
 {
     if (!pCamera)
     {
-        wxMessageBox(_("Please connect a camera first."));
+        PhdMessageBox(_("Please connect a camera first."));
         return;
     }
     if (!TheScope())
     {
-        wxMessageBox(_("Please connect a mount first."));
+        PhdMessageBox(_("Please connect a mount first."));
         return;
     }
 
@@ -36,13 +36,21 @@
 
 #include <wx/sstream.h>
 #include <wx/sckstrm.h>
+#include <cmath>
 #include <sstream>
+#include <unordered_map>
+
+#include "json_writer.h"
 
 EventServer EvtServer;
 
 BEGIN_EVENT_TABLE(EventServer, wxEvtHandler)
     EVT_SOCKET(EVENT_SERVER_ID, EventServer::OnEventServerEvent)
     EVT_SOCKET(EVENT_SERVER_CLIENT_ID, EventServer::OnEventServerClientEvent)
+    EVT_SOCKET(FRAME_SERVER_ID, EventServer::OnFrameServerEvent)
+    EVT_SOCKET(FRAME_SERVER_CLIENT_ID, EventServer::OnFrameServerClientEvent)
+    EVT_SOCKET(METRICS_SERVER_ID, EventServer::OnMetricsServerEvent)
+    EVT_SOCKET(METRICS_SERVER_CLIENT_ID, EventServer::OnMetricsServerClientEvent)
 END_EVENT_TABLE()
 
 enum
@@ -54,7 +62,81 @@ static const wxString literal_null("null");
 static const wxString literal_true("true");
 static const wxString literal_false("false");
 
-static wxString state_name(EXPOSED_STATE st)
+enum EventType
+{
+    EV_VERSION,
+    EV_LOCK_POSITION_SET,
+    EV_LOCK_POSITION_LOST,
+    EV_START_CALIBRATION,
+    EV_CALIBRATION_COMPLETE,
+    EV_CALIBRATION_FAILED,
+    EV_CALIBRATION_DATA_FLIPPED,
+    EV_STAR_SELECTED,
+    EV_STAR_LOST,
+    EV_START_GUIDING,
+    EV_GUIDING_STOPPED,
+    EV_PAUSED,
+    EV_RESUMED,
+    EV_GUIDE_STEP,
+    EV_GUIDING_DITHERED,
+    EV_LOOPING_EXPOSURES,
+    EV_LOOPING_EXPOSURES_STOPPED,
+    EV_APP_STATE,
+    EV_SETTLE_BEGIN,
+    EV_SETTLING,
+    EV_SETTLE_DONE,
+    EV_ALERT,
+    EV_GUIDE_PARAM_CHANGE,
+    EV_COUNT
+};
+
+static const char *const s_eventNames[] = {
+    "Version",
+    "LockPositionSet",
+    "LockPositionLost",
+    "StartCalibration",
+    "CalibrationComplete",
+    "CalibrationFailed",
+    "CalibrationDataFlipped",
+    "StarSelected",
+    "StarLost",
+    "StartGuiding",
+    "GuidingStopped",
+    "Paused",
+    "Resumed",
+    "GuideStep",
+    "GuidingDithered",
+    "LoopingExposures",
+    "LoopingExposuresStopped",
+    "AppState",
+    "SettleBegin",
+    "Settling",
+    "SettleDone",
+    "Alert",
+    "GuideParamChange",
+};
+wxCOMPILE_TIME_ASSERT(WXSIZEOF(s_eventNames) == EV_COUNT, EventNamesMismatch);
+
+// events that may be rate-limited by set_event_filter
+inline static bool is_periodic_event(EventType ev)
+{
+    return ev == EV_GUIDE_STEP || ev == EV_LOOPING_EXPOSURES || ev == EV_SETTLING || ev == EV_STAR_LOST;
+}
+
+static bool event_type(const char *name, EventType *ev)
+{
+    for (int i = 0; i < EV_COUNT; i++)
+    {
+        if (strcmp(name, s_eventNames[i]) == 0)
+        {
+            *ev = (EventType) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char *state_name(EXPOSED_STATE st)
 {
     switch (st)
     {
@@ -186,6 +268,7 @@ struct NV
     NV(const wxString& n_, const PHD_Point& p) : n(n_) { JAry ary; ary << p.X << p.Y; v = ary.str(); }
     NV(const wxString& n_, const wxPoint& p) : n(n_) { JAry ary; ary << p.x << p.y; v = ary.str(); }
     NV(const wxString& n_, const NULL_TYPE& nul) : n(n_), v(literal_null) { }
+    NV(const wxString& n_, const struct B64Encode& enc);
 };
 
 template<typename T>
@@ -214,133 +297,180 @@ static JObj& operator<<(JObj& j, const NV& nv)
     return j;
 }
 
-static NV NVMount(const Mount *mount)
+static JAry& operator<<(JAry& a, JObj& j)
 {
-    return NV("Mount", mount->Name());
+    return a << j.str();
 }
 
-static JObj& operator<<(JObj& j, const PHD_Point& pt)
+static const char *host_name()
 {
-    return j << NV("X", pt.X, 3) << NV("Y", pt.Y, 3);
+    static std::string s_host(wxGetHostName().utf8_str());
+    return s_host.c_str();
 }
 
-static JAry& operator<<(JAry& a, JObj& j)
+static JWriter& ev_begin(JWriter& ev, EventType type)
 {
-    return a << j.str();
+    double const now = PhdClock::UTCMillis().ToDouble() / 1000.0;
+    ev.Reset();
+    return ev.BeginObj()
+        .Add("Event", s_eventNames[type])
+        .Add("Timestamp", now, 3)
+        .Add("Host", host_name())
+        .Add("Inst", pFrame->GetInstanceNumber());
 }
 
-struct Ev : public JObj
+inline static JWriter& ev_point(JWriter& ev, const PHD_Point& pt)
 {
-    Ev(const wxString& event)
-    {
-        double const now = ::wxGetUTCTimeMillis().ToDouble() / 1000.0;
-        *this << NV("Event", event)
-            << NV("Timestamp", now, 3)
-            << NV("Host", wxGetHostName())
-            << NV("Inst", pFrame->GetInstanceNumber());
-    }
-};
+    return ev.Add("X", pt.X, 3).Add("Y", pt.Y, 3);
+}
+
+inline static JWriter& ev_mount(JWriter& ev, const Mount *mount)
+{
+    return ev.Add("Mount", mount->Name());
+}
 
-static Ev ev_message_version()
+static void ev_message_version(JWriter& ev)
 {
-    Ev ev("Version");
-    ev << NV("PHDVersion", PHDVERSION)
-        << NV("PHDSubver", PHDSUBVER)
-        << NV("MsgVersion", MSG_PROTOCOL_VERSION);
-    return ev;
+    ev_begin(ev, EV_VERSION)
+        .Add("PHDVersion", wxString(PHDVERSION))
+        .Add("PHDSubver", wxString(PHDSUBVER))
+        .Add("MsgVersion", (int) MSG_PROTOCOL_VERSION);
 }
 
-static Ev ev_set_lock_position(const PHD_Point& xy)
+static void ev_set_lock_position(JWriter& ev, const PHD_Point& xy)
 {
-    Ev ev("LockPositionSet");
-    ev << xy;
-    return ev;
+    ev_point(ev_begin(ev, EV_LOCK_POSITION_SET), xy);
 }
 
-static Ev ev_calibration_complete(Mount *mount)
+static void ev_calibration_complete(JWriter& ev, Mount *mount)
 {
-    Ev ev("CalibrationComplete");
-    ev << NVMount(mount);
+    ev_mount(ev_begin(ev, EV_CALIBRATION_COMPLETE), mount);
 
     if (mount->IsStepGuider())
     {
-        ev << NV("Limit", mount->GetAoMaxPos());
+        ev.Add("Limit", mount->GetAoMaxPos());
     }
-
-    return ev;
 }
 
-static Ev ev_star_selected(const PHD_Point& pos)
+static void ev_star_selected(JWriter& ev, const PHD_Point& pos)
 {
-    Ev ev("StarSelected");
-    ev << pos;
-    return ev;
+    ev_point(ev_begin(ev, EV_STAR_SELECTED), pos);
 }
 
-static Ev ev_start_guiding()
+static void ev_start_guiding(JWriter& ev)
 {
-    return Ev("StartGuiding");
+    ev_begin(ev, EV_START_GUIDING);
 }
 
-static Ev ev_paused()
+static void ev_paused(JWriter& ev)
 {
-    return Ev("Paused");
+    ev_begin(ev, EV_PAUSED);
 }
 
-static Ev ev_start_calibration(Mount *mount)
+static void ev_start_calibration(JWriter& ev, Mount *mount)
 {
-    Ev ev("StartCalibration");
-    ev << NVMount(mount);
-    return ev;
+    ev_mount(ev_begin(ev, EV_START_CALIBRATION), mount);
 }
 
-static Ev ev_app_state(EXPOSED_STATE st = Guider::GetExposedState())
+static void ev_app_state(JWriter& ev, EXPOSED_STATE st = Guider::GetExposedState())
 {
-    Ev ev("AppState");
-    ev << NV("State", state_name(st));
-    return ev;
+    ev_begin(ev, EV_APP_STATE)
+        .Add("State", state_name(st));
 }
 
-static Ev ev_settling(double distance, double time, double settleTime, bool starLocked)
+struct ClientReadBuf
 {
-    Ev ev("Settling");
+    enum
+    {
+        INITIAL_SIZE = 1024,
+        MAX_REQUEST_SIZE = 1024 * 1024,
+    };
 
-    ev << NV("Distance", distance, 2)
-       << NV("Time", time, 1)
-       << NV("SettleTime", settleTime, 1)
-       << NV("StarLocked", starLocked);
+    std::vector<char> buf;
+    size_t start;   // offset of the first unprocessed byte
+    size_t tail;    // offset of the line still being received; all lines before it are complete
+    size_t len;     // number of bytes in the buffer
 
-    return ev;
-}
+    ClientReadBuf() : buf(INITIAL_SIZE), start(0), tail(0), len(0) { }
+    char *dest() { return &buf[len]; }
+    size_t avail() const { return buf.size() - len; }
+    void grow()
+    {
+        // reclaim the already-processed bytes before resorting to a bigger buffer
+        if (start > 0)
+            compact();
+        if (avail() == 0)
+            buf.resize(buf.size() * 2);
+    }
+    void compact()
+    {
+        if (start == 0)
+            return;
+        if (len > start)
+            memmove(&buf[0], &buf[start], len - start);
+        len -= start;
+        tail -= start;
+        start = 0;
+    }
+    void shrink()
+    {
+        // release the memory used by an unusually large request
+        if (len == 0 && buf.size() > INITIAL_SIZE)
+            std::vector<char>(INITIAL_SIZE).swap(buf);
+    }
 
-static Ev ev_settle_done(const wxString& errorMsg, int settleFrames, int droppedFrames)
-{
-    Ev ev("SettleDone");
+    // Account for n bytes read into dest(). Returns true as soon as a
+    // request exceeds MAX_REQUEST_SIZE, so that an oversized request is
+    // never buffered in full.
+    bool Append(size_t n)
+    {
+        const char *p = buf.data() + len;
+        const char *const end = p + n;
 
-    int status = errorMsg.IsEmpty() ? 0 : 1;
+        len += n;
 
-    ev << NV("Status", status);
+        while (const char *eol = static_cast<const char *>(memchr(p, '\n', end - p)))
+        {
+            if ((size_t)(eol - (buf.data() + tail)) > MAX_REQUEST_SIZE)
+                return true;
+            p = eol + 1;
+            tail = p - buf.data();
+        }
 
-    if (status != 0)
-    {
-        ev << NV("Error", errorMsg);
+        return len - tail > MAX_REQUEST_SIZE;
     }
 
-    ev << NV("TotalFrames", settleFrames)
-        << NV("DroppedFrames", droppedFrames);
+    // Extract the next complete non-blank line into *line (nul-terminated);
+    // returns false when there is none. The buffer may be appended to (and
+    // reallocated) between calls, so no pointers into it are kept.
+    bool NextLine(std::vector<char> *line)
+    {
+        while (start < tail)
+        {
+            // there is always an EOL before the tail
+            const char *eol = static_cast<const char *>(memchr(&buf[start], '\n', tail - start));
 
-    return ev;
-}
+            size_t const end = eol - &buf[0];
+            size_t const linestart = start;
+            size_t const linelen = end - start;
 
-struct ClientReadBuf
-{
-    enum { SIZE = 1024 };
-    char buf[SIZE];
-    char *dest;
+            start = end + 1;
+
+            // skip blank lines, e.g. the LF of a CRLF-terminated request split across reads
+            const char *p = &buf[linestart];
+            const char *const pend = p + linelen;
+            while (p < pend && isspace((unsigned char) *p))
+                ++p;
+            if (p == pend)
+                continue;
+
+            line->assign(p, pend);
+            line->push_back(0);
+            return true;
+        }
 
-    ClientReadBuf() { reset(); }
-    size_t avail() const { return &buf[SIZE] - dest; }
-    void reset() { dest = &buf[0]; }
+        return false;
+    }
 };
 
 struct ClientData
@@ -348,9 +478,43 @@ struct ClientData
     wxSocketClient *cli;
     int refcnt;
     ClientReadBuf rdbuf;
+    std::vector<char> reqbuf;
+    bool processing;
     wxMutex wrlock;
+    wxLongLong connectTime;
+    unsigned int nrRequests;
+
+    // event subscription, see set_event_filter
+    unsigned int eventMask;
+    unsigned int minIntervalMs[EV_COUNT];
+    wxLongLong lastSent[EV_COUNT];
 
-    ClientData(wxSocketClient *cli_) : cli(cli_), refcnt(1) { }
+    ClientData(wxSocketClient *cli_)
+        : cli(cli_), refcnt(1), processing(false), connectTime(::wxGetUTCTimeMillis()), nrRequests(0)
+    {
+        ResetEventFilter();
+    }
+    void ResetEventFilter()
+    {
+        eventMask = ~0U;
+        for (int i = 0; i < EV_COUNT; i++)
+        {
+            minIntervalMs[i] = 0;
+            lastSent[i] = wxLongLong();
+        }
+    }
+    bool WantsEvent(EventType ev, const wxLongLong& now)
+    {
+        if (!(eventMask & (1U << ev)))
+            return false;
+        if (minIntervalMs[ev] != 0)
+        {
+            if (now - lastSent[ev] < minIntervalMs[ev])
+                return false;
+            lastSent[ev] = now;
+        }
+        return true;
+    }
     void AddRef() { ++refcnt; }
     void RemoveRef()
     {
@@ -370,6 +534,8 @@ struct ClientDataGuard
     ClientData *operator->() const { return cd; }
 };
 
+wxCOMPILE_TIME_ASSERT(EV_COUNT <= 32, TooManyEventTypes);
+
 inline static wxMutex *client_wrlock(wxSocketClient *cli)
 {
     return &((ClientData *) cli->GetClientData())->wrlock;
@@ -392,18 +558,24 @@ static wxString SockErrStr(wxSocketError e)
     }
 }
 
-static void send_buf(wxSocketClient *client, const wxCharBuffer& buf)
+static void send_buf(wxSocketClient *client, const char *buf, size_t len)
 {
     wxMutexLocker lock(*client_wrlock(client));
-    client->Write(buf.data(), buf.length());
-    if (client->LastWriteCount() != buf.length())
+    client->Write(buf, len);
+    if (client->LastWriteCount() != len)
     {
+        Metrics.evsrvShortWrites.Inc();
         Debug.Write(wxString::Format("evsrv: cli %p short write %u/%u %s\n",
-            client, client->LastWriteCount(), (unsigned int) buf.length(),
+            client, client->LastWriteCount(), (unsigned int) len,
             SockErrStr(client->Error() ? client->LastError() : wxSOCKET_NOERROR)));
     }
 }
 
+inline static void send_buf(wxSocketClient *client, const wxCharBuffer& buf)
+{
+    send_buf(client, buf.data(), buf.length());
+}
+
 static void do_notify1(wxSocketClient *client, const JAry& ary)
 {
     send_buf(client, (JAry(ary).str() + "\r\n").ToUTF8());
@@ -414,99 +586,116 @@ static void do_notify1(wxSocketClient *client, const JObj& j)
     send_buf(client, (JObj(j).str() + "\r\n").ToUTF8());
 }
 
-static void do_notify(const EventServer::CliSockSet& cli, const JObj& jj)
+static void do_notify1(wxSocketClient *client, JWriter& ev)
 {
-    wxCharBuffer buf = (JObj(jj).str() + "\r\n").ToUTF8();
-
-    for (EventServer::CliSockSet::const_iterator it = cli.begin();
-        it != cli.end(); ++it)
-    {
-        send_buf(*it, buf);
-    }
+    ev.Finish();
+    send_buf(client, ev.Data(), ev.Size());
 }
 
-inline static void simple_notify(const EventServer::CliSockSet& cli, const wxString& ev)
+typedef std::vector<wxSocketClient *> EvRecipients;
+
+// Select the clients that want an event of the given type right now. Callers
+// check for an empty result before doing any work to build the event.
+static const EvRecipients& recipients(const EventServer::CliSockSet& cli, EventType type)
 {
+    static EvRecipients s_to;
+
+    s_to.clear();
+
     if (!cli.empty())
-        do_notify(cli, Ev(ev));
+    {
+        wxLongLong const now = ::wxGetUTCTimeMillis();
+
+        for (EventServer::CliSockSet::const_iterator it = cli.begin();
+            it != cli.end(); ++it)
+        {
+            ClientData *clidata = (ClientData *) (*it)->GetClientData();
+            if (clidata->WantsEvent(type, now))
+                s_to.push_back(*it);
+        }
+    }
+
+    return s_to;
 }
 
-inline static void simple_notify_ev(const EventServer::CliSockSet& cli, const Ev& ev)
+static void do_notify(const EvRecipients& to, JWriter& ev)
 {
-    if (!cli.empty())
-        do_notify(cli, ev);
-}
+    TRACE_SCOPE("EventServer::Notify", "clients", to.size());
 
-#define SIMPLE_NOTIFY(s) simple_notify(m_eventServerClients, s)
-#define SIMPLE_NOTIFY_EV(ev) simple_notify_ev(m_eventServerClients, ev)
+    ev.Finish();
+
+    for (EvRecipients::const_iterator it = to.begin(); it != to.end(); ++it)
+    {
+        send_buf(*it, ev.Data(), ev.Size());
+    }
+}
 
 static void send_catchup_events(wxSocketClient *cli)
 {
     EXPOSED_STATE st = Guider::GetExposedState();
+    JWriter ev;
 
-    do_notify1(cli, ev_message_version());
+    ev_message_version(ev);
+    do_notify1(cli, ev);
 
     if (pFrame->pGuider)
     {
         if (pFrame->pGuider->LockPosition().IsValid())
-            do_notify1(cli, ev_set_lock_position(pFrame->pGuider->LockPosition()));
+        {
+            ev_set_lock_position(ev, pFrame->pGuider->LockPosition());
+            do_notify1(cli, ev);
+        }
 
         if (pFrame->pGuider->CurrentPosition().IsValid())
-            do_notify1(cli, ev_star_selected(pFrame->pGuider->CurrentPosition()));
+        {
+            ev_star_selected(ev, pFrame->pGuider->CurrentPosition());
+            do_notify1(cli, ev);
+        }
     }
 
     if (pMount && pMount->IsCalibrated())
-        do_notify1(cli, ev_calibration_complete(pMount));
+    {
+        ev_calibration_complete(ev, pMount);
+        do_notify1(cli, ev);
+    }
 
     if (pSecondaryMount && pSecondaryMount->IsCalibrated())
-        do_notify1(cli, ev_calibration_complete(pSecondaryMount));
+    {
+        ev_calibration_complete(ev, pSecondaryMount);
+        do_notify1(cli, ev);
+    }
 
     if (st == EXPOSED_STATE_GUIDING_LOCKED)
     {
-        do_notify1(cli, ev_start_guiding());
+        ev_start_guiding(ev);
+        do_notify1(cli, ev);
     }
     else if (st == EXPOSED_STATE_CALIBRATING)
     {
         Mount *mount = pMount;
         if (pFrame->pGuider->GetState() == STATE_CALIBRATING_SECONDARY)
             mount = pSecondaryMount;
-        do_notify1(cli, ev_start_calibration(mount));
+        ev_start_calibration(ev, mount);
+        do_notify1(cli, ev);
     }
     else if (st == EXPOSED_STATE_PAUSED) {
-        do_notify1(cli, ev_paused());
+        ev_paused(ev);
+        do_notify1(cli, ev);
     }
 
-    do_notify1(cli, ev_app_state());
+    ev_app_state(ev);
+    do_notify1(cli, ev);
 }
 
 static void destroy_client(wxSocketClient *cli)
 {
-    ClientData *buf = (ClientData *) cli->GetClientData();
-    buf->RemoveRef();
-}
+    ClientData *clidata = (ClientData *) cli->GetClientData();
 
-static void drain_input(wxSocketInputStream& sis)
-{
-    while (sis.CanRead())
-    {
-        char buf[1024];
-        if (sis.Read(buf, sizeof(buf)).LastRead() == 0)
-            break;
-    }
-}
+    double const secs = (::wxGetUTCTimeMillis() - clidata->connectTime).ToDouble() / 1000.0;
+    Debug.Write(wxString::Format("evsrv: cli %p handled %u requests in %.1fs (%.1f req/s)\n",
+        cli, clidata->nrRequests, secs, secs > 0. ? clidata->nrRequests / secs : 0.));
 
-static bool find_eol(char *p, size_t len)
-{
-    const char *end = p + len;
-    for (; p < end; p++)
-    {
-        if (*p == '\n')
-        {
-            *p = 0;
-            return true;
-        }
-    }
-    return false;
+    clidata->RemoveRef();
 }
 
 enum {
@@ -1281,6 +1470,59 @@ static void save_image(JObj& response, const json_value *params)
     response << jrpc_result(rslt);
 }
 
+static void export_trace(JObj& response, const json_value *params)
+{
+    // always written to the log folder; clients do not get to choose the path
+    wxString fname = Trace::DefaultFilename();
+
+    if (Trace::Export(fname))
+    {
+        response << jrpc_error(1, "error saving trace");
+        return;
+    }
+
+    JObj rslt;
+    rslt << NV("filename", fname);
+    response << jrpc_result(rslt);
+}
+
+// counters and gauges are plain numbers, histograms are summarized in milliseconds
+static void get_metrics(JObj& response, const json_value *params)
+{
+    JObj rslt;
+    MetricHistogram::Snapshot snap;
+
+    for (unsigned int i = 0; i < MetricsRegistry::Count(); i++)
+    {
+        const MetricInfo& m = MetricsRegistry::Get(i);
+
+        switch (m.type)
+        {
+        case METRIC_COUNTER:
+            rslt << NV(m.name, (double) m.Counter().Value(), 0);
+            break;
+        case METRIC_GAUGE:
+            rslt << NV(m.name, (double) m.Gauge().Value(), 0);
+            break;
+        case METRIC_HISTOGRAM:
+        {
+            m.Histogram().GetSnapshot(&snap);
+            JObj h;
+            h << NV("count", (double) snap.count, 0)
+              << NV("mean_ms", snap.Mean() / 1000.0, 3)
+              << NV("p50_ms", snap.Quantile(0.5) / 1000.0, 3)
+              << NV("p90_ms", snap.Quantile(0.9) / 1000.0, 3)
+              << NV("p99_ms", snap.Quantile(0.99) / 1000.0, 3)
+              << NV("max_ms", (double) snap.max / 1000.0, 3);
+            rslt << NV(m.name, h);
+            break;
+        }
+        }
+    }
+
+    response << jrpc_result(rslt);
+}
+
 static void capture_single_frame(JObj& response, const json_value *params)
 {
     if (pFrame->CaptureActive)
@@ -1336,57 +1578,61 @@ static void get_search_region(JObj& response, const json_value *params)
     response << jrpc_result(pFrame->pGuider->GetSearchRegion());
 }
 
+// Table-driven base64 encoder. The output buffer is retained across calls
+// so that repeated encodes of similar-sized data do not allocate.
 struct B64Encode
 {
-    static const char *const E;
-    std::ostringstream os;
-    unsigned int t;
-    size_t nread;
+    static const char E[];
+    std::vector<char> buf;
 
-    B64Encode()
-        : t(0), nread(0)
-    {
-    }
-    void append1(unsigned char ch)
+    void encode(const void *src_, size_t len)
     {
-        t <<= 8;
-        t |= ch;
-        if (++nread % 3 == 0)
+        buf.resize((len + 2) / 3 * 4);
+
+        const unsigned char *src = (const unsigned char *) src_;
+        const unsigned char *const end3 = src + len / 3 * 3;
+        char *dst = buf.data();
+
+        for (; src < end3; src += 3, dst += 4)
         {
-            os << E[t >> 18]
-               << E[(t >> 12) & 0x3F]
-               << E[(t >> 6) & 0x3F]
-               << E[t & 0x3F];
-            t = 0;
+            unsigned int t = (src[0] << 16) | (src[1] << 8) | src[2];
+            dst[0] = E[t >> 18];
+            dst[1] = E[(t >> 12) & 0x3F];
+            dst[2] = E[(t >> 6) & 0x3F];
+            dst[3] = E[t & 0x3F];
         }
-    }
-    void append(const void *src_, size_t len)
-    {
-        const unsigned char *src = (const unsigned char *) src_;
-        const unsigned char *const end = src + len;
-        while (src < end)
-            append1(*src++);
-    }
-    std::string finish()
-    {
-        switch (nread % 3) {
-        case 1:
-            os << E[t >> 2]
-               << E[(t & 0x3) << 4]
-               << "==";
+
+        switch (len % 3) {
+        case 1: {
+            unsigned int t = src[0];
+            dst[0] = E[t >> 2];
+            dst[1] = E[(t & 0x3) << 4];
+            dst[2] = '=';
+            dst[3] = '=';
             break;
-        case 2:
-            os << E[t >> 10]
-                << E[(t >> 4) & 0x3F]
-                << E[(t & 0xf) << 2]
-                << '=';
+        }
+        case 2: {
+            unsigned int t = (src[0] << 8) | src[1];
+            dst[0] = E[t >> 10];
+            dst[1] = E[(t >> 4) & 0x3F];
+            dst[2] = E[(t & 0xf) << 2];
+            dst[3] = '=';
             break;
         }
-        os << std::ends;
-        return os.str();
+        }
     }
 };
-const char *const B64Encode::E = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char B64Encode::E[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// base64 output never needs escaping
+NV::NV(const wxString& n_, const B64Encode& enc)
+    : n(n_)
+{
+    v.reserve(enc.buf.size() + 2);
+    v << '"';
+    v.append(wxString::FromAscii(enc.buf.data(), enc.buf.size()));
+    v << '"';
+}
 
 static void get_star_image(JObj& response, const json_value *params)
 {
@@ -1426,12 +1672,18 @@ static void get_star_image(JObj& response, const json_value *params)
 
     int width = rect.GetWidth();
 
-    B64Encode enc;
-    for (int y = rect.GetTop(); y <= rect.GetBottom(); y++)
+    // gather the star crop into a contiguous buffer and encode it in one pass
+    static std::vector<unsigned short> s_pixels;
+    static B64Encode s_enc;
+
+    s_pixels.resize(width * rect.GetHeight());
+    unsigned short *dst = s_pixels.data();
+    for (int y = rect.GetTop(); y <= rect.GetBottom(); y++, dst += width)
     {
         const unsigned short *p = img->ImageData + y * img->Size.GetWidth() + rect.GetLeft();
-        enc.append(p, rect.GetWidth() * sizeof(unsigned short));
+        memcpy(dst, p, width * sizeof(unsigned short));
     }
+    s_enc.encode(s_pixels.data(), s_pixels.size() * sizeof(unsigned short));
 
     PHD_Point pos(star);
     pos.X -= rect.GetLeft();
@@ -1442,7 +1694,7 @@ static void get_star_image(JObj& response, const json_value *params)
         << NV("width", rect.GetWidth())
         << NV("height", rect.GetHeight())
         << NV("star_pos", pos)
-        << NV("pixels", enc.finish());
+        << NV("pixels", s_enc);
 
     response << jrpc_result(rslt);
 }
@@ -1450,6 +1702,7 @@ static void get_star_image(JObj& response, const json_value *params)
 static bool parse_settle(SettleParams *settle, const json_value *j, wxString *error)
 {
     bool found_pixels = false, found_time = false, found_timeout = false;
+    settle->registration = false;
 
     json_for_each (t, j)
     {
@@ -1471,6 +1724,8 @@ static bool parse_settle(SettleParams *settle, const json_value *j, wxString *er
             found_timeout = true;
             continue;
         }
+        if (strcmp(t->name, "registration") == 0 && bool_param(t, &settle->registration))
+            continue;
     }
 
     settle->frames = 99999;
@@ -1555,6 +1810,7 @@ static void dither(JObj& response, const json_value *params)
     //     frames [integer]
     //     time [integer]
     //     timeout [integer]
+    //     registration [bool] - optional, measure the settle distance by registering the whole frame
     //
     // {"method": "dither", "params": [10, false, {"pixels": 1.5, "time": 8, "timeout": 30}], "id": 42}
     //    or
@@ -2018,6 +2274,77 @@ static void get_sensor_temperature(JObj& response, const json_value *params)
     response << jrpc_result(rslt);
 }
 
+static void set_event_filter(JObj& response, const json_value *params, wxSocketClient *cli)
+{
+    // params:
+    //   events [array of event names] - the events to receive, or null for all events
+    //   rate_limit [object] - minimum interval in milliseconds between successive
+    //     events of a periodic type (GuideStep, LoopingExposures, Settling, StarLost)
+    //
+    // {"method": "set_event_filter", "params": {"events": ["AppState", "SettleDone", "GuideStep"], "rate_limit": {"GuideStep": 5000}}, "id": 42}
+    //
+    // with no params, the client's filter is cleared and it receives all events again
+
+    Params p("events", "rate_limit", params);
+
+    unsigned int mask = ~0U;
+    unsigned int minInterval[EV_COUNT] = { 0 };
+
+    const json_value *events = p.param("events");
+    if (events && events->type != JSON_NULL)
+    {
+        if (events->type != JSON_ARRAY)
+        {
+            response << jrpc_error(JSONRPC_INVALID_PARAMS, "expected events array param");
+            return;
+        }
+        mask = 0;
+        json_for_each (e, events)
+        {
+            EventType type;
+            if (e->type != JSON_STRING || !event_type(e->string_value, &type))
+            {
+                response << jrpc_error(JSONRPC_INVALID_PARAMS, "invalid event name");
+                return;
+            }
+            mask |= 1U << type;
+        }
+    }
+
+    const json_value *rate = p.param("rate_limit");
+    if (rate && rate->type != JSON_NULL)
+    {
+        if (rate->type != JSON_OBJECT)
+        {
+            response << jrpc_error(JSONRPC_INVALID_PARAMS, "expected rate_limit object param");
+            return;
+        }
+        json_for_each (r, rate)
+        {
+            EventType type;
+            if (!event_type(r->name, &type) || !is_periodic_event(type))
+            {
+                response << jrpc_error(JSONRPC_INVALID_PARAMS, "rate_limit only applies to GuideStep, LoopingExposures, Settling and StarLost");
+                return;
+            }
+            if (r->type != JSON_INT || r->int_value < 0)
+            {
+                response << jrpc_error(JSONRPC_INVALID_PARAMS, "expected rate_limit interval in milliseconds");
+                return;
+            }
+            minInterval[type] = r->int_value;
+        }
+    }
+
+    ClientData *clidata = (ClientData *) cli->GetClientData();
+    clidata->ResetEventFilter();
+    clidata->eventMask = mask;
+    for (int i = 0; i < EV_COUNT; i++)
+        clidata->minIntervalMs[i] = minInterval[i];
+
+    response << jrpc_result(0);
+}
+
 struct JRpcCall
 {
     wxSocketClient *cli;
@@ -2051,6 +2378,78 @@ static void dump_response(const JRpcCall& call)
     Debug.Write(wxString::Format("evsrv: cli %p response: %s\n", call.cli, s));
 }
 
+struct JRpcMethod
+{
+    // most methods only need their params, a few act on the calling client
+    void (*fn)(JObj& response, const json_value *params);
+    void (*clifn)(JObj& response, const json_value *params, wxSocketClient *cli);
+
+    JRpcMethod(void (*fn_)(JObj&, const json_value *)) : fn(fn_), clifn(nullptr) { }
+    JRpcMethod(void (*fn_)(JObj&, const json_value *, wxSocketClient *)) : fn(nullptr), clifn(fn_) { }
+
+    void operator()(JObj& response, const json_value *params, wxSocketClient *cli) const
+    {
+        if (clifn)
+            (*clifn)(response, params, cli);
+        else
+            (*fn)(response, params);
+    }
+};
+typedef std::unordered_map<std::string, JRpcMethod> JRpcMethodMap;
+
+static const JRpcMethodMap s_methods = {
+    { "clear_calibration", &clear_calibration },
+    { "deselect_star", &deselect_star },
+    { "get_exposure", &get_exposure },
+    { "set_exposure", &set_exposure },
+    { "get_exposure_durations", &get_exposure_durations },
+    { "get_profiles", &get_profiles },
+    { "get_profile", &get_profile },
+    { "set_profile", &set_profile },
+    { "get_connected", &get_connected },
+    { "set_connected", &set_connected },
+    { "get_calibrated", &get_calibrated },
+    { "get_paused", &get_paused },
+    { "set_paused", &set_paused },
+    { "get_lock_position", &get_lock_position },
+    { "set_lock_position", &set_lock_position },
+    { "loop", &loop },
+    { "stop_capture", &stop_capture },
+    { "guide", &guide },
+    { "dither", &dither },
+    { "find_star", &find_star },
+    { "get_pixel_scale", &get_pixel_scale },
+    { "get_app_state", &get_app_state },
+    { "flip_calibration", &flip_calibration },
+    { "get_lock_shift_enabled", &get_lock_shift_enabled },
+    { "set_lock_shift_enabled", &set_lock_shift_enabled },
+    { "get_lock_shift_params", &get_lock_shift_params },
+    { "set_lock_shift_params", &set_lock_shift_params },
+    { "save_image", &save_image },
+    { "export_trace", &export_trace },
+    { "get_metrics", &get_metrics },
+    { "get_star_image", &get_star_image },
+    { "get_use_subframes", &get_use_subframes },
+    { "get_search_region", &get_search_region },
+    { "shutdown", &shutdown },
+    { "get_camera_binning", &get_camera_binning },
+    { "get_current_equipment", &get_current_equipment },
+    { "get_guide_output_enabled", &get_guide_output_enabled },
+    { "set_guide_output_enabled", &set_guide_output_enabled },
+    { "get_algo_param_names", &get_algo_param_names },
+    { "get_algo_param", &get_algo_param },
+    { "set_algo_param", &set_algo_param },
+    { "get_dec_guide_mode", &get_dec_guide_mode },
+    { "set_dec_guide_mode", &set_dec_guide_mode },
+    { "get_settling", &get_settling },
+    { "guide_pulse", &guide_pulse },
+    { "get_calibration_data", &get_calibration_data },
+    { "capture_single_frame", &capture_single_frame },
+    { "get_cooler_status", &get_cooler_status },
+    { "get_ccd_temperature", &get_sensor_temperature },
+    { "set_event_filter", &set_event_filter },
+};
+
 static bool handle_request(JRpcCall& call)
 {
     const json_value *params;
@@ -2073,73 +2472,19 @@ static bool handle_request(JRpcCall& call)
         return true;
     }
 
-    static struct {
-        const char *name;
-        void (*fn)(JObj& response, const json_value *params);
-    } methods[] = {
-        { "clear_calibration", &clear_calibration, },
-        { "deselect_star", &deselect_star, },
-        { "get_exposure", &get_exposure, },
-        { "set_exposure", &set_exposure, },
-        { "get_exposure_durations", &get_exposure_durations, },
-        { "get_profiles", &get_profiles, },
-        { "get_profile", &get_profile, },
-        { "set_profile", &set_profile, },
-        { "get_connected", &get_connected, },
-        { "set_connected", &set_connected, },
-        { "get_calibrated", &get_calibrated, },
-        { "get_paused", &get_paused, },
-        { "set_paused", &set_paused, },
-        { "get_lock_position", &get_lock_position, },
-        { "set_lock_position", &set_lock_position, },
-        { "loop", &loop, },
-        { "stop_capture", &stop_capture, },
-        { "guide", &guide, },
-        { "dither", &dither, },
-        { "find_star", &find_star, },
-        { "get_pixel_scale", &get_pixel_scale, },
-        { "get_app_state", &get_app_state, },
-        { "flip_calibration", &flip_calibration, },
-        { "get_lock_shift_enabled", &get_lock_shift_enabled, },
-        { "set_lock_shift_enabled", &set_lock_shift_enabled, },
-        { "get_lock_shift_params", &get_lock_shift_params, },
-        { "set_lock_shift_params", &set_lock_shift_params, },
-        { "save_image", &save_image, },
-        { "get_star_image", &get_star_image, },
-        { "get_use_subframes", &get_use_subframes, },
-        { "get_search_region", &get_search_region, },
-        { "shutdown", &shutdown, },
-        { "get_camera_binning", &get_camera_binning, },
-        { "get_current_equipment", &get_current_equipment, },
-        { "get_guide_output_enabled", &get_guide_output_enabled, },
-        { "set_guide_output_enabled", &set_guide_output_enabled, },
-        { "get_algo_param_names", &get_algo_param_names, },
-        { "get_algo_param", &get_algo_param, },
-        { "set_algo_param", &set_algo_param, },
-        { "get_dec_guide_mode", &get_dec_guide_mode, },
-        { "set_dec_guide_mode", &set_dec_guide_mode, },
-        { "get_settling", &get_settling, },
-        { "guide_pulse", &guide_pulse, },
-        { "get_calibration_data", &get_calibration_data, },
-        { "capture_single_frame", &capture_single_frame, },
-        { "get_cooler_status", &get_cooler_status, },
-        { "get_ccd_temperature", &get_sensor_temperature, },
-    };
+    auto it = s_methods.find(call.method->string_value);
 
-    for (unsigned int i = 0; i < WXSIZEOF(methods); i++)
+    if (it != s_methods.end())
     {
-        if (strcmp(call.method->string_value, methods[i].name) == 0)
+        it->second(call.response, params, call.cli);
+        if (id)
         {
-            (*methods[i].fn)(call.response, params);
-            if (id)
-            {
-                call.response << jrpc_id(id);
-                return true;
-            }
-            else
-            {
-                return false;
-            }
+            call.response << jrpc_id(id);
+            return true;
+        }
+        else
+        {
+            return false;
         }
     }
 
@@ -2202,60 +2547,509 @@ static void handle_cli_input_complete(wxSocketClient *cli, char *input, JsonPars
     }
 }
 
-static void handle_cli_input(wxSocketClient *cli, JsonParser& parser)
+static void too_big(wxSocketClient *cli)
 {
-    // Bump refcnt to protect against reentrancy.
-    //
-    // Some functions like set_connected can cause the event loop to run reentrantly. If the
-    // client disconnects before the response is sent and a socket disconnect event is
-    // dispatched the client data could be destroyed before we respond.
-
-    ClientDataGuard clidata(cli);
-
-    ClientReadBuf *rdbuf = &clidata->rdbuf;
+    JRpcResponse response;
+    response << jrpc_error(JSONRPC_INTERNAL_ERROR, "too big") << jrpc_id(0);
+    do_notify1(cli, response);
+}
 
+// returns true when the client sent a request exceeding MAX_REQUEST_SIZE
+static bool read_cli_input(wxSocketClient *cli, ClientReadBuf *rdbuf)
+{
     wxSocketInputStream sis(*cli);
-    size_t avail = rdbuf->avail();
 
     while (sis.CanRead())
     {
-        if (avail == 0)
-        {
-            drain_input(sis);
+        if (rdbuf->avail() == 0)
+            rdbuf->grow();
 
-            JRpcResponse response;
-            response << jrpc_error(JSONRPC_INTERNAL_ERROR, "too big") << jrpc_id(0);
-            do_notify1(cli, response);
-
-            rdbuf->reset();
-            break;
-        }
-        size_t n = sis.Read(rdbuf->dest, avail).LastRead();
+        size_t n = sis.Read(rdbuf->dest(), rdbuf->avail()).LastRead();
         if (n == 0)
             break;
 
-        if (find_eol(rdbuf->dest, n))
-        {
-            drain_input(sis);
-            handle_cli_input_complete(cli, &rdbuf->buf[0], parser);
-            rdbuf->reset();
-            break;
-        }
-
-        rdbuf->dest += n;
-        avail -= n;
+        if (rdbuf->Append(n))
+            return true;
     }
-}
 
-EventServer::EventServer()
-{
+    return false;
 }
 
-EventServer::~EventServer()
+// Process each complete line in the read buffer in order
+static void process_cli_input(ClientData *clidata, JsonParser& parser)
 {
+    ClientReadBuf *rdbuf = &clidata->rdbuf;
+
+    // stop if the client went away while we were handling a request
+    while (clidata->cli->IsConnected() && rdbuf->NextLine(&clidata->reqbuf))
+    {
+        ++clidata->nrRequests;
+
+        handle_cli_input_complete(clidata->cli, &clidata->reqbuf[0], parser);
+    }
+
+    rdbuf->compact();
+    rdbuf->shrink();
 }
 
-bool EventServer::EventServerStart(unsigned int instanceId)
+// returns true when the client must be dropped
+static bool handle_cli_input(wxSocketClient *cli, JsonParser& parser)
+{
+    // Bump refcnt to protect against reentrancy.
+    //
+    // Some functions like set_connected can cause the event loop to run reentrantly. If the
+    // client disconnects before the response is sent and a socket disconnect event is
+    // dispatched the client data could be destroyed before we respond.
+
+    ClientDataGuard clidata(cli);
+
+    if (read_cli_input(cli, &clidata->rdbuf))
+    {
+        // closing the socket also stops an outer invocation from handling
+        // any more of this client's requests
+        too_big(cli);
+        cli->Close();
+        return true;
+    }
+
+    // If we are re-entered while handling an earlier request from this
+    // client, leave the newly read requests for the outer invocation so
+    // that the client's requests are always handled in the order received.
+    if (clidata->processing)
+        return false;
+
+    clidata->processing = true;
+    process_cli_input(clidata.cd, parser);
+    clidata->processing = false;
+
+    return false;
+}
+
+// Binary frame stream
+//
+// Clients connect to port 4500 + instance - 1 (instances 1 to 100 only, so
+// the port cannot collide with another server's) and receive guide frames as a
+// fixed-size little-endian header followed by the raw 16-bit pixels, one
+// frame after another. At any time a client can change its subscription by
+// sending a JSON line:
+//
+//   {"every": N, "roi": [x, y, width, height], "scale": S}
+//
+//   every - send every Nth frame (default 1)
+//   roi   - region of interest in full-frame coordinates, or null for the
+//           full frame (default null)
+//   scale - downscale factor 1-8, each output pixel is the mean of an SxS
+//           block (default 1)
+//
+// Frames are written straight from the frame buffer whenever the requested
+// region is contiguous in memory. If the socket cannot take a whole frame
+// the remainder is queued and subsequent frames are dropped for that client
+// until the queue drains, so a slow client never stalls the guide loop.
+
+enum
+{
+    FRAME_STREAM_MAGIC = 0x32444850, // "PHD2"
+    FRAME_STREAM_VERSION = 1,
+    FRAME_STREAM_HDR_SIZE = 40,
+    FRAME_STREAM_MAX_SCALE = 8,
+};
+
+struct FrameStreamClient
+{
+    wxSocketClient *cli;
+    ClientReadBuf rdbuf;
+    std::vector<char> line;
+    unsigned int every;
+    unsigned int scale;
+    wxRect roi;
+    unsigned int frameCount;
+    std::vector<char> pending;
+    size_t pendingPos;
+    std::vector<unsigned short> scratch;
+    unsigned int nrSent;
+    unsigned int nrDropped;
+
+    FrameStreamClient(wxSocketClient *cli_)
+        : cli(cli_), every(1), scale(1), frameCount(0), pendingPos(0), nrSent(0), nrDropped(0)
+    {
+    }
+};
+
+inline static FrameStreamClient *frame_client(wxSocketClient *cli)
+{
+    return (FrameStreamClient *) cli->GetClientData();
+}
+
+inline static unsigned char *put16(unsigned char *p, unsigned int v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    return p + 2;
+}
+
+inline static unsigned char *put32(unsigned char *p, unsigned int v)
+{
+    p = put16(p, v & 0xffff);
+    return put16(p, v >> 16);
+}
+
+inline static unsigned char *put64(unsigned char *p, wxUint64 v)
+{
+    p = put32(p, (wxUint32)(v & 0xffffffff));
+    return put32(p, (wxUint32)(v >> 32));
+}
+
+static void frame_flush(FrameStreamClient *fc)
+{
+    while (fc->pendingPos < fc->pending.size())
+    {
+        fc->cli->Write(&fc->pending[fc->pendingPos], fc->pending.size() - fc->pendingPos);
+        size_t n = fc->cli->LastWriteCount();
+        if (n == 0)
+            return;
+        fc->pendingPos += n;
+        Metrics.evsrvFrameQueueBytes.Add(-(long long) n);
+    }
+
+    fc->pending.clear();
+    fc->pendingPos = 0;
+}
+
+static void frame_write(FrameStreamClient *fc, const void *p, size_t len)
+{
+    if (fc->pending.empty())
+    {
+        fc->cli->Write(p, len);
+        size_t n = fc->cli->LastWriteCount();
+        if (n == len)
+            return;
+        p = static_cast<const char *>(p) + n;
+        len -= n;
+    }
+
+    // the socket is backed up, queue the rest until we get wxSOCKET_OUTPUT
+    const char *src = static_cast<const char *>(p);
+    fc->pending.insert(fc->pending.end(), src, src + len);
+    Metrics.evsrvFrameQueueBytes.Add(len);
+}
+
+static void send_frame(FrameStreamClient *fc, const usImage *img)
+{
+    if (fc->frameCount++ % fc->every != 0)
+        return;
+
+    if (!fc->pending.empty())
+    {
+        ++fc->nrDropped;
+        Metrics.evsrvFramesDropped.Inc();
+        return;
+    }
+
+    wxRect rect = img->Subframe.IsEmpty() ? wxRect(img->Size) : img->Subframe;
+    if (!fc->roi.IsEmpty())
+        rect.Intersect(fc->roi);
+
+    unsigned int const scale = fc->scale;
+    int const outw = rect.width / scale;
+    int const outh = rect.height / scale;
+    if (outw <= 0 || outh <= 0)
+    {
+        ++fc->nrDropped;
+        return;
+    }
+
+    int const stride = img->Size.GetWidth();
+    const unsigned short *payload;
+
+    if (scale == 1 && rect.width == stride)
+    {
+        // whole rows, contiguous in the frame buffer
+        payload = img->ImageData + rect.y * stride;
+    }
+    else if (scale == 1)
+    {
+        fc->scratch.resize(outw * outh);
+        unsigned short *dst = fc->scratch.data();
+        for (int y = rect.GetTop(); y <= rect.GetBottom(); y++, dst += outw)
+            memcpy(dst, img->ImageData + y * stride + rect.x, outw * sizeof(unsigned short));
+        payload = fc->scratch.data();
+    }
+    else
+    {
+        fc->scratch.resize(outw * outh);
+        unsigned short *dst = fc->scratch.data();
+        unsigned int const n = scale * scale;
+        for (int oy = 0; oy < outh; oy++)
+        {
+            const unsigned short *row = img->ImageData + (rect.y + oy * scale) * stride + rect.x;
+            for (int ox = 0; ox < outw; ox++)
+            {
+                const unsigned short *p = row + ox * scale;
+                unsigned int sum = 0;
+                for (unsigned int dy = 0; dy < scale; dy++, p += stride)
+                    for (unsigned int dx = 0; dx < scale; dx++)
+                        sum += p[dx];
+                *dst++ = (unsigned short)(sum / n);
+            }
+        }
+        payload = fc->scratch.data();
+    }
+
+    size_t const payloadSize = outw * outh * sizeof(unsigned short);
+
+    unsigned char hdr[FRAME_STREAM_HDR_SIZE];
+    unsigned char *p = hdr;
+    p = put32(p, FRAME_STREAM_MAGIC);
+    p = put16(p, FRAME_STREAM_VERSION);
+    p = put16(p, FRAME_STREAM_HDR_SIZE);
+    p = put32(p, img->FrameNum);
+    p = put32(p, payloadSize);
+    p = put64(p, img->ImgStartTime.IsValid() ? (wxUint64) img->ImgStartTime.GetValue().GetValue() : 0);
+    p = put16(p, img->Size.GetWidth());
+    p = put16(p, img->Size.GetHeight());
+    p = put16(p, rect.x);
+    p = put16(p, rect.y);
+    p = put16(p, outw);
+    p = put16(p, outh);
+    p = put16(p, scale);
+    p = put16(p, img->BitsPerPixel);
+    assert(p == hdr + FRAME_STREAM_HDR_SIZE);
+
+    frame_write(fc, hdr, sizeof(hdr));
+    frame_write(fc, payload, payloadSize);
+
+    ++fc->nrSent;
+}
+
+static bool parse_frame_subscription(FrameStreamClient *fc, const json_value *j, wxString *error)
+{
+    if (j->type != JSON_OBJECT)
+    {
+        *error = "expected subscription object";
+        return false;
+    }
+
+    unsigned int every = 1;
+    unsigned int scale = 1;
+    wxRect roi;
+
+    json_for_each (t, j)
+    {
+        if (strcmp(t->name, "every") == 0)
+        {
+            if (t->type != JSON_INT || t->int_value < 1)
+            {
+                *error = "invalid every param";
+                return false;
+            }
+            every = t->int_value;
+        }
+        else if (strcmp(t->name, "scale") == 0)
+        {
+            if (t->type != JSON_INT || t->int_value < 1 || t->int_value > FRAME_STREAM_MAX_SCALE)
+            {
+                *error = "invalid scale param";
+                return false;
+            }
+            scale = t->int_value;
+        }
+        else if (strcmp(t->name, "roi") == 0)
+        {
+            if (t->type != JSON_NULL && (!parse_rect(&roi, t) || roi.width <= 0 || roi.height <= 0))
+            {
+                *error = "invalid roi param";
+                return false;
+            }
+        }
+    }
+
+    fc->every = every;
+    fc->scale = scale;
+    fc->roi = roi;
+    fc->frameCount = 0;
+
+    return true;
+}
+
+// returns true when the client sent a request exceeding MAX_REQUEST_SIZE
+static bool handle_frame_client_input(wxSocketClient *cli, JsonParser& parser)
+{
+    FrameStreamClient *fc = frame_client(cli);
+
+    if (read_cli_input(cli, &fc->rdbuf))
+        return true;
+
+    while (fc->rdbuf.NextLine(&fc->line))
+    {
+        wxString err;
+        if (!parser.Parse(&fc->line[0]))
+            err = parser_error(parser);
+        else
+            parse_frame_subscription(fc, parser.Root(), &err);
+
+        if (err.IsEmpty())
+            Debug.Write(wxString::Format("frmsrv: cli %p subscribe every %u scale %u roi %d,%d,%dx%d\n",
+                cli, fc->every, fc->scale, fc->roi.x, fc->roi.y, fc->roi.width, fc->roi.height));
+        else
+            Debug.Write(wxString::Format("frmsrv: cli %p ignoring subscription: %s\n", cli, err));
+    }
+
+    fc->rdbuf.compact();
+    fc->rdbuf.shrink();
+
+    return false;
+}
+
+static void destroy_frame_client(wxSocketClient *cli)
+{
+    FrameStreamClient *fc = frame_client(cli);
+
+    Debug.Write(wxString::Format("frmsrv: cli %p sent %u frames, dropped %u\n", cli, fc->nrSent, fc->nrDropped));
+
+    Metrics.evsrvFrameQueueBytes.Add(-(long long)(fc->pending.size() - fc->pendingPos));
+
+    delete fc;
+    cli->Destroy();
+}
+
+// Metrics endpoint
+//
+// A minimal HTTP/1.0 responder on port 4600 + instance - 1, bound to the
+// loopback interface, serving the metrics registry in Prometheus text format
+// at /metrics. Each connection serves a single request and is then closed.
+
+enum
+{
+    METRICS_MAX_REQUEST_SIZE = 8 * 1024,
+};
+
+struct MetricsHttpClient
+{
+    std::string req;
+    std::string resp;
+    size_t respPos;
+    bool responding;
+
+    MetricsHttpClient() : respPos(0), responding(false) { }
+};
+
+inline static MetricsHttpClient *metrics_client(wxSocketClient *cli)
+{
+    return (MetricsHttpClient *) cli->GetClientData();
+}
+
+static void metrics_response(MetricsHttpClient *mc, int status, const char *reason, const std::string& body)
+{
+    char hdr[256];
+    snprintf(hdr, sizeof(hdr),
+        "HTTP/1.0 %d %s\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: %u\r\n"
+        "Connection: close\r\n"
+        "\r\n", status, reason, (unsigned int) body.size());
+
+    mc->resp = hdr;
+    mc->resp += body;
+    mc->respPos = 0;
+    mc->responding = true;
+}
+
+static void metrics_handle_request(MetricsHttpClient *mc)
+{
+    // request line: METHOD SP PATH SP VERSION
+    size_t const eol = mc->req.find_first_of("\r\n");
+    std::string line(mc->req, 0, eol);
+
+    size_t const sp1 = line.find(' ');
+    size_t const sp2 = sp1 == std::string::npos ? std::string::npos : line.find(' ', sp1 + 1);
+    std::string method(line, 0, sp1);
+    std::string path = sp1 == std::string::npos ? std::string() : line.substr(sp1 + 1, sp2 == std::string::npos ? std::string::npos : sp2 - sp1 - 1);
+    size_t const q = path.find('?');
+    if (q != std::string::npos)
+        path.erase(q);
+
+    if (method != "GET")
+        metrics_response(mc, 405, "Method Not Allowed", "method not allowed\n");
+    else if (path == "/metrics" || path == "/")
+        metrics_response(mc, 200, "OK", MetricsRegistry::PrometheusText());
+    else
+        metrics_response(mc, 404, "Not Found", "not found\n");
+}
+
+// returns true when the response has been completely sent
+static bool metrics_flush(wxSocketClient *cli, MetricsHttpClient *mc)
+{
+    while (mc->respPos < mc->resp.size())
+    {
+        cli->Write(&mc->resp[mc->respPos], mc->resp.size() - mc->respPos);
+        size_t n = cli->LastWriteCount();
+        if (n == 0)
+            return false;
+        mc->respPos += n;
+    }
+    return true;
+}
+
+// returns true when the connection is done with and should be closed
+static bool handle_metrics_client_input(wxSocketClient *cli)
+{
+    MetricsHttpClient *mc = metrics_client(cli);
+
+    char buf[1024];
+    for (;;)
+    {
+        cli->Read(buf, sizeof(buf));
+        size_t n = cli->LastReadCount();
+        if (n == 0)
+            break;
+        if (mc->responding)
+            continue;
+        mc->req.append(buf, n);
+        if (mc->req.size() > METRICS_MAX_REQUEST_SIZE)
+            return true;
+    }
+
+    if (mc->responding)
+        return false;
+
+    // wait for the end of the request headers so the client is not reset
+    // while still sending them
+    if (mc->req.find("\r\n\r\n") == std::string::npos && mc->req.find("\n\n") == std::string::npos)
+        return false;
+
+    metrics_handle_request(mc);
+
+    return metrics_flush(cli, mc);
+}
+
+static void destroy_metrics_client(wxSocketClient *cli)
+{
+    delete metrics_client(cli);
+    cli->Destroy();
+}
+
+EventServer::EventServer()
+{
+}
+
+EventServer::~EventServer()
+{
+}
+
+// Like the socket server (4300) and the event server (4400), the frame
+// stream and metrics servers each listen on their own block of 100 ports, at
+// the base port plus the instance number - 1. Above instance 100 the port
+// would fall in the next block, so those servers are not started for such
+// instances.
+enum
+{
+    EVENT_SERVER_PORT_BASE = 4400,
+    FRAME_SERVER_PORT_BASE = 4500,
+    METRICS_SERVER_PORT_BASE = 4600,
+    MAX_SERVER_INSTANCES = FRAME_SERVER_PORT_BASE - EVENT_SERVER_PORT_BASE,
+};
+
+bool EventServer::EventServerStart(unsigned int instanceId)
 {
     if (m_serverSocket)
     {
@@ -2263,7 +3057,7 @@ bool EventServer::EventServerStart(unsigned int instanceId)
         return false;
     }
 
-    unsigned int port = 4400 + instanceId - 1;
+    unsigned int port = EVENT_SERVER_PORT_BASE + instanceId - 1;
     wxIPV4address eventServerAddr;
     eventServerAddr.Service(port);
     m_serverSocket = new wxSocketServer(eventServerAddr, wxSOCKET_REUSEADDR);
@@ -2282,6 +3076,67 @@ bool EventServer::EventServerStart(unsigned int instanceId)
 
     Debug.Write(wxString::Format("event server started, listening on port %u\n", port));
 
+    // the frame stream is optional, failing to start it does not fail the event server
+    unsigned int framePort = FRAME_SERVER_PORT_BASE + instanceId - 1;
+
+    if (instanceId > MAX_SERVER_INSTANCES)
+    {
+        Debug.Write(wxString::Format("Frame stream server not started - instance %u is above %u\n",
+            instanceId, MAX_SERVER_INSTANCES));
+    }
+    else
+    {
+        wxIPV4address frameServerAddr;
+        frameServerAddr.Service(framePort);
+        m_frameServerSocket = new wxSocketServer(frameServerAddr, wxSOCKET_REUSEADDR);
+
+        if (m_frameServerSocket->Ok())
+        {
+            m_frameServerSocket->SetEventHandler(*this, FRAME_SERVER_ID);
+            m_frameServerSocket->SetNotify(wxSOCKET_CONNECTION_FLAG);
+            m_frameServerSocket->Notify(true);
+
+            Debug.Write(wxString::Format("frame stream server started, listening on port %u\n", framePort));
+        }
+        else
+        {
+            Debug.Write(wxString::Format("Frame stream server failed to start - Could not listen at port %u\n", framePort));
+            delete m_frameServerSocket;
+            m_frameServerSocket = NULL;
+        }
+    }
+
+    // the metrics endpoint is optional too, and only reachable from the local machine
+    unsigned int metricsPort = METRICS_SERVER_PORT_BASE + instanceId - 1;
+
+    if (instanceId > MAX_SERVER_INSTANCES)
+    {
+        Debug.Write(wxString::Format("Metrics server not started - instance %u is above %u\n",
+            instanceId, MAX_SERVER_INSTANCES));
+    }
+    else
+    {
+        wxIPV4address metricsServerAddr;
+        metricsServerAddr.LocalHost();
+        metricsServerAddr.Service(metricsPort);
+        m_metricsServerSocket = new wxSocketServer(metricsServerAddr, wxSOCKET_REUSEADDR);
+
+        if (m_metricsServerSocket->Ok())
+        {
+            m_metricsServerSocket->SetEventHandler(*this, METRICS_SERVER_ID);
+            m_metricsServerSocket->SetNotify(wxSOCKET_CONNECTION_FLAG);
+            m_metricsServerSocket->Notify(true);
+
+            Debug.Write(wxString::Format("metrics server started, listening on port %u\n", metricsPort));
+        }
+        else
+        {
+            Debug.Write(wxString::Format("Metrics server failed to start - Could not listen at port %u\n", metricsPort));
+            delete m_metricsServerSocket;
+            m_metricsServerSocket = NULL;
+        }
+    }
+
     return false;
 }
 
@@ -2296,10 +3151,32 @@ void EventServer::EventServerStop()
         destroy_client(*it);
     }
     m_eventServerClients.clear();
+    Metrics.evsrvClients.Set(0);
 
     delete m_serverSocket;
     m_serverSocket = NULL;
 
+    for (CliSockSet::const_iterator it = m_frameClients.begin();
+         it != m_frameClients.end(); ++it)
+    {
+        destroy_frame_client(*it);
+    }
+    m_frameClients.clear();
+    Metrics.evsrvFrameClients.Set(0);
+
+    delete m_frameServerSocket;
+    m_frameServerSocket = NULL;
+
+    for (CliSockSet::const_iterator it = m_metricsClients.begin();
+         it != m_metricsClients.end(); ++it)
+    {
+        destroy_metrics_client(*it);
+    }
+    m_metricsClients.clear();
+
+    delete m_metricsServerSocket;
+    m_metricsServerSocket = NULL;
+
     Debug.AddLine("event server stopped");
 }
 
@@ -2326,6 +3203,7 @@ void EventServer::OnEventServerEvent(wxSocketEvent& event)
     send_catchup_events(client);
 
     m_eventServerClients.insert(client);
+    Metrics.evsrvClients.Set(m_eventServerClients.size());
 }
 
 void EventServer::OnEventServerClientEvent(wxSocketEvent& event)
@@ -2339,12 +3217,21 @@ void EventServer::OnEventServerClientEvent(wxSocketEvent& event)
         unsigned int const n = m_eventServerClients.erase(cli);
         if (n != 1)
             Debug.AddLine("client disconnected but not present in client set!");
+        Metrics.evsrvClients.Set(m_eventServerClients.size());
 
         destroy_client(cli);
     }
     else if (event.GetSocketEvent() == wxSOCKET_INPUT)
     {
-        handle_cli_input(cli, m_parser);
+        if (handle_cli_input(cli, m_parser))
+        {
+            Debug.Write(wxString::Format("evsrv: cli %p request too big, disconnecting\n", cli));
+
+            m_eventServerClients.erase(cli);
+            Metrics.evsrvClients.Set(m_eventServerClients.size());
+
+            destroy_client(cli);
+        }
     }
     else
     {
@@ -2352,224 +3239,412 @@ void EventServer::OnEventServerClientEvent(wxSocketEvent& event)
     }
 }
 
+void EventServer::OnFrameServerEvent(wxSocketEvent& event)
+{
+    wxSocketServer *server = static_cast<wxSocketServer *>(event.GetSocket());
+
+    if (event.GetSocketEvent() != wxSOCKET_CONNECTION)
+        return;
+
+    wxSocketClient *client = static_cast<wxSocketClient *>(server->Accept(false));
+
+    if (!client)
+        return;
+
+    Debug.Write(wxString::Format("frmsrv: cli %p connect\n", client));
+
+    client->SetEventHandler(*this, FRAME_SERVER_CLIENT_ID);
+    client->SetNotify(wxSOCKET_LOST_FLAG | wxSOCKET_INPUT_FLAG | wxSOCKET_OUTPUT_FLAG);
+    client->SetFlags(wxSOCKET_NOWAIT);
+    client->Notify(true);
+    client->SetClientData(new FrameStreamClient(client));
+
+    m_frameClients.insert(client);
+    Metrics.evsrvFrameClients.Set(m_frameClients.size());
+}
+
+void EventServer::OnFrameServerClientEvent(wxSocketEvent& event)
+{
+    wxSocketClient *cli = static_cast<wxSocketClient *>(event.GetSocket());
+
+    switch (event.GetSocketEvent())
+    {
+    case wxSOCKET_LOST:
+        Debug.Write(wxString::Format("frmsrv: cli %p disconnect\n", cli));
+        if (m_frameClients.erase(cli) == 1)
+            destroy_frame_client(cli);
+        Metrics.evsrvFrameClients.Set(m_frameClients.size());
+        break;
+    case wxSOCKET_INPUT:
+        if (handle_frame_client_input(cli, m_parser))
+        {
+            Debug.Write(wxString::Format("frmsrv: cli %p subscription request too big, disconnecting\n", cli));
+            if (m_frameClients.erase(cli) == 1)
+                destroy_frame_client(cli);
+            Metrics.evsrvFrameClients.Set(m_frameClients.size());
+        }
+        break;
+    case wxSOCKET_OUTPUT:
+        frame_flush(frame_client(cli));
+        break;
+    default:
+        Debug.Write(wxString::Format("unexpected frame client socket event %d\n", event.GetSocketEvent()));
+        break;
+    }
+}
+
+void EventServer::OnMetricsServerEvent(wxSocketEvent& event)
+{
+    wxSocketServer *server = static_cast<wxSocketServer *>(event.GetSocket());
+
+    if (event.GetSocketEvent() != wxSOCKET_CONNECTION)
+        return;
+
+    wxSocketClient *client = static_cast<wxSocketClient *>(server->Accept(false));
+
+    if (!client)
+        return;
+
+    client->SetEventHandler(*this, METRICS_SERVER_CLIENT_ID);
+    client->SetNotify(wxSOCKET_LOST_FLAG | wxSOCKET_INPUT_FLAG | wxSOCKET_OUTPUT_FLAG);
+    client->SetFlags(wxSOCKET_NOWAIT);
+    client->Notify(true);
+    client->SetClientData(new MetricsHttpClient());
+
+    m_metricsClients.insert(client);
+}
+
+void EventServer::OnMetricsServerClientEvent(wxSocketEvent& event)
+{
+    wxSocketClient *cli = static_cast<wxSocketClient *>(event.GetSocket());
+
+    bool done;
+
+    switch (event.GetSocketEvent())
+    {
+    case wxSOCKET_LOST:
+        done = true;
+        break;
+    case wxSOCKET_INPUT:
+        done = handle_metrics_client_input(cli);
+        break;
+    case wxSOCKET_OUTPUT:
+        done = metrics_client(cli)->responding && metrics_flush(cli, metrics_client(cli));
+        break;
+    default:
+        done = false;
+        break;
+    }
+
+    if (done && m_metricsClients.erase(cli) == 1)
+        destroy_metrics_client(cli);
+}
+
+void EventServer::NotifyNewFrame(const usImage *img)
+{
+    if (m_frameClients.empty() || !img->ImageData)
+        return;
+
+    for (CliSockSet::const_iterator it = m_frameClients.begin();
+         it != m_frameClients.end(); ++it)
+    {
+        send_frame(frame_client(*it), img);
+    }
+}
+
+// Events are only generated on the main thread, so a single reusable buffer
+// serves all of them
+static JWriter& ev_buf()
+{
+    static JWriter s_ev;
+    return s_ev;
+}
+
+inline static void simple_notify(const EventServer::CliSockSet& cli, EventType type)
+{
+    const EvRecipients& to = recipients(cli, type);
+    if (to.empty())
+        return;
+
+    JWriter& ev = ev_buf();
+    ev_begin(ev, type);
+    do_notify(to, ev);
+}
+
+#define SIMPLE_NOTIFY(s) simple_notify(m_eventServerClients, s)
+
 void EventServer::NotifyStartCalibration(Mount *mount)
 {
-    SIMPLE_NOTIFY_EV(ev_start_calibration(mount));
+    const EvRecipients& to = recipients(m_eventServerClients, EV_START_CALIBRATION);
+    if (to.empty())
+        return;
+
+    JWriter& ev = ev_buf();
+    ev_start_calibration(ev, mount);
+
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyCalibrationFailed(Mount *mount, const wxString& msg)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_CALIBRATION_FAILED);
+    if (to.empty())
         return;
 
-    Ev ev("CalibrationFailed");
-    ev << NVMount(mount) << NV("Reason", msg);
+    JWriter& ev = ev_buf();
+    ev_mount(ev_begin(ev, EV_CALIBRATION_FAILED), mount)
+        .Add("Reason", msg);
 
-    do_notify(m_eventServerClients, ev);
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyCalibrationComplete(Mount *mount)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_CALIBRATION_COMPLETE);
+    if (to.empty())
         return;
 
-    do_notify(m_eventServerClients, ev_calibration_complete(mount));
+    JWriter& ev = ev_buf();
+    ev_calibration_complete(ev, mount);
+
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyCalibrationDataFlipped(Mount *mount)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_CALIBRATION_DATA_FLIPPED);
+    if (to.empty())
         return;
 
-    Ev ev("CalibrationDataFlipped");
-    ev << NVMount(mount);
+    JWriter& ev = ev_buf();
+    ev_mount(ev_begin(ev, EV_CALIBRATION_DATA_FLIPPED), mount);
 
-    do_notify(m_eventServerClients, ev);
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyLooping(unsigned int exposure)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_LOOPING_EXPOSURES);
+    if (to.empty())
         return;
 
-    Ev ev("LoopingExposures");
-    ev << NV("Frame", (int) exposure);
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_LOOPING_EXPOSURES)
+        .Add("Frame", (int) exposure);
 
-    do_notify(m_eventServerClients, ev);
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyLoopingStopped()
 {
-    SIMPLE_NOTIFY("LoopingExposuresStopped");
+    SIMPLE_NOTIFY(EV_LOOPING_EXPOSURES_STOPPED);
 }
 
 void EventServer::NotifyStarSelected(const PHD_Point& pt)
 {
-    SIMPLE_NOTIFY_EV(ev_star_selected(pt));
+    const EvRecipients& to = recipients(m_eventServerClients, EV_STAR_SELECTED);
+    if (to.empty())
+        return;
+
+    JWriter& ev = ev_buf();
+    ev_star_selected(ev, pt);
+
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyStarLost(const FrameDroppedInfo& info)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_STAR_LOST);
+    if (to.empty())
         return;
 
-    Ev ev("StarLost");
-
-    ev << NV("Frame", info.frameNumber)
-       << NV("Time", info.time, 3)
-       << NV("StarMass", info.starMass, 0)
-       << NV("SNR", info.starSNR, 2)
-       << NV("AvgDist", info.avgDist, 2);
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_STAR_LOST)
+        .Add("Frame", info.frameNumber)
+        .Add("Time", info.time, 3)
+        .Add("StarMass", info.starMass, 0)
+        .Add("SNR", info.starSNR, 2)
+        .Add("AvgDist", info.avgDist, 2);
 
     if (info.starError)
-        ev << NV("ErrorCode", info.starError);
+        ev.Add("ErrorCode", info.starError);
 
     if (!info.status.IsEmpty())
-        ev << NV("Status", info.status);
+        ev.Add("Status", info.status);
 
-    do_notify(m_eventServerClients, ev);
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyGuidingStarted()
 {
-    SIMPLE_NOTIFY_EV(ev_start_guiding());
+    SIMPLE_NOTIFY(EV_START_GUIDING);
 }
 
 void EventServer::NotifyGuidingStopped()
 {
-    SIMPLE_NOTIFY("GuidingStopped");
+    SIMPLE_NOTIFY(EV_GUIDING_STOPPED);
 }
 
 void EventServer::NotifyPaused()
 {
-    SIMPLE_NOTIFY_EV(ev_paused());
+    SIMPLE_NOTIFY(EV_PAUSED);
 }
 
 void EventServer::NotifyResumed()
 {
-    SIMPLE_NOTIFY("Resumed");
+    SIMPLE_NOTIFY(EV_RESUMED);
 }
 
 void EventServer::NotifyGuideStep(const GuideStepInfo& step)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_GUIDE_STEP);
+    if (to.empty())
         return;
 
-    Ev ev("GuideStep");
-
-    ev << NV("Frame", step.frameNumber)
-       << NV("Time", step.time, 3)
-       << NVMount(step.mount)
-       << NV("dx", step.cameraOffset.X, 3)
-       << NV("dy", step.cameraOffset.Y, 3)
-       << NV("RADistanceRaw", step.mountOffset.X, 3)
-       << NV("DECDistanceRaw", step.mountOffset.Y, 3)
-       << NV("RADistanceGuide", step.guideDistanceRA, 3)
-       << NV("DECDistanceGuide", step.guideDistanceDec, 3);
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_GUIDE_STEP)
+        .Add("Frame", step.frameNumber)
+        .Add("Time", step.time, 3);
+    ev_mount(ev, step.mount)
+        .Add("dx", step.cameraOffset.X, 3)
+        .Add("dy", step.cameraOffset.Y, 3)
+        .Add("RADistanceRaw", step.mountOffset.X, 3)
+        .Add("DECDistanceRaw", step.mountOffset.Y, 3)
+        .Add("RADistanceGuide", step.guideDistanceRA, 3)
+        .Add("DECDistanceGuide", step.guideDistanceDec, 3);
 
     if (step.durationRA > 0)
     {
-       ev << NV("RADuration", step.durationRA)
-          << NV("RADirection", step.mount->DirectionStr((GUIDE_DIRECTION)step.directionRA));
+       ev.Add("RADuration", step.durationRA)
+         .Add("RADirection", step.mount->DirectionStr((GUIDE_DIRECTION)step.directionRA));
     }
 
     if (step.durationDec > 0)
     {
-        ev << NV("DECDuration", step.durationDec)
-           << NV("DECDirection", step.mount->DirectionStr((GUIDE_DIRECTION)step.directionDec));
+        ev.Add("DECDuration", step.durationDec)
+          .Add("DECDirection", step.mount->DirectionStr((GUIDE_DIRECTION)step.directionDec));
     }
 
     if (step.mount->IsStepGuider())
     {
-        ev << NV("Pos", step.aoPos);
+        ev.Add("Pos", step.aoPos);
     }
 
-    ev << NV("StarMass", step.starMass, 0)
-       << NV("SNR", step.starSNR, 2)
-       << NV("AvgDist", step.avgDist, 2);
+    ev.Add("StarMass", step.starMass, 0)
+      .Add("SNR", step.starSNR, 2)
+      .Add("AvgDist", step.avgDist, 2);
 
     if (step.starError)
-       ev << NV("ErrorCode", step.starError);
+       ev.Add("ErrorCode", step.starError);
 
     if (step.raLimited)
-        ev << NV("RALimited", true);
+        ev.Add("RALimited", true);
 
     if (step.decLimited)
-        ev << NV("DecLimited", true);
+        ev.Add("DecLimited", true);
 
-    do_notify(m_eventServerClients, ev);
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyGuidingDithered(double dx, double dy)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_GUIDING_DITHERED);
+    if (to.empty())
         return;
 
-    Ev ev("GuidingDithered");
-    ev << NV("dx", dx, 3) << NV("dy", dy, 3);
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_GUIDING_DITHERED)
+        .Add("dx", dx, 3)
+        .Add("dy", dy, 3);
 
-    do_notify(m_eventServerClients, ev);
+    do_notify(to, ev);
 }
 
 void EventServer::NotifySetLockPosition(const PHD_Point& xy)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_LOCK_POSITION_SET);
+    if (to.empty())
         return;
 
-    do_notify(m_eventServerClients, ev_set_lock_position(xy));
+    JWriter& ev = ev_buf();
+    ev_set_lock_position(ev, xy);
+
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyLockPositionLost()
 {
-    SIMPLE_NOTIFY("LockPositionLost");
+    SIMPLE_NOTIFY(EV_LOCK_POSITION_LOST);
 }
 
 void EventServer::NotifyAppState()
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_APP_STATE);
+    if (to.empty())
         return;
 
-    do_notify(m_eventServerClients, ev_app_state());
+    JWriter& ev = ev_buf();
+    ev_app_state(ev);
+
+    do_notify(to, ev);
 }
 
 void EventServer::NotifySettleBegin()
 {
-    SIMPLE_NOTIFY("SettleBegin");
+    SIMPLE_NOTIFY(EV_SETTLE_BEGIN);
 }
 
 void EventServer::NotifySettling(double distance, double time, double settleTime, bool starLocked)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_SETTLING);
+    if (to.empty())
         return;
 
-    Ev ev(ev_settling(distance, time, settleTime, starLocked));
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_SETTLING)
+        .Add("Distance", distance, 2)
+        .Add("Time", time, 1)
+        .Add("SettleTime", settleTime, 1)
+        .Add("StarLocked", starLocked);
 
-    Debug.Write(wxString::Format("evsrv: %s\n", ev.str()));
+    do_notify(to, ev);
 
-    do_notify(m_eventServerClients, ev);
+    Debug.Write(wxString::Format("evsrv: %s\n", ev.Str().Trim()));
 }
 
 void EventServer::NotifySettleDone(const wxString& errorMsg, int settleFrames, int droppedFrames)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_SETTLE_DONE);
+    if (to.empty())
         return;
 
-    Ev ev(ev_settle_done(errorMsg, settleFrames, droppedFrames));
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_SETTLE_DONE);
 
-    Debug.Write(wxString::Format("evsrv: %s\n", ev.str()));
+    int status = errorMsg.IsEmpty() ? 0 : 1;
+
+    ev.Add("Status", status);
+
+    if (status != 0)
+    {
+        ev.Add("Error", errorMsg);
+    }
+
+    ev.Add("TotalFrames", settleFrames)
+      .Add("DroppedFrames", droppedFrames);
+
+    do_notify(to, ev);
 
-    do_notify(m_eventServerClients, ev);
+    Debug.Write(wxString::Format("evsrv: %s\n", ev.Str().Trim()));
 }
 
 void EventServer::NotifyAlert(const wxString& msg, int type)
 {
-    if (m_eventServerClients.empty())
+    const EvRecipients& to = recipients(m_eventServerClients, EV_ALERT);
+    if (to.empty())
         return;
 
-    Ev ev("Alert");
-    ev << NV("Msg", msg);
-
-    wxString s;
+    const char *s;
     switch (type)
     {
     case wxICON_NONE:
@@ -2587,22 +3662,28 @@ void EventServer::NotifyAlert(const wxString& msg, int type)
         s = "error";
         break;
     }
-    ev << NV("Type", s);
 
-    do_notify(m_eventServerClients, ev);
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_ALERT)
+        .Add("Msg", msg)
+        .Add("Type", s);
+
+    do_notify(to, ev);
 }
 
 template<typename T>
 static void NotifyGuidingParam(const EventServer::CliSockSet& clients, const wxString& name, T val)
 {
-    if (clients.empty())
+    const EvRecipients& to = recipients(clients, EV_GUIDE_PARAM_CHANGE);
+    if (to.empty())
         return;
 
-    Ev ev("GuideParamChange");
-    ev << NV("Name", name);
-    ev << NV("Value", val);
+    JWriter& ev = ev_buf();
+    ev_begin(ev, EV_GUIDE_PARAM_CHANGE)
+        .Add("Name", name)
+        .Add("Value", val);
 
-    do_notify(clients, ev);
+    do_notify(to, ev);
 }
 
 void EventServer::NotifyGuidingParam(const wxString& name, double val)
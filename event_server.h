@@ -47,6 +47,10 @@ private:
     JsonParser m_parser;
     wxSocketServer *m_serverSocket;
     CliSockSet m_eventServerClients;
+    wxSocketServer *m_frameServerSocket;
+    CliSockSet m_frameClients;
+    wxSocketServer *m_metricsServerSocket;
+    CliSockSet m_metricsClients;
 
 public:
     EventServer();
@@ -80,10 +84,15 @@ public:
     void NotifyGuidingParam(const wxString& name, int val);
     void NotifyGuidingParam(const wxString& name, bool val);
     void NotifyGuidingParam(const wxString& name, const wxString& val);
+    void NotifyNewFrame(const usImage *img);
 
 private:
     void OnEventServerEvent(wxSocketEvent& evt);
     void OnEventServerClientEvent(wxSocketEvent& evt);
+    void OnFrameServerEvent(wxSocketEvent& evt);
+    void OnFrameServerClientEvent(wxSocketEvent& evt);
+    void OnMetricsServerEvent(wxSocketEvent& evt);
+    void OnMetricsServerClientEvent(wxSocketEvent& evt);
 
     wxDECLARE_EVENT_TABLE();
 };
@@ -120,3 +120,181 @@ void PHD_fits_close_file(fitsfile *fptr)
     int status = 0;
     fits_close_file(fptr, &status);
 }
+
+enum
+{
+    FITS_BLOCK_SIZE = 2880,
+    FITS_CARD_SIZE = 80,
+};
+
+static bool card_key(const char *card, const char *key)
+{
+    size_t len = strlen(key);
+    if (memcmp(card, key, len) != 0)
+        return false;
+    // keywords are left-justified and blank-padded to 8 characters
+    for (; len < 8; len++)
+        if (card[len] != ' ')
+            return false;
+    return true;
+}
+
+static bool card_value(const char *card, double *val)
+{
+    if (card[8] != '=' || card[9] != ' ')
+        return false;
+    char buf[FITS_CARD_SIZE - 10 + 1];
+    memcpy(buf, card + 10, FITS_CARD_SIZE - 10);
+    buf[FITS_CARD_SIZE - 10] = 0;
+    char *end;
+    *val = strtod(buf, &end);
+    return end != buf;
+}
+
+bool FITSRawImage::Parse(const void *buf, size_t len)
+{
+    const char *const hdr = static_cast<const char *>(buf);
+    double bitpix = 0., naxis = -1., naxis1 = 0., naxis2 = 0., bzero = 0., bscale = 1.;
+    bool simple = false, end = false;
+
+    size_t pos;
+    for (pos = 0; pos + FITS_CARD_SIZE <= len; pos += FITS_CARD_SIZE)
+    {
+        const char *card = hdr + pos;
+
+        if (pos == 0)
+        {
+            if (!card_key(card, "SIMPLE") || card[8] != '=' || card[29] != 'T')
+                return false;
+            simple = true;
+            continue;
+        }
+
+        if (card_key(card, "END"))
+        {
+            end = true;
+            break;
+        }
+
+        double v;
+        if (card_key(card, "BITPIX") && card_value(card, &v))
+            bitpix = v;
+        else if (card_key(card, "NAXIS") && card_value(card, &v))
+            naxis = v;
+        else if (card_key(card, "NAXIS1") && card_value(card, &v))
+            naxis1 = v;
+        else if (card_key(card, "NAXIS2") && card_value(card, &v))
+            naxis2 = v;
+        else if (card_key(card, "BZERO") && card_value(card, &v))
+            bzero = v;
+        else if (card_key(card, "BSCALE") && card_value(card, &v))
+            bscale = v;
+    }
+
+    if (!simple || !end || naxis != 2. || bscale != 1.)
+        return false;
+
+    if (!(bitpix == 16. && (bzero == 32768. || bzero == 0.)) && !(bitpix == 8. && bzero == 0.))
+        return false;
+
+    if (naxis1 < 1. || naxis2 < 1. || naxis1 > 65535. || naxis2 > 65535.)
+        return false;
+
+    // data starts at the block following the END card
+    size_t const dataStart = (pos / FITS_BLOCK_SIZE + 1) * FITS_BLOCK_SIZE;
+    size_t const bytesPerPixel = bitpix == 16. ? 2 : 1;
+    size_t const dataLen = (size_t) naxis1 * (size_t) naxis2 * bytesPerPixel;
+
+    if (dataStart + dataLen > len)
+        return false;
+
+    // anything after the (padded) data array would be another HDU; leave
+    // that to CFITSIO, which only accepts a single HDU. EXTEND = T alone says
+    // nothing, CFITSIO writes it in every primary header.
+    size_t const dataEnd = dataStart + (dataLen + FITS_BLOCK_SIZE - 1) / FITS_BLOCK_SIZE * FITS_BLOCK_SIZE;
+    if (len > dataEnd)
+        return false;
+
+    m_hdr = hdr;
+    m_hdrLen = pos;
+    m_data = reinterpret_cast<const unsigned char *>(hdr) + dataStart;
+    m_width = (int) naxis1;
+    m_height = (int) naxis2;
+    m_bitpix = (int) bitpix;
+    m_bzero = (int) bzero;
+
+    return true;
+}
+
+wxString FITSRawImage::GetString(const char *key) const
+{
+    for (size_t pos = 0; pos < m_hdrLen; pos += FITS_CARD_SIZE)
+    {
+        const char *card = m_hdr + pos;
+        if (!card_key(card, key) || card[8] != '=')
+            continue;
+
+        // 'value', with embedded quotes doubled and trailing blanks insignificant
+        const char *p = card + 10;
+        const char *const end = card + FITS_CARD_SIZE;
+        while (p < end && *p == ' ')
+            ++p;
+        if (p == end || *p != '\'')
+            return wxEmptyString;
+
+        std::string val;
+        for (++p; p < end; ++p)
+        {
+            if (*p == '\'')
+            {
+                if (p + 1 < end && p[1] == '\'')
+                    ++p;
+                else
+                    break;
+            }
+            val += *p;
+        }
+        while (!val.empty() && val.back() == ' ')
+            val.pop_back();
+
+        return wxString(val);
+    }
+
+    return wxEmptyString;
+}
+
+void FITSRawImage::CopyRect(unsigned short *dst, int dstStride, int x, int y, int w, int h) const
+{
+    if (m_bitpix == 8)
+    {
+        for (int row = 0; row < h; row++, dst += dstStride)
+        {
+            const unsigned char *src = m_data + (size_t)(y + row) * m_width + x;
+            for (int i = 0; i < w; i++)
+                dst[i] = src[i];
+        }
+    }
+    else if (m_bzero == 32768)
+    {
+        // unsigned 16-bit: big-endian signed value offset by 32768, i.e. just flip the sign bit
+        for (int row = 0; row < h; row++, dst += dstStride)
+        {
+            const unsigned char *src = m_data + ((size_t)(y + row) * m_width + x) * 2;
+            for (int i = 0; i < w; i++, src += 2)
+                dst[i] = (unsigned short)(((src[0] << 8) | src[1]) ^ 0x8000);
+        }
+    }
+    else
+    {
+        // signed 16-bit, clip negative values as CFITSIO would when reading TUSHORT
+        for (int row = 0; row < h; row++, dst += dstStride)
+        {
+            const unsigned char *src = m_data + ((size_t)(y + row) * m_width + x) * 2;
+            for (int i = 0; i < w; i++, src += 2)
+            {
+                short v = (short)((src[0] << 8) | src[1]);
+                dst[i] = v < 0 ? 0 : (unsigned short) v;
+            }
+        }
+    }
+}
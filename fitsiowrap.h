@@ -40,6 +40,37 @@ extern int PHD_fits_open_diskfile(fitsfile **fptr, const wxString& filename, int
 extern int PHD_fits_create_file(fitsfile **fptr, const wxString& filename, bool clobber, int *status);
 extern void PHD_fits_close_file(fitsfile *fptr);
 
+// Decoder for the common case of a simple, uncompressed, single-HDU 8- or
+// 16-bit FITS image held in memory (e.g. an INDI BLOB). Pixels are converted
+// directly into the caller's buffer without going through CFITSIO. Parse()
+// returns false for anything it does not handle so the caller can fall back
+// to CFITSIO.
+class FITSRawImage
+{
+    const char *m_hdr;
+    size_t m_hdrLen;
+    const unsigned char *m_data;
+    int m_width;
+    int m_height;
+    int m_bitpix;
+    int m_bzero;
+
+public:
+
+    FITSRawImage() : m_hdr(nullptr), m_hdrLen(0), m_data(nullptr), m_width(0), m_height(0), m_bitpix(0), m_bzero(0) { }
+
+    bool Parse(const void *buf, size_t len);
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    // value of a string-valued header keyword, empty if not present
+    wxString GetString(const char *key) const;
+
+    // copy the rectangle (x, y, w, h) of the FITS image to dst, whose rows are dstStride pixels apart
+    void CopyRect(unsigned short *dst, int dstStride, int x, int y, int w, int h) const;
+};
+
 class FITSHdrWriter
 {
     fitsfile *fptr;
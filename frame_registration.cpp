@@ -0,0 +1,172 @@
+/*
+ *  frame_registration.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <algorithm>
+
+enum
+{
+    MIN_WINDOW_SIZE = 32,
+    MAX_WINDOW_SIZE = 128,
+};
+
+static const double PEAK_SIGMA = 2.0;       // pixels; width of the correlation peak after low-pass weighting
+static const double MIN_PEAK_QUALITY = 0.25;    // lower correlation peaks are not trusted
+
+// the part of the image containing data
+static wxRect ValidRect(const usImage& img)
+{
+    return img.Subframe.IsEmpty() ? wxRect(img.Size) : img.Subframe;
+}
+
+// Move a window of side n as little as possible to lie within valid, or
+// center it on valid if it does not fit
+static wxPoint ClampWindow(const wxPoint& origin, int n, const wxRect& valid)
+{
+    wxPoint p;
+    p.x = n <= valid.GetWidth() ? wxMax(valid.GetLeft(), wxMin(origin.x, valid.GetRight() + 1 - n)) :
+        valid.GetLeft() - (n - valid.GetWidth()) / 2;
+    p.y = n <= valid.GetHeight() ? wxMax(valid.GetTop(), wxMin(origin.y, valid.GetBottom() + 1 - n)) :
+        valid.GetTop() - (n - valid.GetHeight()) / 2;
+    return p;
+}
+
+FrameRegistration::FrameRegistration()
+    : m_size(0)
+{
+}
+
+void FrameRegistration::Reset()
+{
+    m_size = 0;
+}
+
+bool FrameRegistration::IsValid() const
+{
+    return m_size > 0;
+}
+
+int FrameRegistration::WindowSize() const
+{
+    return m_size;
+}
+
+bool FrameRegistration::SetReference(const usImage& img, const PHD_Point& center)
+{
+    Reset();
+
+    if (!img.ImageData || !center.IsValid())
+        return true;
+
+    // a window within the subframe, so the transform only sees image data
+    wxRect const valid(ValidRect(img));
+
+    int size = MAX_WINDOW_SIZE;
+    while (size > valid.GetWidth() || size > valid.GetHeight())
+        size >>= 1;
+
+    if (size < MIN_WINDOW_SIZE)
+    {
+        Debug.Write(wxString::Format("FrameRegistration: image %dx%d too small\n", valid.GetWidth(), valid.GetHeight()));
+        return true;
+    }
+
+    m_corr.Init(size, PEAK_SIGMA);
+
+    m_size = size;
+    m_origin = ClampWindow(wxPoint(ROUND(center.X) - size / 2, ROUND(center.Y) - size / 2), size, valid);
+
+    std::vector<unsigned short> window;
+    Extract(img, m_origin, window);
+    m_corr.SetReference(&window[0]);
+
+    Debug.Write(wxString::Format("FrameRegistration: %dx%d reference window at (%d, %d), frame %u\n",
+        size, size, m_origin.x, m_origin.y, img.FrameNum));
+
+    return false;
+}
+
+bool FrameRegistration::Measure(const usImage& img, const PHD_Point& expectedShift, PHD_Point *shift, double *quality)
+{
+    if (!IsValid() || !img.ImageData || !expectedShift.IsValid())
+        return true;
+
+    wxPoint const origin = ClampWindow(m_origin + wxPoint(ROUND(expectedShift.X), ROUND(expectedShift.Y)), m_size, ValidRect(img));
+    wxPoint const offset = origin - m_origin;
+
+    std::vector<unsigned short> window;
+    Extract(img, origin, window);
+
+    double dx, dy;
+    if (m_corr.Measure(&window[0], m_size / 4, MIN_PEAK_QUALITY, &dx, &dy, quality))
+    {
+        Debug.Write(wxString::Format("FrameRegistration: no correlation peak, quality %.3f, frame %u\n", *quality, img.FrameNum));
+        return true;
+    }
+
+    shift->SetXY(offset.x + dx, offset.y + dy);
+
+    return false;
+}
+
+// Copy a window out of the image and remove hot pixels with a 3x3 median.
+// Pixels outside the image or its subframe are set to the mean of the rest.
+void FrameRegistration::Extract(const usImage& img, const wxPoint& origin, std::vector<unsigned short>& out) const
+{
+    int const n = m_size;
+    int const width = img.Size.GetWidth();
+
+    wxRect valid(ValidRect(img));
+    valid.Intersect(wxRect(origin, wxSize(n, n)));
+
+    double sum = 0.0;
+    for (int y = valid.GetTop(); y <= valid.GetBottom(); y++)
+    {
+        const unsigned short *row = img.ImageData + y * width;
+        for (int x = valid.GetLeft(); x <= valid.GetRight(); x++)
+            sum += row[x];
+    }
+    int const count = valid.GetWidth() * valid.GetHeight();
+    unsigned short const fill = count > 0 ? (unsigned short) (sum / count + 0.5) : 0;
+
+    std::vector<unsigned short> raw(n * n, fill);
+    for (int y = valid.GetTop(); y <= valid.GetBottom(); y++)
+    {
+        const unsigned short *src = img.ImageData + y * width + valid.GetLeft();
+        std::copy(src, src + valid.GetWidth(), &raw[(y - origin.y) * n + valid.GetLeft() - origin.x]);
+    }
+
+    out.resize(n * n);
+    Median3(&out[0], &raw[0], wxSize(n, n), wxRect(0, 0, n, n));
+}
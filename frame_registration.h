@@ -0,0 +1,80 @@
+/*
+ *  frame_registration.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef FRAME_REGISTRATION_INCLUDED
+#define FRAME_REGISTRATION_INCLUDED
+
+#include "phase_correlation.h"
+
+#include <vector>
+
+// Measures how far the star field has moved between a reference frame and
+// later frames by phase correlation over a square window of the frame. The
+// window lies within the subframe when the frames are subframes.
+//
+// Every star in the window, and the background structure, contributes to
+// the measurement, so it is much less affected by seeing than the position
+// of a single star. The window is cleaned of hot pixels with a 3x3 median
+// and tapered at its edges, and the cross-power spectrum is low-pass
+// weighted so the correlation peak is a smooth, roughly Gaussian blob that
+// can be located to a fraction of a pixel.
+class FrameRegistration
+{
+    int m_size;                         // window side, a power of 2; 0 without a reference
+    wxPoint m_origin;                   // top-left corner of the reference window
+    PhaseCorrelation m_corr;
+
+public:
+    FrameRegistration();
+
+    void Reset();
+    bool IsValid() const;
+    int WindowSize() const;
+
+    // Take the reference window centered on center, as large as the image
+    // or its subframe allows up to the maximum size. Returns true on error.
+    bool SetReference(const usImage& img, const PHD_Point& center);
+
+    // Measure the shift of img relative to the reference frame. The window
+    // is taken from img displaced by expectedShift, so the field only has to
+    // be found near where it is expected, and moved as little as needed to
+    // lie within the subframe of img. shift is the total shift of the
+    // field, and quality is the height of the correlation peak, near 1 for
+    // identical frames. Returns true on error.
+    bool Measure(const usImage& img, const PHD_Point& expectedShift, PHD_Point *shift, double *quality);
+
+private:
+    void Extract(const usImage& img, const wxPoint& origin, std::vector<unsigned short>& out) const;
+};
+
+#endif
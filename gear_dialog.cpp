@@ -82,6 +82,7 @@ BEGIN_EVENT_TABLE(GearDialog, wxDialog)
     EVT_TOGGLEBUTTON(GEAR_BUTTON_DISCONNECT_ROTATOR, GearDialog::OnButtonDisconnectRotator)
 
     EVT_CHAR_HOOK(GearDialog::OnChar)
+    EVT_TIMER(GEAR_ENUM_TIMER, GearDialog::OnEnumTimer)
 END_EVENT_TABLE()
 
 /*
@@ -122,7 +123,9 @@ GearDialog::GearDialog(wxWindow *pParent) :
     m_mountUpdated(false),
     m_stepGuiderUpdated(false),
     m_rotatorUpdated(false),
-    m_showDarksDialog(false)
+    m_showDarksDialog(false),
+    m_enumTimer(this, GEAR_ENUM_TIMER),
+    m_enumNext(0)
 {
     m_pCamera              = nullptr;
     m_pScope               = nullptr;
@@ -386,59 +389,182 @@ static void LoadChoices(wxChoice *ctl, const wxArrayString& ary)
     ctl->Thaw();
 }
 
-static void LoadCameras(wxChoice *cameras)
+// Building the device lists means querying the ASCOM profile store, probing video
+// devices and so on, which can take seconds. The lists found last time are kept in
+// the profile so the dialog can be populated immediately, and the drivers are
+// queried afterwards, one device type per timer tick, from the event loop.
+
+enum DeviceList
+{
+    DEVLIST_CAMERA,
+    DEVLIST_MOUNT,
+    DEVLIST_AUX_MOUNT,
+    DEVLIST_AO,
+    DEVLIST_ROTATOR,
+
+    DEVLIST_COUNT
+};
+
+static const int ENUM_START_DELAY_MS = 250;     // let the main window paint first
+static const int ENUM_INTERVAL_MS = 20;         // keep the UI responsive between device types
+
+static const char *DeviceListName(int which)
 {
-    LoadChoices(cameras, GuideCamera::GuideCameraList());
+    static const char *names[DEVLIST_COUNT] = { "camera", "mount", "aux mount", "AO", "rotator" };
+    return names[which];
+}
+
+static wxString DeviceListCacheKey(int which)
+{
+    static const char *keys[DEVLIST_COUNT] = { "cameras", "mounts", "auxmounts", "aos", "rotators" };
+    return wxString("/gear/DeviceListCache/") + keys[which];
+}
+
+static wxArrayString QueryDevices(int which)
+{
+    switch (which)
+    {
+    case DEVLIST_CAMERA:    return GuideCamera::GuideCameraList();
+    case DEVLIST_MOUNT:     return Scope::MountList();
+    case DEVLIST_AUX_MOUNT: return Scope::AuxMountList();
+    case DEVLIST_AO:        return StepGuider::AOList();
+    case DEVLIST_ROTATOR:   return Rotator::RotatorList();
+    }
+    return wxArrayString();
+}
+
+// query the drivers for one device type and remember the result for the next startup
+static wxArrayString EnumerateDevices(int which)
+{
+    wxStopWatch swatch;
+    wxArrayString list = QueryDevices(which);
+
+    Debug.Write(wxString::Format("Device enumeration: found %u %s choices in %ld ms\n",
+        (unsigned int) list.size(), DeviceListName(which), swatch.Time()));
+
+    // the device names are not translated but the leading "None" entry is;
+    // leave it out so the cache still applies after a language change
+    wxArrayString devices(list);
+    if (!devices.empty() && devices[0] == _("None"))
+        devices.RemoveAt(0);
+
+    pConfig->Profile.SetString(DeviceListCacheKey(which), wxJoin(devices, '|'));
+
+    return list;
+}
+
+// the list saved by the last enumeration for this profile, making sure it
+// contains the last selected device so the selection can be restored
+static wxArrayString CachedDevices(int which, const wxString& lastChoice)
+{
+    wxString cached = pConfig->Profile.GetString(DeviceListCacheKey(which), wxEmptyString);
+
+    wxArrayString list;
+    list.Add(_("None"));
+    if (!cached.empty())
+    {
+        for (const auto& item : wxSplit(cached, '|'))
+            list.Add(item);
+    }
+
+    bool found = false;
+    for (const auto& item : list)
+    {
+        if (DeviceSelectionMatches(lastChoice, item))
+        {
+            found = true;
+            break;
+        }
+    }
+    if (!found)
+        list.Add(lastChoice);
+
+    return list;
 }
 
-static void LoadMounts(wxChoice *mounts)
+// replace the choices with a freshly enumerated list, keeping the current selection
+static void UpdateDeviceChoices(wxChoice *ctrl, const wxArrayString& list)
 {
-    LoadChoices(mounts, Scope::MountList());
+    if (ctrl->GetStrings() == list)
+        return;
+
+    wxString sel = ctrl->GetStringSelection();
+
+    LoadChoices(ctrl, list);
+
+    if (sel.empty())
+        return;
+
+    SetMatchingSelection(ctrl, sel);
+    if (ctrl->GetSelection() == wxNOT_FOUND)
+    {
+        // the selected device was not found this time; keep it so the
+        // selection does not change underneath the user
+        ctrl->SetSelection(ctrl->Append(sel));
+    }
 }
 
-static void LoadAuxMounts(wxChoice *auxMounts)
+wxChoice *GearDialog::DeviceChoice(int which) const
 {
-    LoadChoices(auxMounts, Scope::AuxMountList());
+    switch (which)
+    {
+    case DEVLIST_CAMERA:    return m_pCameras;
+    case DEVLIST_MOUNT:     return m_pScopes;
+    case DEVLIST_AUX_MOUNT: return m_pAuxScopes;
+    case DEVLIST_AO:        return m_pStepGuiders;
+    case DEVLIST_ROTATOR:   return m_pRotators;
+    }
+    return nullptr;
 }
 
-static void LoadAOs(wxChoice *aos)
+void GearDialog::StartDeviceEnumeration()
 {
-    LoadChoices(aos, StepGuider::AOList());
+    m_enumNext = 0;
+    m_enumTimer.StartOnce(ENUM_START_DELAY_MS);
 }
 
-static void LoadRotators(wxChoice *rots)
+void GearDialog::OnEnumTimer(wxTimerEvent& evt)
 {
-    LoadChoices(rots, Rotator::RotatorList());
+    int which = m_enumNext++;
+
+    UpdateDeviceChoices(DeviceChoice(which), EnumerateDevices(which));
+
+    if (m_enumNext < DEVLIST_COUNT)
+        m_enumTimer.StartOnce(ENUM_INTERVAL_MS);
 }
 
 void GearDialog::LoadGearChoices()
 {
-    LoadCameras(m_pCameras);
-    LoadMounts(m_pScopes);
-    LoadAuxMounts(m_pAuxScopes);
-    LoadAOs(m_pStepGuiders);
-    LoadRotators(m_pRotators);
+    m_lastCamera = pConfig->Profile.GetString("/camera/LastMenuChoice", _("None"));
+    wxString lastScope = pConfig->Profile.GetString("/scope/LastMenuChoice", _("None"));
+    wxString lastAuxScope = pConfig->Profile.GetString("/scope/LastAuxMenuChoice", _("None"));
+    wxString lastStepGuider = pConfig->Profile.GetString("/stepguider/LastMenuChoice", _("None"));
+    wxString lastRotator = pConfig->Profile.GetString("/rotator/LastMenuChoice", _("None"));
+
+    LoadChoices(m_pCameras, CachedDevices(DEVLIST_CAMERA, m_lastCamera));
+    LoadChoices(m_pScopes, CachedDevices(DEVLIST_MOUNT, lastScope));
+    LoadChoices(m_pAuxScopes, CachedDevices(DEVLIST_AUX_MOUNT, lastAuxScope));
+    LoadChoices(m_pStepGuiders, CachedDevices(DEVLIST_AO, lastStepGuider));
+    LoadChoices(m_pRotators, CachedDevices(DEVLIST_ROTATOR, lastRotator));
 
     wxCommandEvent dummyEvent;
-    m_lastCamera = pConfig->Profile.GetString("/camera/LastMenuChoice", _("None"));
     SetMatchingSelection(m_pCameras, m_lastCamera);
     OnChoiceCamera(dummyEvent);
 
-    wxString lastScope = pConfig->Profile.GetString("/scope/LastMenuChoice", _("None"));
     SetMatchingSelection(m_pScopes, lastScope);
     OnChoiceScope(dummyEvent);
 
-    wxString lastAuxScope = pConfig->Profile.GetString("/scope/LastAuxMenuChoice", _("None"));
     SetMatchingSelection(m_pAuxScopes, lastAuxScope);
     OnChoiceAuxScope(dummyEvent);
 
-    wxString lastStepGuider = pConfig->Profile.GetString("/stepguider/LastMenuChoice", _("None"));
     SetMatchingSelection(m_pStepGuiders, lastStepGuider);
     OnChoiceStepGuider(dummyEvent);
 
-    wxString lastRotator = pConfig->Profile.GetString("/rotator/LastMenuChoice", _("None"));
     SetMatchingSelection(m_pRotators, lastRotator);
     OnChoiceRotator(dummyEvent);
+
+    // refresh the lists from the drivers once the event loop is running
+    StartDeviceEnumeration();
 }
 
 int GearDialog::ShowGearDialog(bool autoConnect)
@@ -1005,7 +1131,7 @@ void GearDialog::OnButtonSetupCamera(wxCommandEvent& event)
 
     // camera setup may have changed camera name so re-load the camera list
     wxString selection = m_pCameras->GetStringSelection();
-    LoadCameras(m_pCameras);
+    LoadChoices(m_pCameras, EnumerateDevices(DEVLIST_CAMERA));
     SetMatchingSelection(m_pCameras, selection);
 }
 
@@ -1038,7 +1164,7 @@ bool GearDialog::DoConnectCamera()
             {
                 wxString msg = _("By changing cameras in this profile, you won't be able to use the existing dark library or bad-pixel maps. You should consider"
                     " creating a new profile for this set-up.  Do you want to proceed with changes to this profile?");
-                if (wxMessageBox(msg, _("Camera Change Warning"), wxYES_NO, this) == wxYES)
+                if (PhdMessageBox(msg, _("Camera Change Warning"), wxYES_NO, this) == wxYES)
                 {
                     m_camWarningIssued = true;
                     m_lastCamera = newCam;          // make consistent with what's in the UI
@@ -1271,7 +1397,7 @@ void GearDialog::OnButtonSetupScope(wxCommandEvent& event)
 
     // scope setup may have changed the scope name so re-load the scope list
     wxString selection = m_pScopes->GetStringSelection();
-    LoadMounts(m_pScopes);
+    LoadChoices(m_pScopes, EnumerateDevices(DEVLIST_MOUNT));
     SetMatchingSelection(m_pScopes, selection);
 }
 
@@ -1281,7 +1407,7 @@ void GearDialog::OnButtonSetupAuxScope(wxCommandEvent& event)
 
     // scope setup may have changed scope name so re-load the aux scope list
     wxString selection = m_pAuxScopes->GetStringSelection();
-    LoadAuxMounts(m_pAuxScopes);
+    LoadChoices(m_pAuxScopes, EnumerateDevices(DEVLIST_AUX_MOUNT));
     SetMatchingSelection(m_pAuxScopes, selection);
 }
 
@@ -1310,7 +1436,7 @@ void GearDialog::OnButtonConnectScope(wxCommandEvent& event)
             if (m_pScope && m_ascomScopeSelected && !m_pScope->CanPulseGuide())
             {
                 m_pScope->Disconnect();
-                wxMessageBox(wxString::Format(_("Mount does not support the required PulseGuide interface"), _("Error")));
+                PhdMessageBox(wxString::Format(_("Mount does not support the required PulseGuide interface"), _("Error")));
                 throw THROW_INFO("OnButtonConnectScope: PulseGuide commands not supported");
             }
 
@@ -1486,7 +1612,7 @@ void GearDialog::OnButtonSetupStepGuider(wxCommandEvent& event)
 
     // setup dialog may have changed device name so re-load the list
     wxString selection = m_pStepGuiders->GetStringSelection();
-    LoadAOs(m_pStepGuiders);
+    LoadChoices(m_pStepGuiders, EnumerateDevices(DEVLIST_AO));
     SetMatchingSelection(m_pStepGuiders, selection);
 }
 
@@ -1615,7 +1741,7 @@ void GearDialog::OnButtonSetupRotator(wxCommandEvent& event)
 
     // setup dialog may have changed device name so re-load the list
     wxString selection = m_pRotators->GetStringSelection();
-    LoadRotators(m_pRotators);
+    LoadChoices(m_pRotators, EnumerateDevices(DEVLIST_ROTATOR));
     SetMatchingSelection(m_pRotators, selection);
 }
 
@@ -1997,7 +2123,7 @@ void GearDialog::OnProfileNew(wxCommandEvent& event)
 
     if (pConfig->GetProfileId(newname) > 0)
     {
-        wxMessageBox(wxString::Format(_("Cannot create profile %s, there is already a profile with that name"), newname), _("Error"));
+        PhdMessageBox(wxString::Format(_("Cannot create profile %s, there is already a profile with that name"), newname), _("Error"));
         return;
     }
 
@@ -2006,14 +2132,14 @@ void GearDialog::OnProfileNew(wxCommandEvent& event)
         wxString copyFrom = dlg.m_copyFrom->GetStringSelection();
         if (pConfig->CloneProfile(newname, copyFrom))
         {
-            wxMessageBox(wxString::Format(_("Could not create profile %s from profile %s"), newname, copyFrom), _("Error"));
+            PhdMessageBox(wxString::Format(_("Could not create profile %s from profile %s"), newname, copyFrom), _("Error"));
             return;
         }
     }
 
     if (pConfig->SetCurrentProfile(newname))
     {
-        wxMessageBox(wxString::Format(_("Could not create profile %s"), newname), _("Error"));
+        PhdMessageBox(wxString::Format(_("Could not create profile %s"), newname), _("Error"));
         return;
     }
 
@@ -2029,7 +2155,7 @@ void GearDialog::OnProfileNew(wxCommandEvent& event)
 void GearDialog::OnProfileDelete(wxCommandEvent& event)
 {
     wxString current = m_profiles->GetStringSelection();
-    int result = wxMessageBox(wxString::Format(_("Delete profile %s?"), current), _("Delete Equipment Profile"), wxOK | wxCANCEL | wxCENTRE);
+    int result = PhdMessageBox(wxString::Format(_("Delete profile %s?"), current), _("Delete Equipment Profile"), wxOK | wxCANCEL | wxCENTRE);
     if (result != wxOK)
         return;
     int id = pConfig->GetProfileId(current);
@@ -2058,13 +2184,13 @@ void GearDialog::OnProfileRename(wxCommandEvent& event)
 
     if (pConfig->GetProfileId(newname) > 0)
     {
-        wxMessageBox(_(wxString::Format("Cannot not rename profile to %s, there is already a profile with that name", newname)), _("Error"));
+        PhdMessageBox(_(wxString::Format("Cannot not rename profile to %s, there is already a profile with that name", newname)), _("Error"));
         return;
     }
 
     if (pConfig->RenameProfile(current, newname))
     {
-        wxMessageBox(_("Could not rename profile"), _("Error"));
+        PhdMessageBox(_("Could not rename profile"), _("Error"));
         return;
     }
 
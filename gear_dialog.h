@@ -88,6 +88,9 @@ class GearDialog : public wxDialog
     wxButton *m_pConnectAllButton;
     wxButton *m_pDisconnectAllButton;
 
+    wxTimer m_enumTimer;
+    int m_enumNext;         // next device list to refresh from the drivers
+
 public:
     GearDialog(wxWindow *pParent);
     ~GearDialog();
@@ -108,6 +111,9 @@ public:
 
 private:
     void LoadGearChoices();
+    wxChoice *DeviceChoice(int which) const;
+    void StartDeviceEnumeration();
+    void OnEnumTimer(wxTimerEvent& evt);
     void UpdateGearPointers();
 
     void UpdateCameraButtonState();
@@ -157,6 +157,9 @@ void GraphStepguiderWindow::OnButtonClear(wxCommandEvent& WXUNUSED(evt))
 
 void GraphStepguiderWindow::AppendData(int dx, int dy, const PHD_Point& avgPos)
 {
+    if (wxGetApp().IsHeadless())
+        return;
+
     wxLongLong_t now = ::wxGetUTCTimeMillis().GetValue();
 
     if (m_pClient->m_nItems > 0)
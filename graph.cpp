@@ -547,6 +547,9 @@ void GraphLogWindow::EnableTrendLines(bool enable)
 
 void GraphLogWindow::AppendData(const GuideStepInfo& step)
 {
+    if (wxGetApp().IsHeadless())
+        return;
+
     if (m_pXControlPane)
         m_pXControlPane->UpdateControls();
     if (m_pYControlPane)
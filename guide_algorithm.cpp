@@ -39,6 +39,10 @@
 
 #include "phd.h"
 
+#include "guide_filters.h"
+
+#include <stdarg.h>
+
 wxString GuideAlgorithm::GetConfigPath() const
 {
     return "/" + m_pMount->GetMountClassName() + "/GuideAlgorithm/" +
@@ -61,6 +65,23 @@ void GuideAlgorithm::ResetParams()
         SetMinMove(SmartDefaultMinMove());
 }
 
+GuideFilterLog *GuideAlgorithm::FilterDebugLog()
+{
+    class DebugFilterLog : public GuideFilterLog
+    {
+    public:
+        void Log(const char *format, ...) override
+        {
+            va_list args;
+            va_start(args, format);
+            Debug.Write(wxString::FormatV(format, args));
+            va_end(args);
+        }
+    };
+    static DebugFilterLog s_log;
+    return &s_log;
+}
+
 double GuideAlgorithm::SmartDefaultMinMove(int focalLength, double pixelSize, int binning)
 {
     double imageScale = MyFrame::GetPixelScale(pixelSize, focalLength, binning);
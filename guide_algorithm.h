@@ -60,6 +60,7 @@
 
 class Mount;
 class GraphControlPane;
+class GuideFilterLog;
 
 enum GuideAxis
 {
@@ -110,6 +111,8 @@ public:
     static void AdjustMinMoveSpinCtrl(wxSpinCtrlDouble* minMoveCtrl, int oldBinVal, int newBinVal);
     static double SmartDefaultMinMove();
     static double SmartDefaultMinMove(int focalLength, double pixelSize, int binning);
+    // sends the messages of the guide filters (guide_filters.h) to the debug log
+    static GuideFilterLog *FilterDebugLog();
 };
 
 #endif /* GUIDE_ALGORITHM_H_INCLUDED */
@@ -291,6 +291,26 @@ static void SetRetainModelPct(const GuideAlgorithm *algo, double val)
     pConfig->Profile.SetDouble(algo->GetConfigPath() + "/noreset_max_pct_period", val);
 }
 
+// The RA guide speed recorded with the calibration, normalized to 15 a-s per second:
+// 1.0 means 15 a-s/sec, 0.5 means 7.5 a-s/sec, etc. Looking it up means reading and
+// parsing the stored calibration details, so callers cache the result.
+static double GetRAGuideSpeed(const Mount *mount)
+{
+    CalibrationDetails calDetails;
+    mount->GetCalibrationDetails(&calDetails);
+
+    double guide_speed = 1.0;
+
+    if (calDetails.raGuideSpeed != -1.0)
+    {
+        // raGuideSpeed is stored in a-s per hour.
+        // We want to normalize relative to the sideral 15 a-s per second.
+        guide_speed = 3600.0 * calDetails.raGuideSpeed / 15.0; // normalize!
+    }
+
+    return guide_speed;
+}
+
 class GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcessDialogPane : public wxEvtHandler, public ConfigDialogPane
 {
     GuideAlgorithmGaussianProcess *m_pGuideAlgorithm;
@@ -446,7 +466,7 @@ GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcess(Mount *pMount, Guid
     parameters.compute_period_ = DefaultComputePeriod;
 
     // create instance of the worker
-    GPG = new GaussianProcessGuider(parameters);
+    GPG = new GaussianProcessGuider(parameters, PhdClock::SystemNow);
 
     wxString configPath = GetConfigPath();
 
@@ -485,6 +505,7 @@ GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcess(Mount *pMount, Guid
     block_updates_ = !(m_pMount->GetGuidingEnabled());
     guiding_ra_ = math_tools::NaN;
     guiding_pier_side_ = PIER_SIDE_UNKNOWN;
+    ra_guide_speed_ = GetRAGuideSpeed(m_pMount);
     reset();
 }
 
@@ -1012,7 +1033,7 @@ void GuideAlgorithmGaussianProcess::GuidingStarted()
     bool need_reset = true;
     double ra_offset;    // RA delta in SI seconds
 
-    auto now = std::chrono::system_clock::now();
+    auto now = PhdClock::SystemNow();
 
     double prev_ra = guiding_ra_;
     guiding_ra_ = CurrentRA();
@@ -1020,6 +1041,9 @@ void GuideAlgorithmGaussianProcess::GuidingStarted()
     PierSide prev_side = guiding_pier_side_;
     guiding_pier_side_ = CurrentPierSide();
 
+    // the calibration may have changed since the last time guiding started
+    ra_guide_speed_ = GetRAGuideSpeed(m_pMount);
+
     Debug.Write(wxString::Format("PPEC: guiding starts RA = %s, pier %s, prev RA = %s, pier %s\n",
                                  FormatRA(guiding_ra_), Mount::PierSideStr(guiding_pier_side_),
                                  FormatRA(prev_ra), Mount::PierSideStr(prev_side)));
@@ -1086,7 +1110,7 @@ void GuideAlgorithmGaussianProcess::GuidingStopped()
     double period_length = GPG->GetGPHyperparameters()[PKPeriodLength];
     pConfig->Profile.SetDouble(GetConfigPath() + "/gp_period_per_kern", period_length);
 
-    guiding_stopped_time_ = std::chrono::system_clock::now();
+    guiding_stopped_time_ = PhdClock::SystemNow();
 }
 
 void GuideAlgorithmGaussianProcess::GuidingPaused()
@@ -1111,32 +1135,16 @@ void GuideAlgorithmGaussianProcess::GuidingEnabled()
     block_updates_ = false;
 }
 
-static double GetRAGuideRate(const Mount *mount)
+double GuideAlgorithmGaussianProcess::GetRAGuideRate() const
 {
-    CalibrationDetails calDetails;
-    mount->GetCalibrationDetails(&calDetails);
-
-    double guide_speed = 1.0; // normalized to 15 a-s per second
-                              // 1.0 means 15 a-s/sec,
-                              // 0.5 means 7.5 a-s/sec, etc.
-
-    if (calDetails.raGuideSpeed != -1.0)
-    {
-        // raGuideSpeed is stored in a-s per hour.
-        // We want to normalize relative to the sideral 15 a-s per second.
-        guide_speed = 3600.0 * calDetails.raGuideSpeed / 15.0; // normalize!
-    }
-
     // the guide rate here is normalized to seconds and adjusted for the speed
-    double guide_rate = 1000. * mount->xRate() / guide_speed;
-
-    return guide_rate;
+    return 1000. * m_pMount->xRate() / ra_guide_speed_;
 }
 
 void GuideAlgorithmGaussianProcess::GuidingDithered(double amt)
 {
     // just hand it on to the guide algorithm, and pass the RA rate
-    GPG->GuidingDithered(amt, GetRAGuideRate(m_pMount));
+    GPG->GuidingDithered(amt, GetRAGuideRate());
 }
 
 void GuideAlgorithmGaussianProcess::GuidingDitherSettleDone(bool success)
@@ -1147,5 +1155,5 @@ void GuideAlgorithmGaussianProcess::GuidingDitherSettleDone(bool success)
 
 void GuideAlgorithmGaussianProcess::DirectMoveApplied(double amt)
 {
-    GPG->DirectMoveApplied(amt, GetRAGuideRate(m_pMount));
+    GPG->DirectMoveApplied(amt, GetRAGuideRate());
 }
@@ -124,8 +124,11 @@ private:
     bool block_updates_;             // Don't update GP if guiding is disabled
     double guiding_ra_;              // allow resuming guiding after guiding stopped if there is no change in RA
     PierSide guiding_pier_side_;
+    double ra_guide_speed_;          // normalized RA guide speed of the calibration, refreshed when guiding starts
     std::chrono::system_clock::time_point guiding_stopped_time_; // time guiding stopped
 
+    double GetRAGuideRate() const;
+
 protected:
     double GetControlGain() const;
     bool SetControlGain(double control_gain);
@@ -43,7 +43,8 @@ static const double DefaultMinMove = 0.2;
 static const double DefaultAggressiveness = 80.0;
 
 GuideAlgorithmLowpass2::GuideAlgorithmLowpass2(Mount *pMount, GuideAxis axis)
-    : GuideAlgorithm(pMount, axis)
+    : GuideAlgorithm(pMount, axis),
+      m_filter(FilterDebugLog())
 {
     double minMove = pConfig->Profile.GetDouble(GetConfigPath() + "/minMove", DefaultMinMove);
     SetMinMove(minMove);
@@ -64,54 +65,12 @@ GUIDE_ALGORITHM GuideAlgorithmLowpass2::Algorithm() const
 }
 void GuideAlgorithmLowpass2::reset(void)
 {
-    m_history.Empty();
-    m_rejects = 0;
+    m_filter.Reset();
 }
 
 double GuideAlgorithmLowpass2::result(double input)
 {
-    m_history.Add(input);
-    unsigned int numpts = m_history.GetCount();
-    double dReturn;
-    double attenuation = m_aggressiveness / 100.;
-
-    if (numpts < 4)
-        dReturn = input * attenuation;                    // Don't fall behind while we're figuring things out
-    else
-    {
-        if (fabs(input) > 4.0 * m_minMove)                            // Outlier deflection - dump the history
-        {
-            dReturn = input * attenuation;
-            reset();
-            numpts = 0;
-            Debug.Write("Lowpass2 history cleared, outlier deflection\n");
-        }
-        else
-            dReturn = CalcSlope(m_history) * (double) numpts * attenuation;
-    }
-
-    if (numpts == HISTORY_SIZE)                 // History is fully populated
-        m_history.RemoveAt(0);
-
-    if (fabs(dReturn) > fabs(input))            // Keep guide pulses below magnitude of last deflection
-    {
-        Debug.Write(wxString::Format("GuideAlgorithmLowpass2::Result() input %.2f is < calculated value %.2f, using input\n", input, dReturn));
-        dReturn = input * attenuation;
-        m_rejects++;
-        if (m_rejects > 3)          // 3-in-a-row, our slope is not useful
-        {
-            reset();
-            Debug.Write("Lowpass2 history cleared, 3 successive rejected correction values\n");
-        }
-    }
-    else
-        m_rejects = 0;
-
-    if (fabs(input) < m_minMove)
-        dReturn = 0.0;
-
-    Debug.Write(wxString::Format("GuideAlgorithmLowpass2::Result() returns %.2f from input %.2f\n", dReturn, input));
-    return dReturn;
+    return m_filter.Result(input, m_minMove, m_aggressiveness);
 }
 
 bool GuideAlgorithmLowpass2::SetMinMove(double minMove)
@@ -40,14 +40,13 @@
 #ifndef GUIDE_ALGORITHM_LOWPASS2_H_INCLUDED
 #define GUIDE_ALGORITHM_LOWPASS2_H_INCLUDED
 
+#include "guide_filters.h"
+
 class GuideAlgorithmLowpass2 : public GuideAlgorithm
 {
-    static const unsigned int HISTORY_SIZE = 10;
-
-    ArrayOfDbl m_history;
+    Lowpass2Filter m_filter;
     double m_aggressiveness;
     double m_minMove;
-    int m_rejects;
 
 protected:
     class GuideAlgorithmLowpass2ConfigDialogPane : public ConfigDialogPane
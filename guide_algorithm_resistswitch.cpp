@@ -43,7 +43,8 @@ static const double DefaultMinMove = 0.2;
 static const double DefaultAggression = 1.0;
 
 GuideAlgorithmResistSwitch::GuideAlgorithmResistSwitch(Mount *pMount, GuideAxis axis)
-    : GuideAlgorithm(pMount, axis)
+    : GuideAlgorithm(pMount, axis),
+      m_filter(FilterDebugLog())
 {
     double minMove  = pConfig->Profile.GetDouble(GetConfigPath() + "/minMove", DefaultMinMove);
     SetMinMove(minMove);
@@ -67,112 +68,12 @@ GUIDE_ALGORITHM GuideAlgorithmResistSwitch::Algorithm() const
 }
 void GuideAlgorithmResistSwitch::reset(void)
 {
-    m_history.Empty();
-
-    while (m_history.GetCount() < HISTORY_SIZE)
-    {
-        m_history.Add(0.0);
-    }
-
-    m_currentSide = 0;
-}
-
-static int sign(double x)
-{
-    int iReturn = 0;
-
-    if (x > 0.0)
-    {
-        iReturn = 1;
-    }
-    else if (x < 0.0)
-    {
-        iReturn = -1;
-    }
-
-    return iReturn;
+    m_filter.Reset();
 }
 
 double GuideAlgorithmResistSwitch::result(double input)
 {
-    double dReturn = input;
-
-    m_history.Add(input);
-    m_history.RemoveAt(0);
-
-    try
-    {
-        if (fabs(input) < m_minMove)
-        {
-            throw THROW_INFO("input < m_minMove");
-        }
-
-        if (m_fastSwitchEnabled)
-        {
-            double thresh = 3.0 * m_minMove;
-            if (sign(input) != m_currentSide && fabs(input) > thresh)
-            {
-                Debug.Write(wxString::Format("resist switch: large excursion: input %.2f thresh %.2f direction from %d to %d\n", input, thresh, m_currentSide, sign(input)));
-                // force switch
-                m_currentSide = 0;
-                unsigned int i;
-                for (i = 0; i < HISTORY_SIZE - 3; i++)
-                    m_history[i] = 0.0;
-                for (; i < HISTORY_SIZE; i++)
-                    m_history[i] = input;
-            }
-        }
-
-        int decHistory = 0;
-
-        for (unsigned int i = 0; i < m_history.GetCount(); i++)
-        {
-            if (fabs(m_history[i]) > m_minMove)
-            {
-                decHistory += sign(m_history[i]);
-            }
-        }
-
-        if (m_currentSide == 0 || sign(m_currentSide) == -sign(decHistory))
-        {
-            if (abs(decHistory) < 3)
-            {
-                throw THROW_INFO("not compelling enough");
-            }
-
-            double oldest = 0.0;
-            double newest = 0.0;
-
-            for (int i = 0; i < 3; i++)
-            {
-                oldest += m_history[i];
-                newest += m_history[m_history.GetCount() - (i + 1)];
-            }
-
-            if (fabs(newest) <= fabs(oldest))
-            {
-                throw THROW_INFO("Not getting worse");
-            }
-
-            Debug.Write(wxString::Format("switching direction from %d to %d - decHistory=%d oldest=%.2f newest=%.2f\n", m_currentSide, sign(decHistory), decHistory, oldest, newest));
-
-            m_currentSide = sign(decHistory);
-        }
-
-        if (m_currentSide != sign(input))
-        {
-            throw THROW_INFO("must have overshot -- vetoing move");
-        }
-    }
-    catch (const wxString& Msg)
-    {
-        POSSIBLY_UNUSED(Msg);
-        dReturn = 0.0;
-    }
-
-    Debug.Write(wxString::Format("GuideAlgorithmResistSwitch::Result() returns %.2f from input %.2f\n", dReturn, input));
-
-    return dReturn * m_aggression;
+    return m_filter.Result(input, m_fastSwitchEnabled) * m_aggression;
 }
 
 bool GuideAlgorithmResistSwitch::SetMinMove(double minMove)
@@ -187,7 +88,7 @@ bool GuideAlgorithmResistSwitch::SetMinMove(double minMove)
         }
 
         m_minMove = minMove;
-        m_currentSide = 0;
+        m_filter.ResetSide();
     }
     catch (const wxString& Msg)
     {
@@ -196,6 +97,8 @@ bool GuideAlgorithmResistSwitch::SetMinMove(double minMove)
         m_minMove = DefaultMinMove;
     }
 
+    m_filter.SetMinMove(m_minMove);
+
     pConfig->Profile.SetDouble(GetConfigPath() + "/minMove", m_minMove);
 
     Debug.Write(wxString::Format("GuideAlgorithmResistSwitch::SetMinMove() returns %d, m_minMove=%.2f\n", bError, m_minMove));
@@ -0,0 +1,337 @@
+/*
+ *  guide_filters.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef GUIDE_FILTERS_H_INCLUDED
+#define GUIDE_FILTERS_H_INCLUDED
+
+// The computations of the Lowpass2 and ResistSwitch guide algorithms, kept
+// apart from their settings and UI so they can be run outside PHD2 (see
+// tests/guide_filters_test.cpp).
+
+#include "circbuf.h"
+
+#include <cmath>
+#include <cstdlib>
+
+// receives the diagnostic messages of the filters, PHD2 sends them to the
+// debug log
+class GuideFilterLog
+{
+public:
+    virtual ~GuideFilterLog() { }
+    virtual void Log(const char *format, ...) = 0;
+};
+
+class Lowpass2Filter
+{
+public:
+    static const unsigned int HISTORY_SIZE = 10;
+
+private:
+    // the last HISTORY_SIZE inputs, oldest first
+    circular_buffer<double> m_history;
+    int m_rejects;
+    GuideFilterLog *m_log;
+
+    double HistorySlope() const;
+
+public:
+    Lowpass2Filter(GuideFilterLog *log = nullptr);
+
+    void Reset();
+    double Result(double input, double minMove, double aggressiveness);
+};
+
+class ResistSwitchFilter
+{
+public:
+    static const unsigned int HISTORY_SIZE = 10;
+
+private:
+    // the last HISTORY_SIZE inputs, oldest first; m_decHistory is the sum of
+    // the signs of the entries larger than m_minMove
+    circular_buffer<double> m_history;
+    int m_decHistory;
+    double m_minMove;
+    int m_currentSide;
+    GuideFilterLog *m_log;
+
+    int Vote(double val) const;
+    void UpdateDecHistory();
+
+public:
+    ResistSwitchFilter(GuideFilterLog *log = nullptr);
+
+    void Reset();
+    void SetMinMove(double minMove);
+    void ResetSide() { m_currentSide = 0; }
+    double Result(double input, bool fastSwitchEnabled);
+};
+
+inline Lowpass2Filter::Lowpass2Filter(GuideFilterLog *log)
+    : m_history(HISTORY_SIZE),
+      m_log(log)
+{
+    Reset();
+}
+
+inline void Lowpass2Filter::Reset()
+{
+    m_history.clear();
+    m_rejects = 0;
+}
+
+// the CalcSlope() linear regression over the history. The sums are formed in
+// the same order as CalcSlope() so the result is identical; running sums
+// would round differently and could tip the comparison with the input below
+// the other way.
+inline double Lowpass2Filter::HistorySlope() const
+{
+    int nn = (int) m_history.size();
+
+    if (nn < 2)
+        return 0.;
+
+    double s_xy = 0.0;
+    double s_y = 0.0;
+
+    for (int x = 0; x < nn; x++)
+    {
+        s_xy += (double)(x + 1) * m_history[x];
+        s_y += m_history[x];
+    }
+
+    int sx = (nn * (nn + 1)) / 2;
+    int sxx = sx * (2 * nn + 1) / 3;
+    double s_x = (double) sx;
+    double s_xx = (double) sxx;
+    double n = (double) nn;
+    return (n * s_xy - (s_x * s_y)) / (n * s_xx - (s_x * s_x));
+}
+
+inline double Lowpass2Filter::Result(double input, double minMove, double aggressiveness)
+{
+    m_history.push_front(input);
+    unsigned int numpts = m_history.size();
+    double dReturn;
+    double attenuation = aggressiveness / 100.;
+
+    if (numpts < 4)
+        dReturn = input * attenuation;                    // Don't fall behind while we're figuring things out
+    else
+    {
+        if (fabs(input) > 4.0 * minMove)                              // Outlier deflection - dump the history
+        {
+            dReturn = input * attenuation;
+            Reset();
+            numpts = 0;
+            if (m_log)
+                m_log->Log("Lowpass2 history cleared, outlier deflection\n");
+        }
+        else
+            dReturn = HistorySlope() * (double) numpts * attenuation;
+    }
+
+    if (fabs(dReturn) > fabs(input))            // Keep guide pulses below magnitude of last deflection
+    {
+        if (m_log)
+            m_log->Log("GuideAlgorithmLowpass2::Result() input %.2f is < calculated value %.2f, using input\n", input, dReturn);
+        dReturn = input * attenuation;
+        m_rejects++;
+        if (m_rejects > 3)          // 3-in-a-row, our slope is not useful
+        {
+            Reset();
+            if (m_log)
+                m_log->Log("Lowpass2 history cleared, 3 successive rejected correction values\n");
+        }
+    }
+    else
+        m_rejects = 0;
+
+    if (fabs(input) < minMove)
+        dReturn = 0.0;
+
+    if (m_log)
+        m_log->Log("GuideAlgorithmLowpass2::Result() returns %.2f from input %.2f\n", dReturn, input);
+    return dReturn;
+}
+
+inline ResistSwitchFilter::ResistSwitchFilter(GuideFilterLog *log)
+    : m_history(HISTORY_SIZE),
+      m_decHistory(0),
+      m_minMove(0.0),
+      m_currentSide(0),
+      m_log(log)
+{
+    Reset();
+}
+
+inline void ResistSwitchFilter::Reset()
+{
+    m_history.clear();
+
+    while (m_history.size() < HISTORY_SIZE)
+    {
+        m_history.push_front(0.0);
+    }
+
+    m_decHistory = 0;
+    m_currentSide = 0;
+}
+
+static inline int resist_switch_sign(double x)
+{
+    int iReturn = 0;
+
+    if (x > 0.0)
+    {
+        iReturn = 1;
+    }
+    else if (x < 0.0)
+    {
+        iReturn = -1;
+    }
+
+    return iReturn;
+}
+
+inline int ResistSwitchFilter::Vote(double val) const
+{
+    return fabs(val) > m_minMove ? resist_switch_sign(val) : 0;
+}
+
+// recount the votes of the whole history, needed when m_minMove changes
+inline void ResistSwitchFilter::UpdateDecHistory()
+{
+    m_decHistory = 0;
+
+    for (unsigned int i = 0; i < m_history.size(); i++)
+    {
+        m_decHistory += Vote(m_history[i]);
+    }
+}
+
+inline void ResistSwitchFilter::SetMinMove(double minMove)
+{
+    m_minMove = minMove;
+    UpdateDecHistory();
+}
+
+// returns the move before the aggression is applied, 0 when the move is vetoed
+inline double ResistSwitchFilter::Result(double input, bool fastSwitchEnabled)
+{
+    const char *veto = nullptr;
+
+    m_decHistory += Vote(input) - Vote(m_history[0]);
+    m_history.push_front(input);
+
+    do
+    {
+        if (fabs(input) < m_minMove)
+        {
+            veto = "input < m_minMove";
+            break;
+        }
+
+        if (fastSwitchEnabled)
+        {
+            double thresh = 3.0 * m_minMove;
+            if (resist_switch_sign(input) != m_currentSide && fabs(input) > thresh)
+            {
+                if (m_log)
+                    m_log->Log("resist switch: large excursion: input %.2f thresh %.2f direction from %d to %d\n", input, thresh, m_currentSide, resist_switch_sign(input));
+                // force switch
+                m_currentSide = 0;
+                unsigned int i;
+                for (i = 0; i < HISTORY_SIZE - 3; i++)
+                    m_history[i] = 0.0;
+                for (; i < HISTORY_SIZE; i++)
+                    m_history[i] = input;
+                m_decHistory = 3 * Vote(input);
+            }
+        }
+
+        int decHistory = m_decHistory;
+
+        if (m_currentSide == 0 || resist_switch_sign(m_currentSide) == -resist_switch_sign(decHistory))
+        {
+            if (abs(decHistory) < 3)
+            {
+                veto = "not compelling enough";
+                break;
+            }
+
+            double oldest = 0.0;
+            double newest = 0.0;
+
+            for (int i = 0; i < 3; i++)
+            {
+                oldest += m_history[i];
+                newest += m_history[m_history.size() - (i + 1)];
+            }
+
+            if (fabs(newest) <= fabs(oldest))
+            {
+                veto = "Not getting worse";
+                break;
+            }
+
+            if (m_log)
+                m_log->Log("switching direction from %d to %d - decHistory=%d oldest=%.2f newest=%.2f\n", m_currentSide, resist_switch_sign(decHistory), decHistory, oldest, newest);
+
+            m_currentSide = resist_switch_sign(decHistory);
+        }
+
+        if (m_currentSide != resist_switch_sign(input))
+        {
+            veto = "must have overshot -- vetoing move";
+            break;
+        }
+    } while (false);
+
+    double dReturn = input;
+
+    if (veto)
+    {
+        if (m_log)
+            m_log->Log("resist switch: %s\n", veto);
+        dReturn = 0.0;
+    }
+
+    if (m_log)
+        m_log->Log("GuideAlgorithmResistSwitch::Result() returns %.2f from input %.2f\n", dReturn, input);
+
+    return dReturn;
+}
+
+#endif // GUIDE_FILTERS_H_INCLUDED
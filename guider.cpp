@@ -684,6 +684,9 @@ bool Guider::PaintHelper(wxAutoBufferedPaintDCBase& dc, wxMemoryDC& memDC)
 
 void Guider::UpdateImageDisplay(usImage *pImage)
 {
+    if (wxGetApp().IsHeadless())
+        return;
+
     if (!pImage)
     {
         pImage = m_pCurrentImage;
@@ -1008,7 +1011,7 @@ void Guider::SetState(GUIDER_STATE newState)
 
 void Guider::UpdateCurrentDistance(double distance, double distanceRA)
 {
-    m_starFoundTimestamp = wxDateTime::GetTimeNow();
+    m_starFoundTimestamp = PhdClock::TimeNow();
 
     if (IsGuiding())
     {
@@ -1043,7 +1046,7 @@ double Guider::CurrentError(bool raOnly)
         return LARGE_DISTANCE;
     }
 
-    if (wxDateTime::GetTimeNow() - m_starFoundTimestamp > THRESHOLD_SECONDS)
+    if (PhdClock::TimeNow() - m_starFoundTimestamp > THRESHOLD_SECONDS)
     {
         return LARGE_DISTANCE;
     }
@@ -1144,6 +1147,8 @@ void Guider::DisplayImage(usImage *img)
 
     ImageLogger::SaveImage(prev);
 
+    EvtServer.NotifyNewFrame(img);
+
     UpdateImageDisplay();
 }
 
@@ -1151,6 +1156,9 @@ void Guider::DisplayImage(usImage *img)
 
 void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
 {
+    TRACE_SCOPE("UpdateGuideState", "frame", pImage ? pImage->FrameNum : 0);
+    MetricTimer timer(Metrics.processingTime);
+
     wxString statusMessage;
     bool someException = false;
 
@@ -1166,6 +1174,8 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
             m_pCurrentImage = pImage;
 
             ImageLogger::SaveImage(pPrevImage);
+
+            EvtServer.NotifyNewFrame(pImage);
         }
         else
         {
@@ -1229,6 +1239,7 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
                     if (!m_ignoreLostStarLooping)
                     {
                         SetState(STATE_UNINITIALIZED);
+                        Metrics.starLost.Inc();
                         EvtServer.NotifyStarLost(info);
                     }
                     StaticPaTool::NotifyStarLost();
@@ -1237,12 +1248,16 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
                 case STATE_CALIBRATING_SECONDARY:
                     GuideLog.CalibrationFrameDropped(info);
                     Debug.Write("Star lost during calibration... blundering on\n");
+                    Metrics.framesDropped.Inc();
+                    Metrics.starLost.Inc();
                     EvtServer.NotifyStarLost(info);
                     pFrame->StatusMsg(_("star lost"));
                     break;
                 case STATE_GUIDING:
                 {
                     GuideLog.FrameDropped(info);
+                    Metrics.framesDropped.Inc();
+                    Metrics.starLost.Inc();
                     EvtServer.NotifyStarLost(info);
                     GuidingAssistant::NotifyFrameDropped(info);
                     pFrame->pGraphLog->AppendData(info);
@@ -1425,6 +1440,10 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
             case STATE_STOP:
                 break;
         }
+
+        // only count frames that made it all the way through, not the ones
+        // seen while stopping, paused, or after the star was lost
+        Metrics.frames.Inc();
     }
     catch (const wxString& Msg)
     {
@@ -289,6 +289,7 @@ public:
 
     virtual const PHD_Point& CurrentPosition(void) = 0;
     virtual wxRect GetBoundingBox(void) = 0;
+    virtual void GetSearchRegions(std::vector<wxRect> *regions) = 0;
     virtual int GetMaxMovePixels(void) = 0;
     virtual double StarMass(void) = 0;
     virtual unsigned int StarPeakADU(void) = 0;
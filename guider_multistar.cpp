@@ -1,5 +1,5 @@
 /*
- *  guider_onestar.cpp
+ *  guider_multistar.cpp
  *  PHD Guiding
  *
  *  Created by Craig Stark.
@@ -39,6 +39,7 @@
 #include "phd.h"
 
 #include <wx/dir.h>
+#include <wx/stopwatch.h>
 #include <algorithm>
 
 #if ((wxMAJOR_VERSION < 3) && (wxMINOR_VERSION < 9))
@@ -185,6 +186,49 @@ public:
     }
 };
 
+// Predicts where the star will be in the next frame from the move the mount
+// made since the last frame plus the average uncorrected motion, and keeps
+// track of how far off the predictions have been.
+class MotionPredictor
+{
+    PHD_Point m_drift;      // average uncorrected motion per frame
+    double m_errorVar;      // mean squared prediction error
+    PHD_Point m_predicted;
+
+public:
+
+    void Reset(double initialError)
+    {
+        m_drift.SetXY(0.0, 0.0);
+        m_errorVar = initialError * initialError;
+        m_predicted.Invalidate();
+    }
+
+    const PHD_Point& Drift() const { return m_drift; }
+    double Error() const { return sqrt(m_errorVar); }
+
+    const PHD_Point& Predict(const PHD_Point& prev, const PHD_Point& moved)
+    {
+        m_predicted = prev + moved + m_drift;
+        return m_predicted;
+    }
+
+    void Update(const PHD_Point& prev, const PHD_Point& moved, const PHD_Point& found)
+    {
+        // grow quickly when the star jumps, shrink slowly after it settles
+        double const err2 = found.Distance(m_predicted) * found.Distance(m_predicted);
+        double const alpha = err2 > m_errorVar ? 0.5 : 0.1;
+        m_errorVar += alpha * (err2 - m_errorVar);
+
+        m_drift += (found - prev - moved - m_drift) * 0.1;
+    }
+
+    void Lost(double maxError)
+    {
+        m_errorVar = wxMin(m_errorVar * 2.0, maxError * maxError);
+    }
+};
+
 static const double DefaultMassChangeThreshold = 0.5;
 
 enum {
@@ -193,25 +237,52 @@ enum {
     MAX_SEARCH_REGION = 50,
 };
 
-BEGIN_EVENT_TABLE(GuiderOneStar, Guider)
-    EVT_PAINT(GuiderOneStar::OnPaint)
-    EVT_LEFT_DOWN(GuiderOneStar::OnLClick)
+enum {
+    MAX_GUIDE_STARS = 9,        // primary star plus up to 8 secondary stars
+    MAX_MISSED_FRAMES = 20,     // drop a secondary star that has been unusable this long
+};
+
+enum {
+    PATTERN_STARS = 12,             // stars in the pattern used to find a lost star again
+    PATTERN_RADIUS = 384,           // half-size of the window around the primary star the pattern stars come from
+    RECOVERY_MAX_SHIFT = 256,       // largest jump of the star that recovery looks for
+    RECOVERY_LOST_FRAMES = 3,       // frames lost before searching around the last position for the star
+    RECOVERY_TIME_LIMIT_MS = 1000,  // time allowed for finding the stars and matching the pattern
+};
+
+enum {
+    MIN_SUBFRAME_MARGIN = 13,   // room for the background annulus Star::Find measures around the star
+};
+
+static const double PREDICTION_SIGMAS = 4.0;
+
+static const double MIN_OUTLIER_DISTANCE = 2.0;   // pixels
+
+BEGIN_EVENT_TABLE(GuiderMultiStar, Guider)
+    EVT_PAINT(GuiderMultiStar::OnPaint)
+    EVT_LEFT_DOWN(GuiderMultiStar::OnLClick)
 END_EVENT_TABLE()
 
 // Define a constructor for the guide canvas
-GuiderOneStar::GuiderOneStar(wxWindow *parent)
+GuiderMultiStar::GuiderMultiStar(wxWindow *parent)
     : Guider(parent, XWinSize, YWinSize),
-      m_massChecker(new MassChecker())
+      m_massChecker(new MassChecker()),
+      m_motionPredictor(new MotionPredictor()),
+      m_lostFrames(0),
+      m_multiStarEnabled(true),
+      m_recoveryEnabled(true)
 {
+    m_motionPredictor->Reset(0.0);
     SetState(STATE_UNINITIALIZED);
 }
 
-GuiderOneStar::~GuiderOneStar()
+GuiderMultiStar::~GuiderMultiStar()
 {
     delete m_massChecker;
+    delete m_motionPredictor;
 }
 
-void GuiderOneStar::LoadProfileSettings(void)
+void GuiderMultiStar::LoadProfileSettings(void)
 {
     Guider::LoadProfileSettings();
 
@@ -224,25 +295,31 @@ void GuiderOneStar::LoadProfileSettings(void)
 
     int searchRegion = pConfig->Profile.GetInt("/guider/onestar/SearchRegion", DEFAULT_SEARCH_REGION);
     SetSearchRegion(searchRegion);
+
+    bool multiStarEnabled = pConfig->Profile.GetBoolean("/guider/multistar/enabled", true);
+    SetMultiStarEnabled(multiStarEnabled);
+
+    bool recoveryEnabled = pConfig->Profile.GetBoolean("/guider/multistar/recovery", true);
+    SetRecoveryEnabled(recoveryEnabled);
 }
 
-bool GuiderOneStar::GetMassChangeThresholdEnabled() const
+bool GuiderMultiStar::GetMassChangeThresholdEnabled() const
 {
     return m_massChangeThresholdEnabled;
 }
 
-void GuiderOneStar::SetMassChangeThresholdEnabled(bool enable)
+void GuiderMultiStar::SetMassChangeThresholdEnabled(bool enable)
 {
     m_massChangeThresholdEnabled = enable;
     pConfig->Profile.SetBoolean("/guider/onestar/MassChangeThresholdEnabled", enable);
 }
 
-double GuiderOneStar::GetMassChangeThreshold() const
+double GuiderMultiStar::GetMassChangeThreshold() const
 {
     return m_massChangeThreshold;
 }
 
-bool GuiderOneStar::SetMassChangeThreshold(double massChangeThreshold)
+bool GuiderMultiStar::SetMassChangeThreshold(double massChangeThreshold)
 {
     bool bError = false;
 
@@ -268,7 +345,31 @@ bool GuiderOneStar::SetMassChangeThreshold(double massChangeThreshold)
     return bError;
 }
 
-bool GuiderOneStar::SetSearchRegion(int searchRegion)
+bool GuiderMultiStar::GetMultiStarEnabled() const
+{
+    return m_multiStarEnabled;
+}
+
+void GuiderMultiStar::SetMultiStarEnabled(bool enable)
+{
+    m_multiStarEnabled = enable;
+    if (!enable)
+        m_secondaryStars.clear();
+    pConfig->Profile.SetBoolean("/guider/multistar/enabled", enable);
+}
+
+bool GuiderMultiStar::GetRecoveryEnabled() const
+{
+    return m_recoveryEnabled;
+}
+
+void GuiderMultiStar::SetRecoveryEnabled(bool enable)
+{
+    m_recoveryEnabled = enable;
+    pConfig->Profile.SetBoolean("/guider/multistar/recovery", enable);
+}
+
+bool GuiderMultiStar::SetSearchRegion(int searchRegion)
 {
     bool bError = false;
 
@@ -297,7 +398,7 @@ bool GuiderOneStar::SetSearchRegion(int searchRegion)
     return bError;
 }
 
-bool GuiderOneStar::SetCurrentPosition(const usImage *pImage, const PHD_Point& position)
+bool GuiderMultiStar::SetCurrentPosition(const usImage *pImage, const PHD_Point& position)
 {
     bool bError = true;
 
@@ -324,8 +425,19 @@ bool GuiderOneStar::SetCurrentPosition(const usImage *pImage, const PHD_Point& p
         }
 
         m_massChecker->Reset();
+        m_secondaryStars.clear();
+        m_starPattern.Clear();
+        m_lostFrames = 0;
         bError = !m_star.Find(pImage, m_searchRegion, x, y, pFrame->GetStarFindMode(),
                               GetMinStarHFD(), pCamera->GetSaturationADU());
+
+        // remember the star field around the selected star for recovery
+        if (!bError && m_recoveryEnabled && pImage->Subframe.IsEmpty())
+        {
+            std::vector<Star> stars;
+            if (FindStarsNear(*pImage, m_star, PATTERN_RADIUS, m_searchRegion, stars))
+                m_starPattern.Set(stars, m_star);
+        }
     }
     catch (const wxString& Msg)
     {
@@ -335,6 +447,38 @@ bool GuiderOneStar::SetCurrentPosition(const usImage *pImage, const PHD_Point& p
     return bError;
 }
 
+// AutoFind limited to the pixels within halfSize of center, so the time it
+// takes does not grow with the sensor size. Returns true if stars were found.
+static bool FindStarsNear(const usImage& image, const PHD_Point& center, int halfSize, int searchRegion, std::vector<Star>& stars)
+{
+    stars.clear();
+
+    wxRect win(ROUND(center.X) - halfSize, ROUND(center.Y) - halfSize, 2 * halfSize + 1, 2 * halfSize + 1);
+    win.Intersect(wxRect(image.Size));
+    if (win.IsEmpty())
+        return false;
+
+    usImage crop;
+    if (crop.Init(win.GetSize()))
+        return false;
+    crop.BitsPerPixel = image.BitsPerPixel;
+    crop.Pedestal = image.Pedestal;
+
+    for (int y = 0; y < win.GetHeight(); y++)
+    {
+        memcpy(&crop.Pixel(0, y), &image.Pixel(win.GetLeft(), win.GetTop() + y),
+               win.GetWidth() * sizeof(unsigned short));
+    }
+
+    if (!Star::AutoFind(crop, 0, searchRegion, stars, PATTERN_STARS))
+        return false;
+
+    for (Star& star : stars)
+        star.SetXY(star.X + win.GetLeft(), star.Y + win.GetTop());
+
+    return true;
+}
+
 static wxString StarStatusStr(const Star& star)
 {
     if (!star.IsValid())
@@ -374,7 +518,7 @@ static wxString StarStatus(const Star& star)
     return status;
 }
 
-bool GuiderOneStar::AutoSelect(void)
+bool GuiderMultiStar::AutoSelect(void)
 {
     bool error = false;
 
@@ -402,20 +546,32 @@ bool GuiderOneStar::AutoSelect(void)
         if (pSecondaryMount && pSecondaryMount->IsConnected() && !pSecondaryMount->IsCalibrated())
             edgeAllowance = wxMax(edgeAllowance, pSecondaryMount->CalibrationTotDistance());
 
-        Star newStar;
-        if (!newStar.AutoFind(*image, edgeAllowance, m_searchRegion))
+        std::vector<Star> candidates;
+        if (!Star::AutoFind(*image, edgeAllowance, m_searchRegion, candidates, PATTERN_STARS))
         {
             throw ERROR_INFO("Unable to AutoFind");
         }
 
         m_massChecker->Reset();
+        m_secondaryStars.clear();
+        m_starPattern.Clear();
+        m_lostFrames = 0;
 
-        if (!m_star.Find(image, m_searchRegion, newStar.X, newStar.Y, Star::FIND_CENTROID, GetMinStarHFD(),
+        if (!m_star.Find(image, m_searchRegion, candidates[0].X, candidates[0].Y, Star::FIND_CENTROID, GetMinStarHFD(),
                          pCamera->GetSaturationADU()))
         {
             throw ERROR_INFO("Unable to find");
         }
 
+        SetSecondaryStars(image, candidates);
+
+        if (m_recoveryEnabled)
+        {
+            std::vector<Star> stars;
+            if (FindStarsNear(*image, m_star, PATTERN_RADIUS, m_searchRegion, stars))
+                m_starPattern.Set(stars, m_star);
+        }
+
         if (SetLockPosition(m_star))
         {
             throw ERROR_INFO("Unable to set Lock Position");
@@ -445,7 +601,7 @@ bool GuiderOneStar::AutoSelect(void)
     if (image && image->ImageData)
     {
         if (error)
-            Debug.Write("GuiderOneStar::AutoSelect failed.\n");
+            Debug.Write("GuiderMultiStar::AutoSelect failed.\n");
 
         ImageLogger::LogAutoSelectImage(image, !error);
     }
@@ -453,12 +609,12 @@ bool GuiderOneStar::AutoSelect(void)
     return error;
 }
 
-bool GuiderOneStar::IsLocked(void)
+bool GuiderMultiStar::IsLocked(void)
 {
     return m_star.WasFound();
 }
 
-const PHD_Point& GuiderOneStar::CurrentPosition(void)
+const PHD_Point& GuiderMultiStar::CurrentPosition(void)
 {
     return m_star;
 }
@@ -471,7 +627,7 @@ inline static wxRect SubframeRect(const PHD_Point& pos, int halfwidth)
                   2 * halfwidth + 1);
 }
 
-wxRect GuiderOneStar::GetBoundingBox(void)
+wxRect GuiderMultiStar::GetBoundingBox(void)
 {
     enum { SUBFRAME_BOUNDARY_PX = 0 };
 
@@ -479,6 +635,8 @@ wxRect GuiderOneStar::GetBoundingBox(void)
 
     bool subframe;
     PHD_Point pos;
+    PHD_Point target;   // where the pending correction may take the star
+    int halfW = m_searchRegion;
 
     switch (state) {
     case STATE_SELECTED:
@@ -489,13 +647,14 @@ wxRect GuiderOneStar::GetBoundingBox(void)
         break;
     case STATE_GUIDING: {
         subframe = m_star.WasFound();  // true;
-        // As long as the star is close to the lock position, keep the subframe
-        // at the lock position. Otherwise, follow the star.
-        double dist = CurrentPosition().Distance(LockPosition());
-        if ((int) dist > m_searchRegion / 3)
-            pos = CurrentPosition();
-        else
-            pos = LockPosition();
+        // The guide pulse for this frame has not been computed yet, but it
+        // moves the star from where it is now toward the lock position. Cover
+        // that whole path, shifted by the expected drift, with a margin sized
+        // to how well the star position has been predicted lately.
+        pos = CurrentPosition() + m_motionPredictor->Drift();
+        if (LockPosition().IsValid())
+            target = LockPosition() + m_motionPredictor->Drift();
+        halfW = SubframeMargin();
         break;
     }
     default:
@@ -509,7 +668,21 @@ wxRect GuiderOneStar::GetBoundingBox(void)
 
     if (subframe)
     {
-        wxRect box(SubframeRect(pos, m_searchRegion + SUBFRAME_BOUNDARY_PX));
+        // the camera takes a single subframe, so it must cover the secondary stars too
+        std::vector<PHD_Point> offsets(1, PHD_Point(0.0, 0.0));
+        if (UsingSecondaryStars())
+        {
+            for (const SecondaryStar& sec : m_secondaryStars)
+                offsets.push_back(sec.offset);
+        }
+
+        wxRect box(SubframeRect(pos, halfW + SUBFRAME_BOUNDARY_PX));
+        for (const PHD_Point& offset : offsets)
+        {
+            box.Union(SubframeRect(pos + offset, halfW + SUBFRAME_BOUNDARY_PX));
+            if (target.IsValid())
+                box.Union(SubframeRect(target + offset, halfW + SUBFRAME_BOUNDARY_PX));
+        }
         box.Intersect(wxRect(pCamera->FullSize));
         return box;
     }
@@ -519,43 +692,71 @@ wxRect GuiderOneStar::GetBoundingBox(void)
     }
 }
 
-int GuiderOneStar::GetMaxMovePixels(void)
+// where the guide stars are searched for in the next frame
+void GuiderMultiStar::GetSearchRegions(std::vector<wxRect> *regions)
+{
+    regions->clear();
+
+    const PHD_Point& pos = CurrentPosition();
+    if (!pos.IsValid())
+        return;
+
+    regions->push_back(SubframeRect(pos, m_searchRegion));
+    if (UsingSecondaryStars())
+    {
+        for (const SecondaryStar& sec : m_secondaryStars)
+            regions->push_back(SubframeRect(pos + sec.offset, m_searchRegion));
+    }
+}
+
+// Half-width of the subframe around the predicted star positions while
+// guiding. It starts at the search region and shrinks as the predictions
+// settle down, but never below what Star::Find needs around the star.
+int GuiderMultiStar::SubframeMargin()
+{
+    int margin = MIN_SUBFRAME_MARGIN + (int) ceil(PREDICTION_SIGMAS * m_motionPredictor->Error());
+    return wxMin(margin, m_searchRegion);
+}
+
+int GuiderMultiStar::GetMaxMovePixels(void)
 {
     return m_searchRegion;
 }
 
-double GuiderOneStar::StarMass(void)
+double GuiderMultiStar::StarMass(void)
 {
     return m_star.Mass;
 }
 
-unsigned int GuiderOneStar::StarPeakADU(void)
+unsigned int GuiderMultiStar::StarPeakADU(void)
 {
     return m_star.IsValid() ? m_star.PeakVal : 0;
 }
 
-double GuiderOneStar::SNR(void)
+double GuiderMultiStar::SNR(void)
 {
     return m_star.SNR;
 }
 
-double GuiderOneStar::HFD(void)
+double GuiderMultiStar::HFD(void)
 {
     return m_star.HFD;
 }
 
-int GuiderOneStar::StarError(void)
+int GuiderMultiStar::StarError(void)
 {
     return m_star.GetError();
 }
 
-void GuiderOneStar::InvalidateCurrentPosition(bool fullReset)
+void GuiderMultiStar::InvalidateCurrentPosition(bool fullReset)
 {
     m_star.Invalidate();
 
     if (fullReset)
     {
         m_star.X = m_star.Y = 0.0;
+        m_secondaryStars.clear();
+        m_starPattern.Clear();
     }
 }
 
@@ -575,6 +776,11 @@ struct DistanceChecker
         expires = ::wxGetUTCTimeMillis().GetValue() + ENABLED_INTERVAL_MS;
     }
 
+    void Deactivate()
+    {
+        enabled = false;
+    }
+
     bool CheckDistance(double distance)
     {
         if (!enabled)
@@ -606,7 +812,220 @@ struct DistanceChecker
 
 static DistanceChecker s_distanceChecker;
 
-bool GuiderOneStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset *ofs, FrameDroppedInfo *errorInfo)
+bool GuiderMultiStar::UsingSecondaryStars()
+{
+    return m_multiStarEnabled && !m_secondaryStars.empty() && GetState() == STATE_GUIDING;
+}
+
+void GuiderMultiStar::SetSecondaryStars(const usImage *pImage, const std::vector<Star>& candidates)
+{
+    m_secondaryStars.clear();
+
+    if (!m_multiStarEnabled)
+        return;
+
+    // candidates[0] is the primary star
+    for (size_t i = 1; i < candidates.size() && m_secondaryStars.size() + 1 < MAX_GUIDE_STARS; i++)
+    {
+        SecondaryStar star;
+        if (!star.Find(pImage, m_searchRegion, ROUND(candidates[i].X), ROUND(candidates[i].Y), Star::FIND_CENTROID,
+                       GetMinStarHFD(), pCamera->GetSaturationADU()))
+        {
+            continue;
+        }
+
+        star.offset = star - m_star;
+        star.massChecker = std::make_shared<MassChecker>();
+        star.missedFrames = 0;
+        m_secondaryStars.push_back(star);
+
+        Debug.Write(wxString::Format("MultiStar: secondary star at (%.1f, %.1f) offset (%.1f, %.1f) SNR %.1f\n",
+            star.X, star.Y, star.offset.X, star.offset.Y, star.SNR));
+    }
+}
+
+bool GuiderMultiStar::CheckStarMass(MassChecker *massChecker, const Star& star, double limits[4])
+{
+    if (!m_massChangeThresholdEnabled)
+        return false;
+
+    int exposure;
+    bool isAutoExp;
+    pFrame->GetExposureInfo(&exposure, &isAutoExp);
+    massChecker->SetExposure(exposure, isAutoExp);
+
+    return massChecker->CheckMass(star.Mass, m_massChangeThreshold, limits);
+}
+
+// After the star has been lost for a few frames, look for the star field
+// around it in the whole frame. This finds the star after a jump larger than
+// the search region, like a mount hiccup or the end of a cloud.
+bool GuiderMultiStar::RecoverStar(const usImage *pImage, PHD_Point *pos)
+{
+    if (!m_recoveryEnabled || !m_starPattern.IsValid() || !pImage->Subframe.IsEmpty())
+        return false;
+
+    wxStopWatch swatch;
+
+    // the pattern stars are within PATTERN_RADIUS of the star, so after a
+    // jump of up to RECOVERY_MAX_SHIFT they are all inside this window
+    std::vector<Star> stars;
+    if (!FindStarsNear(*pImage, m_star, PATTERN_RADIUS + RECOVERY_MAX_SHIFT, m_searchRegion, stars))
+    {
+        Debug.Write(wxString::Format("RecoverStar: no stars found in %ld ms\n", swatch.Time()));
+        return false;
+    }
+
+    long const timeLeft = RECOVERY_TIME_LIMIT_MS - swatch.Time();
+    if (timeLeft <= 0)
+    {
+        Debug.Write(wxString::Format("RecoverStar: no time left for matching after %ld ms\n", swatch.Time()));
+        return false;
+    }
+
+    PHD_Point found;
+    if (!m_starPattern.Match(stars, &found, timeLeft))
+    {
+        Debug.Write(wxString::Format("RecoverStar: star pattern not matched, %u stars, %ld ms\n",
+            (unsigned int) stars.size(), swatch.Time()));
+        return false;
+    }
+
+    if (found.X < 0.0 || found.X >= pImage->Size.x || found.Y < 0.0 || found.Y >= pImage->Size.y)
+    {
+        Debug.Write(wxString::Format("RecoverStar: star is off the frame at (%.1f, %.1f)\n", found.X, found.Y));
+        return false;
+    }
+
+    Debug.Write(wxString::Format("RecoverStar: star moved from (%.1f, %.1f) to (%.1f, %.1f) after %u lost frames, %ld ms\n",
+        m_star.X, m_star.Y, found.X, found.Y, m_lostFrames, swatch.Time()));
+    pFrame->StatusMsg(_("Star recovered"));
+
+    *pos = found;
+    return true;
+}
+
+static double Median(std::vector<double> v)
+{
+    size_t const mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    double med = v[mid];
+    if (v.size() % 2 == 0)
+        med = (med + *std::max_element(v.begin(), v.begin() + mid)) / 2.0;
+    return med;
+}
+
+// Each star found gives an estimate of the primary star position. Estimates
+// far from the consensus are dropped and the rest are averaged with weights
+// SNR^2, since the centroid variance goes as 1/SNR^2. Returns the number of
+// stars used, and the index in stars of the one with the highest SNR.
+int GuiderMultiStar::CombineStarPositions(const std::vector<Star>& stars, const std::vector<char>& found, bool primaryOk,
+                                          PHD_Point *pos, size_t *brightest)
+{
+    struct Estimate
+    {
+        size_t idx;
+        PHD_Point pos;
+        double weight;
+    };
+
+    std::vector<Estimate> est;
+
+    if (primaryOk)
+        est.push_back({ 0, stars[0], stars[0].SNR * stars[0].SNR });
+
+    for (size_t i = 1; i < stars.size(); i++)
+    {
+        SecondaryStar& sec = m_secondaryStars[i - 1];
+        ++sec.missedFrames;
+
+        if (!found[i])
+            continue;
+
+        const Star& star = stars[i];
+        double limits[4];
+        if (CheckStarMass(sec.massChecker.get(), star, limits))
+        {
+            Debug.Write(wxString::Format("MultiStar: secondary star %u mass %.f rejected, expected %.f\n",
+                (unsigned int) i, star.Mass, limits[1]));
+            sec.massChecker->AppendData(star.Mass);
+            continue;
+        }
+
+        est.push_back({ i, star - sec.offset, star.SNR * star.SNR });
+    }
+
+    int nused = 0;
+
+    if (!est.empty())
+    {
+        std::vector<double> xs, ys;
+        for (const Estimate& e : est)
+        {
+            xs.push_back(e.pos.X);
+            ys.push_back(e.pos.Y);
+        }
+        PHD_Point const consensus(Median(xs), Median(ys));
+
+        std::vector<double> dev;
+        for (const Estimate& e : est)
+            dev.push_back(e.pos.Distance(consensus));
+        double const maxDev = wxMax(MIN_OUTLIER_DISTANCE, 3.0 * 1.4826 * Median(dev));
+
+        double sw = 0.0, sx = 0.0, sy = 0.0;
+        double bestSNR = -1.0;
+
+        for (size_t k = 0; k < est.size(); k++)
+        {
+            const Estimate& e = est[k];
+            const Star& star = stars[e.idx];
+
+            if (dev[k] > maxDev)
+            {
+                Debug.Write(wxString::Format("MultiStar: star %u is %.2f px from the consensus position, limit %.2f\n",
+                    (unsigned int) e.idx, dev[k], maxDev));
+                continue;
+            }
+
+            if (e.idx > 0)
+            {
+                SecondaryStar& sec = m_secondaryStars[e.idx - 1];
+                sec.massChecker->AppendData(star.Mass);
+                sec.missedFrames = 0;
+            }
+
+            sw += e.weight;
+            sx += e.weight * e.pos.X;
+            sy += e.weight * e.pos.Y;
+            ++nused;
+
+            if (star.SNR > bestSNR)
+            {
+                bestSNR = star.SNR;
+                *brightest = e.idx;
+            }
+        }
+
+        pos->SetXY(sx / sw, sy / sw);
+    }
+
+    // drop secondary stars that have not been usable for a while, like a
+    // star that drifted off the frame or one that was confused with a neighbor
+    for (auto it = m_secondaryStars.begin(); it != m_secondaryStars.end(); )
+    {
+        if (it->missedFrames > MAX_MISSED_FRAMES)
+        {
+            Debug.Write(wxString::Format("MultiStar: dropping secondary star at offset (%.1f, %.1f)\n", it->offset.X, it->offset.Y));
+            it = m_secondaryStars.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    return nused;
+}
+
+bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset *ofs, FrameDroppedInfo *errorInfo)
 {
     if (!m_star.IsValid() && m_star.X == 0.0 && m_star.Y == 0.0)
     {
@@ -623,53 +1042,117 @@ bool GuiderOneStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset *o
 
     try
     {
-        Star newStar(m_star);
+        // While guiding, the secondary stars are measured along with the
+        // primary star at their positions relative to it. The measurements are
+        // independent, so they run in parallel.
+        bool const useSecondaries = UsingSecondaryStars();
+
+        // While guiding, look for the star where the last guide pulse should
+        // have put it rather than where it was, so a large correction does
+        // not take it out of the search region.
+        PHD_Point moved(0.0, 0.0);
+        PHD_Point expected(m_star);
+        bool recovered = false;
+        if (GetState() == STATE_GUIDING)
+        {
+            PHD_Point displacement = pMount ? pMount->MoveDisplacement((int) pImage->FrameNum - 1) : PHD_Point();
+            if (displacement.IsValid())
+                moved = displacement;
+            expected = m_motionPredictor->Predict(m_star, moved);
 
-        if (!newStar.Find(pImage, m_searchRegion, pFrame->GetStarFindMode(), GetMinStarHFD(),
-                          pCamera->GetSaturationADU()))
+            if (m_lostFrames >= RECOVERY_LOST_FRAMES)
+                recovered = RecoverStar(pImage, &expected);
+        }
+        else
+            m_motionPredictor->Reset(m_searchRegion / PREDICTION_SIGMAS);
+
+        std::vector<Star> stars(1, m_star);
+        stars[0].SetXY(expected.X, expected.Y);
+        if (useSecondaries)
+        {
+            for (const SecondaryStar& sec : m_secondaryStars)
+            {
+                Star star(sec);
+                star.SetXY(expected.X + sec.offset.X, expected.Y + sec.offset.Y);
+                stars.push_back(star);
+            }
+        }
+
+        std::vector<char> found(stars.size());
+        Star::FindMode const findMode = pFrame->GetStarFindMode();
+        double const minHFD = GetMinStarHFD();
+        unsigned short const saturation = pCamera->GetSaturationADU();
+
+        ComputePool::ParallelFor((int) stars.size(), 1, [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+                found[i] = stars[i].Find(pImage, m_searchRegion, findMode, minHFD, saturation);
+        });
+
+        Star newStar(stars[0]);
+        bool primaryOk = found[0] != 0;
+        double limits[4];
+
+        if (!primaryOk)
         {
             errorInfo->starError = newStar.GetError();
             errorInfo->starMass = 0.0;
             errorInfo->starSNR = 0.0;
             errorInfo->status = StarStatusStr(newStar);
             m_star.SetError(newStar.GetError());
-
-            s_distanceChecker.Activate();
-            ImageLogger::LogImage(pImage, *errorInfo);
-
-            throw ERROR_INFO("UpdateCurrentPosition():newStar not found");
         }
-
         // check to see if it seems like the star we just found was the
         // same as the original star by comparing the mass
-        if (m_massChangeThresholdEnabled)
+        else if (CheckStarMass(m_massChecker, newStar, limits))
+        {
+            m_star.SetError(Star::STAR_MASSCHANGE);
+            errorInfo->starError = Star::STAR_MASSCHANGE;
+            errorInfo->starMass = newStar.Mass;
+            errorInfo->starSNR = newStar.SNR;
+            errorInfo->status = StarStatusStr(m_star);
+            pFrame->StatusMsg(wxString::Format(_("Mass: %.f vs %.f"), newStar.Mass, limits[1]));
+            Debug.Write(wxString::Format("UpdateCurrentPosition: star mass new=%.1f exp=%.1f thresh=%.0f%% limits=(%.1f, %.1f, %.1f)\n", newStar.Mass, limits[1], m_massChangeThreshold * 100., limits[0], limits[2], limits[3]));
+            m_massChecker->AppendData(newStar.Mass);
+            primaryOk = false;
+        }
+
+        bool haveStar = primaryOk;
+
+        if (useSecondaries)
         {
-            int exposure;
-            bool isAutoExp;
-            pFrame->GetExposureInfo(&exposure, &isAutoExp);
-            m_massChecker->SetExposure(exposure, isAutoExp);
-            double limits[4];
-            if (m_massChecker->CheckMass(newStar.Mass, m_massChangeThreshold, limits))
+            PHD_Point pos;
+            size_t brightest = 0;
+            int nused = CombineStarPositions(stars, found, primaryOk, &pos, &brightest);
+
+            if (nused > 0)
             {
-                m_star.SetError(Star::STAR_MASSCHANGE);
-                errorInfo->starError = Star::STAR_MASSCHANGE;
-                errorInfo->starMass = newStar.Mass;
-                errorInfo->starSNR = newStar.SNR;
-                errorInfo->status = StarStatusStr(m_star);
-                pFrame->StatusMsg(wxString::Format(_("Mass: %.f vs %.f"), newStar.Mass, limits[1]));
-                Debug.Write(wxString::Format("UpdateCurrentPosition: star mass new=%.1f exp=%.1f thresh=%.0f%% limits=(%.1f, %.1f, %.1f)\n", newStar.Mass, limits[1], m_massChangeThreshold * 100., limits[0], limits[2], limits[3]));
-                m_massChecker->AppendData(newStar.Mass);
-
-                s_distanceChecker.Activate();
-                ImageLogger::LogImage(pImage, *errorInfo);
-
-                throw THROW_INFO("massChangeThreshold error");
+                if (!primaryOk)
+                {
+                    // keep guiding on the secondary stars; the primary star
+                    // will be looked for at the combined position next time
+                    Debug.Write(wxString::Format("MultiStar: primary star not usable, guiding on %d secondary stars\n", nused));
+                    newStar = stars[brightest];
+                    haveStar = true;
+                }
+                newStar.SetXY(pos.X, pos.Y);
             }
         }
 
+        if (!haveStar)
+        {
+            s_distanceChecker.Activate();
+            ImageLogger::LogImage(pImage, *errorInfo);
+
+            throw ERROR_INFO("UpdateCurrentPosition(): no usable guide star");
+        }
+
         const PHD_Point& lockPos = LockPosition();
         double distance = lockPos.IsValid() ? newStar.Distance(lockPos) : -1.;
 
+        // the star pattern match already shows that this is the guide star
+        // and not something passing through the search region
+        if (recovered)
+            s_distanceChecker.Deactivate();
+
         if (!s_distanceChecker.CheckDistance(distance))
         {
             m_star.SetError(Star::STAR_ERROR);
@@ -686,9 +1169,16 @@ bool GuiderOneStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset *o
 
         ImageLogger::LogImage(pImage, distance);
 
+        if (recovered)
+            m_motionPredictor->Reset(m_searchRegion / PREDICTION_SIGMAS);
+        else if (GetState() == STATE_GUIDING)
+            m_motionPredictor->Update(m_star, moved, newStar);
+
         // update the star position, mass, etc.
         m_star = newStar;
-        m_massChecker->AppendData(newStar.Mass);
+        m_lostFrames = 0;
+        if (primaryOk)
+            m_massChecker->AppendData(newStar.Mass);
 
         if (lockPos.IsValid())
         {
@@ -709,13 +1199,15 @@ bool GuiderOneStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset *o
     {
         POSSIBLY_UNUSED(Msg);
         bError = true;
+        ++m_lostFrames;
+        m_motionPredictor->Lost(m_searchRegion / PREDICTION_SIGMAS);
         pFrame->ResetAutoExposure(); // use max exposure duration
     }
 
     return bError;
 }
 
-bool GuiderOneStar::IsValidLockPosition(const PHD_Point& pt)
+bool GuiderMultiStar::IsValidLockPosition(const PHD_Point& pt)
 {
     const usImage *pImage = CurrentImage();
     if (!pImage)
@@ -727,7 +1219,7 @@ bool GuiderOneStar::IsValidLockPosition(const PHD_Point& pt)
         pt.Y + 1 + m_searchRegion < pImage->Size.GetY();
 }
 
-void GuiderOneStar::OnLClick(wxMouseEvent &mevent)
+void GuiderMultiStar::OnLClick(wxMouseEvent &mevent)
 {
     try
     {
@@ -810,7 +1302,7 @@ inline static void DrawBox(wxDC& dc, const PHD_Point& star, int halfW, double sc
 }
 
 // Define the repainting behaviour
-void GuiderOneStar::OnPaint(wxPaintEvent& event)
+void GuiderMultiStar::OnPaint(wxPaintEvent& event)
 {
     wxAutoBufferedPaintDC dc(this);
     wxMemoryDC memDC;
@@ -866,6 +1358,14 @@ void GuiderOneStar::OnPaint(wxPaintEvent& event)
                 dc.SetPen(wxPen(wxColour(230,130,30), 1, wxDOT));
             DrawBox(dc, m_star, m_searchRegion, m_scaleFactor);
         }
+
+        // secondary stars
+        if (m_multiStarEnabled && state >= STATE_SELECTED && !m_secondaryStars.empty())
+        {
+            dc.SetPen(wxPen(wxColour(0,160,255), 1, wxSOLID));
+            for (const SecondaryStar& sec : m_secondaryStars)
+                DrawBox(dc, m_star + sec.offset, m_searchRegion, m_scaleFactor);
+        }
     }
     catch (const wxString& Msg)
     {
@@ -873,7 +1373,7 @@ void GuiderOneStar::OnPaint(wxPaintEvent& event)
     }
 }
 
-void GuiderOneStar::SaveStarFITS()
+void GuiderMultiStar::SaveStarFITS()
 {
     double StarX = m_star.X;
     double StarY = m_star.Y;
@@ -932,7 +1432,7 @@ void GuiderOneStar::SaveStarFITS()
     PHD_fits_close_file(fptr);
 }
 
-wxString GuiderOneStar::GetSettingsSummary() const
+wxString GuiderMultiStar::GetSettingsSummary() const
 {
     // return a loggable summary of guider configs
     wxString s = wxString::Format(_T("Search region = %d px, Star mass tolerance "), GetSearchRegion());
@@ -942,35 +1442,38 @@ wxString GuiderOneStar::GetSettingsSummary() const
     else
         s += _T("disabled\n");
 
+    s += wxString::Format(_T("Multi-star mode = %s\n"), GetMultiStarEnabled() ? _T("enabled") : _T("disabled"));
+    s += wxString::Format(_T("Lost star recovery = %s\n"), GetRecoveryEnabled() ? _T("enabled") : _T("disabled"));
+
     return s;
 }
 
-Guider::GuiderConfigDialogPane *GuiderOneStar::GetConfigDialogPane(wxWindow *pParent)
+Guider::GuiderConfigDialogPane *GuiderMultiStar::GetConfigDialogPane(wxWindow *pParent)
 {
-    return new GuiderOneStarConfigDialogPane(pParent, this);
+    return new GuiderMultiStarConfigDialogPane(pParent, this);
 }
 
-GuiderOneStar::GuiderOneStarConfigDialogPane::GuiderOneStarConfigDialogPane(wxWindow *pParent, GuiderOneStar *pGuider)
+GuiderMultiStar::GuiderMultiStarConfigDialogPane::GuiderMultiStarConfigDialogPane(wxWindow *pParent, GuiderMultiStar *pGuider)
     : GuiderConfigDialogPane(pParent, pGuider)
 {
 
 }
 
-void GuiderOneStar::GuiderOneStarConfigDialogPane::LayoutControls(Guider *pGuider, BrainCtrlIdMap& CtrlMap)
+void GuiderMultiStar::GuiderMultiStarConfigDialogPane::LayoutControls(Guider *pGuider, BrainCtrlIdMap& CtrlMap)
 {
     GuiderConfigDialogPane::LayoutControls(pGuider, CtrlMap);
 }
 
-GuiderConfigDialogCtrlSet* GuiderOneStar::GetConfigDialogCtrlSet(wxWindow *pParent, Guider *pGuider, AdvancedDialog *pAdvancedDialog, BrainCtrlIdMap& CtrlMap)
+GuiderConfigDialogCtrlSet* GuiderMultiStar::GetConfigDialogCtrlSet(wxWindow *pParent, Guider *pGuider, AdvancedDialog *pAdvancedDialog, BrainCtrlIdMap& CtrlMap)
 {
-    return new GuiderOneStarConfigDialogCtrlSet(pParent, pGuider, pAdvancedDialog, CtrlMap);
+    return new GuiderMultiStarConfigDialogCtrlSet(pParent, pGuider, pAdvancedDialog, CtrlMap);
 }
 
-GuiderOneStarConfigDialogCtrlSet::GuiderOneStarConfigDialogCtrlSet(wxWindow *pParent, Guider *pGuider, AdvancedDialog *pAdvancedDialog, BrainCtrlIdMap& CtrlMap)
+GuiderMultiStarConfigDialogCtrlSet::GuiderMultiStarConfigDialogCtrlSet(wxWindow *pParent, Guider *pGuider, AdvancedDialog *pAdvancedDialog, BrainCtrlIdMap& CtrlMap)
     : GuiderConfigDialogCtrlSet(pParent, pGuider, pAdvancedDialog, CtrlMap)
 {
     assert(pGuider);
-    m_pGuiderOneStar = static_cast<GuiderOneStar *>(pGuider);
+    m_pGuiderMultiStar = static_cast<GuiderMultiStar *>(pGuider);
 
     int width;
 
@@ -985,7 +1488,7 @@ GuiderOneStarConfigDialogCtrlSet::GuiderOneStarConfigDialogCtrlSet(wxWindow *pPa
     m_pEnableStarMassChangeThresh->SetToolTip(_("Check to enable star mass change detection. When enabled, "
         "PHD skips frames when the guide star mass changes by an amount greater than the setting for 'tolerance'."));
 
-    GetParentWindow(AD_szStarTracking)->Bind(wxEVT_COMMAND_CHECKBOX_CLICKED, &GuiderOneStarConfigDialogCtrlSet::OnStarMassEnableChecked, this, STAR_MASS_ENABLE);
+    GetParentWindow(AD_szStarTracking)->Bind(wxEVT_COMMAND_CHECKBOX_CLICKED, &GuiderMultiStarConfigDialogCtrlSet::OnStarMassEnableChecked, this, STAR_MASS_ENABLE);
 
     width = StringWidth(_T("100.0"));
     m_pMassChangeThreshold = pFrame->MakeSpinCtrlDouble(pParent, wxID_ANY, wxEmptyString, wxDefaultPosition,
@@ -1010,41 +1513,55 @@ GuiderOneStarConfigDialogCtrlSet::GuiderOneStarConfigDialogCtrlSet(wxWindow *pPa
           "This setting can be used to prevent PHD2 from guiding on a hot pixel. "
           "Use the Star Profile Tool to measure the HFD of a hot pixel and set the min HFD threshold "
           "a bit higher. When the HFD falls below this level, the hot pixel will be ignored."));
+    m_pUseMultiStar = new wxCheckBox(parent, wxID_ANY, _("Use multiple stars"));
+    m_pUseMultiStar->SetToolTip(_("When this option is enabled, PHD2 auto-selects additional guide stars along with the "
+        "primary star and guides on their combined position. This reduces the effect of seeing on the guide star "
+        "position, and guiding continues if the primary star is briefly lost. Manual star selection always uses a single star."));
+    m_pRecoverLostStar = new wxCheckBox(parent, wxID_ANY, _("Recover lost star"));
+    m_pRecoverLostStar->SetToolTip(_("When this option is enabled and the guide star has been lost for a few frames, "
+        "PHD2 searches the whole frame for the stars around the guide star and resumes guiding on the guide star "
+        "at its new position. This recovers from jumps larger than the search region."));
     wxFlexGridSizer *pTrackingParams = new wxFlexGridSizer(3, 2, 8, 15);
     pTrackingParams->Add(pSearchRegion, wxSizerFlags(0).Border(wxTOP, 12));
     pTrackingParams->Add(pStarMass,wxSizerFlags(0).Border(wxLEFT, 75));
     pTrackingParams->Add(pHFD, wxSizerFlags().Border(wxTOP, 3));
+    pTrackingParams->Add(m_pUseMultiStar, wxSizerFlags(0).Border(wxLEFT, 75).Border(wxTOP, 6));
+    pTrackingParams->Add(m_pRecoverLostStar, wxSizerFlags(0).Border(wxTOP, 6));
 
     AddGroup(CtrlMap, AD_szStarTracking, pTrackingParams);
 }
 
-GuiderOneStarConfigDialogCtrlSet::~GuiderOneStarConfigDialogCtrlSet()
+GuiderMultiStarConfigDialogCtrlSet::~GuiderMultiStarConfigDialogCtrlSet()
 {
 
 }
 
-void GuiderOneStarConfigDialogCtrlSet::LoadValues()
+void GuiderMultiStarConfigDialogCtrlSet::LoadValues()
 {
-    bool starMassEnabled = m_pGuiderOneStar->GetMassChangeThresholdEnabled();
+    bool starMassEnabled = m_pGuiderMultiStar->GetMassChangeThresholdEnabled();
     m_pEnableStarMassChangeThresh->SetValue(starMassEnabled);
     m_pMassChangeThreshold->Enable(starMassEnabled);
-    m_pMassChangeThreshold->SetValue(100.0 * m_pGuiderOneStar->GetMassChangeThreshold());
-    m_pSearchRegion->SetValue(m_pGuiderOneStar->GetSearchRegion());
-    m_MinHFD->SetValue(m_pGuiderOneStar->GetMinStarHFD());
+    m_pMassChangeThreshold->SetValue(100.0 * m_pGuiderMultiStar->GetMassChangeThreshold());
+    m_pSearchRegion->SetValue(m_pGuiderMultiStar->GetSearchRegion());
+    m_MinHFD->SetValue(m_pGuiderMultiStar->GetMinStarHFD());
+    m_pUseMultiStar->SetValue(m_pGuiderMultiStar->GetMultiStarEnabled());
+    m_pRecoverLostStar->SetValue(m_pGuiderMultiStar->GetRecoveryEnabled());
 
     GuiderConfigDialogCtrlSet::LoadValues();
 }
 
-void GuiderOneStarConfigDialogCtrlSet::UnloadValues()
+void GuiderMultiStarConfigDialogCtrlSet::UnloadValues()
 {
-    m_pGuiderOneStar->SetMassChangeThresholdEnabled(m_pEnableStarMassChangeThresh->GetValue());
-    m_pGuiderOneStar->SetMassChangeThreshold(m_pMassChangeThreshold->GetValue() / 100.0);
-    m_pGuiderOneStar->SetSearchRegion(m_pSearchRegion->GetValue());
-    m_pGuiderOneStar->SetMinStarHFD(m_MinHFD->GetValue());
+    m_pGuiderMultiStar->SetMassChangeThresholdEnabled(m_pEnableStarMassChangeThresh->GetValue());
+    m_pGuiderMultiStar->SetMassChangeThreshold(m_pMassChangeThreshold->GetValue() / 100.0);
+    m_pGuiderMultiStar->SetSearchRegion(m_pSearchRegion->GetValue());
+    m_pGuiderMultiStar->SetMinStarHFD(m_MinHFD->GetValue());
+    m_pGuiderMultiStar->SetMultiStarEnabled(m_pUseMultiStar->GetValue());
+    m_pGuiderMultiStar->SetRecoveryEnabled(m_pRecoverLostStar->GetValue());
     GuiderConfigDialogCtrlSet::UnloadValues();
 }
 
-void GuiderOneStarConfigDialogCtrlSet::OnStarMassEnableChecked(wxCommandEvent& event)
+void GuiderMultiStarConfigDialogCtrlSet::OnStarMassEnableChecked(wxCommandEvent& event)
 {
     m_pMassChangeThreshold->Enable(event.IsChecked());
 }
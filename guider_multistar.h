@@ -1,5 +1,5 @@
 /*
- *  guider_onestar.h
+ *  guider_multistar.h
  *  PHD Guiding
  *
  *  Created by Craig Stark.
@@ -37,49 +37,69 @@
  *
  */
 
-#ifndef GUIDER_ONESTAR_H_INCLUDED
-#define GUIDER_ONESTAR_H_INCLUDED
+#ifndef GUIDER_MULTISTAR_H_INCLUDED
+#define GUIDER_MULTISTAR_H_INCLUDED
+
+#include <memory>
+#include <vector>
 
 class MassChecker;
-class GuiderOneStar;
+class MotionPredictor;
+class GuiderMultiStar;
 class GuiderConfigDialogCtrlSet;
 
-class GuiderOneStarConfigDialogCtrlSet : public GuiderConfigDialogCtrlSet
+class GuiderMultiStarConfigDialogCtrlSet : public GuiderConfigDialogCtrlSet
 {
 
 public:
-    GuiderOneStarConfigDialogCtrlSet(wxWindow *pParent, Guider *pGuider, AdvancedDialog *pAdvancedDialog, BrainCtrlIdMap& CtrlMap);
-    virtual ~GuiderOneStarConfigDialogCtrlSet();
+    GuiderMultiStarConfigDialogCtrlSet(wxWindow *pParent, Guider *pGuider, AdvancedDialog *pAdvancedDialog, BrainCtrlIdMap& CtrlMap);
+    virtual ~GuiderMultiStarConfigDialogCtrlSet();
 
-    GuiderOneStar *m_pGuiderOneStar;
+    GuiderMultiStar *m_pGuiderMultiStar;
     wxSpinCtrl *m_pSearchRegion;
     wxCheckBox *m_pEnableStarMassChangeThresh;
     wxSpinCtrlDouble *m_pMassChangeThreshold;
     wxSpinCtrlDouble *m_MinHFD;
+    wxCheckBox *m_pUseMultiStar;
+    wxCheckBox *m_pRecoverLostStar;
 
     virtual void LoadValues(void);
     virtual void UnloadValues(void);
     void OnStarMassEnableChecked(wxCommandEvent& event);
 };
 
-class GuiderOneStar : public Guider
+class GuiderMultiStar : public Guider
 {
+    // an additional star measured alongside the primary star while guiding
+    struct SecondaryStar : public Star
+    {
+        PHD_Point offset;                           // position relative to the primary star
+        std::shared_ptr<MassChecker> massChecker;
+        unsigned int missedFrames;                  // consecutive frames the star was not used
+    };
+
 private:
-    Star m_star;
+    Star m_star;        // the primary star; while guiding, its position is the combined position of all the stars used
     MassChecker *m_massChecker;
+    MotionPredictor *m_motionPredictor;
+    std::vector<SecondaryStar> m_secondaryStars;
+    StarPattern m_starPattern;  // the star field around the primary star when it was selected
+    unsigned int m_lostFrames;  // consecutive frames without a usable star
 
     // parameters
     bool m_massChangeThresholdEnabled;
     double m_massChangeThreshold;
+    bool m_multiStarEnabled;
+    bool m_recoveryEnabled;
 
 public:
-    class GuiderOneStarConfigDialogPane : public GuiderConfigDialogPane
+    class GuiderMultiStarConfigDialogPane : public GuiderConfigDialogPane
     {
     protected:
 
         public:
-        GuiderOneStarConfigDialogPane(wxWindow *pParent, GuiderOneStar *pGuider);
-        ~GuiderOneStarConfigDialogPane(void) {};
+        GuiderMultiStarConfigDialogPane(wxWindow *pParent, GuiderMultiStar *pGuider);
+        ~GuiderMultiStarConfigDialogPane(void) {};
 
         virtual void LoadValues(void) {};
         virtual void UnloadValues(void) {};
@@ -91,13 +111,17 @@ public:
     double GetMassChangeThreshold() const;
     bool SetMassChangeThreshold(double starMassChangeThreshold);
     bool SetSearchRegion(int searchRegion);
+    bool GetMultiStarEnabled() const;
+    void SetMultiStarEnabled(bool enable);
+    bool GetRecoveryEnabled() const;
+    void SetRecoveryEnabled(bool enable);
 
-    friend class GuiderOneStarConfigDialogPane;
-    friend class GuiderOneStarConfigDialogCtrlSet;
+    friend class GuiderMultiStarConfigDialogPane;
+    friend class GuiderMultiStarConfigDialogCtrlSet;
 
 public:
-    GuiderOneStar(wxWindow *parent);
-    virtual ~GuiderOneStar(void);
+    GuiderMultiStar(wxWindow *parent);
+    virtual ~GuiderMultiStar(void);
 
     void OnPaint(wxPaintEvent& evt) override;
 
@@ -105,6 +129,7 @@ public:
     bool AutoSelect(void) override;
     const PHD_Point& CurrentPosition(void) override;
     wxRect GetBoundingBox(void) override;
+    void GetSearchRegions(std::vector<wxRect> *regions) override;
     int GetMaxMovePixels(void) override;
     double StarMass(void) override;
     unsigned int StarPeakADU(void) override;
@@ -124,6 +149,13 @@ private:
     bool UpdateCurrentPosition(const usImage *pImage, GuiderOffset *ofs, FrameDroppedInfo *errorInfo) final;
     bool SetCurrentPosition(const usImage *pImage, const PHD_Point& position) final;
 
+    bool UsingSecondaryStars();
+    int SubframeMargin();
+    void SetSecondaryStars(const usImage *pImage, const std::vector<Star>& candidates);
+    bool RecoverStar(const usImage *pImage, PHD_Point *pos);
+    bool CheckStarMass(MassChecker *massChecker, const Star& star, double limits[4]);
+    int CombineStarPositions(const std::vector<Star>& stars, const std::vector<char>& found, bool primaryOk, PHD_Point *pos, size_t *brightest);
+
     void OnLClick(wxMouseEvent& evt);
 
     void SaveStarFITS();
@@ -131,4 +163,4 @@ private:
     DECLARE_EVENT_TABLE()
 };
 
-#endif /* GUIDER_ONESTAR_H_INCLUDED */
+#endif /* GUIDER_MULTISTAR_H_INCLUDED */
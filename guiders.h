@@ -37,6 +37,6 @@
 #define GUIDERS_H_INCLUDED
 
 #include "guider.h"
-#include "guider_onestar.h"
+#include "guider_multistar.h"
 
 #endif /* GUIDERS_H_INCLUDED */
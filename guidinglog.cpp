@@ -257,7 +257,7 @@ void GuidingLog::DisableLogging()
         return;
 
     assert(m_file.IsOpened());
-    wxDateTime now = wxDateTime::Now();
+    wxDateTime now = PhdClock::UNow();
 
     m_file.Write("\n");
     m_file.Write("Log disabled at " + now.Format(_T("%Y-%m-%d %H:%M:%S")) + "\n");
@@ -280,7 +280,7 @@ bool GuidingLog::ChangeDirLog(const wxString& newdir)
     }
     if (!SetLogDir(newdir))
     {
-        wxMessageBox(wxString::Format("invalid folder name %s, log folder unchanged", newdir));
+        PhdMessageBox(wxString::Format("invalid folder name %s, log folder unchanged", newdir));
         bOk = false;
     }
     if (bEnabled)                    // if SetLogDir failed, no harm no foul, stay with original. Otherwise
@@ -327,7 +327,7 @@ void GuidingLog::Close()
         return;
 
     assert(m_file.IsOpened());
-    wxDateTime now = wxDateTime::Now();
+    wxDateTime now = PhdClock::UNow();
 
     m_file.Write("\n");
     m_file.Write("Log closed at " + now.Format(_T("%Y-%m-%d %H:%M:%S")) + "\n");
@@ -350,7 +350,7 @@ void GuidingLog::StartCalibration(Mount *pCalibrationMount)
         return;
 
     assert(m_file.IsOpened());
-    wxDateTime now = wxDateTime::Now();
+    wxDateTime now = PhdClock::UNow();
 
     m_file.Write("\n");
     m_file.Write("Calibration Begins at " + now.Format(_T("%Y-%m-%d %H:%M:%S")) + "\n");
@@ -483,7 +483,7 @@ void GuidingLog::GuidingStopped()
 
     assert(m_file.IsOpened());
 
-    m_file.Write("Guiding Ends at " + wxDateTime::Now().Format(_T("%Y-%m-%d %H:%M:%S")) + "\n");
+    m_file.Write("Guiding Ends at " + PhdClock::UNow().Format(_T("%Y-%m-%d %H:%M:%S")) + "\n");
     Flush();
 }
 
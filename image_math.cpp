@@ -34,6 +34,7 @@
 
 #include "phd.h"
 #include "image_math.h"
+#include "median_filter.h"
 
 #include <wx/wfstream.h>
 #include <wx/txtstrm.h>
@@ -105,31 +106,32 @@ bool QuickLRecon(usImage& img)
 
 #define IX(x_, y_) ((RY + (y_)) * W + RX + (x_))
 
-    unsigned short *d;
-    unsigned int t;
+    ComputePool::ParallelRows(RH - 1, RW, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
+        {
+            unsigned short *d = &tmp.ImageData[IX(0, y)];
+            unsigned int t;
 
-    for (int y = 0; y <= RH - 2; y++)
-    {
-        d = &tmp.ImageData[IX(0, y)];
+            for (int x = 0; x <= RW - 2; x++)
+            {
+                t  = img.ImageData[IX(x    , y    )];
+                t += img.ImageData[IX(x + 1, y    )];
+                t += img.ImageData[IX(x    , y + 1)];
+                t += img.ImageData[IX(x + 1, y + 1)];
+                *d++ = (unsigned short)(t >> 2);
+            }
 
-        for (int x = 0; x <= RW - 2; x++)
-        {
-            t  = img.ImageData[IX(x    , y    )];
-            t += img.ImageData[IX(x + 1, y    )];
-            t += img.ImageData[IX(x    , y + 1)];
-            t += img.ImageData[IX(x + 1, y + 1)];
-            *d++ = (unsigned short)(t >> 2);
+            // last col
+            t  = img.ImageData[IX(RW - 1, y    )];
+            t += img.ImageData[IX(RW - 1, y + 1)];
+            *d = (unsigned short)(t >> 1);
         }
-
-        // last col
-        t  = img.ImageData[IX(RW - 1, y    )];
-        t += img.ImageData[IX(RW - 1, y + 1)];
-        *d = (unsigned short)(t >> 1);
-    }
+    });
 
     // last row
 
-    d = &tmp.ImageData[IX(0, RH - 1)];
+    unsigned short *d = &tmp.ImageData[IX(0, RH - 1)];
+    unsigned int t;
 
     for (int x = 0; x <= RW - 2; x++)
     {
@@ -168,265 +170,9 @@ bool Median3(usImage& img)
     return err;
 }
 
-inline static void swap(unsigned short& a, unsigned short& b)
-{
-    unsigned short const t = a;
-    a = b;
-    b = t;
-}
-
-inline static unsigned short median9(const unsigned short l[9])
-{
-    unsigned short l0 = l[0], l1 = l[1], l2 = l[2], l3 = l[3], l4 = l[4];
-    unsigned short x;
-    x = l[5];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    if (x < l4) swap(x, l4);
-    x = l[6];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    if (x < l4) swap(x, l4);
-    x = l[7];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    if (x < l4) swap(x, l4);
-    x = l[8];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    if (x < l4) swap(x, l4);
-
-    if (l1 > l0) l0 = l1;
-    if (l2 > l0) l0 = l2;
-    if (l3 > l0) l0 = l3;
-    if (l4 > l0) l0 = l4;
-
-    return l0;
-}
-
-inline static unsigned short median8(const unsigned short l[8])
-{
-    unsigned short l0 = l[0], l1 = l[1], l2 = l[2], l3 = l[3], l4 = l[4];
-    unsigned short x;
-
-    x = l[5];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    if (x < l4) swap(x, l4);
-    x = l[6];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    if (x < l4) swap(x, l4);
-    x = l[7];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    if (x < l4) swap(x, l4);
-
-    if (l2 > l0) swap(l2, l0);
-    if (l2 > l1) swap(l2, l1);
-
-    if (l3 > l0) swap(l3, l0);
-    if (l3 > l1) swap(l3, l1);
-
-    if (l4 > l0) swap(l4, l0);
-    if (l4 > l1) swap(l4, l1);
-
-    return (unsigned short)(((unsigned int) l0 + (unsigned int) l1) / 2);
-}
-
-inline static unsigned short median6(const unsigned short l[6])
-{
-    unsigned short l0 = l[0], l1 = l[1], l2 = l[2], l3 = l[3];
-    unsigned short x;
-
-    x = l[4];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-    x = l[5];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    if (x < l3) swap(x, l3);
-
-    if (l2 > l0) swap(l2, l0);
-    if (l2 > l1) swap(l2, l1);
-
-    if (l3 > l0) swap(l3, l0);
-    if (l3 > l1) swap(l3, l1);
-
-    return (unsigned short)(((unsigned int) l0 + (unsigned int) l1) / 2);
-}
-
-inline static unsigned short median5(const unsigned short l[5])
-{
-    unsigned short l0 = l[0], l1 = l[1], l2 = l[2];
-    unsigned short x;
-    x = l[3];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-    x = l[4];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-
-    if (l1 > l0) l0 = l1;
-    if (l2 > l0) l0 = l2;
-
-    return l0;
-}
-
-inline static unsigned short median4(const unsigned short l[4])
-{
-    unsigned short l0 = l[0], l1 = l[1], l2 = l[2];
-    unsigned short x;
-    x = l[3];
-    if (x < l0) swap(x, l0);
-    if (x < l1) swap(x, l1);
-    if (x < l2) swap(x, l2);
-
-    if (l2 > l0) swap(l2, l0);
-    if (l2 > l1) swap(l2, l1);
-
-    return (unsigned short)(((unsigned int) l0 + (unsigned int) l1) / 2);
-}
-
-inline static unsigned short median3(const unsigned short l[3])
-{
-    unsigned short l0 = l[0], l1 = l[1], l2 = l[2];
-    if (l2 < l0) swap(l2, l0);
-    if (l2 < l1) swap(l2, l1);
-    if (l1 > l0) l0 = l1;
-    return l0;
-}
-
 bool Median3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect)
 {
-    int const W = size.GetWidth();
-    int const RX = rect.GetX();
-    int const RY = rect.GetY();
-    int const RW = rect.GetWidth();
-    int const RH = rect.GetHeight();
-
-    unsigned short a[9];
-    unsigned short *d;
-
-#define IX(x_, y_) ((RY + (y_)) * W + RX + (x_))
-
-    // top row
-    d = &dst[IX(0, 0)];
-
-    // top-left corner
-    a[0] = src[IX(0, 0)];
-    a[1] = src[IX(1, 0)];
-    a[2] = src[IX(0, 1)];
-    a[3] = src[IX(1, 1)];
-    *d++ = median4(a);
-
-    // top row middle pixels
-    for (int x = 1; x <= RW - 2; x++)
-    {
-        a[0] = src[IX(x - 1, 0)];
-        a[1] = src[IX(x,     0)];
-        a[2] = src[IX(x + 1, 0)];
-        a[3] = src[IX(x - 1, 1)];
-        a[4] = src[IX(x,     1)];
-        a[5] = src[IX(x + 1, 1)];
-        *d++ = median6(a);
-    }
-
-    // top-right corner
-    a[0] = src[IX(RW - 2, 0)];
-    a[1] = src[IX(RW - 1, 0)];
-    a[2] = src[IX(RW - 2, 1)];
-    a[3] = src[IX(RW - 1, 1)];
-    *d = median4(a);
-
-    for (int y = 1; y <= RH - 2; y++)
-    {
-        d = &dst[IX(0, y)];
-
-        // leftmost pixel
-        a[0] = src[IX(0, y - 1)];
-        a[1] = src[IX(1, y - 1)];
-        a[2] = src[IX(0, y    )];
-        a[3] = src[IX(1, y    )];
-        a[4] = src[IX(0, y + 1)];
-        a[5] = src[IX(1, y + 1)];
-        *d++ = median6(a);
-
-        for (int x = 1; x <= RW - 2; x++)
-        {
-            a[0] = src[IX(x - 1, y - 1)];
-            a[1] = src[IX(x    , y - 1)];
-            a[2] = src[IX(x + 1, y - 1)];
-            a[3] = src[IX(x - 1, y    )];
-            a[4] = src[IX(x    , y    )];
-            a[5] = src[IX(x + 1, y    )];
-            a[6] = src[IX(x - 1, y + 1)];
-            a[7] = src[IX(x    , y + 1)];
-            a[8] = src[IX(x + 1, y + 1)];
-            *d++ = median9(a);
-        }
-
-        // rightmost pixel
-        a[0] = src[IX(RW - 2, y - 1)];
-        a[1] = src[IX(RW - 1, y - 1)];
-        a[2] = src[IX(RW - 2, y    )];
-        a[3] = src[IX(RW - 1, y    )];
-        a[4] = src[IX(RW - 2, y + 1)];
-        a[5] = src[IX(RW - 1, y + 1)];
-        *d++ = median6(a);
-    }
-
-    // bottom row
-    d = &dst[IX(0, RH - 1)];
-
-    // bottom-left corner
-    a[0] = src[IX(0, RH - 2)];
-    a[1] = src[IX(1, RH - 2)];
-    a[2] = src[IX(0, RH - 1)];
-    a[3] = src[IX(1, RH - 1)];
-    *d++ = median4(a);
-
-    // bottom row middle pixels
-    for (int x = 1; x <= RW - 2; x++)
-    {
-        a[0] = src[IX(x - 1, RH - 2)];
-        a[1] = src[IX(x    , RH - 2)];
-        a[2] = src[IX(x + 1, RH - 2)];
-        a[3] = src[IX(x - 1, RH - 1)];
-        a[4] = src[IX(x    , RH - 1)];
-        a[5] = src[IX(x + 1, RH - 1)];
-        *d++ = median6(a);
-    }
-
-    // bottom-right corner
-    a[0] = src[IX(RW - 2, RH - 2)];
-    a[1] = src[IX(RW - 1, RH - 2)];
-    a[2] = src[IX(RW - 2, RH - 1)];
-    a[3] = src[IX(RW - 1, RH - 1)];
-    *d = median4(a);
-
-#undef IX
-
-    return false;
+    return MedianFilter::Median3x3(dst, src, size, rect);
 }
 
 static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
@@ -445,7 +191,7 @@ static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
         array[5] = img.ImageData[(x-1) + (y+1) * xsize];
         array[6] = img.ImageData[(x)   + (y+1) * xsize];
         array[7] = img.ImageData[(x+1) + (y+1) * xsize];
-        return median8(array);
+        return MedianFilter::Median8(array);
     }
 
     if (x == 0 && y > 0 && y < ysize - 1)
@@ -456,7 +202,7 @@ static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
         array[2] = img.ImageData[(x + 1) + (y - 1) * xsize];
         array[3] = img.ImageData[(x + 1) + (y)     * xsize];
         array[4] = img.ImageData[(x + 1) + (y + 1) * xsize];
-        return median5(array);
+        return MedianFilter::Median5(array);
     }
 
     if (x == xsize - 1 && y > 0 && y < ysize - 1)
@@ -467,7 +213,7 @@ static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
         array[2] = img.ImageData[(x - 1) + (y - 1) * xsize];
         array[3] = img.ImageData[(x - 1) + (y)     * xsize];
         array[4] = img.ImageData[(x - 1) + (y + 1) * xsize];
-        return median5(array);
+        return MedianFilter::Median5(array);
     }
 
     if (y == 0 && x > 0 && x < xsize - 1)
@@ -478,7 +224,7 @@ static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
         array[2] = img.ImageData[(x)     + (y + 1) * xsize];
         array[3] = img.ImageData[(x + 1) + (y)     * xsize];
         array[4] = img.ImageData[(x + 1) + (y + 1) * xsize];
-        return median5(array);
+        return MedianFilter::Median5(array);
     }
 
     if (y == ysize - 1 && x > 0 && x < xsize - 1)
@@ -489,7 +235,7 @@ static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
         array[2] = img.ImageData[(x)     + (y - 1) * xsize];
         array[3] = img.ImageData[(x + 1) + (y)     * xsize];
         array[4] = img.ImageData[(x + 1) + (y - 1) * xsize];
-        return median5(array);
+        return MedianFilter::Median5(array);
     }
 
     if (x == 0 && y == 0)
@@ -526,7 +272,7 @@ static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
         return 0;
     }
 
-    return median3(array);
+    return MedianFilter::Median3(array);
 }
 
 bool SquarePixels(usImage& img, float xsize, float ysize)
@@ -592,23 +338,34 @@ bool Subtract(usImage& light, const usImage& dark)
         height = light.Size.GetHeight();
     }
 
-    int mindiff = 65535;
+    int const stride = light.Size.GetWidth();
+    int const grain = ComputePool::RowGrain((int) height, (int) width);
 
-    unsigned short *pl0 = &light.Pixel(left, top);
-    const unsigned short *pd0 = &dark.Pixel(left, top);
-    for (unsigned int r = 0; r < height;
-         r++, pl0 += light.Size.GetWidth(), pd0 += light.Size.GetWidth())
-    {
-        unsigned short *const endl = pl0 + width;
-        unsigned short *pl;
-        const unsigned short *pd;
-        for (pl = pl0, pd = pd0; pl < endl; pl++, pd++)
+    // minimum of each row range, combined after all ranges complete
+    std::vector<int> rangeMin((height + grain - 1) / grain, 65535);
+
+    ComputePool::ParallelFor(height, grain, [&](int r0, int r1) {
+        int mindiff = 65535;
+        unsigned short *pl0 = &light.Pixel(left, top + r0);
+        const unsigned short *pd0 = &dark.Pixel(left, top + r0);
+        for (int r = r0; r < r1; r++, pl0 += stride, pd0 += stride)
         {
-            int diff = (int) *pl - (int) *pd;
-            if (diff < mindiff)
-                mindiff = diff;
+            unsigned short *const endl = pl0 + width;
+            unsigned short *pl;
+            const unsigned short *pd;
+            for (pl = pl0, pd = pd0; pl < endl; pl++, pd++)
+            {
+                int diff = (int) *pl - (int) *pd;
+                if (diff < mindiff)
+                    mindiff = diff;
+            }
         }
-    }
+        rangeMin[r0 / grain] = mindiff;
+    });
+
+    int mindiff = 65535;
+    for (int m : rangeMin)
+        mindiff = std::min(mindiff, m);
 
     int offset = 0;
     if (mindiff < 0) // dark was lighter than light
@@ -617,22 +374,23 @@ bool Subtract(usImage& light, const usImage& dark)
         light.Pedestal = (unsigned short) offset;
     }
 
-    pl0 = &light.Pixel(left, top);
-    pd0 = &dark.Pixel(left, top);
-    for (unsigned int r = 0; r < height;
-         r++, pl0 += light.Size.GetWidth(), pd0 += light.Size.GetWidth())
-    {
-        unsigned short *const endl = pl0 + width;
-        unsigned short *pl;
-        const unsigned short *pd;
-        for (pl = pl0, pd = pd0; pl < endl; pl++, pd++)
+    ComputePool::ParallelFor(height, grain, [&](int r0, int r1) {
+        unsigned short *pl0 = &light.Pixel(left, top + r0);
+        const unsigned short *pd0 = &dark.Pixel(left, top + r0);
+        for (int r = r0; r < r1; r++, pl0 += stride, pd0 += stride)
         {
-            int newval = (int) *pl - (int) *pd + offset;
-            if (newval < 0) newval = 0; // shouldn't hit this...
-            else if (newval > 65535) newval = 65535;
-            *pl = (unsigned short) newval;
+            unsigned short *const endl = pl0 + width;
+            unsigned short *pl;
+            const unsigned short *pd;
+            for (pl = pl0, pd = pd0; pl < endl; pl++, pd++)
+            {
+                int newval = (int) *pl - (int) *pd + offset;
+                if (newval < 0) newval = 0; // shouldn't hit this...
+                else if (newval > 65535) newval = 65535;
+                *pl = (unsigned short) newval;
+            }
         }
-    }
+    });
 
     return false;
 }
@@ -659,75 +417,79 @@ inline static unsigned short histo_median(unsigned short histo1[256], unsigned s
 static void MedianFilter(usImage& dst, const usImage& src, int halfWidth)
 {
     dst.Init(src.Size);
-    unsigned short *d = &dst.ImageData[0];
 
     int const width = src.Size.GetWidth();
     int const height = src.Size.GetHeight();
 
-    for (int y = 0; y < height; y++)
-    {
-        int top = std::max(0, y - halfWidth);
-        int bot = std::min(y + halfWidth, height - 1);
-        int left = 0;
-        int right = halfWidth;
-
-        // TODO: we initialize the histogram at the start of each row, but we could make this faster
-        // if we scan left to right, move down, scan right to left, move down so we never need to
-        // reinitialize the histogram
-
-        // initialize 2-level histogram
-        unsigned short histo1[256];
-        unsigned short histo2[65536];
-        memset(&histo1[0], 0, sizeof(histo1));
-        memset(&histo2[0], 0, sizeof(histo2));
-
-        for (int j = top; j <= bot; j++)
+    // each row is independent and costs about (2 * halfWidth + 1) reads per pixel
+    ComputePool::ParallelRows(height, width * (2 * halfWidth + 1), [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
         {
-            const unsigned short *p = &src.Pixel(left, j);
-            for (int i = left; i <= right; i++, p++)
-            {
-                ++histo1[*p >> 8];
-                ++histo2[*p];
-            }
-        }
-        unsigned int n = (right - left + 1) * (bot - top + 1);
+            unsigned short *d = &dst.Pixel(0, y);
 
-        // read off first value for this row
-        *d++ = histo_median(histo1, histo2, n);
+            int top = std::max(0, y - halfWidth);
+            int bot = std::min(y + halfWidth, height - 1);
+            int left = 0;
+            int right = halfWidth;
 
-        // loop across remaining columns for this row
-        for (int i = 1; i < width; i++)
-        {
-            left = std::max(0, i - halfWidth);
-            right = std::min(i + halfWidth, width - 1);
+            // TODO: we initialize the histogram at the start of each row, but we could make this faster
+            // if we scan left to right, move down, scan right to left, move down so we never need to
+            // reinitialize the histogram
 
-            // remove leftmost column
-            if (left > 0)
-            {
-                const unsigned short *p = &src.Pixel(left - 1, top);
-                for (int j = top; j <= bot; j++, p += width)
-                {
-                    --histo1[*p >> 8];
-                    --histo2[*p];
-                }
-                n -= (bot - top + 1);
-            }
+            // initialize 2-level histogram
+            unsigned short histo1[256];
+            unsigned short histo2[65536];
+            memset(&histo1[0], 0, sizeof(histo1));
+            memset(&histo2[0], 0, sizeof(histo2));
 
-            // add new column on right
-            if (i + halfWidth <= width - 1)
+            for (int j = top; j <= bot; j++)
             {
-                const unsigned short *p = &src.Pixel(right, top);
-                for (int j = top; j <= bot; j++, p += width)
+                const unsigned short *p = &src.Pixel(left, j);
+                for (int i = left; i <= right; i++, p++)
                 {
                     ++histo1[*p >> 8];
                     ++histo2[*p];
                 }
-                n += (bot - top + 1);
             }
+            unsigned int n = (right - left + 1) * (bot - top + 1);
 
+            // read off first value for this row
             *d++ = histo_median(histo1, histo2, n);
+
+            // loop across remaining columns for this row
+            for (int i = 1; i < width; i++)
+            {
+                left = std::max(0, i - halfWidth);
+                right = std::min(i + halfWidth, width - 1);
+
+                // remove leftmost column
+                if (left > 0)
+                {
+                    const unsigned short *p = &src.Pixel(left - 1, top);
+                    for (int j = top; j <= bot; j++, p += width)
+                    {
+                        --histo1[*p >> 8];
+                        --histo2[*p];
+                    }
+                    n -= (bot - top + 1);
+                }
+
+                // add new column on right
+                if (i + halfWidth <= width - 1)
+                {
+                    const unsigned short *p = &src.Pixel(right, top);
+                    for (int j = top; j <= bot; j++, p += width)
+                    {
+                        ++histo1[*p >> 8];
+                        ++histo2[*p];
+                    }
+                    n += (bot - top + 1);
+                }
+
+                *d++ = histo_median(histo1, histo2, n);
+            }
         }
-    }
+    });
 }
 
 struct ImageStatsWork
@@ -1033,7 +795,7 @@ const wxArrayString& DefectMapBuilder::GetMapInfo() const
     return m_impl->mapInfo;
 }
 
-bool RemoveDefects(usImage& light, const DefectMap& defectMap)
+bool RemoveDefects(usImage& light, const std::vector<wxPoint>& defectMap)
 {
     // Check to make sure the light frame is valid
     if (!light.ImageData)
@@ -1043,7 +805,7 @@ bool RemoveDefects(usImage& light, const DefectMap& defectMap)
     {
         // Step over each defect and replace the light value
         // with the median of the surrounding pixels
-        for (DefectMap::const_iterator it = defectMap.begin(); it != defectMap.end(); ++it)
+        for (std::vector<wxPoint>::const_iterator it = defectMap.begin(); it != defectMap.end(); ++it)
         {
             const wxPoint& pt = *it;
             // Check to see if we are within the subframe before correcting the defect
@@ -1057,7 +819,7 @@ bool RemoveDefects(usImage& light, const DefectMap& defectMap)
     {
         // Step over each defect and replace the light value
         // with the median of the surrounding pixels
-        for (DefectMap::const_iterator it = defectMap.begin(); it != defectMap.end(); ++it)
+        for (std::vector<wxPoint>::const_iterator it = defectMap.begin(); it != defectMap.end(); ++it)
         {
             int const x = it->x;
             int const y = it->y;
@@ -60,7 +60,7 @@ extern bool SquarePixels(usImage& img, float xsize, float ysize);
 extern int dbl_sort_func(double *first, double *second);
 extern bool Subtract(usImage& light, const usImage& dark);
 extern double CalcSlope(const ArrayOfDbl& y);
-extern bool RemoveDefects(usImage& light, const DefectMap& defectMap);
+extern bool RemoveDefects(usImage& light, const std::vector<wxPoint>& defectMap);
 
 struct DefectMapBuilderImpl;
 
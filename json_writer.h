@@ -0,0 +1,274 @@
+/*
+ *  json_writer.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef JSON_WRITER_INCLUDED
+#define JSON_WRITER_INCLUDED
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Streaming JSON writer for event notifications. Output is appended as
+// UTF-8 directly to a buffer that is reused from one event to the next, so
+// once the buffer has grown to size building an event does not allocate.
+//
+// Uses wxString, wxPoint and PHD_Point, which must be declared before this
+// header is included.
+class JWriter
+{
+    std::vector<char> m_buf;
+    unsigned int m_depth;
+    unsigned int m_more;    // bit n set when level n already has an element
+    bool m_afterKey;
+
+    void put(char c) { m_buf.push_back(c); }
+    void put(const char *s, size_t len) { m_buf.insert(m_buf.end(), s, s + len); }
+
+    void item()
+    {
+        if (m_afterKey)
+        {
+            m_afterKey = false;
+            return;
+        }
+        unsigned int const bit = 1U << m_depth;
+        if (m_more & bit)
+            put(',');
+        else
+            m_more |= bit;
+    }
+
+    void open(char c)
+    {
+        item();
+        put(c);
+        ++m_depth;
+        m_more &= ~(1U << m_depth);
+    }
+
+    void close(char c)
+    {
+        --m_depth;
+        put(c);
+    }
+
+    void putstr(const char *s, size_t len)
+    {
+        put('"');
+        const char *const end = s + len;
+        const char *run = s;
+        for (; s < end; s++)
+        {
+            unsigned char const ch = *s;
+            if (ch >= 0x20 && ch != '"' && ch != '\\')
+                continue;
+            put(run, s - run);
+            run = s + 1;
+            switch (ch) {
+            case '"':  put("\\\"", 2); break;
+            case '\\': put("\\\\", 2); break;
+            case '\r': put("\\r", 2); break;
+            case '\n': put("\\n", 2); break;
+            case '\t': put("\\t", 2); break;
+            default: {
+                char tmp[8];
+                put(tmp, snprintf(tmp, sizeof(tmp), "\\u%04x", ch));
+                break;
+            }
+            }
+        }
+        put(run, end - run);
+        put('"');
+    }
+
+    void putuint(unsigned long long v)
+    {
+        char tmp[24];
+        char *p = tmp + sizeof(tmp);
+        do
+        {
+            *--p = '0' + (char)(v % 10);
+            v /= 10;
+        } while (v);
+        put(p, tmp + sizeof(tmp) - p);
+    }
+
+    void putprintf(double v, int prec)
+    {
+        char tmp[512];
+        int n = snprintf(tmp, sizeof(tmp), "%.*f", prec, v);
+        put(tmp, wxMin(wxMax(n, 0), (int) sizeof(tmp) - 1));
+    }
+
+    void putfixed(double v, int prec)
+    {
+        static const double s_pow10[] = { 1., 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+        if (prec < 0 || prec >= (int) WXSIZEOF(s_pow10) || !(fabs(v) * s_pow10[prec] < 1e15))
+        {
+            // out of range for the fast path (or NaN), let printf deal with it
+            putprintf(v, prec);
+            return;
+        }
+
+        double const x = fabs(v) * s_pow10[prec];
+        double const frac = x - floor(x);
+
+        if (fabs(frac - 0.5) <= x * 4e-16)
+        {
+            // too close to a rounding tie to be sure we would round the same way printf does
+            putprintf(v, prec);
+            return;
+        }
+
+        unsigned long long const scale = (unsigned long long) s_pow10[prec];
+        unsigned long long const n = (unsigned long long)(x + 0.5);
+
+        if (std::signbit(v))
+            put('-');
+
+        putuint(n / scale);
+
+        if (prec > 0)
+        {
+            put('.');
+            char tmp[16];
+            unsigned long long f = n % scale;
+            for (int i = prec - 1; i >= 0; i--)
+            {
+                tmp[i] = '0' + (char)(f % 10);
+                f /= 10;
+            }
+            put(tmp, prec);
+        }
+    }
+
+public:
+
+    JWriter() : m_depth(0), m_more(0), m_afterKey(false) { m_buf.reserve(512); }
+
+    void Reset()
+    {
+        m_buf.clear();
+        m_depth = 0;
+        m_more = 0;
+        m_afterKey = false;
+    }
+
+    const char *Data() const { return m_buf.data(); }
+    size_t Size() const { return m_buf.size(); }
+    wxString Str() const { return wxString::FromUTF8(m_buf.data(), m_buf.size()); }
+
+    JWriter& BeginObj() { open('{'); return *this; }
+    JWriter& EndObj() { close('}'); return *this; }
+    JWriter& BeginAry() { open('['); return *this; }
+    JWriter& EndAry() { close(']'); return *this; }
+
+    JWriter& Key(const char *name)
+    {
+        item();
+        putstr(name, strlen(name));
+        put(':');
+        m_afterKey = true;
+        return *this;
+    }
+
+    JWriter& Val(int v)
+    {
+        item();
+        if (v < 0)
+        {
+            put('-');
+            putuint(0ULL - (unsigned long long) v);
+        }
+        else
+            putuint(v);
+        return *this;
+    }
+    JWriter& Val(unsigned int v) { item(); putuint(v); return *this; }
+    JWriter& Val(double v, int prec) { item(); putfixed(v, prec); return *this; }
+    JWriter& Val(double v)
+    {
+        item();
+        char tmp[32];
+        put(tmp, snprintf(tmp, sizeof(tmp), "%g", v));
+        return *this;
+    }
+    JWriter& Val(bool v)
+    {
+        item();
+        if (v)
+            put("true", 4);
+        else
+            put("false", 5);
+        return *this;
+    }
+    JWriter& Val(const char *s) { item(); putstr(s, strlen(s)); return *this; }
+    JWriter& Val(const wxString& s)
+    {
+        item();
+        char tmp[128];
+        if (s.length() <= sizeof(tmp) && s.IsAscii())
+        {
+            // avoid allocating a conversion buffer for the common case
+            char *p = tmp;
+            for (wxString::const_iterator it = s.begin(); it != s.end(); ++it)
+                *p++ = (char)(*it).GetValue();
+            putstr(tmp, p - tmp);
+        }
+        else
+        {
+            wxScopedCharBuffer utf8 = s.utf8_str();
+            putstr(utf8.data(), utf8.length());
+        }
+        return *this;
+    }
+    JWriter& Val(const PHD_Point& pt) { return BeginAry().Val(pt.X, 2).Val(pt.Y, 2).EndAry(); }
+    JWriter& Val(const wxPoint& pt) { return BeginAry().Val(pt.x).Val(pt.y).EndAry(); }
+    JWriter& Null() { item(); put("null", 4); return *this; }
+
+    template<typename T>
+    JWriter& Add(const char *name, const T& v) { return Key(name).Val(v); }
+    JWriter& Add(const char *name, const char *v) { return Key(name).Val(v); }
+    JWriter& Add(const char *name, double v, int prec) { return Key(name).Val(v, prec); }
+
+    // terminate the top-level object and the line
+    void Finish()
+    {
+        EndObj();
+        put("\r\n", 2);
+    }
+};
+
+#endif // JSON_WRITER_INCLUDED
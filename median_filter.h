@@ -0,0 +1,318 @@
+/*
+ *  median_filter.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MEDIAN_FILTER_H_INCLUDED
+#define MEDIAN_FILTER_H_INCLUDED
+
+// The 3x3 median filter of Median3() and the small median networks used for
+// defect removal. It only depends on wxRect and wxSize so it can be run
+// outside PHD2 (see tests/autofind_test.cpp).
+
+#include "computepool.h"
+
+#include <wx/gdicmn.h>
+
+class MedianFilter
+{
+    static void Swap(unsigned short& a, unsigned short& b)
+    {
+        unsigned short const t = a;
+        a = b;
+        b = t;
+    }
+
+public:
+    // median of 3, 4, 5, 6, 8 or 9 values; for an even count, the mean of the two middle values
+    static unsigned short Median9(const unsigned short l[9])
+    {
+        unsigned short l0 = l[0], l1 = l[1], l2 = l[2], l3 = l[3], l4 = l[4];
+        unsigned short x;
+        x = l[5];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        if (x < l4) Swap(x, l4);
+        x = l[6];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        if (x < l4) Swap(x, l4);
+        x = l[7];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        if (x < l4) Swap(x, l4);
+        x = l[8];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        if (x < l4) Swap(x, l4);
+
+        if (l1 > l0) l0 = l1;
+        if (l2 > l0) l0 = l2;
+        if (l3 > l0) l0 = l3;
+        if (l4 > l0) l0 = l4;
+
+        return l0;
+    }
+
+    static unsigned short Median8(const unsigned short l[8])
+    {
+        unsigned short l0 = l[0], l1 = l[1], l2 = l[2], l3 = l[3], l4 = l[4];
+        unsigned short x;
+
+        x = l[5];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        if (x < l4) Swap(x, l4);
+        x = l[6];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        if (x < l4) Swap(x, l4);
+        x = l[7];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        if (x < l4) Swap(x, l4);
+
+        if (l2 > l0) Swap(l2, l0);
+        if (l2 > l1) Swap(l2, l1);
+
+        if (l3 > l0) Swap(l3, l0);
+        if (l3 > l1) Swap(l3, l1);
+
+        if (l4 > l0) Swap(l4, l0);
+        if (l4 > l1) Swap(l4, l1);
+
+        return (unsigned short)(((unsigned int) l0 + (unsigned int) l1) / 2);
+    }
+
+    static unsigned short Median6(const unsigned short l[6])
+    {
+        unsigned short l0 = l[0], l1 = l[1], l2 = l[2], l3 = l[3];
+        unsigned short x;
+
+        x = l[4];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+        x = l[5];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        if (x < l3) Swap(x, l3);
+
+        if (l2 > l0) Swap(l2, l0);
+        if (l2 > l1) Swap(l2, l1);
+
+        if (l3 > l0) Swap(l3, l0);
+        if (l3 > l1) Swap(l3, l1);
+
+        return (unsigned short)(((unsigned int) l0 + (unsigned int) l1) / 2);
+    }
+
+    static unsigned short Median5(const unsigned short l[5])
+    {
+        unsigned short l0 = l[0], l1 = l[1], l2 = l[2];
+        unsigned short x;
+        x = l[3];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+        x = l[4];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+
+        if (l1 > l0) l0 = l1;
+        if (l2 > l0) l0 = l2;
+
+        return l0;
+    }
+
+    static unsigned short Median4(const unsigned short l[4])
+    {
+        unsigned short l0 = l[0], l1 = l[1], l2 = l[2];
+        unsigned short x;
+        x = l[3];
+        if (x < l0) Swap(x, l0);
+        if (x < l1) Swap(x, l1);
+        if (x < l2) Swap(x, l2);
+
+        if (l2 > l0) Swap(l2, l0);
+        if (l2 > l1) Swap(l2, l1);
+
+        return (unsigned short)(((unsigned int) l0 + (unsigned int) l1) / 2);
+    }
+
+    static unsigned short Median3(const unsigned short l[3])
+    {
+        unsigned short l0 = l[0], l1 = l[1], l2 = l[2];
+        if (l2 < l0) Swap(l2, l0);
+        if (l2 < l1) Swap(l2, l1);
+        if (l1 > l0) l0 = l1;
+        return l0;
+    }
+
+    // 3x3 median of rect; pixels on the edges of rect take the median of
+    // their 4 or 6 neighbors inside rect
+    static bool Median3x3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect)
+    {
+        int const W = size.GetWidth();
+        int const RX = rect.GetX();
+        int const RY = rect.GetY();
+        int const RW = rect.GetWidth();
+        int const RH = rect.GetHeight();
+
+        unsigned short a[9];
+        unsigned short *d;
+
+#define IX(x_, y_) ((RY + (y_)) * W + RX + (x_))
+
+        // top row
+        d = &dst[IX(0, 0)];
+
+        // top-left corner
+        a[0] = src[IX(0, 0)];
+        a[1] = src[IX(1, 0)];
+        a[2] = src[IX(0, 1)];
+        a[3] = src[IX(1, 1)];
+        *d++ = Median4(a);
+
+        // top row middle pixels
+        for (int x = 1; x <= RW - 2; x++)
+        {
+            a[0] = src[IX(x - 1, 0)];
+            a[1] = src[IX(x,     0)];
+            a[2] = src[IX(x + 1, 0)];
+            a[3] = src[IX(x - 1, 1)];
+            a[4] = src[IX(x,     1)];
+            a[5] = src[IX(x + 1, 1)];
+            *d++ = Median6(a);
+        }
+
+        // top-right corner
+        a[0] = src[IX(RW - 2, 0)];
+        a[1] = src[IX(RW - 1, 0)];
+        a[2] = src[IX(RW - 2, 1)];
+        a[3] = src[IX(RW - 1, 1)];
+        *d = Median4(a);
+
+        // middle rows
+        ComputePool::ParallelRows(RH - 2, RW, [&](int r0, int r1) {
+            unsigned short a[9];
+
+            for (int y = r0 + 1; y <= r1; y++)
+            {
+                unsigned short *d = &dst[IX(0, y)];
+
+                // leftmost pixel
+                a[0] = src[IX(0, y - 1)];
+                a[1] = src[IX(1, y - 1)];
+                a[2] = src[IX(0, y    )];
+                a[3] = src[IX(1, y    )];
+                a[4] = src[IX(0, y + 1)];
+                a[5] = src[IX(1, y + 1)];
+                *d++ = Median6(a);
+
+                for (int x = 1; x <= RW - 2; x++)
+                {
+                    a[0] = src[IX(x - 1, y - 1)];
+                    a[1] = src[IX(x    , y - 1)];
+                    a[2] = src[IX(x + 1, y - 1)];
+                    a[3] = src[IX(x - 1, y    )];
+                    a[4] = src[IX(x    , y    )];
+                    a[5] = src[IX(x + 1, y    )];
+                    a[6] = src[IX(x - 1, y + 1)];
+                    a[7] = src[IX(x    , y + 1)];
+                    a[8] = src[IX(x + 1, y + 1)];
+                    *d++ = Median9(a);
+                }
+
+                // rightmost pixel
+                a[0] = src[IX(RW - 2, y - 1)];
+                a[1] = src[IX(RW - 1, y - 1)];
+                a[2] = src[IX(RW - 2, y    )];
+                a[3] = src[IX(RW - 1, y    )];
+                a[4] = src[IX(RW - 2, y + 1)];
+                a[5] = src[IX(RW - 1, y + 1)];
+                *d++ = Median6(a);
+            }
+        });
+
+        // bottom row
+        d = &dst[IX(0, RH - 1)];
+
+        // bottom-left corner
+        a[0] = src[IX(0, RH - 2)];
+        a[1] = src[IX(1, RH - 2)];
+        a[2] = src[IX(0, RH - 1)];
+        a[3] = src[IX(1, RH - 1)];
+        *d++ = Median4(a);
+
+        // bottom row middle pixels
+        for (int x = 1; x <= RW - 2; x++)
+        {
+            a[0] = src[IX(x - 1, RH - 2)];
+            a[1] = src[IX(x    , RH - 2)];
+            a[2] = src[IX(x + 1, RH - 2)];
+            a[3] = src[IX(x - 1, RH - 1)];
+            a[4] = src[IX(x    , RH - 1)];
+            a[5] = src[IX(x + 1, RH - 1)];
+            *d++ = Median6(a);
+        }
+
+        // bottom-right corner
+        a[0] = src[IX(RW - 2, RH - 2)];
+        a[1] = src[IX(RW - 1, RH - 2)];
+        a[2] = src[IX(RW - 2, RH - 1)];
+        a[3] = src[IX(RW - 1, RH - 1)];
+        *d = Median4(a);
+
+#undef IX
+
+        return false;
+    }
+};
+
+#endif
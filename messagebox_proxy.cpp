@@ -35,6 +35,30 @@
 
 #include "phd.h"
 
+static int HeadlessMessageBox(const wxString& message, const wxString& caption, int style)
+{
+    Debug.Write(wxString::Format("headless: message box \"%s\": %s\n", caption, message));
+
+    if (pFrame)
+    {
+        int flags = (style & wxICON_ERROR) ? wxICON_ERROR :
+            (style & wxICON_INFORMATION) ? wxICON_INFORMATION : wxICON_EXCLAMATION;
+        pFrame->Alert(message, flags);
+    }
+
+    if (style & wxCANCEL)
+        return wxCANCEL;
+    if (style & wxYES_NO)
+        return wxNO;
+    return wxOK;
+}
+
+int PhdMessageBox(const wxString& message, const wxString& caption, int style, wxWindow *parent, int x, int y)
+{
+    wxMessageBoxProxy proxy;
+    return proxy.wxMessageBox(message, caption, style, parent, x, y);
+}
+
 void wxMessageBoxProxy::showMessageBox(void)
 {
     m_result = ::wxMessageBox(m_message, m_caption, m_style, m_parent, m_x, m_y);
@@ -45,7 +69,11 @@ int wxMessageBoxProxy::wxMessageBox(const wxString& message, const wxString& cap
 {
     int ret;
 
-    if (wxThread::IsMain())
+    if (wxGetApp().IsHeadless())
+    {
+        ret = HeadlessMessageBox(message, caption, style);
+    }
+    else if (wxThread::IsMain())
     {
         Debug.AddLine(wxString::Format(_T("wxMessageBoxProxy(%s)"), message));
         ret = ::wxMessageBox(message, caption, style, parent, x, y);
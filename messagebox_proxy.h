@@ -52,4 +52,10 @@ public:
     int wxMessageBox(const wxString& message, const wxString& caption = "Message", int style = wxOK, wxWindow *parent = nullptr, int x = -1, int y = -1);
 };
 
+// wxMessageBox() that may be called from any thread. In headless mode there
+// is nobody to dismiss the box, so the message is raised as an alert (which
+// goes to the event server clients) and the answer that changes nothing is
+// returned: wxCANCEL, else wxNO, else wxOK.
+extern int PhdMessageBox(const wxString& message, const wxString& caption = "Message", int style = wxOK, wxWindow *parent = nullptr, int x = -1, int y = -1);
+
 #endif // MESSAGEBOX_PROXY_H_INCLUDED
@@ -0,0 +1,214 @@
+/*
+ *  metrics.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+PhdMetrics Metrics;
+
+static const MetricInfo s_metrics[] = {
+    { "capture_seconds", "Time to capture a frame, including the exposure", METRIC_HISTOGRAM, &Metrics.captureTime },
+    { "frame_processing_seconds", "Time to process a captured frame in the guider", METRIC_HISTOGRAM, &Metrics.processingTime },
+    { "move_seconds", "Time to execute a mount or AO move", METRIC_HISTOGRAM, &Metrics.moveTime },
+    { "worker_queue_latency_seconds", "Time from enqueueing a worker thread request until it starts", METRIC_HISTOGRAM, &Metrics.workerQueueLatency },
+    { "frames_total", "Frames fully processed by the guider", METRIC_COUNTER, &Metrics.frames },
+    { "frames_dropped_total", "Frames dropped during calibration or guiding", METRIC_COUNTER, &Metrics.framesDropped },
+    { "star_lost_total", "Star lost events", METRIC_COUNTER, &Metrics.starLost },
+    { "guide_moves_total", "Guide moves issued", METRIC_COUNTER, &Metrics.guideMoves },
+    { "guide_move_errors_total", "Guide moves that failed", METRIC_COUNTER, &Metrics.guideMoveErrors },
+    { "event_server_clients", "Connected event server clients", METRIC_GAUGE, &Metrics.evsrvClients },
+    { "frame_stream_clients", "Connected frame stream clients", METRIC_GAUGE, &Metrics.evsrvFrameClients },
+    { "frame_stream_queue_bytes", "Frame stream bytes waiting to be sent", METRIC_GAUGE, &Metrics.evsrvFrameQueueBytes },
+    { "frame_stream_dropped_total", "Frames not sent to a frame stream client because it was behind", METRIC_COUNTER, &Metrics.evsrvFramesDropped },
+    { "event_server_short_writes_total", "Event server writes that could not be completed", METRIC_COUNTER, &Metrics.evsrvShortWrites },
+    { "debug_log_write_seconds", "Time to write a debug log line", METRIC_HISTOGRAM, &Metrics.logWriteTime },
+    { "debug_log_flush_seconds", "Time to flush the debug log", METRIC_HISTOGRAM, &Metrics.logFlushTime },
+};
+
+unsigned int MetricHistogram::BucketIndex(unsigned long long us)
+{
+    if (us < SUB_BUCKETS)
+        return (unsigned int) us;
+
+    unsigned int e = SUB_BITS;
+    while (e < MAX_EXP - 1 && (us >> (e + 1)) != 0)
+        ++e;
+
+    if ((us >> (e + 1)) != 0)
+        return NUM_BUCKETS - 1;
+
+    unsigned int sub = (unsigned int)(us >> (e - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + (e - SUB_BITS) * SUB_BUCKETS + sub;
+}
+
+unsigned long long MetricHistogram::BucketLow(unsigned int idx)
+{
+    if (idx < SUB_BUCKETS)
+        return idx;
+    unsigned int e = (idx - SUB_BUCKETS) / SUB_BUCKETS;
+    unsigned int sub = (idx - SUB_BUCKETS) % SUB_BUCKETS;
+    return (unsigned long long) (SUB_BUCKETS + sub) << e;
+}
+
+unsigned long long MetricHistogram::BucketHigh(unsigned int idx)
+{
+    if (idx < SUB_BUCKETS)
+        return idx + 1;
+    unsigned int e = (idx - SUB_BUCKETS) / SUB_BUCKETS;
+    unsigned int sub = (idx - SUB_BUCKETS) % SUB_BUCKETS;
+    return (unsigned long long) (SUB_BUCKETS + sub + 1) << e;
+}
+
+void MetricHistogram::Record(long long us)
+{
+    unsigned long long const v = us > 0 ? (unsigned long long) us : 0;
+
+    m_buckets[BucketIndex(v)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(v, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    unsigned long long prev = m_max.load(std::memory_order_relaxed);
+    while (v > prev && !m_max.compare_exchange_weak(prev, v, std::memory_order_relaxed))
+        ;
+}
+
+void MetricHistogram::GetSnapshot(Snapshot *snap) const
+{
+    // individual fields may be a few samples apart when recording is concurrent;
+    // the count is derived from the buckets so quantiles are self-consistent
+    snap->count = 0;
+    for (unsigned int i = 0; i < NUM_BUCKETS; i++)
+    {
+        snap->buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snap->count += snap->buckets[i];
+    }
+    snap->sum = m_sum.load(std::memory_order_relaxed);
+    snap->max = m_max.load(std::memory_order_relaxed);
+}
+
+double MetricHistogram::Snapshot::Quantile(double q) const
+{
+    if (count == 0)
+        return 0.0;
+
+    unsigned long long rank = (unsigned long long) ceil(q * (double) count);
+    if (rank < 1)
+        rank = 1;
+
+    unsigned long long cum = 0;
+    for (unsigned int i = 0; i < NUM_BUCKETS; i++)
+    {
+        cum += buckets[i];
+        if (cum >= rank)
+        {
+            double mid = 0.5 * (double)(BucketLow(i) + BucketHigh(i) - 1);
+            return wxMin(mid, (double) max);
+        }
+    }
+
+    return (double) max;
+}
+
+unsigned int MetricsRegistry::Count()
+{
+    return WXSIZEOF(s_metrics);
+}
+
+const MetricInfo& MetricsRegistry::Get(unsigned int idx)
+{
+    return s_metrics[idx];
+}
+
+static void prom_header(std::string& out, const MetricInfo& m, const char *type)
+{
+    out += "# HELP phd2_";
+    out += m.name;
+    out += ' ';
+    out += m.help;
+    out += "\n# TYPE phd2_";
+    out += m.name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+static void prom_value(std::string& out, const char *name, const char *suffix, const char *labels, double val)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "phd2_%s%s%s %.9g\n", name, suffix, labels, val);
+    out += buf;
+}
+
+// Prometheus text exposition format, version 0.0.4. Histograms are exported
+// as summaries with fixed quantiles since the bucket boundaries do not line
+// up with the usual decimal "le" buckets.
+std::string MetricsRegistry::PrometheusText()
+{
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 1.0 };
+
+    std::string out;
+    out.reserve(4096);
+
+    MetricHistogram::Snapshot snap;
+
+    for (unsigned int i = 0; i < WXSIZEOF(s_metrics); i++)
+    {
+        const MetricInfo& m = s_metrics[i];
+
+        switch (m.type)
+        {
+        case METRIC_COUNTER:
+            prom_header(out, m, "counter");
+            prom_value(out, m.name, "", "", (double) m.Counter().Value());
+            break;
+        case METRIC_GAUGE:
+            prom_header(out, m, "gauge");
+            prom_value(out, m.name, "", "", (double) m.Gauge().Value());
+            break;
+        case METRIC_HISTOGRAM:
+            prom_header(out, m, "summary");
+            m.Histogram().GetSnapshot(&snap);
+            for (unsigned int j = 0; j < WXSIZEOF(quantiles); j++)
+            {
+                char labels[32];
+                snprintf(labels, sizeof(labels), "{quantile=\"%g\"}", quantiles[j]);
+                double us = quantiles[j] >= 1.0 ? (double) snap.max : snap.Quantile(quantiles[j]);
+                prom_value(out, m.name, "", labels, us * 1e-6);
+            }
+            prom_value(out, m.name, "_sum", "", (double) snap.sum * 1e-6);
+            prom_value(out, m.name, "_count", "", (double) snap.count);
+            break;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,165 @@
+/*
+ *  metrics.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef METRICS_INCLUDED
+#define METRICS_INCLUDED
+
+#include <atomic>
+#include <string>
+
+// Always-on guide loop metrics. Recording is a handful of relaxed atomic
+// operations with no locking or allocation, so any thread can record.
+// The metric classes have no constructors and rely on static zero
+// initialization, so they are usable before main() and from any static
+// initializer.
+
+class MetricCounter
+{
+    std::atomic<unsigned long long> m_val;
+
+public:
+    void Inc(unsigned long long n = 1) { m_val.fetch_add(n, std::memory_order_relaxed); }
+    unsigned long long Value() const { return m_val.load(std::memory_order_relaxed); }
+};
+
+class MetricGauge
+{
+    std::atomic<long long> m_val;
+
+public:
+    void Set(long long v) { m_val.store(v, std::memory_order_relaxed); }
+    void Add(long long n) { m_val.fetch_add(n, std::memory_order_relaxed); }
+    long long Value() const { return m_val.load(std::memory_order_relaxed); }
+};
+
+// Latency histogram in microseconds with log-linear buckets: exact below 8us,
+// then 8 sub-buckets per power of two, for a worst case error of about 6%
+// when reporting the bucket midpoint
+class MetricHistogram
+{
+public:
+    enum
+    {
+        SUB_BITS = 3,
+        SUB_BUCKETS = 1 << SUB_BITS,
+        MAX_EXP = 40, // 2^40 us, about 12 days
+        NUM_BUCKETS = SUB_BUCKETS + (MAX_EXP - SUB_BITS) * SUB_BUCKETS,
+    };
+
+    struct Snapshot
+    {
+        unsigned long long count;
+        unsigned long long sum;   // us
+        unsigned long long max;   // us
+        unsigned long long buckets[NUM_BUCKETS];
+
+        double Quantile(double q) const; // us
+        double Mean() const { return count ? (double) sum / (double) count : 0.0; }
+    };
+
+private:
+    std::atomic<unsigned long long> m_count;
+    std::atomic<unsigned long long> m_sum;
+    std::atomic<unsigned long long> m_max;
+    std::atomic<unsigned int> m_buckets[NUM_BUCKETS];
+
+public:
+    static unsigned int BucketIndex(unsigned long long us);
+    static unsigned long long BucketLow(unsigned int idx);
+    static unsigned long long BucketHigh(unsigned int idx);
+
+    void Record(long long us);
+    void GetSnapshot(Snapshot *snap) const;
+};
+
+// records the lifetime of the enclosing scope in a histogram
+class MetricTimer
+{
+    MetricHistogram& m_hist;
+    long long m_start;
+
+public:
+    MetricTimer(MetricHistogram& hist) : m_hist(hist), m_start(Trace::Now()) { }
+    ~MetricTimer() { m_hist.Record(Trace::Now() - m_start); }
+};
+
+struct PhdMetrics
+{
+    MetricHistogram captureTime;
+    MetricHistogram processingTime;
+    MetricHistogram moveTime;
+    MetricHistogram workerQueueLatency;
+    MetricCounter frames;
+    MetricCounter framesDropped;
+    MetricCounter starLost;
+    MetricCounter guideMoves;
+    MetricCounter guideMoveErrors;
+    MetricGauge evsrvClients;
+    MetricGauge evsrvFrameClients;
+    MetricGauge evsrvFrameQueueBytes;
+    MetricCounter evsrvFramesDropped;
+    MetricCounter evsrvShortWrites;
+    MetricHistogram logWriteTime;
+    MetricHistogram logFlushTime;
+};
+
+extern PhdMetrics Metrics;
+
+enum MetricType
+{
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM,
+};
+
+struct MetricInfo
+{
+    const char *name;
+    const char *help;
+    MetricType type;
+    const void *metric;
+
+    const MetricCounter& Counter() const { return *static_cast<const MetricCounter *>(metric); }
+    const MetricGauge& Gauge() const { return *static_cast<const MetricGauge *>(metric); }
+    const MetricHistogram& Histogram() const { return *static_cast<const MetricHistogram *>(metric); }
+};
+
+class MetricsRegistry
+{
+public:
+    static unsigned int Count();
+    static const MetricInfo& Get(unsigned int idx);
+    static std::string PrometheusText();
+};
+
+#endif
@@ -771,6 +771,7 @@ Mount::Mount()
     m_backlashComp = NULL;
     m_lastStep.mount = this;
     m_lastStep.frameNumber = -1; // invalidate
+    m_lastMoveFrame = -1;
 
     ClearCalibration();
 
@@ -954,17 +955,20 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
             }
         }
 
+        Metrics.guideMoves.Inc();
+
         // Figure out the guide directions based on the (possibly) updated distances
         GUIDE_DIRECTION xDirection = xDistance > 0.0 ? LEFT : RIGHT;
         GUIDE_DIRECTION yDirection = yDistance > 0.0 ? DOWN : UP;
 
         int requestedXAmount = (int) floor(fabs(xDistance / m_xRate) + 0.5);
         MoveResultInfo xMoveResult;
-        result = MoveAxis(xDirection, requestedXAmount, moveOptions, &xMoveResult);
-
         MoveResultInfo yMoveResult;
-        if (result != MOVE_ERROR_SLEWING && result != MOVE_ERROR_AO_LIMIT_REACHED)
+
+        if (CanMoveAxesConcurrently())
         {
+            // both moves start together, so the Dec amount including backlash
+            // compensation must be known before the RA move starts
             int requestedYAmount = (int) floor(fabs(yDistance / m_cal.yRate) + 0.5);
 
             if (moveOptions & MOVEOPT_USE_BLC)
@@ -973,13 +977,42 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
                     m_backlashComp->ApplyBacklashComp(moveOptions, yDirection, yDistance, &requestedYAmount);
             }
 
-            result = MoveAxis(yDirection, requestedYAmount, moveOptions, &yMoveResult);
+            result = MoveAxes(xDirection, requestedXAmount, yDirection, requestedYAmount, moveOptions, &xMoveResult, &yMoveResult);
+        }
+        else
+        {
+            result = MoveAxis(xDirection, requestedXAmount, moveOptions, &xMoveResult);
+
+            if (result != MOVE_ERROR_SLEWING && result != MOVE_ERROR_AO_LIMIT_REACHED)
+            {
+                int requestedYAmount = (int) floor(fabs(yDistance / m_cal.yRate) + 0.5);
+
+                if (moveOptions & MOVEOPT_USE_BLC)
+                {
+                    if (m_backlashComp)
+                        m_backlashComp->ApplyBacklashComp(moveOptions, yDirection, yDistance, &requestedYAmount);
+                }
+
+                result = MoveAxis(yDirection, requestedYAmount, moveOptions, &yMoveResult);
+            }
         }
 
         // Record the info about the guide step. The info will be picked up back in the main UI thread.
         // We don't want to do anything with the info here in the worker thread since UI operations are
         // not allowed outside the main UI thread.
 
+        // Record where the move is expected to put the star so the guider can
+        // look for it there in the next frame. The pulses push the star back
+        // by the mount offset they correct.
+        PHD_Point moved((xDirection == LEFT ? 1.0 : -1.0) * xMoveResult.amountMoved * m_xRate,
+                        (yDirection == DOWN ? 1.0 : -1.0) * yMoveResult.amountMoved * m_cal.yRate);
+        PHD_Point cameraMoved;
+        if (!TransformMountCoordinatesToCameraCoordinates(moved, cameraMoved, false))
+        {
+            m_lastMoveDisplacement.SetXY(-cameraMoved.X, -cameraMoved.Y);
+            m_lastMoveFrame = pFrame->m_frameCounter;
+        }
+
         GuideStepInfo& info = m_lastStep;
 
         info.moveOptions = moveOptions;
@@ -1008,6 +1041,9 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
             result = MOVE_ERROR;
     }
 
+    if (result != MOVE_OK)
+        Metrics.guideMoveErrors.Inc();
+
     return result;
 }
 
@@ -1340,6 +1376,20 @@ bool Mount::SynchronousOnly()
     return false;
 }
 
+bool Mount::CanMoveAxesConcurrently()
+{
+    return false;
+}
+
+Mount::MOVE_RESULT Mount::MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                   unsigned int moveOptions, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult)
+{
+    MOVE_RESULT result = MoveAxis(xDirection, xAmount, moveOptions, xMoveResult);
+    if (result != MOVE_ERROR_SLEWING && result != MOVE_ERROR_AO_LIMIT_REACHED)
+        result = MoveAxis(yDirection, yAmount, moveOptions, yMoveResult);
+    return result;
+}
+
 bool Mount::HasSetupDialog() const
 {
     return false;
@@ -180,6 +180,11 @@ protected:
     BacklashComp *m_backlashComp;
     GuideStepInfo m_lastStep;
 
+    // expected camera displacement of the guide star due to the last move
+    // made by MoveOffset, and the frame number the move was based on
+    PHD_Point m_lastMoveDisplacement;
+    int m_lastMoveFrame;
+
     // Things related to the Advanced Config Dialog
 public:
     class MountConfigDialogPane : public wxEvtHandler, public ConfigDialogPane
@@ -271,6 +276,7 @@ public:
                                                       PHD_Point& cameraVectorEndpoint, bool logged = true);
 
     void LogGuideStepInfo();
+    PHD_Point MoveDisplacement(int frameNumber) const;
 
     GraphControlPane *GetXGuideAlgorithmControlPane(wxWindow *pParent);
     GraphControlPane *GetYGuideAlgorithmControlPane(wxWindow *pParent);
@@ -329,6 +335,10 @@ public:
 
     virtual bool HasNonGuiMove();
     virtual bool SynchronousOnly();
+    // true if MoveAxes can run the moves for both axes at the same time
+    virtual bool CanMoveAxesConcurrently();
+    virtual MOVE_RESULT MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                 unsigned int moveOptions, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult);
     virtual bool HasSetupDialog() const;
     virtual void SetupDialog();
 
@@ -366,6 +376,11 @@ inline bool Mount::GetGuidingEnabled() const
     return m_guidingEnabled;
 }
 
+inline PHD_Point Mount::MoveDisplacement(int frameNumber) const
+{
+    return frameNumber == m_lastMoveFrame ? m_lastMoveDisplacement : PHD_Point();
+}
+
 inline bool Mount::IsBusy() const
 {
     return m_requestCount > 0;
@@ -73,6 +73,7 @@ wxDEFINE_EVENT(STATUSBAR_ENQUEUE_EVENT, wxCommandEvent);
 wxDEFINE_EVENT(STATUSBAR_TIMER_EVENT, wxTimerEvent);
 wxDEFINE_EVENT(SET_STATUS_TEXT_EVENT, wxThreadEvent);
 wxDEFINE_EVENT(ALERT_FROM_THREAD_EVENT, wxThreadEvent);
+wxDEFINE_EVENT(SETTINGS_FLUSH_EVENT, wxThreadEvent);
 wxDEFINE_EVENT(RECONNECT_CAMERA_EVENT, wxThreadEvent);
 wxDEFINE_EVENT(UPDATER_EVENT, wxThreadEvent);
 
@@ -96,6 +97,7 @@ wxBEGIN_EVENT_TABLE(MyFrame, wxFrame)
     EVT_MENU(MENU_HELP_UPGRADE, MyFrame::OnUpgrade)
     EVT_MENU(MENU_HELP_ONLINE, MyFrame::OnHelpOnline)
     EVT_MENU(MENU_HELP_LOG_FOLDER, MyFrame::OnHelpLogFolder)
+    EVT_MENU(MENU_HELP_SAVE_TRACE, MyFrame::OnHelpSaveTrace)
     EVT_MENU(MENU_HELP_UPLOAD_LOGS, MyFrame::OnHelpUploadLogs)
     EVT_MENU(wxID_HELP_PROCEDURES, MyFrame::OnInstructions)
     EVT_MENU(wxID_HELP_CONTENTS,MyFrame::OnHelp)
@@ -160,6 +162,7 @@ wxBEGIN_EVENT_TABLE(MyFrame, wxFrame)
 
     EVT_THREAD(SET_STATUS_TEXT_EVENT, MyFrame::OnStatusMsg)
     EVT_THREAD(ALERT_FROM_THREAD_EVENT, MyFrame::OnAlertFromThread)
+    EVT_THREAD(SETTINGS_FLUSH_EVENT, MyFrame::OnFlushSettings)
     EVT_THREAD(RECONNECT_CAMERA_EVENT, MyFrame::OnReconnectCameraFromThread)
     EVT_THREAD(UPDATER_EVENT, MyFrame::OnUpdaterStateChanged)
     EVT_COMMAND(wxID_ANY, REQUEST_MOUNT_MOVE_EVENT, MyFrame::OnRequestMountMove)
@@ -224,6 +227,8 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
 
     bool serverMode = pConfig->Global.GetBoolean("/ServerMode", DefaultServerMode);
     SetServerMode(serverMode);
+    if (wxGetApp().IsHeadless())
+        m_serverMode = true; // the only way to control a headless instance; not saved to the profile
 
     GuideLog.EnableLogging(true);
 
@@ -265,7 +270,7 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
 
     sizer->Add(m_infoBar, wxSizerFlags().Expand());
 
-    pGuider = new GuiderOneStar(guiderWin);
+    pGuider = new GuiderMultiStar(guiderWin);
     sizer->Add(pGuider, wxSizerFlags().Proportion(1).Expand());
 
     guiderWin->SetSizer(sizer);
@@ -396,7 +401,7 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
     m_mgr.GetArtProvider()->SetColor(wxAUI_DOCKART_INACTIVE_CAPTION_TEXT_COLOUR, *wxWHITE);
 
     wxString perspective = pConfig->Global.GetString("/perspective", wxEmptyString);
-    if (perspective != wxEmptyString)
+    if (perspective != wxEmptyString && !wxGetApp().IsHeadless())
     {
         m_mgr.LoadPerspective(perspective);
         m_mgr.GetPane(_T("MainToolBar")).Caption(_T("Main tool bar"));
@@ -409,32 +414,36 @@ MyFrame::MyFrame(int instanceNumber, wxLocale *locale)
         m_mgr.GetPane(_T("Guider")).PaneBorder(false);
     }
 
+    // a headless frame is never shown, so keep all its panes hidden and
+    // leave the saved layout alone
+    bool const headless = wxGetApp().IsHeadless();
     bool panel_state;
 
-    panel_state = m_mgr.GetPane(_T("MainToolBar")).IsShown();
+    panel_state = m_mgr.GetPane(_T("MainToolBar")).IsShown() && !headless;
     Menubar->Check(MENU_TOOLBAR, panel_state);
 
-    panel_state = m_mgr.GetPane(_T("GraphLog")).IsShown();
+    panel_state = m_mgr.GetPane(_T("GraphLog")).IsShown() && !headless;
     pGraphLog->SetState(panel_state);
     Menubar->Check(MENU_GRAPH, panel_state);
 
-    panel_state = m_mgr.GetPane(_T("Stats")).IsShown();
+    panel_state = m_mgr.GetPane(_T("Stats")).IsShown() && !headless;
     pStatsWin->SetState(panel_state);
     Menubar->Check(MENU_STATS, panel_state);
 
-    panel_state = m_mgr.GetPane(_T("AOPosition")).IsShown();
+    panel_state = m_mgr.GetPane(_T("AOPosition")).IsShown() && !headless;
     pStepGuiderGraph->SetState(panel_state);
     Menubar->Check(MENU_AO_GRAPH, panel_state);
 
-    panel_state = m_mgr.GetPane(_T("Profile")).IsShown();
+    panel_state = m_mgr.GetPane(_T("Profile")).IsShown() && !headless;
     pProfile->SetState(panel_state);
     Menubar->Check(MENU_STARPROFILE, panel_state);
 
-    panel_state = m_mgr.GetPane(_T("Target")).IsShown();
+    panel_state = m_mgr.GetPane(_T("Target")).IsShown() && !headless;
     pTarget->SetState(panel_state);
     Menubar->Check(MENU_TARGET, panel_state);
 
-    m_mgr.Update();
+    if (!headless)
+        m_mgr.Update();
 
     // this forces force a resize of MainToolbar in case size changed from the saved perspective
     MainToolbar->Realize();
@@ -563,6 +572,7 @@ void MyFrame::SetupMenuBar()
     help_menu->Append(MENU_HELP_ONLINE,_("Online Support"),_("Ask for help in the PHD2 Forum"));
     help_menu->Append(MENU_HELP_LOG_FOLDER, _("Open Log Folder"), _("Open the log folder"));
     help_menu->Append(MENU_HELP_UPLOAD_LOGS, _("Upload Log Files..."), _("Upload log files for review"));
+    help_menu->Append(MENU_HELP_SAVE_TRACE, _("Save Performance Trace"), _("Save a timing trace of recent activity for viewing in chrome://tracing or Perfetto"));
     help_menu->Append(wxID_HELP_CONTENTS,_("&Contents...\tF1"),_("Full help"));
     help_menu->Append(wxID_HELP_PROCEDURES,_("&Impatient Instructions"),_("Quick instructions for the impatient"));
 
@@ -1020,6 +1030,9 @@ static bool cond_update_tool(wxAuiToolBar *tb, int toolId, bool enable)
 
 void MyFrame::UpdateButtonsStatus()
 {
+    if (wxGetApp().IsHeadless())
+        return;
+
     bool need_update = false;
 
     bool const loop_enabled =
@@ -1171,6 +1184,13 @@ void MyFrame::DoAlert(const alert_params& params)
 {
     Debug.Write(wxString::Format("Alert: %s\n", params.msg));
 
+    if (wxGetApp().IsHeadless())
+    {
+        // nobody to see the info bar; event server clients get the alert
+        EvtServer.NotifyAlert(params.msg, params.flags);
+        return;
+    }
+
     m_alertDontShowFn = params.fnDontShow;
     m_alertSpecialFn = params.fnSpecial;
     m_alertFnArg = params.arg;
@@ -1259,6 +1279,11 @@ void MyFrame::OnAlertFromThread(wxThreadEvent& event)
     delete params;
 }
 
+void MyFrame::OnFlushSettings(wxThreadEvent& event)
+{
+    SettingsRegistry::Flush();
+}
+
 void MyFrame::OnReconnectCameraFromThread(wxThreadEvent& event)
 {
     DoTryReconnect();
@@ -1329,7 +1354,8 @@ static void StartStatusbarTimer(wxTimer& timer)
 static void SetStatusMsg(PHDStatusBar *statusbar, const wxString& text)
 {
     Debug.Write(wxString::Format("Status Line: %s\n", text));
-    statusbar->StatusMsg(text);
+    if (!wxGetApp().IsHeadless())
+        statusbar->StatusMsg(text);
 }
 
 enum StatusbarThreadMsgType
@@ -1399,7 +1425,8 @@ void MyFrame::OnStatusMsg(wxThreadEvent& event)
 void MyFrame::UpdateStarInfo(double SNR, bool Saturated)
 {
     assert(wxThread::IsMain());
-    m_statusbar->UpdateStarInfo(SNR, Saturated);
+    if (!wxGetApp().IsHeadless())
+        m_statusbar->UpdateStarInfo(SNR, Saturated);
 }
 
 void MyFrame::UpdateStateLabels()
@@ -1430,7 +1457,8 @@ void MyFrame::UpdateGuiderInfo(const GuideStepInfo& info)
         info.mountOffset.Y, info.durationDec, info.directionRA == NORTH ? "NORTH" : "SOUTH"));
 
     assert(wxThread::IsMain());
-    m_statusbar->UpdateGuiderInfo(info);
+    if (!wxGetApp().IsHeadless())
+        m_statusbar->UpdateGuiderInfo(info);
 }
 
 void MyFrame::ClearGuiderInfo()
@@ -1478,6 +1506,9 @@ bool MyFrame::StartWorkerThread(WorkerThread*& pWorkerThread)
             {
                 throw ERROR_INFO("Could not Run() the worker thread!");
             }
+
+            Trace::SetThreadName(pWorkerThread->GetId(),
+                &pWorkerThread == &m_pPrimaryWorkerThread ? "primary worker" : "secondary worker");
         }
     }
     catch (const wxString& Msg)
@@ -1580,6 +1611,8 @@ void MyFrame::OnStatusbarTimerEvent(wxTimerEvent& evt)
 
 void MyFrame::ScheduleExposure()
 {
+    TRACE_SCOPE("ScheduleExposure");
+
     int exposureDuration = RequestedExposureDuration();
     int exposureOptions = GetRawImageMode() ? CAPTURE_BPM_REVIEW : CAPTURE_LIGHT;
     const wxRect& subframe =
@@ -1593,6 +1626,20 @@ void MyFrame::ScheduleExposure()
 
     m_exposurePending = true;
 
+    if (pCamera && pCamera->GetLearnDefects())
+    {
+        DefectLearner::Field field;
+        const PHD_Point& star = pGuider->CurrentPosition();
+        if (star.IsValid())
+        {
+            field.hasStar = true;
+            field.starX = star.X;
+            field.starY = star.Y;
+        }
+        pGuider->GetSearchRegions(&field.exclude);
+        pCamera->SetDefectLearnerField(field);
+    }
+
     usImage *img = new usImage();
 
     wxCriticalSectionLocker lock(m_CSpWorkerThread);
@@ -1602,6 +1649,8 @@ void MyFrame::ScheduleExposure()
 
 void MyFrame::SchedulePrimaryMove(Mount *mount, const GuiderOffset& ofs, unsigned int moveOptions)
 {
+    TRACE_SCOPE("SchedulePrimaryMove");
+
     Debug.Write(wxString::Format("SchedulePrimaryMove(%p, x=%.2f, y=%.2f, opts=%u)\n", mount, ofs.cameraOfs.X, ofs.cameraOfs.Y, moveOptions));
 
     wxCriticalSectionLocker lock(m_CSpWorkerThread);
@@ -1615,6 +1664,8 @@ void MyFrame::SchedulePrimaryMove(Mount *mount, const GuiderOffset& ofs, unsigne
 
 void MyFrame::ScheduleSecondaryMove(Mount *mount, const GuiderOffset& ofs, unsigned int moveOptions)
 {
+    TRACE_SCOPE("ScheduleSecondaryMove");
+
     Debug.Write(wxString::Format("ScheduleSecondaryMove(%p, x=%.2f, y=%.2f, opts=%u)\n", mount, ofs.cameraOfs.X, ofs.cameraOfs.Y, moveOptions));
 
     wxCriticalSectionLocker lock(m_CSpWorkerThread);
@@ -1976,12 +2027,15 @@ void MyFrame::OnClose(wxCloseEvent& event)
 
     GuideLog.Close();
 
-    pConfig->Global.SetString("/perspective", m_mgr.SavePerspective());
-    wxString geometry = wxString::Format("%c;%d;%d;%d;%d",
-        this->IsMaximized() ? '1' : '0',
-        this->GetSize().x, this->GetSize().y,
-        this->GetScreenPosition().x, this->GetScreenPosition().y);
-    pConfig->Global.SetString("/geometry", geometry);
+    if (!wxGetApp().IsHeadless())
+    {
+        pConfig->Global.SetString("/perspective", m_mgr.SavePerspective());
+        wxString geometry = wxString::Format("%c;%d;%d;%d;%d",
+            this->IsMaximized() ? '1' : '0',
+            this->GetSize().x, this->GetSize().y,
+            this->GetScreenPosition().x, this->GetScreenPosition().y);
+        pConfig->Global.SetString("/geometry", geometry);
+    }
 
     if (help->GetFrame())
         help->GetFrame()->Close();
@@ -2060,7 +2114,7 @@ void MyFrame::NotifyGuidingStarted()
 {
     StatusMsg(_("Guiding"));
 
-    m_guidingStarted = wxDateTime::UNow();
+    m_guidingStarted = PhdClock::UNow();
     m_frameCounter = 0;
 
     if (pMount)
@@ -2974,7 +3028,7 @@ void MyFrameConfigDialogCtrlSet::UnloadValues()
     {
         if (m_pResetConfiguration->GetValue())
         {
-            int choice = wxMessageBox(_("This will reset all PHD2 configuration values and restart the program.  Are you sure?"), _("Confirmation"), wxYES_NO);
+            int choice = PhdMessageBox(_("This will reset all PHD2 configuration values and restart the program.  Are you sure?"), _("Confirmation"), wxYES_NO);
 
             if (choice == wxYES)
             {
@@ -2999,7 +3053,7 @@ void MyFrameConfigDialogCtrlSet::UnloadValues()
         pFrame->SetLanguage(m_LanguageIDs[language]);
         if (m_oldLanguageChoice != language)
         {
-            int val = wxMessageBox(_("You must restart PHD2 for the language change to take effect.\n"
+            int val = PhdMessageBox(_("You must restart PHD2 for the language change to take effect.\n"
                 "Would you like to restart PHD2 now?"), _("Restart PHD2"), wxYES_NO | wxCENTRE);
             if (val == wxYES)
                 wxGetApp().RestartApp();
@@ -56,6 +56,7 @@ wxDECLARE_EVENT(STATUSBAR_ENQUEUE_EVENT, wxCommandEvent);
 wxDECLARE_EVENT(STATUSBAR_TIMER_EVENT, wxTimerEvent);
 wxDECLARE_EVENT(SET_STATUS_TEXT_EVENT, wxThreadEvent);
 wxDECLARE_EVENT(ALERT_FROM_THREAD_EVENT, wxThreadEvent);
+wxDECLARE_EVENT(SETTINGS_FLUSH_EVENT, wxThreadEvent);
 
 enum NOISE_REDUCTION_METHOD
 {
@@ -263,6 +264,7 @@ public:
     void OnUpgrade(wxCommandEvent& evt);
     void OnHelpOnline(wxCommandEvent& evt);
     void OnHelpLogFolder(wxCommandEvent& evt);
+    void OnHelpSaveTrace(wxCommandEvent& evt);
     void OnHelpUploadLogs(wxCommandEvent& evt);
     void OnInstructions(wxCommandEvent& evt);
     void OnSave(wxCommandEvent& evt);
@@ -463,6 +465,7 @@ private:
     void OnAlertButton(wxCommandEvent& evt);
     void OnAlertHelp(wxCommandEvent& evt);
     void OnAlertFromThread(wxThreadEvent& event);
+    void OnFlushSettings(wxThreadEvent& event);
     void OnReconnectCameraFromThread(wxThreadEvent& event);
     void OnStatusbarTimerEvent(wxTimerEvent& evt);
     void OnUpdaterStateChanged(wxThreadEvent& event);
@@ -557,6 +560,7 @@ enum {
 
         GEAR_BUTTON_CONNECT_ALL,
         GEAR_BUTTON_DISCONNECT_ALL,
+        GEAR_ENUM_TIMER,
     GEAR_DIALOG_IDS_END,
     CTRL_GAMMA,
     WIN_VFW,  // Dummy event to capture VFW streams
@@ -643,6 +647,7 @@ enum {
     MENU_HELP_ONLINE,
     MENU_HELP_UPLOAD_LOGS,
     MENU_HELP_LOG_FOLDER,
+    MENU_HELP_SAVE_TRACE,
 };
 
 enum {
@@ -650,6 +655,10 @@ enum {
     SOCK_SERVER_CLIENT_ID,
     EVENT_SERVER_ID,
     EVENT_SERVER_CLIENT_ID,
+    FRAME_SERVER_ID,
+    FRAME_SERVER_CLIENT_ID,
+    METRICS_SERVER_ID,
+    METRICS_SERVER_CLIENT_ID,
 };
 
 wxDECLARE_EVENT(APPSTATE_NOTIFY_EVENT, wxCommandEvent);
@@ -673,7 +682,7 @@ inline double MyFrame::GetPixelScale(double pixelSizeMicrons, int focalLengthMm,
 
 inline double MyFrame::TimeSinceGuidingStarted() const
 {
-    return (wxDateTime::UNow() - m_guidingStarted).GetMilliseconds().ToDouble() / 1000.0;
+    return (PhdClock::UNow() - m_guidingStarted).GetMilliseconds().ToDouble() / 1000.0;
 }
 
 inline Star::FindMode MyFrame::GetStarFindMode() const
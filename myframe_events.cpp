@@ -167,7 +167,7 @@ void MyFrame::OnQuit(wxCommandEvent& WXUNUSED(event))
 
 void MyFrame::OnInstructions(wxCommandEvent& WXUNUSED(event))
 {
-    wxMessageBox(wxString::Format(_("Welcome to PHD2 (Push Here Dummy, Gen2) Guiding\n\n \
+    PhdMessageBox(wxString::Format(_("Welcome to PHD2 (Push Here Dummy, Gen2) Guiding\n\n \
 Basic operation is quite simple (hence the 'PHD')\n\n \
   1) Press the green 'USB' button, select your camera and mount, click on 'Connect All'\n \
   2) Pick an exposure duration from the drop-down list. Try 2 seconds to start.\n \
@@ -214,6 +214,19 @@ void MyFrame::OnHelpLogFolder(wxCommandEvent& evt)
     _shell_open(Debug.GetLogDir());
 }
 
+void MyFrame::OnHelpSaveTrace(wxCommandEvent& evt)
+{
+    wxString filename = Trace::DefaultFilename();
+
+    if (Trace::Export(filename))
+    {
+        Alert(wxString::Format(_("Could not save performance trace %s"), filename));
+        return;
+    }
+
+    StatusMsg(wxString::Format(_("Performance trace saved to %s"), filename));
+}
+
 void MyFrame::OnHelpUploadLogs(wxCommandEvent& evt)
 {
     LogUploader::UploadLogs();
@@ -374,7 +387,7 @@ void MyFrame::OnLoopExposure(wxCommandEvent& WXUNUSED(event))
     {
         if (!pCamera || !pCamera->Connected)
         {
-            wxMessageBox(_("Please connect to a camera first"),_("Info"));
+            PhdMessageBox(_("Please connect to a camera first"),_("Info"));
             throw ERROR_INFO("Camera not connected");
         }
 
@@ -438,6 +451,8 @@ static void WarnRawImageMode(void)
  */
 void MyFrame::OnExposeComplete(usImage *pNewFrame, bool err)
 {
+    TRACE_SCOPE("OnExposeComplete");
+
     try
     {
         Debug.Write("OnExposeComplete: enter\n");
@@ -614,7 +629,7 @@ void MyFrame::OnDark(wxCommandEvent& WXUNUSED(event))
 {
     if (!pCamera || !pCamera->Connected)
     {
-        wxMessageBox(_("Please connect to a camera first"), _("Info"));
+        PhdMessageBox(_("Please connect to a camera first"), _("Info"));
         return;
     }
 
@@ -717,7 +732,7 @@ void MyFrame::OnRefineDefMap(wxCommandEvent& evt)
 {
     if (!pCamera || !pCamera->Connected)
     {
-        wxMessageBox(_("Please connect to a camera first"), _("Info"));
+        PhdMessageBox(_("Please connect to a camera first"), _("Info"));
         return;
     }
 
@@ -741,7 +756,7 @@ void MyFrame::OnImportCamCal(wxCommandEvent& evt)
 {
     if (!pCamera)
     {
-        wxMessageBox(_("Please connect a camera first."));
+        PhdMessageBox(_("Please connect a camera first."));
         return;
     }
 
@@ -962,7 +977,7 @@ void MyFrame::GuideButtonClick(bool interactive)
 
         if (pGuider->GetState() < STATE_SELECTED)
         {
-            wxMessageBox(_T("Please select a guide star before attempting to guide"));
+            PhdMessageBox(_T("Please select a guide star before attempting to guide"));
             throw ERROR_INFO("Unable to guide with state < STATE_SELECTED");
         }
 
@@ -1020,7 +1035,7 @@ void MyFrame::OnTestGuide(wxCommandEvent& WXUNUSED(evt))
     {
         if (!pSecondaryMount || !pSecondaryMount->IsConnected())
         {
-            wxMessageBox(_("Please connect a mount first."), _("Manual Guide"));
+            PhdMessageBox(_("Please connect a mount first."), _("Manual Guide"));
             return;
         }
     }
@@ -1037,7 +1052,7 @@ void MyFrame::OnStarCrossTest(wxCommandEvent& evt)
     {
         if (!pSecondaryMount || !pSecondaryMount->IsConnected())
         {
-            wxMessageBox(_("Please connect a mount first."), _("Star-Cross Test"));
+            PhdMessageBox(_("Please connect a mount first."), _("Star-Cross Test"));
             return;
         }
     }
@@ -62,3 +62,47 @@ bool OnboardST4::ST4PulseGuideScope(int direction, int duration)
     assert(false);
     return true;
 }
+
+bool OnboardST4::ST4CanPulseConcurrently(void)
+{
+    return false;
+}
+
+bool OnboardST4::ST4PulseGuideScopeConcurrent(int raDirection, int raDuration, int decDirection, int decDuration)
+{
+    assert(false);
+    return true;
+}
+
+// Drive two pulses on independent relays from the calling thread. Both relays
+// are switched on together and each is switched off when its own duration has
+// elapsed, so the pair completes in the time of the longer pulse.
+bool OnboardST4::ST4RunConcurrentPulses(int direction1, int duration1, int direction2, int duration2, const ST4RelayFn& setRelay)
+{
+    if (duration2 < duration1)
+    {
+        std::swap(direction1, direction2);
+        std::swap(duration1, duration2);
+    }
+
+    if (setRelay(direction1, true))
+        return true;
+
+    if (setRelay(direction2, true))
+    {
+        setRelay(direction1, false);
+        return true;
+    }
+
+    ClockStopWatch swatch;
+
+    bool interrupted = WorkerThread::MilliSleep(duration1, WorkerThread::INT_ANY) != 0;
+    bool err = setRelay(direction1, false);
+
+    long remaining = duration2 - swatch.Time();
+    if (!interrupted && remaining > 0)
+        WorkerThread::MilliSleep(remaining, WorkerThread::INT_ANY);
+    err = setRelay(direction2, false) || err;
+
+    return err;
+}
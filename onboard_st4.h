@@ -36,6 +36,8 @@
 #ifndef ONBOARD_ST4_H_INCLUDED
 #define ONBOARD_ST4_H_INCLUDED
 
+#include <functional>
+
 class OnboardST4
 {
 public:
@@ -44,6 +46,13 @@ public:
     virtual bool    ST4HasNonGuiMove(void);
     virtual bool    ST4SynchronousOnly(void);
     virtual bool    ST4PulseGuideScope(int direction, int duration);
+    // hosts with independent relays for each direction can pulse RA and Dec at the same time
+    virtual bool    ST4CanPulseConcurrently(void);
+    virtual bool    ST4PulseGuideScopeConcurrent(int raDirection, int raDuration, int decDirection, int decDuration);
+
+protected:
+    typedef std::function<bool(int direction, bool on)> ST4RelayFn;
+    static bool     ST4RunConcurrentPulses(int direction1, int duration1, int direction2, int duration2, const ST4RelayFn& setRelay);
 };
 
 #endif //ONBOARD_ST4_H_INCLUDED
@@ -0,0 +1,268 @@
+/*
+ *  phase_correlation.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PHASE_CORRELATION_H_INCLUDED
+#define PHASE_CORRELATION_H_INCLUDED
+
+// The phase correlation of FrameRegistration: the shift between two square
+// windows of a star field, located to a fraction of a pixel. It does not
+// depend on wxWidgets so it can be run outside PHD2 (see
+// tests/frame_registration_test.cpp).
+
+#include "computepool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+class PhaseCorrelation
+{
+    typedef std::complex<double> Complex;
+
+    enum { TRANSFORM_GRAIN = 16 };  // rows or columns per parallel range
+
+    int m_size;                         // window side, a power of 2
+    std::vector<double> m_taper;        // edge taper, one dimension
+    std::vector<double> m_lowpass;      // cross-power weight for each frequency
+    double m_weight;                    // sum of m_lowpass
+    std::vector<Complex> m_twiddle;     // exp(-2 pi i k / m_size)
+    std::vector<Complex> m_refSpectrum; // conjugated spectrum of the reference window
+
+public:
+    PhaseCorrelation() : m_size(0), m_weight(0.0) { }
+
+    int Size() const { return m_size; }
+
+    // Prepare for windows of size x size pixels, size a power of 2.
+    // peakSigma is the width in pixels of the correlation peak after
+    // low-pass weighting.
+    void Init(int size, double peakSigma)
+    {
+        static const double PI = 3.14159265358979323846;
+
+        m_refSpectrum.clear();
+
+        if (size == m_size)
+            return;
+
+        m_size = size;
+
+        // Tukey window: flat except for a cosine roll-off over the outer
+        // eighth on each side, so stars off center still count fully
+        m_taper.resize(size);
+        int const edge = size / 8;
+        for (int i = 0; i < size; i++)
+        {
+            int const d = std::min(i, size - 1 - i);
+            m_taper[i] = d < edge ? 0.5 - 0.5 * cos(PI * (d + 0.5) / edge) : 1.0;
+        }
+
+        m_twiddle.resize(size / 2);
+        for (int k = 0; k < size / 2; k++)
+            m_twiddle[k] = std::polar(1.0, -2.0 * PI * k / size);
+
+        // the transform of a Gaussian of width peakSigma
+        m_lowpass.resize(size * size);
+        m_weight = 0.0;
+        double const c = -2.0 * PI * PI * peakSigma * peakSigma / ((double) size * size);
+        for (int y = 0; y < size; y++)
+        {
+            int const fy = y <= size / 2 ? y : y - size;
+            for (int x = 0; x < size; x++)
+            {
+                int const fx = x <= size / 2 ? x : x - size;
+                m_lowpass[y * size + x] = exp(c * (fx * fx + fy * fy));
+                m_weight += m_lowpass[y * size + x];
+            }
+        }
+    }
+
+    // Take the reference window, Size() x Size() pixels in rows
+    void SetReference(const unsigned short *window)
+    {
+        Prepare(window, m_refSpectrum);
+        Transform(m_refSpectrum, false);
+        for (Complex& c : m_refSpectrum)
+            c = std::conj(c);
+    }
+
+    // Shift (dx, dy) of the star field in window relative to the reference
+    // window, up to maxShift pixels in x and y, and the height of the
+    // correlation peak, near 1 for identical windows. Returns true if the
+    // peak is lower than minQuality.
+    bool Measure(const unsigned short *window, int maxShift, double minQuality, double *dx, double *dy, double *quality) const
+    {
+        int const n = m_size;
+
+        std::vector<Complex> corr;
+        Prepare(window, corr);
+        Transform(corr, false);
+
+        // normalized cross-power spectrum; only the phase difference remains
+        for (int i = 0; i < n * n; i++)
+        {
+            Complex const c = corr[i] * m_refSpectrum[i];
+            double const mag = std::abs(c);
+            corr[i] = mag > 0.0 ? c * (m_lowpass[i] / mag) : Complex(0.0, 0.0);
+        }
+
+        Transform(corr, true);
+
+        // Sparse fields also correlate where one star of the window falls on
+        // another star of the reference, so the peak is only looked for
+        // within the expected range of the shift
+        int const m = std::min(maxShift, n / 2 - 1);
+        int px = 0, py = 0;
+        for (int y = -m; y <= m; y++)
+        {
+            for (int x = -m; x <= m; x++)
+            {
+                if (corr[((y + n) % n) * n + (x + n) % n].real() > corr[((py + n) % n) * n + (px + n) % n].real())
+                {
+                    px = x;
+                    py = y;
+                }
+            }
+        }
+
+        px = (px + n) % n;
+        py = (py + n) % n;
+        double const v0 = corr[py * n + px].real();
+
+        *quality = v0 / m_weight;
+
+        if (*quality < minQuality)
+            return true;
+
+        // locate the peak to a fraction of a pixel from its neighbors, which
+        // wrap around the window edges
+        auto at = [&](int x, int y) { return corr[((y + n) % n) * n + (x + n) % n].real(); };
+        auto refine = [](double vm, double v, double vp) {
+            if (vm > 0.0 && vp > 0.0)
+            {
+                // Gaussian peak: fit a parabola to the log
+                double const lm = log(vm), l = log(v), lp = log(vp);
+                double const d = lm - 2.0 * l + lp;
+                return d < 0.0 ? 0.5 * (lm - lp) / d : 0.0;
+            }
+            double const d = vm - 2.0 * v + vp;
+            return d < 0.0 ? 0.5 * (vm - vp) / d : 0.0;
+        };
+
+        *dx = (px <= n / 2 ? px : px - n) + refine(at(px - 1, py), v0, at(px + 1, py));
+        *dy = (py <= n / 2 ? py : py - n) + refine(at(px, py - 1), v0, at(px, py + 1));
+
+        return false;
+    }
+
+private:
+    // In-place radix-2 FFT of n points, n a power of 2, with
+    // twiddle[k] = exp(-2 pi i k / n). The inverse transform is not scaled.
+    static void FFT(Complex *a, int n, const Complex *twiddle, bool inverse)
+    {
+        // bit-reversal permutation
+        for (int i = 1, j = 0; i < n; i++)
+        {
+            int bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j)
+                std::swap(a[i], a[j]);
+        }
+
+        for (int len = 2; len <= n; len <<= 1)
+        {
+            int const half = len >> 1;
+            int const step = n / len;
+            for (int i = 0; i < n; i += len)
+            {
+                for (int k = 0; k < half; k++)
+                {
+                    Complex w = twiddle[k * step];
+                    if (inverse)
+                        w = std::conj(w);
+                    Complex const u = a[i + k];
+                    Complex const v = a[i + k + half] * w;
+                    a[i + k] = u + v;
+                    a[i + k + half] = u - v;
+                }
+            }
+        }
+    }
+
+    // Subtract the mean and taper the window to zero at its edges so the
+    // edges do not correlate
+    void Prepare(const unsigned short *window, std::vector<Complex>& out) const
+    {
+        int const n = m_size;
+
+        double mean = 0.0;
+        for (int i = 0; i < n * n; i++)
+            mean += window[i];
+        mean /= (double) (n * n);
+
+        out.resize(n * n);
+        for (int y = 0; y < n; y++)
+        {
+            for (int x = 0; x < n; x++)
+                out[y * n + x] = Complex((window[y * n + x] - mean) * m_taper[x] * m_taper[y], 0.0);
+        }
+    }
+
+    // 2-D FFT: transform the rows, then the columns
+    void Transform(std::vector<Complex>& data, bool inverse) const
+    {
+        int const n = m_size;
+
+        ComputePool::ParallelFor(n, TRANSFORM_GRAIN, [&](int begin, int end) {
+            for (int y = begin; y < end; y++)
+                FFT(&data[y * n], n, &m_twiddle[0], inverse);
+        });
+
+        ComputePool::ParallelFor(n, TRANSFORM_GRAIN, [&](int begin, int end) {
+            std::vector<Complex> col(n);
+            for (int x = begin; x < end; x++)
+            {
+                for (int y = 0; y < n; y++)
+                    col[y] = data[y * n + x];
+                FFT(&col[0], n, &m_twiddle[0], inverse);
+                for (int y = 0; y < n; y++)
+                    data[y * n + x] = col[y];
+            }
+        });
+    }
+};
+
+#endif
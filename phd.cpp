@@ -67,6 +67,9 @@ static const wxCmdLineEntryDesc cmdLineDesc[] =
 {
     { wxCMD_LINE_OPTION, "i", "instanceNumber", "sets the PHD2 instance number (default = 1)", wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_PARAM_OPTIONAL},
     { wxCMD_LINE_SWITCH, "R", "Reset", "Reset all PHD2 settings to default values"},
+    { wxCMD_LINE_SWITCH, "V", "virtualClock", "run on a virtual clock (faster than real time simulator sessions)"},
+    { wxCMD_LINE_OPTION, "s", "seed", "random number seed for the camera simulator", wxCMD_LINE_VAL_NUMBER, wxCMD_LINE_PARAM_OPTIONAL},
+    { wxCMD_LINE_SWITCH, nullptr, "headless", "run without showing any windows, controlled only through the event server"},
     { wxCMD_LINE_NONE }
 };
 
@@ -85,7 +88,7 @@ static void DisableOSXAppNap(void)
         if (err.GetCount() > 0 || (out.GetCount() > 0 && out[0].Contains("0"))) // it's not there or disabled
         {
             wxExecute("defaults write " APPKEY " NSAppSleepDisabled -bool YES");
-            wxMessageBox("OSX 10.9's App Nap feature causes problems.  Please quit and relaunch PHD to finish disabling App Nap.");
+            PhdMessageBox("OSX 10.9's App Nap feature causes problems.  Please quit and relaunch PHD to finish disabling App Nap.");
         }
     }
 # undef APPKEY
@@ -108,7 +111,9 @@ struct ExecFuncThreadEvent : public wxThreadEvent
 PhdApp::PhdApp(void)
 {
     m_resetConfig = false;
+    m_headless = false;
     m_instanceNumber = 1;
+    m_simSeed = -1;
 #ifdef  __linux__
     XInitThreads();
 #endif // __linux__
@@ -524,6 +529,10 @@ bool PhdApp::OnInit()
     Debug.Write(wxString::Format("   %s\n", wxGetLinuxDistributionInfo().Description));
 #endif
     Debug.Write(wxString::Format("   %s\n", wxVERSION_STRING));
+    if (PhdClock::IsVirtual())
+        Debug.Write("   virtual clock enabled\n");
+    if (m_headless)
+        Debug.Write("   headless mode\n");
     float dummy;
     Debug.Write(wxString::Format("   cfitsio %.2lf\n", ffvers(&dummy)));
 #if defined(CV_VERSION)
@@ -584,6 +593,16 @@ bool PhdApp::OnInit()
 
     pFrame = new MyFrame(m_instanceNumber, &m_locale);
 
+    if (m_headless)
+    {
+        // the frame is never shown, so it is never laid out or painted, and
+        // there is nobody to answer the profile wizard or the updater; the
+        // event server client selects and connects the equipment profile
+        if (pConfig->IsNewInstance() || (pConfig->NumProfiles() == 1 && pFrame->pGearDialog->IsEmptyProfile()))
+            Debug.Write("headless: no equipment profile has been set up\n");
+        return true;
+    }
+
     pFrame->Show(true);
 
     if (pConfig->IsNewInstance() || (pConfig->NumProfiles() == 1 && pFrame->pGearDialog->IsEmptyProfile()))
@@ -631,6 +650,13 @@ bool PhdApp::OnCmdLineParsed(wxCmdLineParser& parser)
 
     m_resetConfig = parser.Found("R");
 
+    if (parser.Found("V"))
+        PhdClock::EnableVirtualClock();
+
+    (void)parser.Found("s", &m_simSeed);
+
+    m_headless = parser.Found("headless");
+
     return bReturn;
 }
 
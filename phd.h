@@ -156,12 +156,20 @@ WX_DEFINE_ARRAY_DOUBLE(double, ArrayOfDbl);
 #define PHD_MESSAGES_CATALOG "phd2"
 #endif
 
+#include "phdclock.h"
+#include "trace.h"
+#include "metrics.h"
+#include "computepool.h"
 #include "phdconfig.h"
+#include "settings_registry.h"
 #include "configdialog.h"
 #include "optionsbutton.h"
 #include "usImage.h"
 #include "point.h"
 #include "star.h"
+#include "star_pattern.h"
+#include "calibration_fit.h"
+#include "frame_registration.h"
 #include "circbuf.h"
 #include "guidinglog.h"
 #include "graph.h"
@@ -176,6 +184,7 @@ WX_DEFINE_ARRAY_DOUBLE(double, ArrayOfDbl);
 #include "parallelports.h"
 #include "onboard_st4.h"
 #include "cameras.h"
+#include "defect_learner.h"
 #include "camera.h"
 #include "mount.h"
 #include "scopes.h"
@@ -221,6 +230,8 @@ class PhdApp : public wxApp
     wxSingleInstanceChecker *m_instanceChecker;
     long m_instanceNumber;
     bool m_resetConfig;
+    bool m_headless;
+    long m_simSeed;
     wxString m_resourcesDir;
     wxDateTime m_initTime;
 
@@ -243,6 +254,8 @@ public:
     const wxString& GetPHDResourcesDir() const { return m_resourcesDir; }
     wxString GetLocalesDir() const;
     const wxDateTime& GetInitTime() const { return m_initTime; }
+    long GetSimulatorSeed() const { return m_simSeed; } // -1 if not specified
+    bool IsHeadless() const { return m_headless; }
     wxString UserAgent() const;
 };
 
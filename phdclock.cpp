@@ -0,0 +1,107 @@
+/*
+ *  phdclock.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include "virtual_clock.h"
+
+static bool s_virtual;
+static VirtualClock s_clock;
+
+void PhdClock::EnableVirtualClock()
+{
+    // start the virtual clock at the current time so log timestamps look reasonable
+    s_clock.Start(::wxGetUTCTimeMillis().GetValue());
+    s_virtual = true;
+}
+
+bool PhdClock::IsVirtual()
+{
+    return s_virtual;
+}
+
+void PhdClock::AddThread()
+{
+    if (s_virtual)
+        s_clock.AddThread();
+}
+
+void PhdClock::RemoveThread()
+{
+    if (s_virtual)
+        s_clock.RemoveThread();
+}
+
+void PhdClock::BeginWait()
+{
+    if (s_virtual)
+        s_clock.BeginWait();
+}
+
+void PhdClock::EndWait()
+{
+    if (s_virtual)
+        s_clock.EndWait();
+}
+
+wxLongLong PhdClock::UTCMillis()
+{
+    return s_virtual ? wxLongLong(s_clock.Now()) : ::wxGetUTCTimeMillis();
+}
+
+wxDateTime PhdClock::UNow()
+{
+    return s_virtual ? wxDateTime(wxLongLong(s_clock.Now())) : wxDateTime::UNow();
+}
+
+time_t PhdClock::TimeNow()
+{
+    return s_virtual ? (time_t)(s_clock.Now() / 1000) : wxDateTime::GetTimeNow();
+}
+
+std::chrono::system_clock::time_point PhdClock::SystemNow()
+{
+    if (!s_virtual)
+        return std::chrono::system_clock::now();
+
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::milliseconds(s_clock.Now())));
+}
+
+void PhdClock::MilliSleep(unsigned long ms)
+{
+    if (s_virtual)
+        s_clock.Sleep(ms);
+    else
+        wxMilliSleep(ms);
+}
@@ -0,0 +1,80 @@
+/*
+ *  phdclock.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PHDCLOCK_INCLUDED
+#define PHDCLOCK_INCLUDED
+
+#include <chrono>
+
+// Time source for everything that paces a guiding session: worker thread
+// sleeps, the simulators, settling, the guide and debug logs, and the GP
+// guider.
+//
+// Normally this is just the system clock. When the virtual clock is enabled
+// (--virtualClock command-line switch) time stands still until all the
+// worker threads are sleeping or idle, and then jumps to the earliest wake
+// time (see VirtualClock), so a simulator session runs as fast as the CPU
+// allows.
+class PhdClock
+{
+public:
+    static void EnableVirtualClock();
+    static bool IsVirtual();
+
+    // worker threads take part in the virtual clock: AddThread/RemoveThread
+    // when they start and end, BeginWait/EndWait around waiting for work
+    static void AddThread();
+    static void RemoveThread();
+    static void BeginWait();
+    static void EndWait();
+
+    static wxLongLong UTCMillis();
+    static wxDateTime UNow();
+    static time_t TimeNow();
+    static std::chrono::system_clock::time_point SystemNow();
+
+    static void MilliSleep(unsigned long ms);
+};
+
+// wxStopWatch work-alike measuring PhdClock time
+class ClockStopWatch
+{
+    wxLongLong m_t0;
+
+public:
+    ClockStopWatch() { Start(); }
+    void Start(long t0 = 0) { m_t0 = PhdClock::UTCMillis() - t0; }
+    long Time() const { return (PhdClock::UTCMillis() - m_t0).ToLong(); }
+};
+
+#endif
@@ -197,6 +197,7 @@ PhdConfig::PhdConfig(const wxString& baseConfigName, int instance)
 
 PhdConfig::~PhdConfig()
 {
+    SettingsRegistry::Flush();
     delete Global.m_pConfig;
 }
 
@@ -279,6 +280,7 @@ void PhdConfig::InitializeProfile()
     m_currentProfileId = currentProfile;
     Profile.SelectProfile(currentProfile);
     Global.SetInt("/currentProfile", currentProfile); // in case we just created it
+    SettingsRegistry::Load();
 }
 
 void PhdConfig::DeleteAll()
@@ -287,6 +289,8 @@ void PhdConfig::DeleteAll()
     {
         Debug.AddLine(wxString::Format("Deleting all configuration data"));
 
+        SettingsRegistry::Flush();
+
         for (unsigned int i = 0; i < NumProfiles(); i++)
             pFrame->DeleteDarkLibraryFiles(i);
 
@@ -318,9 +322,12 @@ bool PhdConfig::SetCurrentProfile(const wxString& name)
         }
     }
 
+    SettingsRegistry::Flush();
+
     m_currentProfileId = id;
     Profile.SelectProfile(id);
     Global.SetInt("/currentProfile", id);
+    SettingsRegistry::Load();
 
     return false;
 }
@@ -469,6 +476,8 @@ bool PhdConfig::CloneProfile(const wxString& dest, const wxString& source)
         return true; // ??? should never happen
     }
 
+    SettingsRegistry::Flush();
+
     CopyGroup(Global.m_pConfig, wxString::Format("/profile/%d", srcId), wxString::Format("/profile/%d", dstId));
     // name was overwritten by copy
     Global.SetString(wxString::Format("/profile/%d/name", dstId), dest);
@@ -496,6 +505,7 @@ void PhdConfig::DeleteProfile(const wxString& name)
         m_currentProfileId = FirstProfile();
         Profile.SelectProfile(m_currentProfileId);
         Global.SetInt("/currentProfile", m_currentProfileId);
+        SettingsRegistry::Load();
     }
 }
 
@@ -615,6 +625,8 @@ bool PhdConfig::ReadProfile(const wxString& filename)
         }
     }
 
+    SettingsRegistry::Load();
+
     return false;
 }
 
@@ -685,6 +697,8 @@ bool PhdConfig::WriteProfile(const wxString& filename)
     }
     wxTextOutputStream tos(os);
 
+    SettingsRegistry::Flush();
+
     tos.WriteString("PHD Profile " PROFILE_STREAM_VERSION "\n");
     wxString profile = wxString::Format("/profile/%d", m_currentProfileId);
     WriteGroup(tos, Profile.m_pConfig, profile, profile);
@@ -57,6 +57,10 @@ enum SettleOp
 
 enum { SETTLING_TIME_DISABLED = 9999 };
 
+// largest difference in pixels between the registered shift and the shift of
+// the guide star for the registered shift to be used
+static const double MAX_REGISTRATION_DISAGREEMENT = 3.0;
+
 struct ControllerState
 {
     State state;
@@ -68,8 +72,11 @@ struct ControllerState
     SettleOp settleOp;
     SettleParams settle;
     bool settlePriorFrameInRange;
-    wxStopWatch *settleTimeout;
-    wxStopWatch *settleInRange;
+    ClockStopWatch *settleTimeout;
+    ClockStopWatch *settleInRange;
+    FrameRegistration *registration;
+    PHD_Point registrationStar;     // star position in the reference frame
+    PHD_Point registrationLock;     // lock position in the reference frame
     DEC_GUIDE_MODE saveDecGuideMode;
     bool overrideDecGuideMode;
     int settleFrameCount;
@@ -82,8 +89,9 @@ static ControllerState ctrl;
 
 void PhdController::OnAppInit()
 {
-    ctrl.settleTimeout = new wxStopWatch();
-    ctrl.settleInRange = new wxStopWatch();
+    ctrl.settleTimeout = new ClockStopWatch();
+    ctrl.settleInRange = new ClockStopWatch();
+    ctrl.registration = new FrameRegistration();
 }
 
 void PhdController::OnAppExit()
@@ -92,6 +100,8 @@ void PhdController::OnAppExit()
     ctrl.settleTimeout = NULL;
     delete ctrl.settleInRange;
     ctrl.settleInRange = NULL;
+    delete ctrl.registration;
+    ctrl.registration = NULL;
 }
 
 bool PhdController::IsSettling()
@@ -122,6 +132,7 @@ bool PhdController::Guide(bool recalibrate, const SettleParams& settle, wxString
     ctrl.forceCalibration = recalibrate;
     ctrl.settleOp = OP_GUIDE;
     ctrl.settle = settle;
+    ctrl.registration->Reset();
     SETSTATE(STATE_SETUP);
     UpdateControllerState();
     return true;
@@ -135,6 +146,72 @@ static void do_fail(const wxString& msg)
     SETSTATE(STATE_FINISH);
 }
 
+static void set_registration_reference(void)
+{
+    Guider *guider = pFrame->pGuider;
+    const usImage *img = guider->CurrentImage();
+
+    if (!img || !guider->IsLocked() || !guider->LockPosition().IsValid())
+    {
+        Debug.AddLine("PhdController: no reference frame for registration");
+        return;
+    }
+
+    if (!ctrl.registration->SetReference(*img, guider->CurrentPosition()))
+    {
+        ctrl.registrationStar = guider->CurrentPosition();
+        ctrl.registrationLock = guider->LockPosition();
+    }
+}
+
+// The distance of the star from the lock position, from the shift of the
+// whole field since the reference frame rather than from the position of
+// the star alone. Returns false if the shift could not be measured.
+static bool registered_guide_error(double *error)
+{
+    Guider *guider = pFrame->pGuider;
+    const usImage *img = guider->CurrentImage();
+    const PHD_Point& lockPos = guider->LockPosition();
+
+    if (!ctrl.registration->IsValid() || !img || !lockPos.IsValid())
+        return false;
+
+    // the lock position moved by the dither amount, and so should the field
+    PHD_Point shift;
+    double quality;
+    if (ctrl.registration->Measure(*img, lockPos - ctrl.registrationLock, &shift, &quality))
+        return false;
+
+    // A field with few stars can correlate at a wrong shift. The guide star
+    // position is noisy but never that far off, so a shift it disagrees
+    // with is not used.
+    const PHD_Point& starPos = guider->CurrentPosition();
+    if (starPos.IsValid() && (starPos - ctrl.registrationStar).Distance(shift) > MAX_REGISTRATION_DISAGREEMENT)
+    {
+        Debug.Write(wxString::Format("PhdController: registered shift (%.2f, %.2f) quality %.2f disagrees with the guide star, not used\n",
+                                     shift.X, shift.Y, quality));
+        return false;
+    }
+
+    PHD_Point const ofs = ctrl.registrationStar + shift - lockPos;
+
+    const Scope *const scope = TheScope();
+    if (scope && scope->GetDecGuideMode() == DEC_NONE)
+    {
+        PHD_Point mountOfs;
+        if (!pMount || pMount->TransformCameraCoordinatesToMountCoordinates(ofs, mountOfs, false))
+            return false;
+        *error = fabs(mountOfs.X);
+    }
+    else
+        *error = ofs.Distance();
+
+    Debug.Write(wxString::Format("PhdController: registered shift (%.2f, %.2f) quality %.2f, distance = %.2f\n",
+                                 shift.X, shift.Y, quality, *error));
+
+    return true;
+}
+
 bool PhdController::Dither(double pixels, bool forceRaOnly, const SettleParams& settle, wxString *errMsg)
 
 {
@@ -182,6 +259,12 @@ bool PhdController::Dither(double pixels, bool forceRaOnly, const SettleParams&
         }
     }
 
+    // the last frame before the dither is the reference for measuring the
+    // settle distance by registration
+    ctrl.registration->Reset();
+    if (settle.registration)
+        set_registration_reference();
+
     bool error = pFrame->Dither(pixels, raOnly);
     if (error)
     {
@@ -208,6 +291,7 @@ bool PhdController::Dither(double pixels, int settleFrames, wxString *errMsg)
     settle.settleTimeSec = SETTLING_TIME_DISABLED;
     settle.timeoutSec = SETTLING_TIME_DISABLED;
     settle.frames = settleFrames;
+    settle.registration = false;
 
     return Dither(pixels, false, settle, errMsg);
 }
@@ -483,6 +567,8 @@ void PhdController::UpdateControllerState(void)
         case STATE_SETTLE_WAIT: {
             bool lockedOnStar = pFrame->pGuider->IsLocked();
             double currentError = pFrame->CurrentGuideError();
+            if (lockedOnStar && ctrl.settle.registration)
+                registered_guide_error(&currentError);
             bool inRange = lockedOnStar && currentError <= ctrl.settle.tolerancePx;
             bool aoBumpInProgress = IsAoBumpInProgress();
             long timeInRange = 0;
@@ -41,6 +41,7 @@ struct SettleParams
     int settleTimeSec;   // time to be within tolerance
     int timeoutSec;      // timeout value
     int frames;          // number of frames
+    bool registration;   // measure the distance by registering the whole frame
 };
 
 class PhdController
@@ -915,13 +915,13 @@ void PHD2Updater::CheckNow()
     UpdateNow(updater).Run();
 
     if (updater->m_status == UPD_UP_TO_DATE)
-        wxMessageBox(_("PHD2 is up to date"), _("Software Update"), wxOK);
+        PhdMessageBox(_("PHD2 is up to date"), _("Software Update"), wxOK);
     else if (updater->m_status == UPD_READY_FOR_INSTALL || updater->m_status == UPD_DOWNLOAD_DONE)
         updater->ShowUpdate(UpdaterDialog::MODE_INSTALL, UpdaterDialog::INTERACTIVE);
     else if (updater->m_status == UPD_UPDATE_NEEDED)
         updater->ShowUpdate(UpdaterDialog::MODE_NOTIFY, UpdaterDialog::INTERACTIVE);
     else if (updater->m_status == UPD_ABORTED && !updater->abort)
-        wxMessageBox(_("Unable to check updates"), _("Software Update"), wxOK | wxICON_WARNING, pFrame);
+        PhdMessageBox(_("Unable to check updates"), _("Software Update"), wxOK | wxICON_WARNING, pFrame);
 
     pFrame->m_upgradeMenuItem->Enable(true);
 }
@@ -52,7 +52,7 @@ wxWindow *PolarDriftTool::CreatePolarDriftToolWindow()
 {
     if (!pCamera || !pCamera->Connected)
     {
-        wxMessageBox(_("Please connect a camera first."));
+        PhdMessageBox(_("Please connect a camera first."));
         return 0;
     }
 
@@ -77,7 +77,7 @@ wxWindow *PolarDriftTool::CreatePolarDriftToolWindow()
     }
     if (pFrame->pGuider->IsCalibratingOrGuiding())
     {
-        wxMessageBox(_("Please wait till Calibration is done and stop guiding"));
+        PhdMessageBox(_("Please wait till Calibration is done and stop guiding"));
         return 0;
     }
 
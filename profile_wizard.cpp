@@ -611,7 +611,7 @@ struct AutoConnectCamera
 
         if (!m_camera || !m_camera->Connected)
         {
-            wxMessageBox(_("PHD2 could not connect to the camera so you may want to deal with that later. "
+            PhdMessageBox(_("PHD2 could not connect to the camera so you may want to deal with that later. "
                 "In the meantime, you can just enter the pixel-size manually along with the "
                 "focal length and binning levels."));
 
@@ -827,7 +827,7 @@ static double GetPixelSize(GuideCamera *cam)
     double rslt;
     if (cam->GetDevicePixelSize(&rslt))
     {
-        wxMessageBox(_("This camera driver doesn't report the pixel size, so you'll need to enter the value manually"));
+        PhdMessageBox(_("This camera driver doesn't report the pixel size, so you'll need to enter the value manually"));
         rslt = 0.;
     }
     return rslt;
@@ -879,7 +879,7 @@ void ProfileWizard::InitMountProps(Scope* theScope)
         ShowStatus(wxEmptyString);
         if (err)
         {
-            wxMessageBox(
+            PhdMessageBox(
                 wxString::Format(_("PHD2 could not connect to the mount, so you'll probably want to deal with that later.  "
                 "In the meantime, if you know the mount guide speed setting, you can enter it manually. "
                 " Otherwise, you can just leave it at the default value of %0.1fx"), Scope::DEFAULT_MOUNT_GUIDE_SPEED));
@@ -892,7 +892,7 @@ void ProfileWizard::InitMountProps(Scope* theScope)
                 speedVal = wxMax(raSpeed, decSpeed) * 3600.0 / (15.0 * siderealSecondPerSec);  // deg/sec -> sidereal multiple
             else
             {
-                wxMessageBox(
+                PhdMessageBox(
                     wxString::Format(_("Apparently, this mount driver doesn't report guide speeds.  If you know the mount guide speed setting, you can enter it manually. "
                     "Otherwise, you can just leave it at the default value of %0.1fx"), Scope::DEFAULT_MOUNT_GUIDE_SPEED));
                 speedVal = Scope::DEFAULT_MOUNT_GUIDE_SPEED;
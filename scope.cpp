@@ -53,6 +53,9 @@ static const GUIDE_ALGORITHM DefaultDecGuideAlgorithm = GUIDE_ALGORITHM_RESIST_S
 static const double DEC_BACKLASH_DISTANCE = 3.0;
 static const int MAX_CALIBRATION_STEPS = 60;
 static const int CAL_ALERT_MINSTEPS = 4;
+static const int CAL_FIT_MIN_SAMPLES = 6;                                    // Start position plus 5 steps
+static const double CAL_FIT_ANGLE_TOLERANCE = 2.0 * M_PI / 180.0;           // 95% interval half-width
+static const double CAL_FIT_RATE_TOLERANCE = 0.05;                          // 95% interval half-width, ratio of rate
 static const double CAL_ALERT_ORTHOGONALITY_TOLERANCE = 12.5;               // Degrees
 static const double CAL_ALERT_DECRATE_DIFFERENCE = 0.20;                    // Ratio tolerance
 static const double CAL_ALERT_AXISRATES_TOLERANCE = 0.20;                   // Ratio tolerance
@@ -647,95 +650,104 @@ void Scope::AlertLimitReached(int duration, GuideAxis axis)
     }
 }
 
-Mount::MOVE_RESULT Scope::MoveAxis(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, MoveResultInfo *moveResult)
+// Apply the Dec guide mode and the max duration settings to the duration of a
+// guide step (or deduced step) move
+int Scope::LimitGuideDuration(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, bool *limitReached)
 {
-    MOVE_RESULT result = MOVE_OK;
-    bool limitReached = false;
+    *limitReached = false;
 
-    try
+    if ((moveOptions & (MOVEOPT_ALGO_RESULT | MOVEOPT_ALGO_DEDUCE)) == 0)
+        return duration;
+
+    switch (direction)
     {
-        Debug.Write(wxString::Format("MoveAxis(%s, %d, %s)\n", DirectionChar(direction), duration, DumpMoveOptionBits(moveOptions)));
+        case NORTH:
+        case SOUTH:
 
-        if (!m_guidingEnabled && (moveOptions & MOVEOPT_MANUAL) == 0)
-        {
-            throw THROW_INFO("Guiding disabled");
-        }
+            // Enforce dec guide mode and max duration
+            if ((m_decGuideMode == DEC_NONE) ||
+                (direction == SOUTH && m_decGuideMode == DEC_NORTH) ||
+                (direction == NORTH && m_decGuideMode == DEC_SOUTH))
+            {
+                duration = 0;
+                Debug.Write("duration set to 0 by GuideMode\n");
+            }
 
-        // Compute the actual guide durations
+            if (duration > m_maxDecDuration)
+            {
+                duration = m_maxDecDuration;
+                Debug.Write(wxString::Format("duration set to %d by maxDecDuration\n", duration));
+                *limitReached = true;
+            }
 
-        switch (direction)
-        {
-            case NORTH:
-            case SOUTH:
+            if (*limitReached && direction == m_decLimitReachedDirection)
+            {
+                if (++m_decLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
+                    AlertLimitReached(duration, GUIDE_DEC);
+            }
+            else
+                m_decLimitReachedCount = 0;
 
-                // Enforce dec guide mode and max duration for guide step (or deduced step) moves
-                if (moveOptions & (MOVEOPT_ALGO_RESULT | MOVEOPT_ALGO_DEDUCE))
-                {
-                    if ((m_decGuideMode == DEC_NONE) ||
-                        (direction == SOUTH && m_decGuideMode == DEC_NORTH) ||
-                        (direction == NORTH && m_decGuideMode == DEC_SOUTH))
-                    {
-                        duration = 0;
-                        Debug.Write("duration set to 0 by GuideMode\n");
-                    }
+            if (*limitReached)
+                m_decLimitReachedDirection = direction;
+            else
+                m_decLimitReachedDirection = NONE;
+            break;
 
-                    if (duration > m_maxDecDuration)
-                    {
-                        duration = m_maxDecDuration;
-                        Debug.Write(wxString::Format("duration set to %d by maxDecDuration\n", duration));
-                        limitReached = true;
-                    }
+        case EAST:
+        case WEST:
 
-                    if (limitReached && direction == m_decLimitReachedDirection)
-                    {
-                        if (++m_decLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
-                            AlertLimitReached(duration, GUIDE_DEC);
-                    }
-                    else
-                        m_decLimitReachedCount = 0;
+            // Enforce max duration
+            if (duration > m_maxRaDuration)
+            {
+                duration = m_maxRaDuration;
+                Debug.Write(wxString::Format("duration set to %d by maxRaDuration\n", duration));
+                *limitReached = true;
+            }
 
-                    if (limitReached)
-                        m_decLimitReachedDirection = direction;
-                    else
-                        m_decLimitReachedDirection = NONE;
-                }
-                break;
-            case EAST:
-            case WEST:
+            if (*limitReached && direction == m_raLimitReachedDirection)
+            {
+                if (++m_raLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
+                    AlertLimitReached(duration, GUIDE_RA);
+            }
+            else
+                m_raLimitReachedCount = 0;
 
-                // Enforce max duration for guide step (or deduced step) moves
-                if (moveOptions & (MOVEOPT_ALGO_RESULT | MOVEOPT_ALGO_DEDUCE))
-                {
-                    if (duration > m_maxRaDuration)
-                    {
-                        duration = m_maxRaDuration;
-                        Debug.Write(wxString::Format("duration set to %d by maxRaDuration\n", duration));
-                        limitReached = true;
-                    }
+            if (*limitReached)
+                m_raLimitReachedDirection = direction;
+            else
+                m_raLimitReachedDirection = NONE;
+            break;
 
-                    if (limitReached && direction == m_raLimitReachedDirection)
-                    {
-                        if (++m_raLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
-                            AlertLimitReached(duration, GUIDE_RA);
-                    }
-                    else
-                        m_raLimitReachedCount = 0;
+        case NONE:
+            break;
+    }
 
-                    if (limitReached)
-                        m_raLimitReachedDirection = direction;
-                    else
-                        m_raLimitReachedDirection = NONE;
-                }
-                break;
+    return duration;
+}
 
-            case NONE:
-                break;
+Mount::MOVE_RESULT Scope::MoveAxis(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, MoveResultInfo *moveResult)
+{
+    MOVE_RESULT result = MOVE_OK;
+    bool limitReached = false;
+
+    try
+    {
+        Debug.Write(wxString::Format("MoveAxis(%s, %d, %s)\n", DirectionChar(direction), duration, DumpMoveOptionBits(moveOptions)));
+
+        if (!m_guidingEnabled && (moveOptions & MOVEOPT_MANUAL) == 0)
+        {
+            throw THROW_INFO("Guiding disabled");
         }
 
+        // Compute the actual guide duration
+        duration = LimitGuideDuration(direction, duration, moveOptions, &limitReached);
+
         // Actually do the guide
         assert(duration >= 0);
         if (duration > 0)
         {
+            TRACE_SCOPE("Scope::Guide", "duration", duration);
             result = Guide(direction, duration);
             if (result != MOVE_OK)
             {
@@ -762,6 +774,84 @@ Mount::MOVE_RESULT Scope::MoveAxis(GUIDE_DIRECTION direction, int duration, unsi
     return result;
 }
 
+bool Scope::CanMoveAxesConcurrently()
+{
+    return CanGuideConcurrently();
+}
+
+bool Scope::CanGuideConcurrently()
+{
+    return false;
+}
+
+Mount::MOVE_RESULT Scope::GuideConcurrent(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration)
+{
+    assert(false);
+    return MOVE_ERROR;
+}
+
+// Run the RA and Dec pulses of a guide step at the same time, so the step
+// takes as long as the longer pulse rather than the sum of both
+Mount::MOVE_RESULT Scope::MoveAxes(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration,
+                                   unsigned int moveOptions, MoveResultInfo *raMoveResult, MoveResultInfo *decMoveResult)
+{
+    MOVE_RESULT result = MOVE_OK;
+    bool raLimitReached = false;
+    bool decLimitReached = false;
+
+    try
+    {
+        Debug.Write(wxString::Format("MoveAxes(%s, %d, %s, %d, %s)\n", DirectionChar(raDirection), raDuration,
+            DirectionChar(decDirection), decDuration, DumpMoveOptionBits(moveOptions)));
+
+        if (!m_guidingEnabled && (moveOptions & MOVEOPT_MANUAL) == 0)
+        {
+            throw THROW_INFO("Guiding disabled");
+        }
+
+        raDuration = LimitGuideDuration(raDirection, raDuration, moveOptions, &raLimitReached);
+        decDuration = LimitGuideDuration(decDirection, decDuration, moveOptions, &decLimitReached);
+
+        assert(raDuration >= 0 && decDuration >= 0);
+        if (raDuration > 0 && decDuration > 0)
+        {
+            TRACE_SCOPE("Scope::GuideConcurrent", "duration", wxMax(raDuration, decDuration));
+            result = GuideConcurrent(raDirection, raDuration, decDirection, decDuration);
+        }
+        else if (raDuration > 0)
+        {
+            TRACE_SCOPE("Scope::Guide", "duration", raDuration);
+            result = Guide(raDirection, raDuration);
+        }
+        else if (decDuration > 0)
+        {
+            TRACE_SCOPE("Scope::Guide", "duration", decDuration);
+            result = Guide(decDirection, decDuration);
+        }
+
+        if (result != MOVE_OK)
+        {
+            throw ERROR_INFO("guide failed");
+        }
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        if (result == MOVE_OK)
+            result = MOVE_ERROR;
+        raDuration = decDuration = 0;
+    }
+
+    Debug.Write(wxString::Format("MoveAxes returns status %d, amounts %d, %d\n", result, raDuration, decDuration));
+
+    raMoveResult->amountMoved = raDuration;
+    raMoveResult->limited = raLimitReached;
+    decMoveResult->amountMoved = decDuration;
+    decMoveResult->limited = decLimitReached;
+
+    return result;
+}
+
 static wxString CalibrationWarningKey(CalibrationIssueType etype)
 {
     wxString qual;
@@ -1010,6 +1100,8 @@ bool Scope::BeginCalibration(const PHD_Point& currentLocation)
         m_calibrationState = CALIBRATION_STATE_GO_WEST;
         m_calibrationDetails.raSteps.clear();
         m_calibrationDetails.decSteps.clear();
+        m_raFit.Reset();
+        m_decFit.Reset();
         m_raSteps = 0;
         m_decSteps = 0;
         m_calibrationDetails.lastIssue = CI_None;
@@ -1123,6 +1215,24 @@ static void SuppressDecBacklashAlert(long)
     pConfig->Global.SetBoolean(DecBacklashAlertKey(), false);
 }
 
+// A calibration leg is complete once the fit pins down the axis angle and rate,
+// or when the star has moved the full calibration distance. The distance comes
+// from the fit when there is one so that a single bad centroid cannot end the leg.
+static bool CalibrationLegComplete(const CalibrationFit& fit, double dist, double distCrit)
+{
+    if (fit.IsConverged(CAL_FIT_MIN_SAMPLES, CAL_FIT_ANGLE_TOLERANCE, CAL_FIT_RATE_TOLERANCE))
+    {
+        Debug.Write(wxString::Format("Calibration: fit converged after %d samples, fitted distance = %.1f\n",
+            fit.SampleCount(), fit.Displacement()));
+        return true;
+    }
+
+    if (fit.IsValid())
+        return !fit.LastSampleIsOutlier() && fit.Displacement() >= distCrit;
+
+    return dist >= distCrit;
+}
+
 bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
 {
     bool bError = false;
@@ -1166,8 +1276,11 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                 // step number in the log is the step that just finished
                 GuideLog.CalibrationStep(this, "West", m_calibrationSteps, dX, dY, currentLocation, dist);
                 m_calibrationDetails.raSteps.push_back(wxRealPoint(dX, dY));
+                m_raFit.AddSample(m_calibrationSteps * m_calibrationDuration, currentLocation);
+                if (m_raFit.LastSampleIsOutlier())
+                    Debug.Write(wxString::Format("Calibration: West step %d is an outlier, ignored\n", m_calibrationSteps));
 
-                if (dist < dist_crit)
+                if (!CalibrationLegComplete(m_raFit, dist, dist_crit))
                 {
                     if (m_calibrationSteps++ > MAX_CALIBRATION_STEPS)
                     {
@@ -1185,8 +1298,21 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
 
                 // West calibration complete
 
-                m_calibration.xAngle = m_calibrationStartingLocation.Angle(currentLocation);
-                m_calibration.xRate = dist / (m_calibrationSteps * m_calibrationDuration);
+                if (m_raFit.IsValid())
+                {
+                    // the fit gives the direction of the west motion; xAngle points east
+                    m_calibration.xAngle = norm_angle(m_raFit.Angle() + M_PI);
+                    m_calibration.xRate = m_raFit.Rate();
+
+                    Debug.Write(wxString::Format("WEST fit: samples=%d outliers=%d angle=%.1f+/-%.1f rate=%.3f+/-%.3f\n",
+                        m_raFit.SampleCount(), m_raFit.OutlierCount(), degrees(m_calibration.xAngle), degrees(m_raFit.AngleInterval()),
+                        m_calibration.xRate * 1000.0, m_raFit.RateInterval() * 1000.0));
+                }
+                else
+                {
+                    m_calibration.xAngle = m_calibrationStartingLocation.Angle(currentLocation);
+                    m_calibration.xRate = dist / (m_calibrationSteps * m_calibrationDuration);
+                }
 
                 m_calibration.raGuideParity = GUIDE_PARITY_UNKNOWN;
                 if (m_calibrationStartingCoords.IsValid())
@@ -1306,6 +1432,8 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                 m_blMaxClearingPulses = wxMax(8, BL_MAX_CLEARING_TIME / m_calibrationDuration);
                 m_blLastCumDistance = 0;
                 m_blAcceptedMoves = 0;
+                m_blLastMoveAccepted = false;
+                m_decFit.Reset();
                 Debug.Write(wxString::Format("Backlash: Looking for 3 moves of %0.1f px, max attempts = %d\n", m_blExpectedBacklashStep, m_blMaxClearingPulses));
                 // fall through
                 Debug.Write("Falling Through to state CLEAR_BACKLASH\n");
@@ -1334,10 +1462,18 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                     {
                         m_blAcceptedMoves++;
                         Debug.Write(wxString::Format("Backlash: Accepted clearing move of %0.1f\n", blDelta));
+
+                        // The first move of a run of accepted moves may still be taking up slack, but from
+                        // there on the clearing moves are north calibration steps
+                        if (m_blLastMoveAccepted)
+                            m_decFit.AddSample(m_decFit.SampleCount() * m_calibrationDuration, m_blMarkerPoint);
+                        m_blLastMoveAccepted = true;
                     }
                     else
                     {
                         m_blAcceptedMoves = 0;            // Reset on a direction reversal
+                        m_blLastMoveAccepted = false;
+                        m_decFit.Reset();
                         Debug.Write(wxString::Format("Backlash: Rejected clearing move of %0.1f, direction reversal\n", blDelta));
                     }
                 }
@@ -1350,6 +1486,8 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                     }
                     else
                         Debug.Write(wxString::Format("Backlash: Rejected small move of %0.1f px\n", blDelta));
+                    m_blLastMoveAccepted = false;
+                    m_decFit.Reset();
                 }
 
                 if (m_blAcceptedMoves < BL_BACKLASH_MIN_COUNT)                    // More work to do
@@ -1373,6 +1511,7 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                             // Exhausted all the clearing pulses without reaching the goal - but we did move the mount > 3 px (same as PHD1)
                             m_calibrationSteps = 0;
                             m_calibrationStartingLocation = currentLocation;
+                            m_decFit.Reset();
                             dX = 0;
                             dY = 0;
                             dist = 0;
@@ -1391,18 +1530,29 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                 }
                 else        //Got our 3 moves, move ahead
                 {
-                    // We know the last backlash clearing move was big enough - include that as a north calibration move
+                    // We know the last backlash clearing move was big enough - include that as a north calibration move,
+                    // along with any earlier moves of the same run that were already recorded as north steps
+                    if (m_decFit.SampleCount() == 0)
+                        m_decFit.AddSample(0.0, m_blMarkerPoint);
 
-                    // log the starting point
-                    GuideLog.CalibrationStep(this, "North", 0, 0.0, 0.0, m_blMarkerPoint, 0.0);
-                    m_calibrationDetails.decSteps.push_back(wxRealPoint(0.0, 0.0));
+                    m_calibrationStartingLocation = m_decFit.Origin();
 
-                    m_calibrationSteps = 1;
-                    m_calibrationStartingLocation = m_blMarkerPoint;
-                    dX = m_blMarkerPoint.dX(currentLocation);
-                    dY = m_blMarkerPoint.dY(currentLocation);
-                    dist = m_blMarkerPoint.Distance(currentLocation);
-                    Debug.Write("Backlash: Got 3 acceptable moves, using last move as step 1 of N calibration\n");
+                    // log the starting point and the steps before this one
+                    for (int i = 0; i < m_decFit.SampleCount(); i++)
+                    {
+                        const PHD_Point& pos = m_decFit.SamplePos(i);
+                        double sdX = m_calibrationStartingLocation.dX(pos);
+                        double sdY = m_calibrationStartingLocation.dY(pos);
+                        GuideLog.CalibrationStep(this, "North", i, sdX, sdY, pos, m_calibrationStartingLocation.Distance(pos));
+                        m_calibrationDetails.decSteps.push_back(wxRealPoint(sdX, sdY));
+                    }
+
+                    m_calibrationSteps = m_decFit.SampleCount();
+                    dX = m_calibrationStartingLocation.dX(currentLocation);
+                    dY = m_calibrationStartingLocation.dY(currentLocation);
+                    dist = m_calibrationStartingLocation.Distance(currentLocation);
+                    Debug.Write(wxString::Format("Backlash: Got 3 acceptable moves, using last %d moves as steps 1-%d of N calibration\n",
+                        m_calibrationSteps, m_calibrationSteps));
                 }
 
                 m_blDistanceMoved = m_blMarkerPoint.Distance(m_calibrationInitialLocation);     // Need this to set nudging limit
@@ -1420,8 +1570,11 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
 
                 GuideLog.CalibrationStep(this, "North", m_calibrationSteps, dX, dY, currentLocation, dist);
                 m_calibrationDetails.decSteps.push_back(wxRealPoint(dX, dY));
+                m_decFit.AddSample(m_calibrationSteps * m_calibrationDuration, currentLocation);
+                if (m_decFit.LastSampleIsOutlier())
+                    Debug.Write(wxString::Format("Calibration: North step %d is an outlier, ignored\n", m_calibrationSteps));
 
-                if (dist < dist_crit)
+                if (!CalibrationLegComplete(m_decFit, dist, dist_crit))
                 {
                     if (m_calibrationSteps++ > MAX_CALIBRATION_STEPS)
                     {
@@ -1440,22 +1593,38 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                 // note: this calculation is reversed from the ra calculation, because
                 // that one was calibrating WEST, but the angle is really relative
                 // to EAST
+                double yAngle;
+                double yRate;
+                if (m_decFit.IsValid())
+                {
+                    yAngle = m_decFit.Angle();
+                    yRate = m_decFit.Rate();
+
+                    Debug.Write(wxString::Format("NORTH fit: samples=%d outliers=%d angle=%.1f+/-%.1f rate=%.3f+/-%.3f\n",
+                        m_decFit.SampleCount(), m_decFit.OutlierCount(), degrees(yAngle), degrees(m_decFit.AngleInterval()),
+                        yRate * 1000.0, m_decFit.RateInterval() * 1000.0));
+                }
+                else
+                {
+                    yAngle = currentLocation.Angle(m_calibrationStartingLocation);
+                    yRate = dist / (m_calibrationSteps * m_calibrationDuration);
+                }
+
                 if (m_assumeOrthogonal)
                 {
                     double a1 = norm_angle(m_calibration.xAngle + M_PI / 2.);
                     double a2 = norm_angle(m_calibration.xAngle - M_PI / 2.);
-                    double yAngle = currentLocation.Angle(m_calibrationStartingLocation);
                     m_calibration.yAngle = fabs(norm_angle(a1 - yAngle)) < fabs(norm_angle(a2 - yAngle)) ? a1 : a2;
-                    double dec_dist = dist * cos(yAngle - m_calibration.yAngle);
-                    m_calibration.yRate = dec_dist / (m_calibrationSteps * m_calibrationDuration);
+                    m_calibration.yRate = yRate * cos(yAngle - m_calibration.yAngle);
 
-                    Debug.Write(wxString::Format("Assuming orthogonal axes: measured Y angle = %.1f, X angle = %.1f, orthogonal = %.1f, %.1f, best = %.1f, dist = %.2f, dec_dist = %.2f\n",
-                        degrees(yAngle), degrees(m_calibration.xAngle), degrees(a1), degrees(a2), degrees(m_calibration.yAngle), dist, dec_dist));
+                    Debug.Write(wxString::Format("Assuming orthogonal axes: measured Y angle = %.1f, X angle = %.1f, orthogonal = %.1f, %.1f, best = %.1f, rate = %.3f, dec_rate = %.3f\n",
+                        degrees(yAngle), degrees(m_calibration.xAngle), degrees(a1), degrees(a2), degrees(m_calibration.yAngle),
+                        yRate * 1000.0, m_calibration.yRate * 1000.0));
                 }
                 else
                 {
-                    m_calibration.yAngle = currentLocation.Angle(m_calibrationStartingLocation);
-                    m_calibration.yRate = dist / (m_calibrationSteps * m_calibrationDuration);
+                    m_calibration.yAngle = yAngle;
+                    m_calibration.yRate = yRate;
                 }
 
                 m_decSteps = m_calibrationSteps;
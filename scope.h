@@ -114,10 +114,13 @@ class Scope : public Mount
     int m_blAcceptedMoves;
     double m_blDistanceMoved;
     int m_blMaxClearingPulses;
+    bool m_blLastMoveAccepted;
     enum blConstants { BL_BACKLASH_MIN_COUNT = 3, BL_MAX_CLEARING_TIME = 60000, BL_MIN_CLEARING_DISTANCE = 3 };
 
     Calibration m_calibration;
     CalibrationDetails m_calibrationDetails;
+    CalibrationFit m_raFit;
+    CalibrationFit m_decFit;
     bool m_assumeOrthogonal;
     int m_raSteps;
     int m_decSteps;
@@ -255,6 +258,7 @@ public:
     // Does not get called unless guiding was started interactively (by clicking the guide button)
     virtual bool PreparePositionInteractive();
     virtual bool CanPulseGuide();
+    bool CanMoveAxesConcurrently() override;
 
     virtual void StartDecDrift();
     virtual void EndDecDrift();
@@ -265,6 +269,9 @@ private:
     // by a subclass
     MOVE_RESULT MoveAxis(GUIDE_DIRECTION direction, int durationMs, unsigned int moveOptions, MoveResultInfo *moveResultInfo) final;
     MOVE_RESULT MoveAxis(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions) final;
+    MOVE_RESULT MoveAxes(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration,
+                         unsigned int moveOptions, MoveResultInfo *raMoveResult, MoveResultInfo *decMoveResult) final;
+    int LimitGuideDuration(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, bool *limitReached);
     int CalibrationMoveSize();
     void CheckCalibrationDuration(int currDuration);
     int CalibrationTotDistance() override;
@@ -278,6 +285,11 @@ private:
 // these MUST be supplied by a subclass
 private:
     virtual MOVE_RESULT Guide(GUIDE_DIRECTION direction, int durationMs) = 0;
+
+// a subclass that can run an RA and a Dec pulse at the same time overrides both of these
+private:
+    virtual bool CanGuideConcurrently();
+    virtual MOVE_RESULT GuideConcurrent(GUIDE_DIRECTION raDirection, int raDurationMs, GUIDE_DIRECTION decDirection, int decDurationMs);
 };
 
 inline bool Scope::IsStopGuidingWhenSlewingEnabled() const
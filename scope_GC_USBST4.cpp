@@ -116,14 +116,14 @@ Mount::MOVE_RESULT ScopeGCUSBST4::Guide(GUIDE_DIRECTION direction, int duration)
         case NONE:
             return MOVE_OK;
     }
-//  wxMessageBox(wxString::Format("Sending -%s-",buf));
+//  PhdMessageBox(wxString::Format("Sending -%s-",buf));
     int num_bytes = write(portFID,buf,strlen(buf));
     if (num_bytes == -1) {
         pFrame->Alert(wxString::Format(_("Error writing to GC USB ST4: %s(%d)"),_U(strerror(errno)),errno));
 //      close(portFID);
 //      return false;
     }
-//  wxMessageBox(wxString::Format("send %d vs %d",strlen(buf),num_bytes));
+//  PhdMessageBox(wxString::Format("send %d vs %d",strlen(buf),num_bytes));
     WorkerThread::MilliSleep(duration + 50);
     return MOVE_OK;
 }
@@ -139,7 +139,7 @@ bool ScopeGCUSBST4::Connect()
     io_object_t     theObject;
 
     if (createSerialIterator(&theSerialIterator) != KERN_SUCCESS) {
-        wxMessageBox(_T("Error in finding serial ports"),_("Error"));
+        PhdMessageBox(_T("Error in finding serial ports"),_("Error"));
         return false;
     }
     bool found_device = false;
@@ -157,7 +157,7 @@ bool ScopeGCUSBST4::Connect()
     IOObjectRelease(theSerialIterator); // Release the iterator.
 
     if (!found_device) {
-        wxMessageBox("Could not find device - searched for usbmodem* to no avail...",_("Error"));
+        PhdMessageBox("Could not find device - searched for usbmodem* to no avail...",_("Error"));
         return true;
     }
 
@@ -169,7 +169,7 @@ bool ScopeGCUSBST4::Connect()
 
     portFID = open(tempstr, O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (portFID == -1) { // error on opening
-        wxMessageBox(wxString::Format(_T("Error opening serial port %s: %s(%d)"),
+        PhdMessageBox(wxString::Format(_T("Error opening serial port %s: %s(%d)"),
                                         _U(tempstr), _U(strerror(errno)), errno),_("Error"));
         return true;
     }
@@ -180,7 +180,7 @@ bool ScopeGCUSBST4::Connect()
     struct termios  options;
     //options = gOriginalTTYAttrs;
     if (tcgetattr(portFID, &options) == -1) {
-        wxMessageBox(_T("Error getting port options"),_("Error"));
+        PhdMessageBox(_T("Error getting port options"),_("Error"));
         close(portFID);
         return true;
     }
@@ -194,31 +194,31 @@ bool ScopeGCUSBST4::Connect()
     options.c_cc[VSTOP]=0x13;
     cfsetspeed(&options, B9600);
     //options.c_cflag = 0x8b00;
-    /*wxMessageBox(wxString::Format("SET termios: iFlag %x  oFlag %x  cFlag %x  lFlag %x  speed %d\n",
+    /*PhdMessageBox(wxString::Format("SET termios: iFlag %x  oFlag %x  cFlag %x  lFlag %x  speed %d\n",
            options.c_iflag,
            options.c_oflag,
            options.c_cflag,
            options.c_lflag,
            options.c_ispeed));*/
     if (tcsetattr(portFID, TCSANOW, &options) == -1) {
-        wxMessageBox(_T("Error setting port options"),_("Error"));
+        PhdMessageBox(_T("Error setting port options"),_("Error"));
         close(portFID);
         return true;
     }
 /*  int handshake;
     if (ioctl(portFID, TIOCMGET, &handshake) == -1) {
-        wxMessageBox("Error getting port handshake");
+        PhdMessageBox("Error getting port handshake");
         close(portFID);
         return false;
     }
     unsigned long mics = 1UL;
     if (ioctl(portFID, IOSSDATALAT, &mics) == -1) {
-        wxMessageBox("Error setting port latency");
+        PhdMessageBox("Error setting port latency");
         close(portFID);
         return false;
 
     }*/
-//  wxMessageBox(wxString::Format("%d",(int) cfgetispeed(&options)));
+//  PhdMessageBox(wxString::Format("%d",(int) cfgetispeed(&options)));
 
     // Init / check the device
     char buf[2];
@@ -229,7 +229,7 @@ bool ScopeGCUSBST4::Connect()
     buf[1]=0;
     num_bytes = write(portFID,buf,1);
     if (num_bytes == -1) {
-        wxMessageBox(wxString::Format(_T("Error during initial kickstart: %s(%d)"),_U(strerror(errno)),errno),_("Error"));
+        PhdMessageBox(wxString::Format(_T("Error during initial kickstart: %s(%d)"),_U(strerror(errno)),errno),_("Error"));
         close(portFID);
         return true;
     }
@@ -239,18 +239,18 @@ bool ScopeGCUSBST4::Connect()
     buf[1]=0;
     num_bytes = write(portFID,buf,1);
     if (num_bytes == -1) {
-        wxMessageBox(wxString::Format(_T("Error during test polling of device: %s(%d)"),_U(strerror(errno)),errno),_("Error"));
+        PhdMessageBox(wxString::Format(_T("Error during test polling of device: %s(%d)"),_U(strerror(errno)),errno),_("Error"));
         close(portFID);
         return true;
     }
     num_bytes = read(portFID,buf,1);
     if (num_bytes == -1) {
-        wxMessageBox(_T("Error during test read of device"));
+        PhdMessageBox(_T("Error during test read of device"));
         close(portFID);
         return true;
     }
     if (buf[0] != 'A') {
-        wxMessageBox(wxString::Format(_T("Device returned %x instead of %x on test poll"),buf[0],'A'));
+        PhdMessageBox(wxString::Format(_T("Device returned %x instead of %x on test poll"),buf[0],'A'));
         close(portFID);
         return true;
     }
@@ -184,7 +184,7 @@ void ScopeASCOM::SetupDialog(void)
         Variant res;
         if (!scope.InvokeMethod(&res, L"SetupDialog"))
         {
-            wxMessageBox(wxString(scope.Excep().bstrSource) + ":\n" +
+            PhdMessageBox(wxString(scope.Excep().bstrSource) + ":\n" +
                 scope.Excep().bstrDescription, _("Error"), wxOK | wxICON_ERROR);
         }
     }
@@ -200,7 +200,7 @@ bool ScopeASCOM::Connect(void)
 
         if (IsConnected())
         {
-            wxMessageBox("Scope already connected",_("Error"));
+            PhdMessageBox("Scope already connected",_("Error"));
             throw ERROR_INFO("ASCOM Scope: Connected - Already Connected");
         }
 
@@ -208,7 +208,7 @@ bool ScopeASCOM::Connect(void)
 
         if (!Create(pScopeDriver))
         {
-            wxMessageBox(_T("Could not establish instance of ") + m_choice, _("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("Could not establish instance of ") + m_choice, _("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("ASCOM Scope: Could not establish ASCOM Scope instance");
         }
 
@@ -217,7 +217,7 @@ bool ScopeASCOM::Connect(void)
         // ... get the dispatch ID for the Connected property ...
         if (!pScopeDriver.GetDispatchId(&dispid_connected, L"Connected"))
         {
-            wxMessageBox(_T("ASCOM driver problem -- cannot connect"),_("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("ASCOM driver problem -- cannot connect"),_("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("ASCOM Scope: Could not get the dispatch id for the Connected property");
         }
 
@@ -233,14 +233,14 @@ bool ScopeASCOM::Connect(void)
         // ... get the dispatch ID for the "Slewing" property ....
         if (!pScopeDriver.GetDispatchId(&dispid_isslewing, L"Slewing"))
         {
-            wxMessageBox(_T("ASCOM driver missing the Slewing property"),_("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("ASCOM driver missing the Slewing property"),_("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("ASCOM Scope: Could not get the dispatch id for the Slewing property");
         }
 
         // ... get the dispatch ID for the "PulseGuide" property ....
         if (!pScopeDriver.GetDispatchId(&dispid_pulseguide, L"PulseGuide"))
         {
-            wxMessageBox(_T("ASCOM driver missing the PulseGuide property"),_("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("ASCOM driver missing the PulseGuide property"),_("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("ASCOM Scope: Could not get the dispatch id for the PulseGuide property");
         }
 
@@ -327,7 +327,7 @@ bool ScopeASCOM::Connect(void)
         // set the Connected property to true in a background thread
         if (bg.Run())
         {
-            wxMessageBox(_T("ASCOM driver problem during connection: ") + bg.GetErrorMsg(),
+            PhdMessageBox(_T("ASCOM driver problem during connection: ") + bg.GetErrorMsg(),
                 _("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("ASCOM Scope: Could not set Connected property to true");
         }
@@ -336,7 +336,7 @@ bool ScopeASCOM::Connect(void)
         Variant vRes;
         if (!pScopeDriver.GetProp(&vRes, L"Name"))
         {
-            wxMessageBox(_T("ASCOM driver problem getting Name property"), _("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_T("ASCOM driver problem getting Name property"), _("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("ASCOM Scope: Could not get the scope name: " + ExcepMsg(pScopeDriver.Excep()));
         }
 
@@ -135,11 +135,11 @@ bool ScopeEquinox::Connect()
     wxString prefix = "E6";
 //  if (mountcode == SCOPE_EQMAC) prefix = "EQMAC";
     if (E6ReturnCode == -1) {
-        wxMessageBox (prefix + " responded it's not connected to a mount",_("Error"));
+        PhdMessageBox (prefix + " responded it's not connected to a mount",_("Error"));
         return true;
     }
     else if (err == -600) {
-        wxMessageBox (prefix + " not running",_("Error"));
+        PhdMessageBox (prefix + " not running",_("Error"));
         return true;
     }
 
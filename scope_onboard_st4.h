@@ -53,6 +53,10 @@ public:
     bool SynchronousOnly(void) override;
 
     MOVE_RESULT Guide(GUIDE_DIRECTION direction, int duration) override;
+
+private:
+    bool CanGuideConcurrently(void) override;
+    MOVE_RESULT GuideConcurrent(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration) override;
 };
 
 #endif // SCOPE_ONBOARD_ST4_H_INCLUDED
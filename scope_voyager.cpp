@@ -50,7 +50,7 @@ bool ScopeVoyager::Connect(const wxString& hostname)
     VoyagerClient.WaitOnConnect(5);
 
     if (VoyagerClient.IsConnected()) {
-        wxMessageBox(_("Connection established"));
+        PhdMessageBox(_("Connection established"));
         bError = false;
     }
 
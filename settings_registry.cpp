@@ -0,0 +1,205 @@
+/*
+ *  settings_registry.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
+template<typename T>
+struct SettingDef
+{
+    T SettingsSnapshot::*field;
+    const char *key;
+    T defaultValue;
+    T minValue;
+    T maxValue;
+};
+
+static const SettingDef<int> IntSettings[] =
+{
+    { &SettingsSnapshot::decBacklashPulse, "/scope/DecBacklashPulse", 0, 0, 8000 },
+};
+
+static const SettingDef<double> DoubleSettings[] =
+{
+    { &SettingsSnapshot::bumpSettlingBoost, "/stepguider/BumpSettlingBoost", 3.0, 0.0, 100.0 },
+};
+
+static std::mutex s_lock;
+static std::shared_ptr<const SettingsSnapshot> s_current;
+static bool s_dirtyInt[WXSIZEOF(IntSettings)];
+static bool s_dirtyDouble[WXSIZEOF(DoubleSettings)];
+static bool s_flushQueued;
+
+static int ReadSetting(const SettingDef<int>& def)
+{
+    return pConfig->Profile.GetInt(def.key, def.defaultValue);
+}
+
+static double ReadSetting(const SettingDef<double>& def)
+{
+    return pConfig->Profile.GetDouble(def.key, def.defaultValue);
+}
+
+static void WriteSetting(const SettingDef<int>& def, int value)
+{
+    pConfig->Profile.SetInt(def.key, value);
+}
+
+static void WriteSetting(const SettingDef<double>& def, double value)
+{
+    pConfig->Profile.SetDouble(def.key, value);
+}
+
+template<typename T, size_t N>
+static void LoadTable(SettingsSnapshot *snap, const SettingDef<T> (&table)[N], bool (&dirty)[N])
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        const SettingDef<T>& def = table[i];
+        T val = ReadSetting(def);
+        if (val < def.minValue || val > def.maxValue)
+        {
+            Debug.Write(wxString::Format("Settings: %s out of range, using the default\n", def.key));
+            val = def.defaultValue;
+        }
+        snap->*def.field = val;
+        dirty[i] = false;
+    }
+}
+
+template<typename T, size_t N>
+static void FlushTable(const SettingsSnapshot& snap, const SettingDef<T> (&table)[N], const bool (&dirty)[N])
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        if (dirty[i])
+            WriteSetting(table[i], snap.*table[i].field);
+    }
+}
+
+template<typename T, size_t N>
+static bool SetValue(T SettingsSnapshot::*field, T value, const SettingDef<T> (&table)[N], bool (&dirty)[N])
+{
+    size_t i = 0;
+    while (table[i].field != field)
+        if (++i == N)
+            return true;
+
+    const SettingDef<T>& def = table[i];
+    if (value < def.minValue || value > def.maxValue)
+    {
+        Debug.Write(wxString::Format("Settings: rejected out of range value for %s\n", def.key));
+        return true;
+    }
+
+    bool queue;
+    {
+        std::lock_guard<std::mutex> lk(s_lock);
+        if (!s_current || s_current.get()->*field == value)
+            return false;
+
+        std::shared_ptr<SettingsSnapshot> snap(new SettingsSnapshot(*s_current));
+        snap.get()->*field = value;
+        s_current = snap;
+        dirty[i] = true;
+
+        queue = !s_flushQueued;
+        s_flushQueued = true;
+    }
+
+    // one write for all the values set until the main thread gets to it
+    if (queue)
+    {
+        if (pFrame)
+            wxQueueEvent(pFrame, new wxThreadEvent(wxEVT_THREAD, SETTINGS_FLUSH_EVENT));
+        else if (wxThread::IsMain())
+            SettingsRegistry::Flush();
+    }
+
+    return false;
+}
+
+std::shared_ptr<const SettingsSnapshot> SettingsRegistry::Current()
+{
+    std::lock_guard<std::mutex> lk(s_lock);
+    return s_current;
+}
+
+bool SettingsRegistry::Set(int SettingsSnapshot::*field, int value)
+{
+    return SetValue(field, value, IntSettings, s_dirtyInt);
+}
+
+bool SettingsRegistry::Set(double SettingsSnapshot::*field, double value)
+{
+    return SetValue(field, value, DoubleSettings, s_dirtyDouble);
+}
+
+void SettingsRegistry::Load()
+{
+    std::shared_ptr<SettingsSnapshot> snap(new SettingsSnapshot());
+    snap->profileId = pConfig->GetCurrentProfileId();
+
+    std::lock_guard<std::mutex> lk(s_lock);
+    LoadTable(snap.get(), IntSettings, s_dirtyInt);
+    LoadTable(snap.get(), DoubleSettings, s_dirtyDouble);
+    s_current = snap;
+}
+
+void SettingsRegistry::Flush()
+{
+    std::shared_ptr<const SettingsSnapshot> snap;
+    bool dirtyInt[WXSIZEOF(IntSettings)];
+    bool dirtyDouble[WXSIZEOF(DoubleSettings)];
+
+    // take the queued values and write them without holding the lock so
+    // Set() never waits on wxConfig
+    {
+        std::lock_guard<std::mutex> lk(s_lock);
+        s_flushQueued = false;
+        snap = s_current;
+        std::copy(std::begin(s_dirtyInt), std::end(s_dirtyInt), dirtyInt);
+        std::copy(std::begin(s_dirtyDouble), std::end(s_dirtyDouble), dirtyDouble);
+        std::fill(std::begin(s_dirtyInt), std::end(s_dirtyInt), false);
+        std::fill(std::begin(s_dirtyDouble), std::end(s_dirtyDouble), false);
+    }
+
+    if (!snap || snap->profileId != pConfig->GetCurrentProfileId())
+        return;
+
+    FlushTable(*snap, IntSettings, dirtyInt);
+    FlushTable(*snap, DoubleSettings, dirtyDouble);
+}
@@ -0,0 +1,75 @@
+/*
+ *  settings_registry.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef SETTINGS_REGISTRY_H_INCLUDED
+#define SETTINGS_REGISTRY_H_INCLUDED
+
+#include <memory>
+
+// Profile settings used in the guide loop, as plain fields. A snapshot is
+// never modified: a change publishes a new one, so code holding a snapshot
+// reads consistent values without locking or touching wxConfig.
+struct SettingsSnapshot
+{
+    int profileId;
+    double bumpSettlingBoost;   // minimum AO bump step weight while settling; below 1 there is no boost
+    int decBacklashPulse;       // Dec backlash compensation pulse, ms
+};
+
+// Typed settings for code that must not wait on wxConfig.
+//
+// Each field of SettingsSnapshot has an entry in a compile-time table with
+// its profile key, default and valid range. The values of the current
+// profile are read into a snapshot when the profile is selected; a value out
+// of range is replaced by the default. Set() publishes a new snapshot
+// immediately and queues the value, and the queued values are written to the
+// profile together on the main thread. Set() and Current() may be called
+// from any thread.
+class SettingsRegistry
+{
+public:
+    static std::shared_ptr<const SettingsSnapshot> Current();
+
+    // Set a value, identified by its field. Returns true if the value is
+    // out of range.
+    static bool Set(int SettingsSnapshot::*field, int value);
+    static bool Set(double SettingsSnapshot::*field, double value);
+
+    // main thread only: read the snapshot of the current profile, dropping
+    // queued values of the previous one
+    static void Load();
+    // main thread only: write the queued values to the profile
+    static void Flush();
+};
+
+#endif
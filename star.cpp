@@ -36,6 +36,7 @@
  */
 
 #include "phd.h"
+#include "autofind_peaks.h"
 #include <algorithm>
 
 Star::Star(void)
@@ -81,44 +82,213 @@ void Star::SetError(FindResult error)
     m_lastFindResult = error;
 }
 
+// Star::Find measures the star within the aperture radius and the
+// background in the annulus between the aperture and the outer radius
+enum
+{
+    APERTURE_RADIUS = 7,
+    ANNULUS_RADIUS = 12,
+    MAX_APERTURE_PIXELS = (2 * APERTURE_RADIUS + 1) * (2 * APERTURE_RADIUS + 1),
+    MAX_ANNULUS_PIXELS = (2 * ANNULUS_RADIUS + 1) * (2 * ANNULUS_RADIUS + 1),
+};
+
+struct PixelOffset
+{
+    int dx;
+    int dy;
+};
+
+// Pixel offsets from the star peak in the aperture and in the annulus, in
+// row order. The shapes never change, so they are computed once.
+struct ApertureTables
+{
+    std::vector<PixelOffset> aperture;
+    std::vector<PixelOffset> annulus;
+
+    ApertureTables()
+    {
+        int const A2 = APERTURE_RADIUS * APERTURE_RADIUS;
+        int const B2 = ANNULUS_RADIUS * ANNULUS_RADIUS;
+
+        for (int dy = -ANNULUS_RADIUS; dy <= ANNULUS_RADIUS; dy++)
+        {
+            for (int dx = -ANNULUS_RADIUS; dx <= ANNULUS_RADIUS; dx++)
+            {
+                int const r2 = dx * dx + dy * dy;
+                PixelOffset const ofs = { dx, dy };
+                if (r2 <= A2)
+                    aperture.push_back(ofs);
+                else if (r2 <= B2)
+                    annulus.push_back(ofs);
+            }
+        }
+    }
+};
+
+static const ApertureTables& GetApertureTables()
+{
+    static const ApertureTables s_tables;
+    return s_tables;
+}
+
+// Background mean and variance from the annulus pixels: sigma-clip at 2
+// sigma until the mean settles. The values are gathered into one compact
+// buffer so each clipping pass is a short linear scan, and the sums are
+// kept in integers so they are exact.
+static void AnnulusBackground(const unsigned short *vals, unsigned int count, double *mean, double *sigma2, unsigned int *nbg)
+{
+    double mean_bg = 0., prev_mean_bg;
+    double sigma2_bg = 0.;
+    double sigma_bg = 0.;
+    int lo = 0, hi = 65535;
+
+    for (int iter = 0; iter < 9; iter++)
+    {
+        if (iter > 0)
+        {
+            // integer bounds for mean +/- 2 sigma, inclusive
+            double const lim0 = ceil(mean_bg - 2.0 * sigma_bg);
+            double const lim1 = floor(mean_bg + 2.0 * sigma_bg);
+            lo = (int) wxMax(lim0, 0.0);
+            hi = (int) wxMax(wxMin(lim1, 65535.0), -1.0);
+        }
+
+        unsigned int k = 0;
+        unsigned long long sum = 0;
+        unsigned long long sumsq = 0;
+
+        if (lo <= hi)
+        {
+            for (unsigned int i = 0; i < count; i++)
+            {
+                unsigned int const v = vals[i];
+                if (v - (unsigned int) lo <= (unsigned int) (hi - lo))
+                {
+                    ++k;
+                    sum += v;
+                    sumsq += (unsigned long long) v * v;
+                }
+            }
+        }
+
+        *nbg = k;
+
+        if (k < 10) // only possible after the first iteration
+        {
+            Debug.Write(wxString::Format("Star::Find: too few background points! nbg=%u mean=%.1f sigma=%.1f\n", k, mean_bg, sigma_bg));
+            break;
+        }
+
+        prev_mean_bg = mean_bg;
+        mean_bg = (double) sum / (double) k;
+        sigma2_bg = (double) ((long long) k * (long long) sumsq - (long long) (sum * sum)) / ((double) k * (double) (k - 1));
+        sigma_bg = sqrt(sigma2_bg);
+
+        if (iter > 0 && fabs(mean_bg - prev_mean_bg) < 0.5)
+            break;
+    }
+
+    *mean = mean_bg;
+    *sigma2 = sigma2_bg;
+}
+
 // helper struct for HFR calculation
 struct R2M
 {
-    double r2;
-    wxPoint p;
+    int x;
+    int y;
     double m;
-    R2M() { }
-    R2M(int x, int y, double m_) : p(x, y), m(m_) { }
-    bool operator<(const R2M& rhs) const { return r2 < rhs.r2; }
 };
 
-static double hfr(std::vector<R2M>& vec, double cx, double cy, double mass)
+// Half flux radius. The pixels are bucketed into narrow radial bins around
+// the centroid; whole bins are accumulated until the bin containing the
+// half-mass crossing, and only that bin's few pixels are sorted by radius.
+// This gives the same result as sorting all of the pixels.
+static double hfr(const R2M *pixels, unsigned int count, double cx, double cy, double mass)
 {
-    if (vec.size() == 1) // hot pixel?
+    if (count == 1) // hot pixel?
         return 0.25;
 
-    // compute Half Flux Radius (HFR)
-    for (auto it = vec.begin(); it != vec.end(); ++it)
+    enum { BINS_PER_PX = 4, MAX_RADIUS = 2 * APERTURE_RADIUS + 1, NBINS = MAX_RADIUS * BINS_PER_PX };
+
+    struct RM
+    {
+        double r2;
+        double m;
+        bool operator<(const RM& rhs) const { return r2 < rhs.r2; }
+    };
+
+    RM rm[MAX_APERTURE_PIXELS];
+    unsigned short bin[MAX_APERTURE_PIXELS];
+    unsigned short binStart[NBINS + 1] = { 0 };
+    double binMass[NBINS] = { 0.0 };
+    double binPosMass[NBINS] = { 0.0 };
+    double binMaxR2[NBINS] = { 0.0 };
+
+    for (unsigned int i = 0; i < count; i++)
     {
-        double dx = (double) it->p.x - cx;
-        double dy = (double) it->p.y - cy;
-        it->r2 = dx * dx + dy * dy;
+        double dx = (double) pixels[i].x - cx;
+        double dy = (double) pixels[i].y - cy;
+        double r2 = dx * dx + dy * dy;
+        int b = wxMin((int) (sqrt(r2) * BINS_PER_PX), NBINS - 1);
+        bin[i] = b;
+        binStart[b + 1]++;
+        binMass[b] += pixels[i].m;
+        if (pixels[i].m > 0.0)
+            binPosMass[b] += pixels[i].m;
+        if (r2 > binMaxR2[b])
+            binMaxR2[b] = r2;
+    }
+
+    // counting sort of the pixels into their bins
+    for (int b = 0; b < NBINS; b++)
+        binStart[b + 1] += binStart[b];
+    unsigned short next[NBINS];
+    std::copy(binStart, binStart + NBINS, next);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        double dx = (double) pixels[i].x - cx;
+        double dy = (double) pixels[i].y - cy;
+        RM& e = rm[next[bin[i]]++];
+        e.r2 = dx * dx + dy * dy;
+        e.m = pixels[i].m;
     }
-    std::sort(vec.begin(), vec.end()); // sort by ascending radius^2
 
     // find radius of half-mass
     double r20, r21, m0, m1;
     r20 = r21 = m0 = m1 = 0.0;
     double halfm = 0.5 * mass;
-    for (auto it = vec.begin(); it != vec.end(); ++it)
+    bool found = false;
+    for (int b = 0; b < NBINS && !found; b++)
     {
-        const R2M& rm = *it;
-        r20 = r21;
-        m0 = m1;
-        r21 = rm.r2;
-        m1 += rm.m;
-        if (m1 > halfm)
-            break;
+        unsigned int const begin = binStart[b], end = binStart[b + 1];
+        if (begin == end)
+            continue;
+
+        if (m1 + binPosMass[b] <= halfm)
+        {
+            // the running mass cannot cross half-mass within this bin; take
+            // it whole, ending at the bin's outermost pixel
+            r20 = r21;
+            m0 = m1;
+            r21 = binMaxR2[b];
+            m1 += binMass[b];
+            continue;
+        }
+
+        std::sort(rm + begin, rm + end);
+        for (unsigned int i = begin; i < end; i++)
+        {
+            r20 = r21;
+            m0 = m1;
+            r21 = rm[i].r2;
+            m1 += rm[i].m;
+            if (m1 > halfm)
+            {
+                found = true;
+                break;
+            }
+        }
     }
 
     // interpolate
@@ -137,6 +307,8 @@ static double hfr(std::vector<R2M>& vec, double cx, double cy, double mass)
 
 bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, FindMode mode, double minHFD, unsigned short maxADU)
 {
+    TRACE_SCOPE("Star::Find");
+
     FindResult Result = STAR_OK;
     double newX = base_x;
     double newY = base_y;
@@ -240,75 +412,30 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
             peak_val /= 16; // smoothed peak value
         }
 
-        // meaure noise in the annulus with inner radius A and outer radius B
-        int const A = 7;   // inner radius
-        int const B = 12;  // outer radius
-        int const A2 = A * A;
-        int const B2 = B * B;
-
-        // center window around peak value
-        start_x = wxMax(peak_x - B, minx);
-        end_x = wxMin(peak_x + B, maxx);
-        start_y = wxMax(peak_y - B, miny);
-        end_y = wxMin(peak_y + B, maxy);
+        // measure the background in the annulus around the peak and the star
+        // within the aperture, using the precomputed pixel offsets
 
-        // find the mean and stdev of the background
+        const ApertureTables& tables = GetApertureTables();
 
-        unsigned int nbg;
-        double mean_bg = 0., prev_mean_bg;
-        double sigma2_bg;
-        double sigma_bg;
+        // only check for pixels outside the image when the annulus is clipped
+        bool const clipped = peak_x - ANNULUS_RADIUS < minx || peak_x + ANNULUS_RADIUS > maxx ||
+            peak_y - ANNULUS_RADIUS < miny || peak_y + ANNULUS_RADIUS > maxy;
+        const unsigned short *peak = imgdata + peak_y * rowsize + peak_x;
 
-        for (int iter = 0; iter < 9; iter++)
+        unsigned short bgvals[MAX_ANNULUS_PIXELS];
+        unsigned int nvals = 0;
+        for (const PixelOffset& ofs : tables.annulus)
         {
-            double sum = 0.0;
-            double a = 0.0;
-            double q = 0.0;
-            nbg = 0;
-
-            const unsigned short *row = imgdata + rowsize * start_y;
-            for (int y = start_y; y <= end_y; y++, row += rowsize)
-            {
-                int dy = y - peak_y;
-                int dy2 = dy * dy;
-                for (int x = start_x; x <= end_x; x++)
-                {
-                    int dx = x - peak_x;
-                    int r2 = dx * dx + dy2;
-
-                    // exclude points not in annulus
-                    if (r2 <= A2 || r2 > B2)
-                        continue;
-
-                    double const val = (double) row[x];
-
-                    if (iter > 0 && (val < mean_bg - 2.0 * sigma_bg || val > mean_bg + 2.0 * sigma_bg))
-                        continue;
-
-                    sum += val;
-                    ++nbg;
-                    double const k = (double) nbg;
-                    double const a0 = a;
-                    a += (val - a) / k;
-                    q += (val - a0) * (val - a);
-                }
-            }
-
-            if (nbg < 10) // only possible after the first iteration
-            {
-                Debug.Write(wxString::Format("Star::Find: too few background points! nbg=%u mean=%.1f sigma=%.1f\n", nbg, mean_bg, sigma_bg));
-                break;
-            }
-
-            prev_mean_bg = mean_bg;
-            mean_bg = sum / (double) nbg;
-            sigma2_bg = q / (double) (nbg - 1);
-            sigma_bg = sqrt(sigma2_bg);
-
-            if (iter > 0 && fabs(mean_bg - prev_mean_bg) < 0.5)
-                break;
+            if (clipped && (peak_x + ofs.dx < minx || peak_x + ofs.dx > maxx || peak_y + ofs.dy < miny || peak_y + ofs.dy > maxy))
+                continue;
+            bgvals[nvals++] = peak[ofs.dy * rowsize + ofs.dx];
         }
 
+        unsigned int nbg;
+        double mean_bg;
+        double sigma2_bg;
+        AnnulusBackground(bgvals, nvals, &mean_bg, &sigma2_bg, &nbg);
+
         unsigned short thresh;
 
         double cx = 0.0;
@@ -316,7 +443,7 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
         double mass = 0.0;
         unsigned int n;
 
-        std::vector<R2M> hfrvec;
+        R2M hfrpx[MAX_APERTURE_PIXELS];
 
         if (mode == FIND_PEAK)
         {
@@ -326,47 +453,33 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
         }
         else
         {
+            double const sigma_bg = sqrt(sigma2_bg);
             thresh = (unsigned short)(mean_bg + 3.0 * sigma_bg + 0.5);
 
             // find pixels over threshold within aperture; compute mass and centroid
 
-            start_x = wxMax(peak_x - A, minx);
-            end_x = wxMin(peak_x + A, maxx);
-            start_y = wxMax(peak_y - A, miny);
-            end_y = wxMin(peak_y + A, maxy);
-
             n = 0;
 
-            const unsigned short *row = imgdata + rowsize * start_y;
-            for (int y = start_y; y <= end_y; y++, row += rowsize)
+            for (const PixelOffset& ofs : tables.aperture)
             {
-                int dy = y - peak_y;
-                int dy2 = dy * dy;
-                if (dy2 > A2)
+                if (clipped && (peak_x + ofs.dx < minx || peak_x + ofs.dx > maxx || peak_y + ofs.dy < miny || peak_y + ofs.dy > maxy))
                     continue;
 
-                for (int x = start_x; x <= end_x; x++)
-                {
-                    int dx = x - peak_x;
-
-                    // exclude points outside aperture
-                    if (dx * dx + dy2 > A2)
-                        continue;
-
-                    // exclude points below threshold
-                    unsigned short val = row[x];
-                    if (val < thresh)
-                        continue;
+                // exclude points below threshold
+                unsigned short val = peak[ofs.dy * rowsize + ofs.dx];
+                if (val < thresh)
+                    continue;
 
-                    double const d = (double) val - mean_bg;
+                double const d = (double) val - mean_bg;
 
-                    cx += dx * d;
-                    cy += dy * d;
-                    mass += d;
-                    ++n;
+                cx += ofs.dx * d;
+                cy += ofs.dy * d;
+                mass += d;
 
-                    hfrvec.push_back(R2M(x, y, d));
-                }
+                R2M& px = hfrpx[n++];
+                px.x = peak_x + ofs.dx;
+                px.y = peak_y + ofs.dy;
+                px.m = d;
             }
         }
 
@@ -383,7 +496,7 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
         // avoid this by requiring the smoothed peak value to be above the threshold
         if (peak_val <= thresh && SNR >= LOW_SNR)
         {
-            Debug.Write(wxString::Format("Star::Find false star n=%u nbg=%u bg=%.1f sigma=%.1f thresh=%u peak=%u\n", n, nbg, mean_bg, sigma_bg, thresh, peak_val));
+            Debug.Write(wxString::Format("Star::Find false star n=%u nbg=%u bg=%.1f sigma=%.1f thresh=%u peak=%u\n", n, nbg, mean_bg, sqrt(sigma2_bg), thresh, peak_val));
             SNR = LOW_SNR - 0.1;
         }
 
@@ -404,7 +517,7 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
         newX = peak_x + cx / mass;
         newY = peak_y + cy / mass;
 
-        HFD = 2.0 * hfr(hfrvec, newX, newY, mass);
+        HFD = 2.0 * hfr(hfrpx, mode == FIND_PEAK ? 0 : n, newX, newY, mass);
 
         if (HFD < minHFD && mode != FIND_PEAK)
         {
@@ -483,59 +596,12 @@ bool Star::Find(const usImage *pImg, int searchRegion, FindMode mode, double min
     return Find(pImg, searchRegion, X, Y, mode, minHFD, saturation);
 }
 
-struct FloatImg
-{
-    float *px;
-    wxSize Size;
-    unsigned int NPixels;
-
-    FloatImg() : px(0) { }
-    FloatImg(const wxSize& size) : px(0) { Init(size); }
-    FloatImg(const usImage& img) : px(0) {
-        Init(img.Size);
-        for (unsigned int i = 0; i < NPixels; i++)
-            px[i] = (float) img.ImageData[i];
-    }
-    ~FloatImg() { delete[] px; }
-    void Init(const wxSize& sz) { delete[] px;  Size = sz; NPixels = Size.GetWidth() * Size.GetHeight(); px = new float[NPixels]; }
-    void Swap(FloatImg& other) { std::swap(px, other.px); std::swap(Size, other.Size); std::swap(NPixels, other.NPixels); }
-};
-
-static void GetStats(double *mean, double *stdev, const FloatImg& img, const wxRect& win)
-{
-    // Determine the mean and standard deviation
-    double sum = 0.0;
-    double a = 0.0;
-    double q = 0.0;
-    double k = 1.0;
-    double km1 = 0.0;
-
-    const int width = img.Size.GetWidth();
-    const float *p0 = &img.px[win.GetTop() * width + win.GetLeft()];
-    for (int y = 0; y < win.GetHeight(); y++)
-    {
-        const float *end = p0 + win.GetWidth();
-        for (const float *p = p0; p < end; p++)
-        {
-            double const x = (double) *p;
-            sum += x;
-            double const a0 = a;
-            a += (x - a) / k;
-            q += (x - a0) * (x - a);
-            km1 = k;
-            k += 1.0;
-        }
-        p0 += width;
-    }
-
-    *mean = sum / km1;
-    *stdev = sqrt(q / km1);
-}
+typedef AutoFindPeaks::Peak Peak;
 
 // un-comment to save the intermediate autofind image
 //#define SAVE_AUTOFIND_IMG
 
-static void SaveImage(const FloatImg& img, const char *name)
+static void SaveImage(const AutoFindPeaks::FloatImg& img, const char *name)
 {
 #ifdef SAVE_AUTOFIND_IMG
     float maxv = img.px[0];
@@ -560,122 +626,6 @@ static void SaveImage(const FloatImg& img, const char *name)
 #endif // SAVE_AUTOFIND_IMG
 }
 
-static void psf_conv(FloatImg& dst, const FloatImg& src)
-{
-    dst.Init(src.Size);
-
-    //                       A      B1     B2    C1     C2    C3     D1     D2     D3
-    const double PSF[] = { 0.906, 0.584, 0.365, .117, .049, -0.05, -.064, -.074, -.094 };
-
-    int const width = src.Size.GetWidth();
-    int const height = src.Size.GetHeight();
-
-    memset(dst.px, 0, src.NPixels * sizeof(float));
-
-    /* PSF Grid is:
-    D3 D3 D3 D3 D3 D3 D3 D3 D3
-    D3 D3 D3 D2 D1 D2 D3 D3 D3
-    D3 D3 C3 C2 C1 C2 C3 D3 D3
-    D3 D2 C2 B2 B1 B2 C2 D2 D3
-    D3 D1 C1 B1 A  B1 C1 D1 D3
-    D3 D2 C2 B2 B1 B2 C2 D2 D3
-    D3 D3 C3 C2 C1 C2 C3 D3 D3
-    D3 D3 D3 D2 D1 D2 D3 D3 D3
-    D3 D3 D3 D3 D3 D3 D3 D3 D3
-
-    1@A
-    4@B1, B2, C1, C3, D1
-    8@C2, D2
-    44 * D3
-    */
-
-    int psf_size = 4;
-
-    for (int y = psf_size; y < height - psf_size; y++)
-    {
-        for (int x = psf_size; x < width - psf_size; x++)
-        {
-            float A, B1, B2, C1, C2, C3, D1, D2, D3;
-
-#define PX(dx, dy) *(src.px + width * (y + (dy)) + x + (dx))
-            A =  PX(+0, +0);
-            B1 = PX(+0, -1) + PX(+0, +1) + PX(+1, +0) + PX(-1, +0);
-            B2 = PX(-1, -1) + PX(+1, -1) + PX(-1, +1) + PX(+1, +1);
-            C1 = PX(+0, -2) + PX(-2, +0) + PX(+2, +0) + PX(+0, +2);
-            C2 = PX(-1, -2) + PX(+1, -2) + PX(-2, -1) + PX(+2, -1) + PX(-2, +1) + PX(+2, +1) + PX(-1, +2) + PX(+1, +2);
-            C3 = PX(-2, -2) + PX(+2, -2) + PX(-2, +2) + PX(+2, +2);
-            D1 = PX(+0, -3) + PX(-3, +0) + PX(+3, +0) + PX(+0, +3);
-            D2 = PX(-1, -3) + PX(+1, -3) + PX(-3, -1) + PX(+3, -1) + PX(-3, +1) + PX(+3, +1) + PX(-1, +3) + PX(+1, +3);
-            D3 = PX(-4, -2) + PX(-3, -2) + PX(+3, -2) + PX(+4, -2) + PX(-4, -1) + PX(+4, -1) + PX(-4, +0) + PX(+4, +0) + PX(-4, +1) + PX(+4, +1) + PX(-4, +2) + PX(-3, +2) + PX(+3, +2) + PX(+4, +2);
-#undef PX
-            int i;
-            const float *uptr;
-
-            uptr = src.px + width * (y - 4) + (x - 4);
-            for (i = 0; i < 9; i++)
-                D3 += *uptr++;
-
-            uptr = src.px + width * (y - 3) + (x - 4);
-            for (i = 0; i < 3; i++)
-                D3 += *uptr++;
-            uptr += 3;
-            for (i = 0; i < 3; i++)
-                D3 += *uptr++;
-
-            uptr = src.px + width * (y + 3) + (x - 4);
-            for (i = 0; i < 3; i++)
-                D3 += *uptr++;
-            uptr += 3;
-            for (i = 0; i < 3; i++)
-                D3 += *uptr++;
-
-            uptr = src.px + width * (y + 4) + (x - 4);
-            for (i = 0; i < 9; i++)
-                D3 += *uptr++;
-
-            double mean = (A + B1 + B2 + C1 + C2 + C3 + D1 + D2 + D3) / 81.0;
-            double PSF_fit = PSF[0] * (A - mean) + PSF[1] * (B1 - 4.0 * mean) + PSF[2] * (B2 - 4.0 * mean) +
-                PSF[3] * (C1 - 4.0 * mean) + PSF[4] * (C2 - 8.0 * mean) + PSF[5] * (C3 - 4.0 * mean) +
-                PSF[6] * (D1 - 4.0 * mean) + PSF[7] * (D2 - 8.0 * mean) + PSF[8] * (D3 - 44.0 * mean);
-
-            dst.px[width * y + x] = (float) PSF_fit;
-        }
-    }
-}
-
-static void Downsample(FloatImg& dst, const FloatImg& src, int downsample)
-{
-    int width = src.Size.GetWidth();
-    int dw = src.Size.GetWidth() / downsample;
-    int dh = src.Size.GetHeight() / downsample;
-
-    dst.Init(wxSize(dw, dh));
-
-    for (int yy = 0; yy < dh; yy++)
-    {
-        for (int xx = 0; xx < dw; xx++)
-        {
-            float sum = 0.0;
-            for (int j = 0; j < downsample; j++)
-                for (int i = 0; i < downsample; i++)
-                    sum += src.px[(yy * downsample + j) * width + xx * downsample + i];
-            float val = sum / (downsample * downsample);
-            dst.px[yy * dw + xx] = val;
-        }
-    }
-}
-
-struct Peak
-{
-    int x;
-    int y;
-    float val;
-
-    Peak() { }
-    Peak(int x_, int y_, float val_) : x(x_), y(y_), val(val_) { }
-    bool operator<(const Peak& rhs) const { return val < rhs.val; }
-};
-
 static void RemoveItems(std::set<Peak>& stars, const std::set<int>& to_erase)
 {
     int n = 0;
@@ -695,6 +645,18 @@ static void RemoveItems(std::set<Peak>& stars, const std::set<int>& to_erase)
 
 bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegion)
 {
+    std::vector<Star> foundStars;
+    if (!AutoFind(image, extraEdgeAllowance, searchRegion, foundStars, 1))
+        return false;
+
+    SetXY(foundStars[0].X, foundStars[0].Y);
+    return true;
+}
+
+bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegion, std::vector<Star>& foundStars, unsigned int maxStars)
+{
+    foundStars.clear();
+
     if (!image.Subframe.IsEmpty())
     {
         Debug.AddLine("Autofind called on subframe, returning error");
@@ -705,101 +667,31 @@ bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegi
 
     Debug.Write(wxString::Format("Star::AutoFind called with edgeAllowance = %d searchRegion = %d\n", extraEdgeAllowance, searchRegion));
 
-    // run a 3x3 median first to eliminate hot pixels
-    usImage smoothed;
-    smoothed.CopyFrom(image);
-    Median3(smoothed);
+    enum { TOP_N = 100 };  // keep track of the brightest stars
+    std::set<Peak> stars;  // sorted by ascending intensity
+
+    // large images are searched at reduced resolution first
+    int downsample = AutoFindPeaks::Downsample(image.NPixels);
 
-    // convert to floating point
-    FloatImg conv(smoothed);
+    AutoFindPeaks::SearchStats stats;
+    AutoFindPeaks::FloatImg conv;
 
-    // downsample the source image
-    const int downsample = 1;
     if (downsample > 1)
     {
-        FloatImg tmp;
-        Downsample(tmp, conv, downsample);
-        conv.Swap(tmp);
-    }
+        AutoFindPeaks::FindPeaksBinned(stars, image.ImageData, image.Size, downsample, TOP_N, Median3, &stats, &conv);
 
-    // run the PSF convolution
+        Debug.Write(wxString::Format("AutoFind: %dx binned search, %u candidates\n", downsample, stats.candidates));
+    }
+    else
     {
-        FloatImg tmp;
-        psf_conv(tmp, conv);
-        conv.Swap(tmp);
+        AutoFindPeaks::FindPeaksFull(stars, image.ImageData, image.Size, TOP_N, Median3, &stats, &conv);
     }
 
-    enum { CONV_RADIUS = 4 };
-    int dw = conv.Size.GetWidth();      // width of the downsampled image
-    int dh = conv.Size.GetHeight();     // height of the downsampled image
-    wxRect convRect(CONV_RADIUS, CONV_RADIUS, dw - 2 * CONV_RADIUS, dh - 2 * CONV_RADIUS);  // region containing valid data
-
     SaveImage(conv, "PHD2_AutoFind.fit");
 
-    enum { TOP_N = 100 };  // keep track of the brightest stars
-    std::set<Peak> stars;  // sorted by ascending intensity
-
-    double global_mean, global_stdev;
-    GetStats(&global_mean, &global_stdev, conv, convRect);
-
-    Debug.Write(wxString::Format("AutoFind: global mean = %.1f, stdev %.1f\n", global_mean, global_stdev));
+    Debug.Write(wxString::Format("AutoFind: global mean = %.1f, stdev %.1f\n", stats.mean, stats.stdev));
 
-    const double threshold = 0.1;
-    Debug.Write(wxString::Format("AutoFind: using threshold = %.1f\n", threshold));
-
-    // find each local maximum
-    int srch = 4;
-    for (int y = convRect.GetTop() + srch; y <= convRect.GetBottom() - srch; y++)
-    {
-        for (int x = convRect.GetLeft() + srch; x <= convRect.GetRight() - srch; x++)
-        {
-            float val = conv.px[dw * y + x];
-            bool ismax = false;
-            if (val > 0.0)
-            {
-                ismax = true;
-                for (int j = -srch; j <= srch; j++)
-                {
-                    for (int i = -srch; i <= srch; i++)
-                    {
-                        if (i == 0 && j == 0)
-                            continue;
-                        if (conv.px[dw * (y + j) + (x + i)] > val)
-                        {
-                            ismax = false;
-                            break;
-                        }
-                    }
-                }
-            }
-            if (!ismax)
-                continue;
-
-            // compare local maximum to mean value of surrounding pixels
-            const int local = 7;
-            double local_mean, local_stdev;
-            wxRect localRect(x - local, y - local, 2 * local + 1, 2 * local + 1);
-            localRect.Intersect(convRect);
-            GetStats(&local_mean, &local_stdev, conv, localRect);
-
-            // this is our measure of star intensity
-            double h = (val - local_mean) / global_stdev;
-
-            if (h < threshold)
-            {
-                //  Debug.Write(wxString::Format("AG: local max REJECT [%d, %d] PSF %.1f SNR %.1f\n", imgx, imgy, val, SNR));
-                continue;
-            }
-
-            // coordinates on the original image
-            int imgx = x * downsample + downsample / 2;
-            int imgy = y * downsample + downsample / 2;
-
-            stars.insert(Peak(imgx, imgy, h));
-            if (stars.size() > TOP_N)
-                stars.erase(stars.begin());
-        }
-    }
+    Debug.Write(wxString::Format("AutoFind: using threshold = %.1f\n", AutoFindPeaks::PeakThreshold()));
 
     for (std::set<Peak>::const_reverse_iterator it = stars.rbegin(); it != stars.rend(); ++it)
         Debug.Write(wxString::Format("AutoFind: local max [%d, %d] %.1f\n", it->x, it->y, it->val));
@@ -956,6 +848,8 @@ bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegi
     //       this pass will reject saturated and nearly-saturated stars
     //   pass 2: find brightest non-saturated star
     //   pass 3: find brightest star, even if saturated
+    // when more than one star is wanted, they all come from the first pass
+    // that accepts any star
 
     for (int pass = 1; pass <= 3; pass++)
     {
@@ -987,12 +881,17 @@ bool Star::AutoFind(const usImage& image, int extraEdgeAllowance, int searchRegi
                 }
 
                 // star accepted
-                SetXY(it->x, it->y);
                 Debug.Write(wxString::Format("Autofind returns star at [%d, %d] %.1f Mass %.f SNR %.1f\n", it->x, it->y, it->val, tmp.Mass, tmp.SNR));
-                return true;
+                tmp.SetXY(it->x, it->y);
+                foundStars.push_back(tmp);
+                if (foundStars.size() >= maxStars)
+                    return true;
             }
         }
 
+        if (!foundStars.empty())
+            return true;
+
         if (pass == 1)
             Debug.Write("AutoFind: could not find a star on Pass 1\n");
         else if (pass == 2)
@@ -77,6 +77,9 @@ public:
     bool Find(const usImage *pImg, int searchRegion, FindMode mode, double min_hfd, unsigned short saturation);
     bool Find(const usImage *pImg, int searchRegion, int X, int Y, FindMode mode, double min_hfd, unsigned short saturation);
     bool AutoFind(const usImage& image, int edgeAllowance, int searchRegion);
+    // up to maxStars candidate guide stars, best first, positioned at their
+    // peaks; returns false if none were found
+    static bool AutoFind(const usImage& image, int edgeAllowance, int searchRegion, std::vector<Star>& foundStars, unsigned int maxStars);
 
     bool WasFound(FindResult result);
     bool WasFound(void);
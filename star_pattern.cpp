@@ -0,0 +1,263 @@
+/*
+ *  star_pattern.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <wx/stopwatch.h>
+#include <algorithm>
+
+enum
+{
+    MIN_PATTERN_STARS = 3,
+    MIN_MATCHED_STARS = 4,  // one more than a triangle, so a single chance match is not enough
+};
+
+static const double MIN_TRIANGLE_SIDE = 10.0;   // pixels; smaller triangles are dominated by position errors
+static const double POSITION_TOLERANCE = 3.0;   // pixels; AutoFind positions are pixel peaks
+
+void StarPattern::Clear()
+{
+    m_stars.clear();
+    m_triangles.clear();
+}
+
+bool StarPattern::IsValid() const
+{
+    return !m_triangles.empty();
+}
+
+unsigned int StarPattern::StarCount() const
+{
+    return (unsigned int) m_stars.size();
+}
+
+void StarPattern::BuildTriangles(const std::vector<PHD_Point>& pts, std::vector<Triangle> *triangles)
+{
+    triangles->clear();
+
+    size_t const n = pts.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = i + 1; j < n; j++)
+        {
+            for (size_t k = j + 1; k < n; k++)
+            {
+                Triangle t;
+                t.side[0] = pts[j].Distance(pts[k]);
+                t.vtx[0] = (unsigned char) i;
+                t.side[1] = pts[i].Distance(pts[k]);
+                t.vtx[1] = (unsigned char) j;
+                t.side[2] = pts[i].Distance(pts[j]);
+                t.vtx[2] = (unsigned char) k;
+
+                // sort the sides, keeping each with its opposite vertex
+                for (int a = 0; a < 2; a++)
+                {
+                    for (int b = 0; b < 2 - a; b++)
+                    {
+                        if (t.side[b] > t.side[b + 1])
+                        {
+                            std::swap(t.side[b], t.side[b + 1]);
+                            std::swap(t.vtx[b], t.vtx[b + 1]);
+                        }
+                    }
+                }
+
+                if (t.side[0] < MIN_TRIANGLE_SIDE)
+                    continue;
+
+                // when two sides are nearly equal the vertices cannot be told apart
+                if (t.side[1] - t.side[0] < 2.0 * POSITION_TOLERANCE || t.side[2] - t.side[1] < 2.0 * POSITION_TOLERANCE)
+                    continue;
+
+                triangles->push_back(t);
+            }
+        }
+    }
+
+    std::sort(triangles->begin(), triangles->end(),
+        [](const Triangle& a, const Triangle& b) { return a.side[2] < b.side[2]; });
+}
+
+void StarPattern::Set(const std::vector<Star>& stars, const PHD_Point& reference)
+{
+    Clear();
+
+    if (stars.size() < MIN_PATTERN_STARS)
+    {
+        Debug.Write(wxString::Format("StarPattern: too few stars (%u)\n", (unsigned int) stars.size()));
+        return;
+    }
+
+    for (const Star& star : stars)
+        m_stars.push_back(star - reference);
+
+    BuildTriangles(m_stars, &m_triangles);
+
+    if (m_triangles.empty())
+        m_stars.clear();
+
+    Debug.Write(wxString::Format("StarPattern: %u stars, %u triangles\n", (unsigned int) m_stars.size(),
+        (unsigned int) m_triangles.size()));
+}
+
+// Count the pattern stars that land on a star of the new frame when shifted
+// by offset, and refine the offset from the stars that do
+static unsigned int CountMatches(const std::vector<PHD_Point>& pattern, const std::vector<PHD_Point>& pts, const PHD_Point& offset,
+                                 PHD_Point *refined)
+{
+    unsigned int count = 0;
+    PHD_Point sum(0.0, 0.0);
+
+    for (const PHD_Point& p : pattern)
+    {
+        PHD_Point const expected = p + offset;
+        double best = POSITION_TOLERANCE;
+        const PHD_Point *match = nullptr;
+        for (const PHD_Point& q : pts)
+        {
+            double const d = q.Distance(expected);
+            if (d <= best)
+            {
+                best = d;
+                match = &q;
+            }
+        }
+        if (match)
+        {
+            ++count;
+            sum += *match - p;
+        }
+    }
+
+    if (count > 0)
+        *refined = sum / (double) count;
+
+    return count;
+}
+
+bool StarPattern::Match(const std::vector<Star>& stars, PHD_Point *reference, long timeLimitMs) const
+{
+    if (!IsValid() || stars.size() < MIN_PATTERN_STARS)
+        return false;
+
+    wxStopWatch swatch;
+
+    std::vector<PHD_Point> pts;
+    for (const Star& star : stars)
+        pts.push_back(star);
+
+    std::vector<Triangle> triangles;
+    BuildTriangles(pts, &triangles);
+
+    // every pair of triangles with the same sides gives a candidate offset;
+    // score each distinct offset by the number of pattern stars it matches
+    std::vector<PHD_Point> tried;
+    unsigned int bestCount = 0;
+    PHD_Point bestOffset;
+    bool ambiguous = false;
+    double const sideTol = 2.0 * POSITION_TOLERANCE;
+
+    for (const Triangle& t : triangles)
+    {
+        if (swatch.Time() > timeLimitMs)
+        {
+            Debug.Write(wxString::Format("StarPattern: match timed out after %ld ms\n", swatch.Time()));
+            return false;
+        }
+
+        auto it = std::lower_bound(m_triangles.begin(), m_triangles.end(), t.side[2] - sideTol,
+            [](const Triangle& a, double len) { return a.side[2] < len; });
+
+        for (; it != m_triangles.end() && it->side[2] <= t.side[2] + sideTol; ++it)
+        {
+            if (fabs(it->side[0] - t.side[0]) > sideTol || fabs(it->side[1] - t.side[1]) > sideTol)
+                continue;
+
+            PHD_Point offset(0.0, 0.0);
+            for (int v = 0; v < 3; v++)
+                offset += pts[t.vtx[v]] - m_stars[it->vtx[v]];
+            offset /= 3.0;
+
+            // the triangles must line up under the shift alone; the field
+            // does not rotate while guiding
+            bool aligned = true;
+            for (int v = 0; v < 3; v++)
+            {
+                if (pts[t.vtx[v]].Distance(m_stars[it->vtx[v]] + offset) > POSITION_TOLERANCE)
+                    aligned = false;
+            }
+            if (!aligned)
+                continue;
+
+            bool seen = false;
+            for (const PHD_Point& prev : tried)
+            {
+                if (prev.Distance(offset) <= POSITION_TOLERANCE)
+                {
+                    seen = true;
+                    break;
+                }
+            }
+            if (seen)
+                continue;
+            tried.push_back(offset);
+
+            PHD_Point refined;
+            unsigned int const count = CountMatches(m_stars, pts, offset, &refined);
+
+            if (count > bestCount)
+            {
+                bestCount = count;
+                bestOffset = refined;
+                ambiguous = false;
+            }
+            else if (count == bestCount && bestOffset.Distance(refined) > 2.0 * POSITION_TOLERANCE)
+            {
+                ambiguous = true;
+            }
+        }
+    }
+
+    unsigned int const needed = wxMin((unsigned int) MIN_MATCHED_STARS, StarCount());
+
+    Debug.Write(wxString::Format("StarPattern: %u of %u stars matched at offset (%.1f, %.1f), %u candidates, %ld ms%s\n",
+        bestCount, StarCount(), bestOffset.IsValid() ? bestOffset.X : 0.0, bestOffset.IsValid() ? bestOffset.Y : 0.0,
+        (unsigned int) tried.size(), swatch.Time(), ambiguous ? ", ambiguous" : ""));
+
+    if (bestCount < needed || ambiguous)
+        return false;
+
+    *reference = bestOffset;
+    return true;
+}
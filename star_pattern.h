@@ -0,0 +1,76 @@
+/*
+ *  star_pattern.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef STAR_PATTERN_INCLUDED
+#define STAR_PATTERN_INCLUDED
+
+#include <vector>
+
+// A fingerprint of the star field around the guide star, used to find the
+// guide star again after a jump too large for the search region.
+//
+// The pattern keeps the positions of the brightest stars relative to a
+// reference point (the guide star) and the side lengths of every triangle
+// they form. The image scale does not change while guiding, so a triangle in
+// a new frame matches a pattern triangle when its three side lengths do;
+// each match gives a candidate offset, and the offset that brings the most
+// pattern stars onto stars in the new frame wins.
+class StarPattern
+{
+    struct Triangle
+    {
+        double side[3];         // ascending
+        unsigned char vtx[3];   // vertex opposite each side
+    };
+
+    std::vector<PHD_Point> m_stars;         // relative to the reference point
+    std::vector<Triangle> m_triangles;      // sorted by longest side
+
+public:
+    void Clear();
+    bool IsValid() const;
+    unsigned int StarCount() const;
+
+    // Build the pattern from stars found around the reference point
+    void Set(const std::vector<Star>& stars, const PHD_Point& reference);
+
+    // Find the pattern among the stars of a new frame. Like Star::Find,
+    // returns true on success, with the reference point's position in the
+    // new frame. Gives up when timeLimitMs is exhausted.
+    bool Match(const std::vector<Star>& stars, PHD_Point *reference, long timeLimitMs) const;
+
+private:
+    static void BuildTriangles(const std::vector<PHD_Point>& pts, std::vector<Triangle> *triangles);
+};
+
+#endif
@@ -78,7 +78,7 @@ void ProfileWindow::SetState(bool is_active)
 
 void ProfileWindow::UpdateData(const usImage *img, float xpos, float ypos)
 {
-    if (this->data == NULL) return;
+    if (this->data == NULL || wxGetApp().IsHeadless()) return;
     int xstart = ROUNDF(xpos) - HALFW;
     int ystart = ROUNDF(ypos) - HALFW;
     if (xstart < 0) xstart = 0;
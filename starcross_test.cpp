@@ -315,7 +315,7 @@ void StarCrossDialog::ExecuteTest()
     }
     m_CancelTest = false;
     // Leave plenty of room for camera exposure and mount response overhead
-    wxMessageBox(wxString::Format(_("Start a %d exposure on your main camera, then click 'Ok'"),
+    PhdMessageBox(wxString::Format(_("Start a %d exposure on your main camera, then click 'Ok'"),
         (2 * totalPulses * m_Amount) / 1000));
     while (!done && !m_CancelTest)
     {
@@ -328,7 +328,7 @@ void StarCrossDialog::ExecuteTest()
             {
                 Debug.Write("Star-cross test completed\n");
                 m_Explanations->SetLabel(Explanation(currStep, dirCount));
-                wxMessageBox(
+                PhdMessageBox(
                     _("Wait for the main camera exposure to complete, then save that image for review")
                     );
                 pConfig->Profile.SetDouble("/SCT/PulseCount", m_DirectionalPulseCount);
@@ -431,7 +431,7 @@ void StarCrossDialog::OnStart(wxCommandEvent& evt)
         ExecuteTest();
     }
     else
-        wxMessageBox(_("Mount connection must be restored"));
+        PhdMessageBox(_("Mount connection must be restored"));
 }
 
 void StarCrossDialog::OnCancel(wxCommandEvent& evt)
@@ -97,7 +97,7 @@ wxWindow *StaticPaTool::CreateStaticPaToolWindow()
 {
     if (!pCamera || !pCamera->Connected)
     {
-        wxMessageBox(_("Please connect a camera first."));
+        PhdMessageBox(_("Please connect a camera first."));
         return 0;
     }
 
@@ -121,7 +121,7 @@ wxWindow *StaticPaTool::CreateStaticPaToolWindow()
     }
     if (pFrame->pGuider->IsCalibratingOrGuiding())
     {
-        wxMessageBox(_("Please wait till Calibration is done and stop guiding"));
+        PhdMessageBox(_("Please wait till Calibration is done and stop guiding"));
         return 0;
     }
 
@@ -937,6 +937,7 @@ Mount::MOVE_RESULT StepGuider::MoveAxis(GUIDE_DIRECTION direction, int steps, un
 
             if (steps > 0)
             {
+                TRACE_SCOPE("StepGuider::Step", "steps", steps);
                 STEP_RESULT sres = Step(direction, steps);
                 if (sres != STEP_OK)
                 {
@@ -1178,7 +1179,7 @@ Mount::MOVE_RESULT StepGuider::MoveOffset(GuiderOffset *ofs, unsigned int moveOp
                 // force larger bump when settling
                 if (PhdController::IsSettling())
                 {
-                    double boost = pConfig->Profile.GetDouble("/stepguider/BumpSettlingBoost", 3.0);
+                    double boost = SettingsRegistry::Current()->bumpSettlingBoost;
                     if (weight < boost)
                     {
                         weight = boost;
@@ -99,7 +99,7 @@ bool StepGuiderSxAO::Connect(void)
 
         if (version == 0)
         {
-            wxMessageBox(wxString::Format(
+            PhdMessageBox(wxString::Format(
                 _("This AO device has firmware version %03u which means it needs to be flashed.\n"
                   "It is recommended to load firmware version 101 or earlier.\n"
                   "The SXV-AO Utility v104 or newer, available at http://www.sxccd.com/drivers-downloads,\n"
@@ -143,7 +143,7 @@ void StepGuiderSxAO::ShowPropertyDialog(void)
 
         if (serialPorts.IsEmpty())
         {
-            wxMessageBox(_("No serial ports found"),_("Error"), wxOK | wxICON_ERROR);
+            PhdMessageBox(_("No serial ports found"),_("Error"), wxOK | wxICON_ERROR);
             throw ERROR_INFO("No Serial ports found");
         }
 
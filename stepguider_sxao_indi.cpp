@@ -98,7 +98,7 @@ void StepGuiderSxAoINDI::CheckState(void)
     // Check if the device has all the required properties for our usage.
     if (IsConnected() && (ao_driverVersion && aoN_prop && aoS_prop && aoW_prop && aoE_prop && aoCenter_prop)) {
         if (atof(ao_driverVersion->text) < 1.12) {
-            wxMessageBox(wxString::Format(
+            PhdMessageBox(wxString::Format(
                 _("We need at least INDI driver %s version 1.12 to get the Firmware version and the Limit switch states."),
                 ao_driverExec->text), _("Error"));
         } else if (ao_firmware) {
@@ -107,7 +107,7 @@ void StepGuiderSxAoINDI::CheckState(void)
                     throw ERROR_INFO("StepGuiderSxAoINDI::CheckState: unable to get firmware version");
                 }
                 if (SxAoVersion == 0) {
-                    wxMessageBox(wxString::Format(
+                    PhdMessageBox(wxString::Format(
                         _("This AO device has firmware version %03u which means it needs to be flashed.\n"
                           "The SXV-AO Utility v104 or newer, available at http://www.sxccd.com/drivers-downloads,\n"
                           "contains the firmware."), SxAoVersion),
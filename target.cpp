@@ -139,6 +139,9 @@ void TargetWindow::SetState(bool is_active)
 
 void TargetWindow::AppendData(const GuideStepInfo& step)
 {
+    if (wxGetApp().IsHeadless())
+        return;
+
     m_pClient->AppendData(step);
 
     if (this->m_visible)
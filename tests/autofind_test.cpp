@@ -0,0 +1,232 @@
+/*
+ *  autofind_test.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Compares the binned search AutoFind uses on large images with the full
+// resolution search on simulated star fields, and times both for common
+// sensor sizes.
+//
+// Acceptance criterion: the brightest peak of the binned search is the
+// brightest peak of the full resolution search, and at least 19 of the 20
+// brightest full resolution peaks are found by the binned search at the
+// same pixel with an intensity, relative to the brightest peak, within 10%.
+// The binned search estimates the noise of the convolved image from a
+// sample of rows, so only the ratios of its intensities, which are what
+// AutoFind compares, are expected to match.
+
+#include <gtest/gtest.h>
+
+#include "autofind_peaks.h"
+#include "median_filter.h"
+#include "serial_compute_pool.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+struct StarField
+{
+    wxSize size;
+    std::vector<unsigned short> px;
+};
+
+// Gaussian stars of the given FWHM on a noisy sky background, with some hot pixels
+static void MakeStarField(StarField *field, int width, int height, double fwhm, unsigned int seed)
+{
+    enum { STARS_PER_MPIXEL = 40 };
+    static const double SKY = 1000.0;
+    static const double NOISE = 15.0;
+    static const double HOT_PIXEL_FRACTION = 1e-4;
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, NOISE);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    field->size = wxSize(width, height);
+    std::vector<double> img((size_t) width * height);
+
+    for (double& v : img)
+        v = SKY + noise(rng);
+
+    double const sigma = fwhm / 2.3548;
+    int const r = (int) ceil(4.0 * sigma);
+    int const nstars = (int) ((double) width * height * STARS_PER_MPIXEL / 1e6);
+
+    for (int k = 0; k < nstars; k++)
+    {
+        double const cx = 20.0 + uniform(rng) * (width - 40);
+        double const cy = 20.0 + uniform(rng) * (height - 40);
+        double const peak = 50.0 * pow(400.0, uniform(rng));  // 50 .. 20000 ADU
+
+        for (int y = (int) cy - r; y <= (int) cy + r; y++)
+        {
+            for (int x = (int) cx - r; x <= (int) cx + r; x++)
+            {
+                double const dx = x - cx, dy = y - cy;
+                img[(size_t) y * width + x] += peak * exp(-(dx * dx + dy * dy) / (2.0 * sigma * sigma));
+            }
+        }
+    }
+
+    field->px.resize(img.size());
+    for (size_t i = 0; i < img.size(); i++)
+        field->px[i] = (unsigned short) std::min(std::max(img[i], 0.0), 65535.0);
+
+    size_t const hot = (size_t) (img.size() * HOT_PIXEL_FRACTION);
+    for (size_t i = 0; i < hot; i++)
+        field->px[(size_t) (uniform(rng) * (img.size() - 1))] = 60000;
+}
+
+typedef std::vector<AutoFindPeaks::Peak> PeakList;
+
+// peaks sorted by descending intensity
+static PeakList Sorted(const std::set<AutoFindPeaks::Peak>& stars)
+{
+    return PeakList(stars.rbegin(), stars.rend());
+}
+
+enum { TOP_N = 100 };  // as in Star::AutoFind
+
+static PeakList FullSearch(const StarField& field)
+{
+    std::set<AutoFindPeaks::Peak> stars;
+    AutoFindPeaks::SearchStats stats;
+    AutoFindPeaks::FindPeaksFull(stars, &field.px[0], field.size, TOP_N, MedianFilter::Median3x3, &stats);
+    return Sorted(stars);
+}
+
+static PeakList BinnedSearch(const StarField& field, int downsample)
+{
+    std::set<AutoFindPeaks::Peak> stars;
+    AutoFindPeaks::SearchStats stats;
+    AutoFindPeaks::FindPeaksBinned(stars, &field.px[0], field.size, downsample, TOP_N, MedianFilter::Median3x3, &stats);
+    return Sorted(stars);
+}
+
+static const AutoFindPeaks::Peak *FindMatch(const PeakList& peaks, const AutoFindPeaks::Peak& p)
+{
+    for (const AutoFindPeaks::Peak& q : peaks)
+        if (q.x == p.x && q.y == p.y)
+            return &q;
+    return 0;
+}
+
+struct FieldParams
+{
+    int width;
+    int height;
+    double fwhm;
+};
+
+class AutoFindTest : public ::testing::TestWithParam<FieldParams>
+{
+};
+
+TEST_P(AutoFindTest, binned_search_finds_full_resolution_peaks)
+{
+    enum { COMPARE = 20, MIN_MATCHED = 19 };
+    static const double MAX_INTENSITY_DIFF = 0.1;
+
+    FieldParams const& p = GetParam();
+
+    StarField field;
+    MakeStarField(&field, p.width, p.height, p.fwhm, 1234);
+
+    int const downsample = AutoFindPeaks::Downsample(field.size.GetWidth() * field.size.GetHeight());
+    ASSERT_GT(downsample, 1);
+
+    PeakList const full = FullSearch(field);
+    PeakList const binned = BinnedSearch(field, downsample);
+
+    ASSERT_GE(full.size(), (size_t) COMPARE);
+    ASSERT_FALSE(binned.empty());
+
+    EXPECT_EQ(full[0].x, binned[0].x);
+    EXPECT_EQ(full[0].y, binned[0].y);
+
+    int matched = 0;
+    for (int i = 0; i < COMPARE; i++)
+    {
+        const AutoFindPeaks::Peak *q = FindMatch(binned, full[i]);
+        double const fullRel = full[i].val / full[0].val;
+        if (q && fabs(q->val / binned[0].val - fullRel) <= MAX_INTENSITY_DIFF * fullRel)
+            ++matched;
+        else
+            std::cout << "  full resolution peak [" << full[i].x << ", " << full[i].y << "] " << full[i].val
+                      << (q ? " has a different intensity in the binned search" : " not found by the binned search") << std::endl;
+    }
+
+    std::cout << p.width << "x" << p.height << " FWHM " << p.fwhm << " px, " << downsample << "x binned: "
+              << matched << " of " << COMPARE << " brightest peaks matched, intensity scale "
+              << binned[0].val / full[0].val << std::endl;
+
+    EXPECT_GE(matched, (int) MIN_MATCHED);
+}
+
+INSTANTIATE_TEST_CASE_P(SimulatedFields, AutoFindTest,
+                        ::testing::Values(FieldParams{ 2560, 1920, 1.5 }, FieldParams{ 2560, 1920, 2.5 }, FieldParams{ 2560, 1920, 4.0 },
+                                          FieldParams{ 6248, 4176, 1.5 }, FieldParams{ 6248, 4176, 2.5 }, FieldParams{ 6248, 4176, 4.0 }));
+
+TEST(AutoFindBenchmark, full_and_binned_search_time)
+{
+    static const wxSize SIZES[] = { wxSize(2560, 1920), wxSize(3096, 2080), wxSize(4656, 3520), wxSize(6248, 4176) };
+
+    for (const wxSize& size : SIZES)
+    {
+        StarField field;
+        MakeStarField(&field, size.GetWidth(), size.GetHeight(), 3.0, 42);
+
+        int const downsample = AutoFindPeaks::Downsample(size.GetWidth() * size.GetHeight());
+
+        auto t0 = std::chrono::steady_clock::now();
+        PeakList const full = FullSearch(field);
+        auto t1 = std::chrono::steady_clock::now();
+        PeakList const binned = BinnedSearch(field, downsample);
+        auto t2 = std::chrono::steady_clock::now();
+
+        EXPECT_FALSE(binned.empty());
+
+        double const fullMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        double const binnedMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+        std::cout << "AutoFind " << size.GetWidth() << "x" << size.GetHeight() << ": full resolution " << fullMs
+                  << " ms, " << downsample << "x binned " << binnedMs << " ms, speedup " << fullMs / binnedMs << "x" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,193 @@
+/*
+ *  calibration_fit_test.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Feeds CalibrationFit simulated calibration legs: a clean line, a line with
+// one centroid on the wrong star, and noisy legs run until the fit converges
+// at the tolerances used by Scope::UpdateCalibrationState.
+
+#include <gtest/gtest.h>
+
+#include <wx/wx.h>
+
+#include <cassert>
+#include <cmath>
+#include <random>
+
+#include "point.h"
+#include "calibration_fit.h"
+
+// same as scope.cpp
+static const int CAL_FIT_MIN_SAMPLES = 6;
+static const double CAL_FIT_ANGLE_TOLERANCE = 2.0 * M_PI / 180.0;
+static const double CAL_FIT_RATE_TOLERANCE = 0.05;
+
+static const double PULSE_MS = 750.0;
+static const double DIST_CRIT = 25.0;   // pixels
+
+// the leg end decision of CalibrationLegComplete in scope.cpp
+static bool LegComplete(const CalibrationFit& fit, double dist)
+{
+    if (fit.IsConverged(CAL_FIT_MIN_SAMPLES, CAL_FIT_ANGLE_TOLERANCE, CAL_FIT_RATE_TOLERANCE))
+        return true;
+
+    if (fit.IsValid())
+        return !fit.LastSampleIsOutlier() && fit.Displacement() >= DIST_CRIT;
+
+    return dist >= DIST_CRIT;
+}
+
+static double AngleDiff(double a, double b)
+{
+    return std::remainder(a - b, 2.0 * M_PI);
+}
+
+struct Leg
+{
+    double x0;
+    double y0;
+    double angle;   // radians
+    double rate;    // px/ms
+    double noise;   // per-axis centroid noise, pixels
+
+    PHD_Point At(int step, std::mt19937& rng) const
+    {
+        std::normal_distribution<double> n(0.0, noise);
+        double const t = step * PULSE_MS;
+        return PHD_Point(x0 + rate * t * cos(angle) + n(rng), y0 + rate * t * sin(angle) + n(rng));
+    }
+};
+
+TEST(CalibrationFitTest, clean_line)
+{
+    Leg const leg = { 100.0, 200.0, 30.0 * M_PI / 180.0, 0.004, 0.0 };
+    std::mt19937 rng(1);
+    CalibrationFit fit;
+
+    for (int step = 0; step < CAL_FIT_MIN_SAMPLES; step++)
+    {
+        EXPECT_FALSE(fit.IsConverged(CAL_FIT_MIN_SAMPLES, CAL_FIT_ANGLE_TOLERANCE, CAL_FIT_RATE_TOLERANCE));
+        fit.AddSample(step * PULSE_MS, leg.At(step, rng));
+    }
+
+    ASSERT_TRUE(fit.IsValid());
+    EXPECT_EQ(fit.OutlierCount(), 0);
+    EXPECT_NEAR(fit.Rate(), leg.rate, 1e-9);
+    EXPECT_NEAR(AngleDiff(fit.Angle(), leg.angle), 0.0, 1e-9);
+    EXPECT_NEAR(fit.Displacement(), leg.rate * (CAL_FIT_MIN_SAMPLES - 1) * PULSE_MS, 1e-6);
+    EXPECT_TRUE(fit.IsConverged(CAL_FIT_MIN_SAMPLES, CAL_FIT_ANGLE_TOLERANCE, CAL_FIT_RATE_TOLERANCE));
+}
+
+TEST(CalibrationFitTest, wild_centroid)
+{
+    // slow enough that the leg is still open when the bad frame arrives
+    Leg const leg = { 300.0, 300.0, -100.0 * M_PI / 180.0, 0.002, 0.5 };
+    int const badStep = 4;
+    std::mt19937 rng(2);
+    CalibrationFit fit;
+
+    int step = 0;
+    for (; step < 12; step++)
+    {
+        PHD_Point pos = leg.At(step, rng);
+        if (step == badStep)
+        {
+            // centroid lands on another star beyond the calibration distance
+            pos.X += 30.0 * cos(leg.angle + 0.3);
+            pos.Y += 30.0 * sin(leg.angle + 0.3);
+        }
+        fit.AddSample(step * PULSE_MS, pos);
+
+        double const dist = fit.Origin().Distance(pos);
+        if (step == badStep)
+        {
+            EXPECT_GE(dist, DIST_CRIT);
+            EXPECT_TRUE(fit.LastSampleIsOutlier());
+            EXPECT_FALSE(LegComplete(fit, dist)) << "the bad centroid ended the leg";
+        }
+        else
+        {
+            EXPECT_FALSE(fit.LastSampleIsOutlier()) << "step " << step;
+        }
+        if (LegComplete(fit, dist))
+            break;
+    }
+
+    ASSERT_TRUE(fit.IsValid());
+    EXPECT_GT(step, badStep);
+    EXPECT_EQ(fit.OutlierCount(), 1);
+    EXPECT_NEAR(fit.Rate(), leg.rate, std::max(fit.RateInterval(), 0.02 * leg.rate));
+    EXPECT_NEAR(AngleDiff(fit.Angle(), leg.angle), 0.0, std::max(fit.AngleInterval(), 1.0 * M_PI / 180.0));
+}
+
+TEST(CalibrationFitTest, convergence)
+{
+    Leg const leg = { 500.0, 400.0, 200.0 * M_PI / 180.0, 0.004, 0.3 };
+    int const trials = 50;
+    int rateCovered = 0;
+    int angleCovered = 0;
+
+    for (int trial = 0; trial < trials; trial++)
+    {
+        std::mt19937 rng(100 + trial);
+        CalibrationFit fit;
+
+        int step = 0;
+        for (; step < 60; step++)
+        {
+            fit.AddSample(step * PULSE_MS, leg.At(step, rng));
+            if (fit.IsConverged(CAL_FIT_MIN_SAMPLES, CAL_FIT_ANGLE_TOLERANCE, CAL_FIT_RATE_TOLERANCE))
+                break;
+        }
+
+        ASSERT_LT(step, 60) << "trial " << trial << " did not converge";
+        EXPECT_GE(fit.SampleCount(), CAL_FIT_MIN_SAMPLES);
+        EXPECT_LE(fit.AngleInterval(), CAL_FIT_ANGLE_TOLERANCE);
+        EXPECT_LE(fit.RateInterval(), CAL_FIT_RATE_TOLERANCE * fit.Rate());
+
+        if (fabs(fit.Rate() - leg.rate) <= fit.RateInterval())
+            ++rateCovered;
+        if (fabs(AngleDiff(fit.Angle(), leg.angle)) <= fit.AngleInterval())
+            ++angleCovered;
+    }
+
+    // the stated 95% intervals hold the true values, allowing for stopping as
+    // soon as they are narrow enough
+    EXPECT_GE(rateCovered, trials * 85 / 100);
+    EXPECT_GE(angleCovered, trials * 85 / 100);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,323 @@
+/*
+ *  defect_learner_test.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Runs DefectLearner on simulated guide frames with hot and cold pixels and
+// undersampled stars, checks which pixels it flags, and times it for a few
+// sensor sizes.
+
+#include <gtest/gtest.h>
+
+#include "defect_learner.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+static const double SKY = 1000.0;
+static const double SKY_NOISE = 10.0;
+static const int SEARCH_REGION = 15;    // guider default
+
+struct SimStar
+{
+    double x;       // position in the field, the sensor position is this plus the field offset
+    double y;
+    double peak;
+    double sigma;
+};
+
+// Guide frames of a star field that moves across a sensor with fixed defects
+class SimCamera
+{
+    enum { NOISE_FRAMES = 4 };
+
+    int m_w;
+    int m_h;
+    std::mt19937 m_rng;
+    std::vector<std::vector<unsigned short>> m_noise;
+    std::vector<SimStar> m_stars;   // the first one is the guide star
+    unsigned int m_frame;
+
+public:
+    std::vector<unsigned short> frame;
+    std::set<std::pair<int, int>> hot;
+    std::set<std::pair<int, int>> cold;
+    double offsetX;
+    double offsetY;
+
+    SimCamera(int w, int h, int starCount, int defectCount)
+        : m_w(w), m_h(h), m_rng(42), m_frame(0), frame(w * h), offsetX(0.0), offsetY(0.0)
+    {
+        std::normal_distribution<double> noise(SKY, SKY_NOISE);
+        m_noise.resize(NOISE_FRAMES);
+        for (auto& f : m_noise)
+        {
+            f.resize(w * h);
+            for (auto& v : f)
+                v = (unsigned short) lround(noise(m_rng));
+        }
+
+        std::uniform_int_distribution<int> xpos(40, w - 41), ypos(40, h - 41);
+        std::uniform_real_distribution<double> bright(0.0, 1.0);
+
+        // half of the stars are undersampled (FWHM 0.8 px) and look like a
+        // single hot pixel in one frame
+        m_stars.push_back(SimStar { w / 2.0, h / 2.0, 5000.0, 0.8 / 2.3548 });
+        for (int i = 1; i < starCount; i++)
+        {
+            double const fwhm = i % 2 ? 0.8 : 3.0;
+            m_stars.push_back(SimStar { (double) xpos(m_rng), (double) ypos(m_rng), 200.0 * pow(25.0, bright(m_rng)), fwhm / 2.3548 });
+        }
+
+        for (int i = 0; i < defectCount; i++)
+        {
+            std::pair<int, int> const pt(xpos(m_rng), ypos(m_rng));
+            if (i % 5 == 4)
+                cold.insert(pt);
+            else
+                hot.insert(pt);
+        }
+    }
+
+    double GuideStarX() const { return m_stars[0].x + offsetX; }
+    double GuideStarY() const { return m_stars[0].y + offsetY; }
+
+    DefectLearner::Field Field() const
+    {
+        DefectLearner::Field field;
+        field.hasStar = true;
+        field.starX = GuideStarX();
+        field.starY = GuideStarY();
+        field.exclude.push_back(wxRect((int) GuideStarX() - SEARCH_REGION, (int) GuideStarY() - SEARCH_REGION,
+                                       2 * SEARCH_REGION + 1, 2 * SEARCH_REGION + 1));
+        return field;
+    }
+
+    // guiding error of a well guided mount
+    void Jitter()
+    {
+        std::normal_distribution<double> err(0.0, 0.15);
+        offsetX += err(m_rng);
+        offsetY += err(m_rng);
+    }
+
+    void Dither()
+    {
+        std::uniform_real_distribution<double> amount(4.0, 8.0);
+        std::bernoulli_distribution sign(0.5);
+        offsetX += sign(m_rng) ? amount(m_rng) : -amount(m_rng);
+        offsetY += sign(m_rng) ? amount(m_rng) : -amount(m_rng);
+        // stay near the middle of the sensor
+        offsetX = std::max(-30.0, std::min(30.0, offsetX));
+        offsetY = std::max(-30.0, std::min(30.0, offsetY));
+    }
+
+    void Render()
+    {
+        frame = m_noise[m_frame++ % NOISE_FRAMES];
+
+        for (const SimStar& s : m_stars)
+        {
+            double const cx = s.x + offsetX, cy = s.y + offsetY;
+            for (int y = std::max(0, (int) cy - 4); y <= std::min(m_h - 1, (int) cy + 4); y++)
+            {
+                for (int x = std::max(0, (int) cx - 4); x <= std::min(m_w - 1, (int) cx + 4); x++)
+                {
+                    // pixel centers are at integer coordinates
+                    double const rx = x - cx, ry = y - cy;
+                    double const v = frame[y * m_w + x] + s.peak * exp(-(rx * rx + ry * ry) / (2.0 * s.sigma * s.sigma));
+                    frame[y * m_w + x] = (unsigned short) std::min(v, 65535.0);
+                }
+            }
+        }
+
+        for (const auto& pt : hot)
+            frame[pt.second * m_w + pt.first] += 1500;
+        for (const auto& pt : cold)
+            frame[pt.second * m_w + pt.first] = 300;
+    }
+
+    void Learn(DefectLearner& learner)
+    {
+        Render();
+        learner.Learn(&frame[0], wxSize(m_w, m_h), Field());
+    }
+};
+
+static void CheckFlagged(const DefectLearner& learner, const SimCamera& cam, bool expectAll)
+{
+    std::set<std::pair<int, int>> flagged;
+    for (const wxPoint& pt : learner.Defects())
+        flagged.insert(std::make_pair(pt.x, pt.y));
+
+    for (const auto& pt : flagged)
+        EXPECT_TRUE(cam.hot.count(pt) || cam.cold.count(pt)) << "pixel " << pt.first << "," << pt.second << " is not a defect";
+
+    if (expectAll)
+    {
+        for (const auto& pt : cam.hot)
+            EXPECT_TRUE(flagged.count(pt)) << "hot pixel " << pt.first << "," << pt.second << " not flagged";
+        for (const auto& pt : cam.cold)
+            EXPECT_TRUE(flagged.count(pt)) << "cold pixel " << pt.first << "," << pt.second << " not flagged";
+    }
+}
+
+TEST(DefectLearnerTest, flags_defects_but_not_undersampled_stars)
+{
+    SimCamera cam(1280, 960, 400, 50);
+    DefectLearner learner;
+
+    for (int i = 1; i <= 150; i++)
+    {
+        cam.Jitter();
+        if (i % 15 == 0)
+            cam.Dither();
+        cam.Learn(learner);
+    }
+
+    EXPECT_EQ(learner.RowStride(), 2U);
+    CheckFlagged(learner, cam, true);
+}
+
+// without dithers the guided field does not move, and the learner cannot
+// tell a defect from an undersampled star
+TEST(DefectLearnerTest, needs_field_movement_to_flag)
+{
+    SimCamera cam(1280, 960, 400, 50);
+    DefectLearner learner;
+
+    for (int i = 1; i <= 150; i++)
+    {
+        cam.Jitter();
+        cam.Learn(learner);
+    }
+
+    EXPECT_TRUE(learner.Defects().empty());
+    EXPECT_GT(learner.CandidateCount(), 0U);
+}
+
+TEST(DefectLearnerTest, ignores_guide_star_search_region)
+{
+    int const w = 640, h = 480;
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(SKY, SKY_NOISE);
+
+    DefectLearner learner;
+    DefectLearner::Field field;
+    field.exclude.push_back(wxRect(100 - SEARCH_REGION, 100 - SEARCH_REGION, 2 * SEARCH_REGION + 1, 2 * SEARCH_REGION + 1));
+
+    std::vector<unsigned short> sky[2];
+    for (auto& f : sky)
+    {
+        f.resize(w * h);
+        for (auto& v : f)
+            v = (unsigned short) lround(noise(rng));
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+        std::vector<unsigned short> frame = sky[i % 2];
+        frame[105 * w + 95] += 1500;    // inside the search region
+        frame[300 * w + 400] += 1500;
+        // the field moves, the search region around the guide star stays
+        // where the star was selected
+        field.hasStar = true;
+        field.starX = 100.0 + 5.0 * (i / 10 % 2);
+        field.starY = 100.0 + 5.0 * (i / 20 % 2);
+        learner.Learn(&frame[0], wxSize(w, h), field);
+    }
+
+    ASSERT_EQ(learner.Defects().size(), 1U);
+    EXPECT_EQ(learner.Defects()[0].x, 400);
+    EXPECT_EQ(learner.Defects()[0].y, 300);
+}
+
+// on large sensors each frame only scans a subset of the rows
+TEST(DefectLearnerTest, large_sensor_within_pixel_budget)
+{
+    int const w = 2560, h = 1920;
+    SimCamera cam(w, h, 800, 50);
+    DefectLearner learner;
+
+    cam.Learn(learner);
+    unsigned int const stride = learner.RowStride();
+    EXPECT_GT(stride, 1U);
+    EXPECT_LE((double) (h - 2) * w / stride, 1.01 * DefectLearner::PIXEL_BUDGET);
+
+    for (int i = 2; i <= 100 * (int) stride; i++)
+    {
+        cam.Jitter();
+        if (i % (10 * stride) == 0)
+            cam.Dither();
+        cam.Learn(learner);
+    }
+
+    CheckFlagged(learner, cam, true);
+}
+
+TEST(DefectLearnerBenchmark, learn_time)
+{
+    static const int FRAMES = 64;
+    static const int sizes[][2] = { { 1280, 960 }, { 1936, 1096 }, { 2560, 1920 }, { 3008, 2008 } };
+
+    for (const auto& sz : sizes)
+    {
+        SimCamera cam(sz[0], sz[1], 400, 50);
+        DefectLearner learner;
+
+        double ms = 0.0;
+        for (int i = 1; i <= FRAMES; i++)
+        {
+            cam.Jitter();
+            if (i % 15 == 0)
+                cam.Dither();
+            cam.Render();
+
+            auto t0 = std::chrono::steady_clock::now();
+            learner.Learn(&cam.frame[0], wxSize(sz[0], sz[1]), cam.Field());
+            auto t1 = std::chrono::steady_clock::now();
+            ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        }
+
+        std::cout << "DefectLearner::Learn " << sz[0] << "x" << sz[1] << ", 1/" << learner.RowStride() << " of the rows: "
+                  << ms / FRAMES << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
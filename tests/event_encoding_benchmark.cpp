@@ -0,0 +1,260 @@
+/*
+ *  event_encoding_benchmark.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Compares the JWriter event encoding with the JObj/NV encoding it
+// replaced. The old encoder is reproduced here as it was in event_server.cpp.
+// Both must produce the same bytes, and the time per GuideStep event is
+// printed for each.
+
+#include <gtest/gtest.h>
+
+#include <wx/wx.h>
+#include <cmath>
+#include "point.h"
+#include "json_writer.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+// --- the old encoder ---
+
+static const wxString literal_true("true");
+static const wxString literal_false("false");
+
+static wxString json_escape(const wxString& s)
+{
+    wxString t(s);
+    static const wxString BACKSLASH("\\");
+    static const wxString BACKSLASHBACKSLASH("\\\\");
+    static const wxString DQUOT("\"");
+    static const wxString BACKSLASHDQUOT("\\\"");
+    static const wxString CR("\r");
+    static const wxString BACKSLASHCR("\\r");
+    static const wxString LF("\n");
+    static const wxString BACKSLASHLF("\\n");
+    t.Replace(BACKSLASH, BACKSLASHBACKSLASH);
+    t.Replace(DQUOT, BACKSLASHDQUOT);
+    t.Replace(CR, BACKSLASHCR);
+    t.Replace(LF, BACKSLASHLF);
+    return t;
+}
+
+struct JObj
+{
+    wxString m_s;
+    bool m_first;
+    bool m_closed;
+    JObj() : m_first(true), m_closed(false) { m_s << '{'; }
+    void close() { m_s << '}'; m_closed = true; }
+    wxString str() { if (!m_closed) close(); return m_s; }
+};
+
+struct NV
+{
+    wxString n;
+    wxString v;
+    NV(const wxString& n_, const wxString& v_) : n(n_), v('"' + json_escape(v_) + '"') { }
+    NV(const wxString& n_, const char *v_) : n(n_), v('"' + json_escape(v_) + '"') { }
+    NV(const wxString& n_, int v_) : n(n_), v(wxString::Format("%d", v_)) { }
+    NV(const wxString& n_, double v_, int prec) : n(n_), v(wxString::Format("%.*f", prec, v_)) { }
+    NV(const wxString& n_, bool v_) : n(n_), v(v_ ? literal_true : literal_false) { }
+};
+
+static JObj& operator<<(JObj& j, const NV& nv)
+{
+    if (j.m_first)
+        j.m_first = false;
+    else
+        j.m_s << ',';
+    j.m_s << '"' << nv.n << "\":" << nv.v;
+    return j;
+}
+
+// --- a guide step, with the fields NotifyGuideStep sends ---
+
+struct Step
+{
+    double timestamp;
+    int frameNumber;
+    double time;
+    double dx, dy;
+    double raRaw, decRaw;
+    double raGuide, decGuide;
+    int durationRA;
+    int durationDec;
+    double starMass;
+    double snr;
+    double avgDist;
+};
+
+static const char *const HOST = "OBSERVATORY-PC";
+static const char *const MOUNT = "Mount simulator";
+
+static std::string EncodeOld(const Step& s)
+{
+    JObj ev;
+    ev << NV("Event", "GuideStep")
+       << NV("Timestamp", s.timestamp, 3)
+       << NV("Host", HOST)
+       << NV("Inst", 1);
+    ev << NV("Frame", s.frameNumber)
+       << NV("Time", s.time, 3)
+       << NV("Mount", MOUNT)
+       << NV("dx", s.dx, 3)
+       << NV("dy", s.dy, 3)
+       << NV("RADistanceRaw", s.raRaw, 3)
+       << NV("DECDistanceRaw", s.decRaw, 3)
+       << NV("RADistanceGuide", s.raGuide, 3)
+       << NV("DECDistanceGuide", s.decGuide, 3);
+    if (s.durationRA > 0)
+        ev << NV("RADuration", s.durationRA) << NV("RADirection", "East");
+    if (s.durationDec > 0)
+        ev << NV("DECDuration", s.durationDec) << NV("DECDirection", "North");
+    ev << NV("StarMass", s.starMass, 0)
+       << NV("SNR", s.snr, 2)
+       << NV("AvgDist", s.avgDist, 2);
+
+    // do_notify appended the line terminator and converted to UTF-8
+    wxString str = ev.str();
+    str += "\r\n";
+    wxCharBuffer buf = str.ToUTF8();
+    return std::string(buf.data(), buf.length());
+}
+
+static void EncodeNew(JWriter& ev, const Step& s)
+{
+    ev.Reset();
+    ev.BeginObj()
+        .Add("Event", "GuideStep")
+        .Add("Timestamp", s.timestamp, 3)
+        .Add("Host", HOST)
+        .Add("Inst", 1)
+        .Add("Frame", s.frameNumber)
+        .Add("Time", s.time, 3)
+        .Add("Mount", MOUNT)
+        .Add("dx", s.dx, 3)
+        .Add("dy", s.dy, 3)
+        .Add("RADistanceRaw", s.raRaw, 3)
+        .Add("DECDistanceRaw", s.decRaw, 3)
+        .Add("RADistanceGuide", s.raGuide, 3)
+        .Add("DECDistanceGuide", s.decGuide, 3);
+    if (s.durationRA > 0)
+        ev.Add("RADuration", s.durationRA).Add("RADirection", "East");
+    if (s.durationDec > 0)
+        ev.Add("DECDuration", s.durationDec).Add("DECDirection", "North");
+    ev.Add("StarMass", s.starMass, 0)
+      .Add("SNR", s.snr, 2)
+      .Add("AvgDist", s.avgDist, 2);
+    ev.Finish();
+}
+
+static std::vector<Step> MakeSteps(unsigned int count)
+{
+    std::mt19937 rng(42);
+    std::normal_distribution<double> err(0.0, 0.8);
+    std::uniform_int_distribution<int> pulse(-400, 400);
+
+    std::vector<Step> steps(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        Step& s = steps[i];
+        s.timestamp = 1700000000.0 + i * 2.017;
+        s.frameNumber = i + 1;
+        s.time = i * 2.017;
+        s.dx = err(rng);
+        s.dy = err(rng);
+        s.raRaw = err(rng);
+        s.decRaw = err(rng);
+        s.raGuide = s.raRaw * 0.7;
+        s.decGuide = s.decRaw * 0.9;
+        s.durationRA = pulse(rng);
+        s.durationDec = pulse(rng);
+        s.starMass = 20000.0 + 5000.0 * err(rng);
+        s.snr = 40.0 + 5.0 * err(rng);
+        s.avgDist = fabs(err(rng));
+    }
+    return steps;
+}
+
+TEST(EventEncodingTest, same_output_as_old_encoder)
+{
+    std::vector<Step> steps = MakeSteps(100000);
+    JWriter ev;
+
+    for (const Step& s : steps)
+    {
+        EncodeNew(ev, s);
+        std::string const newStr(ev.Data(), ev.Size());
+        ASSERT_EQ(EncodeOld(s), newStr);
+    }
+}
+
+TEST(EventEncodingTest, benchmark)
+{
+    enum { STEPS = 10000, PASSES = 10 };
+
+    std::vector<Step> steps = MakeSteps(STEPS);
+    size_t bytes = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++)
+        for (const Step& s : steps)
+            bytes += EncodeOld(s).size();
+    auto t1 = std::chrono::steady_clock::now();
+
+    JWriter ev;
+    for (int pass = 0; pass < PASSES; pass++)
+        for (const Step& s : steps)
+        {
+            EncodeNew(ev, s);
+            bytes -= ev.Size();
+        }
+    auto t2 = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(bytes, 0u);
+
+    double const n = (double) STEPS * PASSES;
+    double const oldUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / n;
+    double const newUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / n;
+
+    std::cout << "GuideStep event encoding: JObj/NV " << oldUs << " us, JWriter " << newUs
+              << " us, speedup " << oldUs / newUs << "x" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
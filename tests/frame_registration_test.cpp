@@ -0,0 +1,208 @@
+/*
+ *  frame_registration_test.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Registers simulated star fields shifted by known sub-pixel amounts with
+// the phase correlation of FrameRegistration and checks the measured
+// shifts, and times a measurement for each window size.
+//
+// The fields have 20 or more stars per 128x128 pixels. Sparser fields can
+// correlate at a wrong shift; PhdController checks the registered shift
+// against the guide star for them.
+
+#include <gtest/gtest.h>
+
+#include "phase_correlation.h"
+#include "serial_compute_pool.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static const double PEAK_SIGMA = 2.0;           // as in FrameRegistration
+static const double MIN_PEAK_QUALITY = 0.25;
+
+struct SimStar
+{
+    double x;
+    double y;
+    double peak;
+};
+
+static std::vector<SimStar> MakeStars(int count, int size, std::mt19937& rng)
+{
+    std::uniform_real_distribution<double> pos(0.0, size);
+    std::uniform_real_distribution<double> bright(0.0, 1.0);
+
+    std::vector<SimStar> stars(count);
+    for (SimStar& s : stars)
+    {
+        s.x = pos(rng);
+        s.y = pos(rng);
+        s.peak = 200.0 * pow(50.0, bright(rng));    // 200 .. 10000 ADU
+    }
+    return stars;
+}
+
+// A size x size window of the field shifted by (dx, dy): Gaussian stars of
+// FWHM 3 px on a sky background with Poisson noise when noise is set
+static std::vector<unsigned short> Render(const std::vector<SimStar>& stars, int size, double dx, double dy, bool noise,
+                                          std::mt19937& rng)
+{
+    static const double SKY = 1000.0;
+    static const double SIGMA = 3.0 / 2.3548;
+
+    std::vector<double> img(size * size, SKY);
+    for (const SimStar& s : stars)
+    {
+        double const cx = s.x + dx, cy = s.y + dy;
+        for (int y = std::max(0, (int) cy - 6); y <= std::min(size - 1, (int) cy + 6); y++)
+        {
+            for (int x = std::max(0, (int) cx - 6); x <= std::min(size - 1, (int) cx + 6); x++)
+            {
+                double const rx = x - cx, ry = y - cy;
+                img[y * size + x] += s.peak * exp(-(rx * rx + ry * ry) / (2.0 * SIGMA * SIGMA));
+            }
+        }
+    }
+
+    std::vector<unsigned short> px(size * size);
+    for (int i = 0; i < size * size; i++)
+    {
+        double v = img[i];
+        if (noise)
+            v = std::poisson_distribution<int>(v)(rng);
+        px[i] = (unsigned short) std::min(v, 65535.0);
+    }
+    return px;
+}
+
+struct RegistrationParams
+{
+    int windowSize;
+    int density;        // stars per 128x128 pixels
+    bool noise;
+    double shiftRange;  // shifts up to this many pixels in x and y
+    double maxError;    // largest error of any measured shift, pixels
+    double maxRms;      // RMS error of the measured shifts, pixels
+};
+
+class FrameRegistrationTest : public ::testing::TestWithParam<RegistrationParams>
+{
+};
+
+TEST_P(FrameRegistrationTest, measures_known_subpixel_shifts)
+{
+    enum { SHIFTS = 100 };
+
+    RegistrationParams const& p = GetParam();
+    std::mt19937 rng(p.windowSize * 1000 + p.density);
+    std::uniform_real_distribution<double> shiftDist(-p.shiftRange, p.shiftRange);
+
+    // stars outside the window move into it
+    int const fieldSize = p.windowSize + 40;
+    std::vector<SimStar> stars = MakeStars(p.density * fieldSize * fieldSize / (128 * 128), fieldSize, rng);
+    for (SimStar& s : stars)
+    {
+        s.x -= 20.0;
+        s.y -= 20.0;
+    }
+
+    PhaseCorrelation corr;
+    corr.Init(p.windowSize, PEAK_SIGMA);
+    corr.SetReference(&Render(stars, p.windowSize, 0.0, 0.0, p.noise, rng)[0]);
+
+    double sumsq = 0.0;
+    double maxErr = 0.0;
+    for (int i = 0; i < SHIFTS; i++)
+    {
+        double const sx = shiftDist(rng), sy = shiftDist(rng);
+
+        double dx, dy, quality;
+        ASSERT_FALSE(corr.Measure(&Render(stars, p.windowSize, sx, sy, p.noise, rng)[0], p.windowSize / 4, MIN_PEAK_QUALITY,
+                                  &dx, &dy, &quality))
+            << "shift (" << sx << ", " << sy << ") not found, quality " << quality;
+
+        double const err = hypot(dx - sx, dy - sy);
+        sumsq += err * err;
+        maxErr = std::max(maxErr, err);
+    }
+
+    double const rms = sqrt(sumsq / SHIFTS);
+
+    std::cout << p.windowSize << "x" << p.windowSize << " window, " << p.density << " stars per 128x128" << (p.noise ? ", Poisson noise" : "")
+              << ": RMS error " << rms << " px, max " << maxErr << " px" << std::endl;
+
+    EXPECT_LE(rms, p.maxRms);
+    EXPECT_LE(maxErr, p.maxError);
+}
+
+INSTANTIATE_TEST_CASE_P(SimulatedFields, FrameRegistrationTest,
+                        ::testing::Values(RegistrationParams{ 128, 20, false, 10.0, 0.4, 0.2 },
+                                          RegistrationParams{ 128, 20, true, 10.0, 0.4, 0.2 },
+                                          RegistrationParams{ 128, 40, true, 10.0, 0.1, 0.05 },
+                                          RegistrationParams{ 64, 40, true, 10.0, 0.4, 0.2 },
+                                          RegistrationParams{ 64, 80, true, 10.0, 0.3, 0.15 },
+                                          RegistrationParams{ 32, 80, true, 3.0, 0.6, 0.25 }));
+
+TEST(FrameRegistrationBenchmark, measure_time)
+{
+    enum { PASSES = 200 };
+
+    for (int size = 32; size <= 128; size *= 2)
+    {
+        std::mt19937 rng(size);
+        std::vector<SimStar> stars = MakeStars(20, size, rng);
+
+        PhaseCorrelation corr;
+        corr.Init(size, PEAK_SIGMA);
+        corr.SetReference(&Render(stars, size, 0.0, 0.0, true, rng)[0]);
+        std::vector<unsigned short> const frame = Render(stars, size, 1.3, -2.6, true, rng);
+
+        double dx, dy, quality;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < PASSES; i++)
+            corr.Measure(&frame[0], size / 4, MIN_PEAK_QUALITY, &dx, &dy, &quality);
+        auto t1 = std::chrono::steady_clock::now();
+
+        std::cout << "PhaseCorrelation::Measure " << size << "x" << size << ": "
+                  << std::chrono::duration<double, std::milli>(t1 - t0).count() / PASSES << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
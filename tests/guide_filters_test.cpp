@@ -0,0 +1,373 @@
+/*
+ *  guide_filters_test.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Replays the recorded guide logs of the GP guider tests through the
+// Lowpass2 and ResistSwitch filters and through the implementations they
+// replaced, which are reproduced below as they were before the history was
+// moved into ring buffers. Both must produce exactly the same guide moves.
+
+#include <gtest/gtest.h>
+
+#include "guide_filters.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// --- the previous implementations ---
+
+static double CalcSlope(const std::vector<double>& y)
+{
+    // Does a linear regression to calculate the slope
+
+    int nn = (int) y.size();
+
+    if (nn < 2)
+        return 0.;
+
+    double s_xy = 0.0;
+    double s_y = 0.0;
+
+    for (int x = 0; x < nn; x++)
+    {
+        s_xy += (double)(x + 1) * y[x];
+        s_y += y[x];
+    }
+
+    int sx = (nn * (nn + 1)) / 2;
+    int sxx = sx * (2 * nn + 1) / 3;
+    double s_x = (double) sx;
+    double s_xx = (double) sxx;
+    double n = (double) nn;
+    return (n * s_xy - (s_x * s_y)) / (n * s_xx - (s_x * s_x));
+}
+
+struct OldLowpass2
+{
+    static const unsigned int HISTORY_SIZE = 10;
+
+    std::vector<double> m_history;
+    double m_aggressiveness;
+    double m_minMove;
+    int m_rejects;
+
+    OldLowpass2(double minMove, double aggressiveness)
+        : m_aggressiveness(aggressiveness), m_minMove(minMove) { reset(); }
+
+    void reset()
+    {
+        m_history.clear();
+        m_rejects = 0;
+    }
+
+    double result(double input)
+    {
+        m_history.push_back(input);
+        unsigned int numpts = m_history.size();
+        double dReturn;
+        double attenuation = m_aggressiveness / 100.;
+
+        if (numpts < 4)
+            dReturn = input * attenuation;
+        else
+        {
+            if (fabs(input) > 4.0 * m_minMove)
+            {
+                dReturn = input * attenuation;
+                reset();
+                numpts = 0;
+            }
+            else
+                dReturn = CalcSlope(m_history) * (double) numpts * attenuation;
+        }
+
+        if (numpts == HISTORY_SIZE)
+            m_history.erase(m_history.begin());
+
+        if (fabs(dReturn) > fabs(input))
+        {
+            dReturn = input * attenuation;
+            m_rejects++;
+            if (m_rejects > 3)
+                reset();
+        }
+        else
+            m_rejects = 0;
+
+        if (fabs(input) < m_minMove)
+            dReturn = 0.0;
+
+        return dReturn;
+    }
+};
+
+static int sign(double x)
+{
+    return x > 0.0 ? 1 : x < 0.0 ? -1 : 0;
+}
+
+struct OldResistSwitch
+{
+    static const unsigned int HISTORY_SIZE = 10;
+
+    std::vector<double> m_history;
+    double m_minMove;
+    bool m_fastSwitchEnabled;
+    int m_currentSide;
+
+    OldResistSwitch(double minMove, bool fastSwitch)
+        : m_minMove(minMove), m_fastSwitchEnabled(fastSwitch) { reset(); }
+
+    void reset()
+    {
+        m_history.assign(HISTORY_SIZE, 0.0);
+        m_currentSide = 0;
+    }
+
+    void SetMinMove(double minMove)
+    {
+        m_minMove = minMove;
+        m_currentSide = 0;
+    }
+
+    double result(double input)
+    {
+        m_history.push_back(input);
+        m_history.erase(m_history.begin());
+
+        if (fabs(input) < m_minMove)
+            return 0.0;
+
+        if (m_fastSwitchEnabled)
+        {
+            double thresh = 3.0 * m_minMove;
+            if (sign(input) != m_currentSide && fabs(input) > thresh)
+            {
+                m_currentSide = 0;
+                unsigned int i;
+                for (i = 0; i < HISTORY_SIZE - 3; i++)
+                    m_history[i] = 0.0;
+                for (; i < HISTORY_SIZE; i++)
+                    m_history[i] = input;
+            }
+        }
+
+        int decHistory = 0;
+
+        for (unsigned int i = 0; i < m_history.size(); i++)
+        {
+            if (fabs(m_history[i]) > m_minMove)
+                decHistory += sign(m_history[i]);
+        }
+
+        if (m_currentSide == 0 || sign(m_currentSide) == -sign(decHistory))
+        {
+            if (abs(decHistory) < 3)
+                return 0.0;
+
+            double oldest = 0.0;
+            double newest = 0.0;
+
+            for (int i = 0; i < 3; i++)
+            {
+                oldest += m_history[i];
+                newest += m_history[m_history.size() - (i + 1)];
+            }
+
+            if (fabs(newest) <= fabs(oldest))
+                return 0.0;
+
+            m_currentSide = sign(decHistory);
+        }
+
+        if (m_currentSide != sign(input))
+            return 0.0;
+
+        return input;
+    }
+};
+
+// --- the recorded guide logs ---
+
+struct GuideLogEntry
+{
+    bool reset;     // an INFO line (dither, settling, pause), the guider state is reset here
+    double ra;      // RARawDistance
+    double dec;     // DECRawDistance
+};
+
+static std::vector<GuideLogEntry> ReadGuideLog(const std::string& filename)
+{
+    std::vector<GuideLogEntry> entries;
+    std::ifstream file(filename);
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (line.compare(0, 5, "INFO:") == 0)
+        {
+            GuideLogEntry e = { true, 0.0, 0.0 };
+            entries.push_back(e);
+            continue;
+        }
+
+        std::vector<std::string> row;
+        std::stringstream ss(line);
+        std::string cell;
+        while (std::getline(ss, cell, ','))
+            row.push_back(cell);
+
+        // header and dropped frame lines
+        if (row.size() < 18 || row[0].empty() || !isdigit((unsigned char) row[0][0]) || row[5].empty() || row[6].empty())
+            continue;
+
+        GuideLogEntry e = { false, std::stod(row[5]), std::stod(row[6]) };
+        entries.push_back(e);
+    }
+
+    return entries;
+}
+
+class GuideFiltersTest : public ::testing::TestWithParam<int>
+{
+protected:
+    std::vector<GuideLogEntry> m_log;
+
+    void SetUp() override
+    {
+        char filename[64];
+        snprintf(filename, sizeof(filename), "performance_dataset%02d.txt", GetParam());
+        m_log = ReadGuideLog(filename);
+        ASSERT_GT(m_log.size(), 100u) << "cannot read " << filename;
+    }
+};
+
+// the min-move is changed twice during each replay, as a user would from the UI
+static double MinMoveAt(size_t i, size_t n, double minMove)
+{
+    return i < n / 3 ? minMove : i < 2 * n / 3 ? minMove * 2.0 : minMove * 0.5;
+}
+
+TEST_P(GuideFiltersTest, lowpass2_matches_previous_implementation)
+{
+    static const double MIN_MOVES[] = { 0.05, 0.15, 0.3 };
+    static const double AGGRESSIVENESS[] = { 50.0, 80.0, 100.0 };
+
+    size_t steps = 0;
+
+    for (double minMove : MIN_MOVES)
+        for (double aggr : AGGRESSIVENESS)
+            for (int axis = 0; axis < 2; axis++)
+            {
+                OldLowpass2 oldAlgo(minMove, aggr);
+                Lowpass2Filter newAlgo;
+
+                for (size_t i = 0; i < m_log.size(); i++)
+                {
+                    const GuideLogEntry& e = m_log[i];
+                    if (e.reset)
+                    {
+                        oldAlgo.reset();
+                        newAlgo.Reset();
+                        continue;
+                    }
+
+                    double const mm = MinMoveAt(i, m_log.size(), minMove);
+                    oldAlgo.m_minMove = mm;
+
+                    double const input = axis == 0 ? e.ra : e.dec;
+                    double const expected = oldAlgo.result(input);
+                    double const actual = newAlgo.Result(input, mm, aggr);
+
+                    ASSERT_EQ(expected, actual) << "step " << i << " input " << input;
+                    ++steps;
+                }
+            }
+
+    std::cout << "Lowpass2: " << steps << " steps" << std::endl;
+}
+
+TEST_P(GuideFiltersTest, resistswitch_matches_previous_implementation)
+{
+    static const double MIN_MOVES[] = { 0.05, 0.15, 0.3 };
+
+    size_t steps = 0;
+
+    for (double minMove : MIN_MOVES)
+        for (int fastSwitch = 0; fastSwitch < 2; fastSwitch++)
+            for (int axis = 0; axis < 2; axis++)
+            {
+                OldResistSwitch oldAlgo(minMove, fastSwitch != 0);
+                ResistSwitchFilter newAlgo;
+                newAlgo.SetMinMove(minMove);
+
+                for (size_t i = 0; i < m_log.size(); i++)
+                {
+                    const GuideLogEntry& e = m_log[i];
+                    if (e.reset)
+                    {
+                        oldAlgo.reset();
+                        newAlgo.Reset();
+                        continue;
+                    }
+
+                    double const mm = MinMoveAt(i, m_log.size(), minMove);
+                    if (mm != oldAlgo.m_minMove)
+                    {
+                        // what GuideAlgorithmResistSwitch::SetMinMove does
+                        oldAlgo.SetMinMove(mm);
+                        newAlgo.ResetSide();
+                        newAlgo.SetMinMove(mm);
+                    }
+
+                    double const input = axis == 0 ? e.ra : e.dec;
+                    double const expected = oldAlgo.result(input);
+                    double const actual = newAlgo.Result(input, fastSwitch != 0);
+
+                    ASSERT_EQ(expected, actual) << "step " << i << " input " << input;
+                    ++steps;
+                }
+            }
+
+    std::cout << "ResistSwitch: " << steps << " steps" << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(RecordedGuideLogs, GuideFiltersTest, ::testing::Range(1, 9));
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,162 @@
+/*
+ *  virtual_clock_test.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Sleeps on the virtual clock from several threads: sleeps that run at the
+// same time overlap, and the clock only advances when every participating
+// thread is blocked.
+
+#include <gtest/gtest.h>
+
+#include "virtual_clock.h"
+
+#include <atomic>
+#include <thread>
+
+static const long long T0 = 1000000;
+
+// releases the threads together once they have all registered
+class StartGate
+{
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    int m_waiting;
+
+public:
+    StartGate(int threads) : m_waiting(threads) { }
+
+    void Arrive()
+    {
+        std::unique_lock<std::mutex> lk(m_lock);
+        if (--m_waiting == 0)
+            m_cond.notify_all();
+        else
+            m_cond.wait(lk, [this] { return m_waiting == 0; });
+    }
+};
+
+TEST(VirtualClockTest, concurrent_sleeps_overlap)
+{
+    VirtualClock clock;
+    clock.Start(T0);
+    StartGate gate(2);
+    long long wokeA = 0, wokeB = 0;
+
+    std::thread a([&] {
+        clock.AddThread();
+        gate.Arrive();
+        clock.Sleep(1000);
+        wokeA = clock.Now();
+        clock.RemoveThread();
+    });
+    std::thread b([&] {
+        clock.AddThread();
+        gate.Arrive();
+        clock.Sleep(500);
+        wokeB = clock.Now();
+        clock.RemoveThread();
+    });
+    a.join();
+    b.join();
+
+    EXPECT_EQ(wokeB, T0 + 500);
+    EXPECT_EQ(wokeA, T0 + 1000);
+    EXPECT_EQ(clock.Now(), T0 + 1000);
+}
+
+TEST(VirtualClockTest, sequential_sleeps_add_up)
+{
+    VirtualClock clock;
+    clock.Start(T0);
+
+    std::thread a([&] {
+        clock.AddThread();
+        clock.Sleep(1000);
+        clock.Sleep(500);
+        clock.RemoveThread();
+    });
+    a.join();
+
+    EXPECT_EQ(clock.Now(), T0 + 1500);
+}
+
+// the clock does not advance while a participating thread is running, and
+// does once that thread waits for work
+TEST(VirtualClockTest, waits_for_running_threads)
+{
+    VirtualClock clock;
+    clock.Start(T0);
+    StartGate gate(2);
+    std::atomic<bool> sleeperDone(false);
+    long long whileRunning = 0;
+
+    std::thread sleeper([&] {
+        clock.AddThread();
+        gate.Arrive();
+        clock.Sleep(1000);
+        sleeperDone = true;
+        clock.RemoveThread();
+    });
+    std::thread worker([&] {
+        clock.AddThread();
+        gate.Arrive();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        whileRunning = clock.Now();
+        clock.BeginWait();
+        while (!sleeperDone)
+            std::this_thread::yield();
+        clock.EndWait();
+        clock.RemoveThread();
+    });
+    sleeper.join();
+    worker.join();
+
+    EXPECT_EQ(whileRunning, T0);
+    EXPECT_EQ(clock.Now(), T0 + 1000);
+}
+
+// a thread that does not take part in the clock sleeps without waiting for anyone
+TEST(VirtualClockTest, non_participating_sleep)
+{
+    VirtualClock clock;
+    clock.Start(T0);
+
+    clock.Sleep(250);
+
+    EXPECT_EQ(clock.Now(), T0 + 250);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
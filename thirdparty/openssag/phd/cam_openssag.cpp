@@ -58,7 +58,7 @@ bool Camera_OpenSSAGClass::Connect() {
     }
 
     if (!ssag->Connect()) {
-        wxMessageBox(_T("Could not connect to StarShoot Autoguider"));
+        PhdMessageBox(_T("Could not connect to StarShoot Autoguider"));
         return true;
     }
 
@@ -102,7 +102,7 @@ bool Camera_OpenSSAGClass::CaptureFull(int duration, usImage& img, bool recon) {
     int ysize = FullSize.GetHeight();
 
     if (img.Init(xsize,ysize)) {
-        wxMessageBox(_T("Memory allocation error during capture"),wxT("Error"),wxOK | wxICON_ERROR);
+        PhdMessageBox(_T("Memory allocation error during capture"),wxT("Error"),wxOK | wxICON_ERROR);
         Disconnect();
         return true;
     }
@@ -0,0 +1,189 @@
+/*
+ *  trace.cpp
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "phd.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+enum { TRACE_BUFFER_SIZE = 64 * 1024 }; // must be a power of 2
+
+struct TraceEvent
+{
+    // sequence number of the event occupying the slot plus one, 0 while the slot is being written
+    std::atomic<unsigned long long> seq;
+    const char *name;
+    const char *argName;
+    long long arg;
+    long long start;
+    long long dur;
+    wxThreadIdType tid;
+};
+
+static TraceEvent s_events[TRACE_BUFFER_SIZE];
+static std::atomic<unsigned long long> s_next;
+
+static wxCriticalSection s_namesLock;
+static std::map<wxThreadIdType, std::string> s_threadNames;
+
+long long Trace::Now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::Complete(const char *name, long long start, const char *argName, long long arg)
+{
+    long long const end = Now();
+
+    // claim a slot; writers never wait for each other or for the exporter
+    unsigned long long const n = s_next.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& ev = s_events[n & (TRACE_BUFFER_SIZE - 1)];
+
+    ev.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ev.name = name;
+    ev.argName = argName;
+    ev.arg = arg;
+    ev.start = start;
+    ev.dur = end - start;
+    ev.tid = wxThread::GetCurrentId();
+
+    ev.seq.store(n + 1, std::memory_order_release);
+}
+
+void Trace::SetThreadName(wxThreadIdType tid, const char *name)
+{
+    wxCriticalSectionLocker lck(s_namesLock);
+    s_threadNames[tid] = name;
+}
+
+wxString Trace::DefaultFilename()
+{
+    return Debug.GetLogDir() + PATHSEPSTR + wxDateTime::Now().Format(_T("PHD2_Trace_%Y-%m-%d_%H%M%S.json"));
+}
+
+bool Trace::Export(const wxString& filename)
+{
+    struct Snapshot
+    {
+        const char *name;
+        const char *argName;
+        long long arg;
+        long long start;
+        long long dur;
+        wxThreadIdType tid;
+    };
+
+    // copy out the events, skipping any slot that is overwritten while we read it
+    unsigned long long const end = s_next.load(std::memory_order_acquire);
+    unsigned long long const begin = end > TRACE_BUFFER_SIZE ? end - TRACE_BUFFER_SIZE : 0;
+
+    std::vector<Snapshot> events;
+    events.reserve((size_t)(end - begin));
+
+    for (unsigned long long n = begin; n < end; n++)
+    {
+        const TraceEvent& ev = s_events[n & (TRACE_BUFFER_SIZE - 1)];
+        if (ev.seq.load(std::memory_order_acquire) != n + 1)
+            continue;
+        Snapshot s = { ev.name, ev.argName, ev.arg, ev.start, ev.dur, ev.tid };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ev.seq.load(std::memory_order_relaxed) != n + 1)
+            continue;
+        events.push_back(s);
+    }
+
+    // thread ids can be large (pthread_t on some platforms), so number the threads instead
+    std::map<wxThreadIdType, int> tids;
+    for (const Snapshot& s : events)
+        tids.insert(std::make_pair(s.tid, (int) tids.size() + 1));
+
+    wxFFile file(filename, "w");
+    if (!file.IsOpened())
+        return true;
+
+    std::string out;
+    out.reserve(events.size() * 100 + 1024);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"PHD2\"}}";
+
+    {
+        wxCriticalSectionLocker lck(s_namesLock);
+
+        char buf[256];
+        for (const auto& t : tids)
+        {
+            std::string name;
+            auto it = s_threadNames.find(t.first);
+            if (it != s_threadNames.end())
+                name = it->second;
+            else if (t.first == wxThread::GetMainId())
+                name = "main";
+            else
+                name = "thread " + std::to_string(t.second);
+
+            snprintf(buf, sizeof(buf), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                t.second, name.c_str());
+            out += buf;
+        }
+    }
+
+    for (const Snapshot& s : events)
+    {
+        char buf[256];
+        int len = snprintf(buf, sizeof(buf), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld",
+            s.name, tids[s.tid], s.start, s.dur);
+        if (len > 0 && (size_t) len < sizeof(buf))
+            out.append(buf, len);
+        if (s.argName)
+        {
+            len = snprintf(buf, sizeof(buf), ",\"args\":{\"%s\":%lld}", s.argName, s.arg);
+            if (len > 0 && (size_t) len < sizeof(buf))
+                out.append(buf, len);
+        }
+        out += '}';
+    }
+
+    out += "\n]}\n";
+
+    bool err = !file.Write(out.data(), out.size()) || !file.Close();
+
+    Debug.Write(wxString::Format("Trace: exported %u events to %s\n", (unsigned int) events.size(), filename));
+
+    return err;
+}
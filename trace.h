@@ -0,0 +1,75 @@
+/*
+ *  trace.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef TRACE_INCLUDED
+#define TRACE_INCLUDED
+
+// Low-overhead tracing of where the time goes in each guide cycle.
+//
+// Scoped trace points record complete events (name, start, duration, thread
+// and an optional numeric argument) into a fixed-size lock-free ring buffer
+// holding the most recent events. The buffer can be exported on demand in
+// Chrome trace event format for viewing in chrome://tracing or Perfetto.
+//
+// Event and argument names must be string literals; they are stored by
+// pointer and written to the export without escaping.
+class Trace
+{
+public:
+    static long long Now(); // microseconds, monotonic
+    static void Complete(const char *name, long long start, const char *argName, long long arg);
+    static void SetThreadName(wxThreadIdType tid, const char *name);
+    static wxString DefaultFilename();
+    static bool Export(const wxString& filename);
+};
+
+class TraceScope
+{
+    const char *m_name;
+    const char *m_argName;
+    long long m_arg;
+    long long m_start;
+
+public:
+    TraceScope(const char *name, const char *argName = nullptr, long long arg = 0)
+        : m_name(name), m_argName(argName), m_arg(arg), m_start(Trace::Now()) { }
+    ~TraceScope() { Trace::Complete(m_name, m_start, m_argName, m_arg); }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// TRACE_SCOPE("name") or TRACE_SCOPE("name", "argname", value) traces the rest of the enclosing block
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(_trace_scope_, __LINE__)(__VA_ARGS__)
+
+#endif
@@ -73,6 +73,35 @@ void usImage::SwapImageData(usImage& other)
     other.ImageData = t;
 }
 
+// min and max of n pixels, each range of pixels scanned by whichever pool
+// thread claims it
+static void MinMax(const unsigned short *p, unsigned int n, int *pmin, int *pmax)
+{
+    int const grain = ComputePool::RowGrain((int) n, 1);
+    int const nranges = ((int) n + grain - 1) / grain;
+    std::vector<unsigned short> lo(nranges, 65535), hi(nranges, 0);
+
+    ComputePool::ParallelFor((int) n, grain, [&](int begin, int end) {
+        unsigned short mn = 65535, mx = 0;
+        for (int i = begin; i < end; i++)
+        {
+            unsigned short const d = p[i];
+            if (d < mn) mn = d;
+            if (d > mx) mx = d;
+        }
+        lo[begin / grain] = mn;
+        hi[begin / grain] = mx;
+    });
+
+    *pmin = 65535;
+    *pmax = 0;
+    for (int i = 0; i < nranges; i++)
+    {
+        if (lo[i] < *pmin) *pmin = lo[i];
+        if (hi[i] > *pmax) *pmax = hi[i];
+    }
+}
+
 void usImage::CalcStats()
 {
     if (!ImageData || !NPixels)
@@ -85,27 +114,13 @@ void usImage::CalcStats()
     {
         // full frame, no subframe
 
-        const unsigned short *src;
-
-        src = ImageData;
-        for (unsigned int i = 0; i < NPixels; i++)
-        {
-            int d = (int) *src++;
-            if (d < Min) Min = d;
-            if (d > Max) Max = d;
-        }
+        MinMax(ImageData, NPixels, &Min, &Max);
 
         unsigned short *tmpdata = new unsigned short[NPixels];
 
         Median3(tmpdata, ImageData, Size, wxRect(Size));
 
-        src = tmpdata;
-        for (unsigned int i = 0; i < NPixels; i++)
-        {
-            int d = (int) *src++;
-            if (d < FiltMin) FiltMin = d;
-            if (d > FiltMax) FiltMax = d;
-        }
+        MinMax(tmpdata, NPixels, &FiltMin, &FiltMax);
 
         delete[] tmpdata;
     }
@@ -122,26 +137,17 @@ void usImage::CalcStats()
         for (int y = 0; y < Subframe.height; y++)
         {
             const unsigned short *src = ImageData + Subframe.x + (Subframe.y + y) * Size.GetWidth();
-            for (int x = 0; x < Subframe.width; x++)
-            {
-               int d = (int) *src;
-               if (d < Min) Min = d;
-               if (d > Max) Max = d;
-               *dst++ = *src++;
-            }
+            memcpy(dst, src, Subframe.width * sizeof(unsigned short));
+            dst += Subframe.width;
         }
 
+        MinMax(tmpdata, pixcnt, &Min, &Max);
+
         dst = new unsigned short[pixcnt];
 
         Median3(dst, tmpdata, Subframe.GetSize(), wxRect(Subframe.GetSize()));
 
-        const unsigned short *src = dst;
-        for (unsigned int i = 0; i < pixcnt; i++)
-        {
-            int d = (int) *src++;
-            if (d < FiltMin) FiltMin = d;
-            if (d > FiltMax) FiltMax = d;
-        }
+        MinMax(dst, pixcnt, &FiltMin, &FiltMax);
 
         delete[] dst;
         delete[] tmpdata;
@@ -158,45 +164,51 @@ bool usImage::CopyToImage(wxImage **rawimg, int blevel, int wlevel, double power
         img = new wxImage(Size.GetWidth(), Size.GetHeight(), false);
     }
 
-    unsigned char *ImgPtr = img->GetData();
-    unsigned short *RawPtr = ImageData;
+    unsigned char *const ImgData = img->GetData();
+    int const W = Size.GetWidth();
 
-    if (power == 1.0 || blevel >= wlevel)
-    {
-        float range = (float) wxMax(1, wlevel);  // Go 0-max
-        for (unsigned int i = 0; i < NPixels; i++, RawPtr++)
+    ComputePool::ParallelRows(Size.GetHeight(), W, [&](int y0, int y1) {
+        unsigned char *ImgPtr = ImgData + y0 * W * 3;
+        const unsigned short *RawPtr = ImageData + y0 * W;
+        unsigned int const npix = (y1 - y0) * W;
+
+        if (power == 1.0 || blevel >= wlevel)
         {
-            float d;
-            if (*RawPtr >= range)
-                d = 255.0;
-            else
-                d = ((float) (*RawPtr) / range) * 255.0;
-
-            *ImgPtr++ = (unsigned char) d;
-            *ImgPtr++ = (unsigned char) d;
-            *ImgPtr++ = (unsigned char) d;
+            float range = (float) wxMax(1, wlevel);  // Go 0-max
+            for (unsigned int i = 0; i < npix; i++, RawPtr++)
+            {
+                float d;
+                if (*RawPtr >= range)
+                    d = 255.0;
+                else
+                    d = ((float) (*RawPtr) / range) * 255.0;
+
+                *ImgPtr++ = (unsigned char) d;
+                *ImgPtr++ = (unsigned char) d;
+                *ImgPtr++ = (unsigned char) d;
+            }
         }
-    }
-    else
-    {
-        float range = (float) (wlevel - blevel);
-        for (unsigned int i = 0; i < NPixels; i++, RawPtr++ )
+        else
         {
-            float d;
-            if (*RawPtr <= blevel)
-                d = 0.0;
-            else if (*RawPtr >= wlevel)
-                d = 255.0;
-            else
+            float range = (float) (wlevel - blevel);
+            for (unsigned int i = 0; i < npix; i++, RawPtr++ )
             {
-                d = ((float) (*RawPtr) - (float) blevel) / range;
-                d = pow(d, (float) power) * 255.0;
+                float d;
+                if (*RawPtr <= blevel)
+                    d = 0.0;
+                else if (*RawPtr >= wlevel)
+                    d = 255.0;
+                else
+                {
+                    d = ((float) (*RawPtr) - (float) blevel) / range;
+                    d = pow(d, (float) power) * 255.0;
+                }
+                *ImgPtr++ = (unsigned char) d;
+                *ImgPtr++ = (unsigned char) d;
+                *ImgPtr++ = (unsigned char) d;
             }
-            *ImgPtr++ = (unsigned char) d;
-            *ImgPtr++ = (unsigned char) d;
-            *ImgPtr++ = (unsigned char) d;
         }
-    }
+    });
 
     *rawimg = img;
     return false;
@@ -277,7 +289,7 @@ bool usImage::BinnedCopyToImage(wxImage **rawimg, int blevel, int wlevel, double
 
 void usImage::InitImgStartTime()
 {
-    ImgStartTime = wxDateTime::UNow();
+    ImgStartTime = PhdClock::UNow();
 }
 
 bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
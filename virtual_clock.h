@@ -0,0 +1,165 @@
+/*
+ *  virtual_clock.h
+ *  PHD Guiding
+ *
+ *  Copyright (c) 2026 openphdguiding.org
+ *  All rights reserved.
+ *
+ *  This source code is distributed under the following "BSD" license
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *    Neither the name of Craig Stark, Stark Labs nor the names of its
+ *     contributors may be used to endorse or promote products derived from
+ *     this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef VIRTUAL_CLOCK_H_INCLUDED
+#define VIRTUAL_CLOCK_H_INCLUDED
+
+// The virtual clock behind PhdClock (--virtualClock). It only depends on the
+// standard library so it can be run outside PHD2 (see
+// tests/virtual_clock_test.cpp).
+//
+// Time advances like in a discrete-event simulation: a sleeping thread
+// blocks until the clock reaches its wake time, and the clock jumps to the
+// earliest pending wake time once every participating thread is blocked,
+// either sleeping or waiting for work. Sleeps on several threads at the same
+// time therefore overlap instead of adding up. A thread that does not
+// participate counts while it sleeps.
+//
+// A participating thread can also block somewhere the clock does not see,
+// e.g. on a lock held by a sleeping thread. So that this cannot deadlock, a
+// sleeper that has seen no progress for STALL_MS of real time advances the
+// clock anyway.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+class VirtualClock
+{
+    enum { STALL_MS = 50 };
+
+    std::atomic<long long> m_now;       // milliseconds
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    std::multiset<long long> m_wakeTimes;
+    int m_threads;                      // participating threads
+    int m_blocked;                      // participating threads sleeping or waiting for work
+
+    static bool& Participating()
+    {
+        static thread_local bool participating = false;
+        return participating;
+    }
+
+    // call with m_lock held
+    void AdvanceTo(long long t)
+    {
+        if (t > m_now.load())
+        {
+            m_now = t;
+            m_cond.notify_all();
+        }
+    }
+
+    // call with m_lock held
+    void Advance()
+    {
+        if (!m_wakeTimes.empty() && m_blocked >= m_threads)
+            AdvanceTo(*m_wakeTimes.begin());
+    }
+
+public:
+    VirtualClock() : m_now(0), m_threads(0), m_blocked(0) { }
+
+    void Start(long long now) { m_now = now; }
+    long long Now() const { return m_now.load(); }
+
+    // register or unregister the calling thread as participating
+    void AddThread()
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        Participating() = true;
+        ++m_threads;
+    }
+
+    void RemoveThread()
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        Participating() = false;
+        --m_threads;
+        Advance();
+    }
+
+    // a participating thread is waiting for work
+    void BeginWait()
+    {
+        if (!Participating())
+            return;
+        std::lock_guard<std::mutex> lk(m_lock);
+        ++m_blocked;
+        Advance();
+    }
+
+    void EndWait()
+    {
+        if (!Participating())
+            return;
+        std::lock_guard<std::mutex> lk(m_lock);
+        --m_blocked;
+    }
+
+    void Sleep(long long ms)
+    {
+        bool const participating = Participating();
+
+        std::unique_lock<std::mutex> lk(m_lock);
+
+        long long const wake = m_now.load() + ms;
+        auto const it = m_wakeTimes.insert(wake);
+        if (!participating)
+            ++m_threads;    // counts as participating while it sleeps
+        ++m_blocked;
+
+        Advance();
+
+        while (m_now.load() < wake)
+        {
+            long long const before = m_now.load();
+            if (m_cond.wait_for(lk, std::chrono::milliseconds(STALL_MS)) == std::cv_status::timeout &&
+                m_now.load() == before)
+            {
+                AdvanceTo(*m_wakeTimes.begin());
+            }
+        }
+
+        m_wakeTimes.erase(it);
+        if (!participating)
+            --m_threads;
+        --m_blocked;
+    }
+};
+
+#endif
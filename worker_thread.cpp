@@ -37,8 +37,12 @@
 
 WorkerThread::WorkerThread(MyFrame *pFrame)
     : wxThread(wxTHREAD_JOINABLE),
-      m_interruptRequested(0),
+      m_stopCount(0),
+      m_terminateRequested(false),
+      m_currentStopToken(0),
       m_killable(true),
+      m_queueCond(m_queueLock),
+      m_queueSeq(0),
       m_skipSendExposeComplete(false)
 {
     m_pFrame = pFrame;
@@ -50,45 +54,37 @@ WorkerThread::~WorkerThread(void)
     Debug.Write("WorkerThread destructor called\n");
 }
 
-void WorkerThread::EnqueueMessage(const WORKER_THREAD_REQUEST& message)
+void WorkerThread::EnqueueMessage(const WORKER_THREAD_REQUEST& message, WORKER_REQUEST_PRIORITY priority)
 {
-    wxMessageQueueError queueError;
-
-    if (message.request == REQUEST_EXPOSE)
-    {
-        queueError = m_lowPriorityQueue.Post(message);
-    }
-    else
-    {
-        queueError = m_highPriorityQueue.Post(message);
-    }
-
-    assert(queueError == wxMSGQUEUE_NO_ERROR);
-
-    queueError = m_wakeupQueue.Post(true);
-
-    assert(queueError == wxMSGQUEUE_NO_ERROR);
+    QUEUED_REQUEST qr;
+    qr.message = message;
+    qr.priority = priority;
+    qr.stopToken = m_stopCount;
+    qr.enqueueTime = Trace::Now();
+
+    wxMutexLocker lock(m_queueLock);
+    qr.seq = m_queueSeq++;
+    m_queue.push(qr);
+    m_queueCond.Signal();
 }
 
 /*************      Terminate      **************************/
 
 void WorkerThread::EnqueueWorkerThreadTerminateRequest(void)
 {
-    m_interruptRequested = INT_STOP | INT_TERMINATE;
+    m_terminateRequested = true;
 
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
 
     message.request = REQUEST_TERMINATE;
-    EnqueueMessage(message);
+    EnqueueMessage(message, PRIORITY_HIGH);
 }
 
 /*************      Expose      **************************/
 
 void WorkerThread::EnqueueWorkerThreadExposeRequest(usImage *pImage, int exposureDuration, int exposureOptions, const wxRect& subframe)
 {
-    m_interruptRequested &= ~INT_STOP;
-
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
 
@@ -101,13 +97,21 @@ void WorkerThread::EnqueueWorkerThreadExposeRequest(usImage *pImage, int exposur
     message.args.expose.subframe         = subframe;
     message.args.expose.pSemaphore       = 0;
 
-    EnqueueMessage(message);
+    EnqueueMessage(message, PRIORITY_LOW);
 }
 
 unsigned int WorkerThread::MilliSleep(int ms, unsigned int checkInterrupts)
 {
     enum { MAX_SLEEP = 100 };
 
+    if (PhdClock::IsVirtual())
+    {
+        // the virtual clock advances without actually sleeping
+        if (ms > 0)
+            PhdClock::MilliSleep(ms);
+        return WorkerThread::InterruptRequested() & checkInterrupts;
+    }
+
     if (ms <= MAX_SLEEP)
     {
         if (ms > 0)
@@ -121,7 +125,7 @@ unsigned int WorkerThread::MilliSleep(int ms, unsigned int checkInterrupts)
     long elapsed = 0;
     do {
         wxMilliSleep(wxMin((long) ms - elapsed, (long) MAX_SLEEP));
-        unsigned int val = thr ? (thr->m_interruptRequested & checkInterrupts) : 0;
+        unsigned int val = thr ? (thr->Interrupts() & checkInterrupts) : 0;
         if (val)
             return val;
         elapsed = swatch.Time();
@@ -138,15 +142,28 @@ void WorkerThread::SetSkipExposeComplete()
 
 bool WorkerThread::HandleExpose(EXPOSE_REQUEST *req)
 {
+    TRACE_SCOPE("HandleExpose", "exposure", req->exposureDuration);
+
     bool bError = false;
 
     try
     {
-        if (WorkerThread::MilliSleep(m_pFrame->GetTimeLapse(), INT_ANY))
+        if (m_pFrame->GetTimeLapse() > 0)
+        {
+            TRACE_SCOPE("TimeLapse");
+            if (WorkerThread::MilliSleep(m_pFrame->GetTimeLapse(), INT_ANY))
+            {
+                throw ERROR_INFO("Time lapse interrupted");
+            }
+        }
+        else if (WorkerThread::InterruptRequested() & INT_ANY)
         {
+            // e.g. the exposure was queued before RequestStop()
             throw ERROR_INFO("Time lapse interrupted");
         }
 
+        long long const captureStart = Trace::Now();
+
         if (pCamera->HasNonGuiCapture())
         {
             Debug.Write(wxString::Format("Handling exposure in thread, d=%d o=%x r=(%d,%d,%d,%d)\n", req->exposureDuration,
@@ -176,10 +193,14 @@ bool WorkerThread::HandleExpose(EXPOSE_REQUEST *req)
             req->pSemaphore = NULL;
         }
 
+        Metrics.captureTime.Record(Trace::Now() - captureStart);
+
         Debug.Write("Exposure complete\n");
 
         if (!bError)
         {
+            TRACE_SCOPE("NoiseReductionAndStats");
+
             switch (m_pFrame->GetNoiseReductionMethod())
             {
                 case NR_NONE:
@@ -192,7 +213,9 @@ bool WorkerThread::HandleExpose(EXPOSE_REQUEST *req)
                     break;
             }
 
-            req->pImage->CalcStats();
+            // the stats only set the display stretch levels
+            if (!wxGetApp().IsHeadless())
+                req->pImage->CalcStats();
         }
     }
     catch (const wxString& Msg)
@@ -216,8 +239,6 @@ void WorkerThread::SendWorkerThreadExposeComplete(usImage *pImage, bool bError)
 
 void WorkerThread::EnqueueWorkerThreadMoveRequest(Mount *mount, const GuiderOffset& ofs, unsigned int moveOptions)
 {
-    m_interruptRequested &= ~INT_STOP;
-
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
 
@@ -230,13 +251,11 @@ void WorkerThread::EnqueueWorkerThreadMoveRequest(Mount *mount, const GuiderOffs
     message.args.move.moveOptions     = moveOptions;
     message.args.move.semaphore       = nullptr;
 
-    EnqueueMessage(message);
+    EnqueueMessage(message, PRIORITY_HIGH);
 }
 
 void WorkerThread::EnqueueWorkerThreadAxisMove(Mount *mount, const GUIDE_DIRECTION direction, int duration, unsigned int moveOptions)
 {
-    m_interruptRequested &= ~INT_STOP;
-
     WORKER_THREAD_REQUEST message;
     memset(&message, 0, sizeof(message));
 
@@ -250,11 +269,14 @@ void WorkerThread::EnqueueWorkerThreadAxisMove(Mount *mount, const GUIDE_DIRECTI
     message.args.move.moveOptions     = moveOptions;
     message.args.move.semaphore       = nullptr;
 
-    EnqueueMessage(message);
+    EnqueueMessage(message, PRIORITY_HIGH);
 }
 
 Mount::MOVE_RESULT WorkerThread::HandleMove(MOVE_REQUEST *req)
 {
+    TRACE_SCOPE("HandleMove", "duration", req->duration);
+    MetricTimer timer(Metrics.moveTime);
+
     Mount::MOVE_RESULT result = Mount::MOVE_OK;
 
     try
@@ -348,25 +370,33 @@ wxThread::ExitCode WorkerThread::Entry()
     Debug.Write(wxString::Format("worker thread CoInitializeEx returns %x\n", hr));
 #endif
 
+    PhdClock::AddThread();
+
     while (!bDone)
     {
-        bool dummy;
-        wxMessageQueueError queueError = m_wakeupQueue.Receive(dummy);
-
-        Debug.Write("Worker thread wakes up\n");
+        QUEUED_REQUEST next;
+        {
+            TRACE_SCOPE("Idle");
+            wxMutexLocker lock(m_queueLock);
+            if (m_queue.empty())
+            {
+                PhdClock::BeginWait();
+                while (m_queue.empty())
+                    m_queueCond.Wait();
+                PhdClock::EndWait();
+            }
+            next = m_queue.top();
+            m_queue.pop();
+        }
 
-        assert(queueError == wxMSGQUEUE_NO_ERROR);
+        m_currentStopToken = next.stopToken;
 
-        WORKER_THREAD_REQUEST message;
-        queueError = m_highPriorityQueue.ReceiveTimeout(0, message);
+        long long const latency = Trace::Now() - next.enqueueTime;
+        Metrics.workerQueueLatency.Record(latency);
 
-        if (queueError == wxMSGQUEUE_TIMEOUT)
-        {
-            queueError = m_lowPriorityQueue.ReceiveTimeout(0, message);
-            assert(queueError != wxMSGQUEUE_TIMEOUT);
-        }
+        Debug.Write(wxString::Format("Worker thread wakes up, queue latency %.1f ms\n", latency / 1000.0));
 
-        assert(queueError == wxMSGQUEUE_NO_ERROR);
+        WORKER_THREAD_REQUEST& message = next.message;
 
         switch (message.request)
         {
@@ -419,6 +449,8 @@ wxThread::ExitCode WorkerThread::Entry()
         bDone |= TestDestroy();
     }
 
+    PhdClock::RemoveThread();
+
     Debug.Write("WorkerThread::Entry() ends\n");
     Debug.Flush();
 
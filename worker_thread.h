@@ -36,6 +36,10 @@
 #ifndef WORKER_THREAD_H_INCLUDED
 #define WORKER_THREAD_H_INCLUDED
 
+#include <atomic>
+#include <queue>
+#include <vector>
+
 class MyFrame;
 
 /*
@@ -44,15 +48,17 @@ class MyFrame;
  * second mount, so that on systems with two mounts (probably an AO and a telescope), the
  * second mount can be moving while we image and guide with the first mount.
  *
- * The worker threads have three queues, one for move requests (higher priority)
- * and one for exposure requests (lower priority) and one "wakeup queue". The wx queue
- * routines do not have a way to wait on multiple queues, so there is no easy way
- * to implement the dual queue priority model without a third queue.
+ * Each worker thread has a single request queue protected by a mutex, with a
+ * condition variable to wake the thread.  Requests carry an explicit priority:
+ * move and terminate requests are high priority and exposure requests are low
+ * priority.  The thread always services the oldest request of the highest
+ * priority, so a move is never stuck behind a queued exposure.
  *
- * When something is enqueued on either of the work queues, a dummy message is
- * also enqueued on the wakeup queue, which wakes the thread up.  It then finds
- * the work item by looking first on the high priority queue and then the low
- * priority queue.
+ * Each request also carries a stop token, the value of the thread's stop
+ * counter when the request was enqueued.  RequestStop() advances the counter,
+ * which cancels the running request and any request queued before the stop,
+ * but not requests enqueued afterwards.  Long running operations poll for
+ * cancellation with StopRequested() / TerminateRequested() or MilliSleep().
  *
  */
 
@@ -103,12 +109,39 @@ class WorkerThread : public wxThread
         } args;
     };
 
+    enum WORKER_REQUEST_PRIORITY
+    {
+        PRIORITY_LOW,       // exposures
+        PRIORITY_HIGH,      // moves and terminate
+    };
+
+    struct QUEUED_REQUEST
+    {
+        WORKER_THREAD_REQUEST message;
+        WORKER_REQUEST_PRIORITY priority;
+        unsigned long long seq;     // FIFO order within a priority
+        unsigned int stopToken;     // value of m_stopCount when enqueued
+        long long enqueueTime;      // us, for measuring queue latency
+    };
+
+    struct QueueOrder
+    {
+        // std::priority_queue puts the greatest element on top
+        bool operator()(const QUEUED_REQUEST& a, const QUEUED_REQUEST& b) const
+        {
+            return a.priority != b.priority ? a.priority < b.priority : a.seq > b.seq;
+        }
+    };
+
     MyFrame *m_pFrame;
-    volatile unsigned int m_interruptRequested;
+    std::atomic<unsigned int> m_stopCount;
+    std::atomic<bool> m_terminateRequested;
+    unsigned int m_currentStopToken;    // stop token of the request being serviced
     volatile bool m_killable;
-    wxMessageQueue<bool> m_wakeupQueue;
-    wxMessageQueue<WORKER_THREAD_REQUEST> m_highPriorityQueue;
-    wxMessageQueue<WORKER_THREAD_REQUEST> m_lowPriorityQueue;
+    wxMutex m_queueLock;
+    wxCondition m_queueCond;
+    std::priority_queue<QUEUED_REQUEST, std::vector<QUEUED_REQUEST>, QueueOrder> m_queue;
+    unsigned long long m_queueSeq;
     bool m_skipSendExposeComplete;
 
 public:
@@ -187,12 +220,20 @@ protected:
     void SendWorkerThreadMoveComplete(Mount *mount, Mount::MOVE_RESULT moveResult);
     // in the frame class: void MyFrame::OnWorkerThreadGuideComplete(wxThreadEvent& event);
 
-    void EnqueueMessage(const WORKER_THREAD_REQUEST& message);
+    void EnqueueMessage(const WORKER_THREAD_REQUEST& message, WORKER_REQUEST_PRIORITY priority);
+    unsigned int Interrupts(void) const;
 };
 
 inline void WorkerThread::RequestStop(void)
 {
-    m_interruptRequested |= INT_STOP;
+    ++m_stopCount;
+}
+
+inline unsigned int WorkerThread::Interrupts(void) const
+{
+    if (m_terminateRequested)
+        return INT_STOP | INT_TERMINATE;
+    return m_stopCount != m_currentStopToken ? INT_STOP : 0;
 }
 
 inline WorkerThread *WorkerThread::This(void)
@@ -203,7 +244,7 @@ inline WorkerThread *WorkerThread::This(void)
 inline unsigned int WorkerThread::InterruptRequested(void)
 {
     WorkerThread *thr = WorkerThread::This();
-    return thr ? thr->m_interruptRequested : 0;
+    return thr ? thr->Interrupts() : 0;
 }
 
 inline unsigned int WorkerThread::StopRequested(void)